@@ -6,6 +6,7 @@
 #include "../../Common/MathHelper.h"
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
+#include "../../Common/TextureBatchLoader.h"
 #include "FrameResource.h"
 #include "Waves.h"
 
@@ -562,13 +563,14 @@ void TreeBillboardsApp::LoadTextures()
 	mTextures[fenceTex->Name]     = std::move(fenceTex);
 	mTextures[treeArrayTex->Name] = std::move(treeArrayTex);
 
+	// Read all files in parallel and upload them through one shared upload heap.
+	// The tree array ships with a single level, so its mips are built on load to stop the billboards aliasing.
+	TextureBatchLoader loader(md3dDevice.Get());
 	for (auto& tex : mTextures)
 	{
-		tex.second->Resource = d3dUtil::CreateTexture(md3dDevice.Get(),
-		                                              mCommandList.Get(),
-		                                              tex.second->Filename.c_str(),
-		                                              tex.second->UploadHeap);
+		loader.Add(tex.second.get(), tex.first == "treeArrayTex" ? DDS_LOADER_GENERATE_MIPS : DDS_LOADER_DEFAULT);
 	}
+	loader.Load(mCommandList.Get());
 }
 
 void TreeBillboardsApp::BuildRootSignature()
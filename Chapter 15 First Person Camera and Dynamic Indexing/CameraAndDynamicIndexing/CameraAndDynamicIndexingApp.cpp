@@ -6,6 +6,7 @@
 CameraAndDynamicIndexingApp::CameraAndDynamicIndexingApp(HINSTANCE hInstance)
 	: D3DApp(hInstance)
 {
+	mAppCaption = mMainWndCaption;
 }
 
 CameraAndDynamicIndexingApp::~CameraAndDynamicIndexingApp()
@@ -42,6 +43,9 @@ bool CameraAndDynamicIndexingApp::Initialize()
 	// Wait until initialization is complete.
 	FlushCommandQueue();
 
+	// The tail mips are on the GPU now, so their upload heaps can go.
+	mTextureStreamer->DisposeUploaders();
+
 	return true;
 }
 
@@ -71,6 +75,8 @@ void CameraAndDynamicIndexingApp::Update(const GameTimer& gt)
 	}
 
 	AnimateMaterials(gt);
+	UpdateLods(gt);
+	UpdateTextureStreaming(gt);
 	UpdateObjectCBs(gt);
 	UpdateMaterialBuffer(gt);
 	UpdateMainPassCB(gt);
@@ -88,6 +94,17 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 	// Reusing the command list reuses memory.
 	ThrowIfFailed(mCommandList->Reset(cmdListAlloc.Get(), mPSOs["opaque"].Get()));
 
+	// Record the copies for any mips that finished streaming in. This frame still draws with the old views
+	// (they stay valid until its fence), the materials pick up the new ones from the next frame on.
+	if (mTextureStreamer->Update(mCommandList.Get(), mCurrentFence + 1, mFence->GetCompletedValue()))
+	{
+		for (auto& e : mMaterialTextureIds)
+		{
+			e.first->DiffuseSrvHeapIndex = mTextureStreamer->GetSrvHeapIndex(e.second);
+			e.first->NumFramesDirty      = gNumFrameResources;
+		}
+	}
+
 	mCommandList->RSSetViewports(1, &mScreenViewport);
 	mCommandList->RSSetScissorRects(1, &mScissorRect);
 
@@ -121,7 +138,7 @@ void CameraAndDynamicIndexingApp::Draw(const GameTimer& gt)
 	// The root signature knows how many descriptors are expected in the table.
 	mCommandList->SetGraphicsRootDescriptorTable(3, mSrvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
-	DrawRenderItems(mCommandList.Get(), mOpaqueRitems);
+	DrawRenderItems(mCommandList.Get(), mDrawRitems);
 
 	// Indicate a state transition on the resource usage.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(),
@@ -199,6 +216,13 @@ void CameraAndDynamicIndexingApp::OnKeyboardInput(const GameTimer& gt)
 	if (GetAsyncKeyState('D') & 0x8000)
 		mCamera.Strafe(10.0f * dt);
 
+	// 1 turns level of detail selection on, 2 draws everything at full detail.
+	if (d3dUtil::IsKeyDown('1'))
+		mLodEnabled = true;
+
+	if (d3dUtil::IsKeyDown('2'))
+		mLodEnabled = false;
+
 	mCamera.UpdateViewMatrix();
 }
 
@@ -231,6 +255,67 @@ void CameraAndDynamicIndexingApp::UpdateObjectCBs(const GameTimer& gt)
 	}
 }
 
+void CameraAndDynamicIndexingApp::UpdateLods(const GameTimer& gt)
+{
+	mLodSelector.BeginFrame(mCamera.GetPosition(), mCamera.GetFovY(), (float)mClientHeight);
+
+	mDrawRitems.clear();
+	for (RenderItem* ri : mOpaqueRitems)
+	{
+		if (mLodEnabled)
+		{
+			if (!mLodSelector.Select(*ri->Lods, XMLoadFloat4x4(&ri->World), ri->Lod))
+				continue;
+		}
+		else
+		{
+			ri->Lod = LodState();
+		}
+
+		const SubmeshGeometry& level = ri->Lods->Levels[ri->Lod.Level];
+		ri->IndexCount               = level.IndexCount;
+		ri->StartIndexLocation       = level.StartIndexLocation;
+		ri->BaseVertexLocation       = level.BaseVertexLocation;
+		mDrawRitems.push_back(ri);
+	}
+
+	// Triangles actually submitted against the full detail count, next to the frame stats in the caption.
+	const LodSelector::Stats& stats = mLodSelector.GetStats();
+	if (mLodEnabled)
+	{
+		mMainWndCaption = mAppCaption +
+		                  L"    triangles: " + std::to_wstring(stats.TrianglesSubmitted) + L" / " + std::to_wstring(stats.TrianglesFull) +
+		                  L"   dropped: " + std::to_wstring(stats.ItemsCulled) + L" / " + std::to_wstring(stats.ItemsTested);
+	}
+	else
+	{
+		mMainWndCaption = mAppCaption + L"    LOD off";
+	}
+}
+
+void CameraAndDynamicIndexingApp::UpdateTextureStreaming(const GameTimer& gt)
+{
+	// Pixels covered by one world unit at distance 1 from the eye.
+	float pixelsPerUnit = mClientHeight / (2.0f * tanf(0.5f * mCamera.GetFovY()));
+
+	// Each texture is requested at the sharpest level any render item using it needs this frame.
+	std::unordered_map<UINT, float> screenSizes;
+	XMVECTOR                        eyePos = mCamera.GetPosition();
+	for (auto& e : mAllRitems)
+	{
+		XMMATRIX world    = XMLoadFloat4x4(&e->World);
+		float    distance = XMVectorGetX(XMVector3Length(world.r[3] - eyePos));
+		float    pixels   = e->TexRepeatWorldSize * pixelsPerUnit / std::max(distance, mCamera.GetNearZ());
+
+		UINT   id   = mMaterialTextureIds[e->Mat];
+		float& size = screenSizes[id];
+		size        = std::max(size, pixels);
+	}
+
+	for (auto& e : screenSizes)
+		mTextureStreamer->SetDesiredScreenSize(e.first, e.second);
+}
+
 void CameraAndDynamicIndexingApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
 	auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
@@ -316,19 +401,22 @@ void CameraAndDynamicIndexingApp::LoadTextures()
 	mTextures[tileTex->Name]   = std::move(tileTex);
 	mTextures[crateTex->Name]  = std::move(crateTex);
 
-	for (auto& tex : mTextures)
-	{
-		tex.second->Resource = d3dUtil::CreateTexture(md3dDevice.Get(),
-		                                              mCommandList.Get(),
-		                                              tex.second->Filename.c_str(),
-		                                              tex.second->UploadHeap);
-	}
+	// Only the headers are read here; the resources are created by the texture streamer once the SRV heap
+	// exists (see BuildDescriptorHeaps). With the index of the last run, only changed files are read again.
+	// The index is only a cache: if it can't be written (e.g. a read-only working directory), the next run
+	// scans again.
+	const std::wstring indexFilename = L"TextureCatalog.bin";
+
+	bool loaded = mTextureCatalog.Load(indexFilename);
+	auto scan   = mTextureCatalog.ScanDirectory(L"../../Textures");
+	if (!loaded || scan.FilesParsed > 0 || scan.FilesRemoved > 0)
+		mTextureCatalog.Save(indexFilename);
 }
 
 void CameraAndDynamicIndexingApp::BuildRootSignature()
 {
 	CD3DX12_DESCRIPTOR_RANGE texTable;
-	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 4, 0, 0); // (t0-t3, space 0) describes texture shader resources
+	texTable.Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 8, 0, 0); // (t0-t7, space 0) describes texture shader resources (2 streaming slots per texture)
 
 	// Root parameter can be a table, root descriptor or root constants.
 	CD3DX12_ROOT_PARAMETER slotRootParameter[4];
@@ -339,7 +427,7 @@ void CameraAndDynamicIndexingApp::BuildRootSignature()
 	slotRootParameter[0].InitAsConstantBufferView(0);                                        // Per Object constant buffer: b0
 	slotRootParameter[1].InitAsConstantBufferView(1);                                        // Per frame constant buffer: b1
 	slotRootParameter[2].InitAsShaderResourceView(0, 1);                                     // Per frame material array data: (t0, space 1)
-	slotRootParameter[3].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL); // Per frame texture array data: (t0-t3, space 0)
+	slotRootParameter[3].InitAsDescriptorTable(1, &texTable, D3D12_SHADER_VISIBILITY_PIXEL); // Per frame texture array data: (t0-t7, space 0)
 
 	auto staticSamplers = GetStaticSamplers();
 
@@ -375,50 +463,31 @@ void CameraAndDynamicIndexingApp::BuildDescriptorHeaps()
 	// Create the SRV heap.
 	//
 	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc = {};
-	srvHeapDesc.NumDescriptors             = 4;
+	srvHeapDesc.NumDescriptors             = 2 * (UINT)mTextures.size(); // the streamer flips between 2 views per texture
 	srvHeapDesc.Type                       = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 	srvHeapDesc.Flags                      = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
 	ThrowIfFailed(md3dDevice->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&mSrvDescriptorHeap)));
 
 	//
-	// Fill out the heap with actual descriptors.
+	// Load the tail mips of every texture. The streamer fills out the heap with the actual descriptors.
 	//
-	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-
-	auto bricksTex = mTextures["bricksTex"]->Resource;
-	auto stoneTex  = mTextures["stoneTex"]->Resource;
-	auto tileTex   = mTextures["tileTex"]->Resource;
-	auto crateTex  = mTextures["crateTex"]->Resource;
-
-	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-	srvDesc.Shader4ComponentMapping         = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-	srvDesc.Format                          = bricksTex->GetDesc().Format;
-	srvDesc.ViewDimension                   = D3D12_SRV_DIMENSION_TEXTURE2D;
-	srvDesc.Texture2D.MostDetailedMip       = 0;
-	srvDesc.Texture2D.MipLevels             = bricksTex->GetDesc().MipLevels;
-	srvDesc.Texture2D.ResourceMinLODClamp   = 0.0f;
-	md3dDevice->CreateShaderResourceView(bricksTex.Get(), &srvDesc, hDescriptor);
-
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-	srvDesc.Format              = stoneTex->GetDesc().Format;
-	srvDesc.Texture2D.MipLevels = stoneTex->GetDesc().MipLevels;
-	md3dDevice->CreateShaderResourceView(stoneTex.Get(), &srvDesc, hDescriptor);
-
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-	srvDesc.Format              = tileTex->GetDesc().Format;
-	srvDesc.Texture2D.MipLevels = tileTex->GetDesc().MipLevels;
-	md3dDevice->CreateShaderResourceView(tileTex.Get(), &srvDesc, hDescriptor);
-
-	// next descriptor
-	hDescriptor.Offset(1, mCbvSrvUavDescriptorSize);
-
-	srvDesc.Format              = crateTex->GetDesc().Format;
-	srvDesc.Texture2D.MipLevels = crateTex->GetDesc().MipLevels;
-	md3dDevice->CreateShaderResourceView(crateTex.Get(), &srvDesc, hDescriptor);
+	const UINT64 textureBudget = 16 * 1024 * 1024;
+	mTextureStreamer           = std::make_unique<TextureStreamer>(md3dDevice.Get(),
+	                                                               mSrvDescriptorHeap.Get(),
+	                                                               0,
+	                                                               mCbvSrvUavDescriptorSize,
+	                                                               (UINT)mTextures.size(),
+	                                                               textureBudget);
+
+	for (const char* name : {"bricksTex", "stoneTex", "tileTex", "crateTex"})
+	{
+		// Already catalogued by the scan, so this only compares the file size and write time.
+		UINT entry = mTextureCatalog.AddFile(mTextures[name]->Filename);
+		if (entry == DDSCatalog::kNotFound)
+			ThrowIfFailed(E_FAIL);
+
+		mStreamedTextureIds[name] = mTextureStreamer->RegisterTexture(mCommandList.Get(), mTextureCatalog.Entries()[entry]);
+	}
 }
 
 void CameraAndDynamicIndexingApp::BuildShadersAndInputLayout()
@@ -436,103 +505,57 @@ void CameraAndDynamicIndexingApp::BuildShadersAndInputLayout()
 
 void CameraAndDynamicIndexingApp::BuildShapeGeometry()
 {
-	GeometryGenerator           geoGen;
-	GeometryGenerator::MeshData box      = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3);
-	GeometryGenerator::MeshData grid     = geoGen.CreateGrid(20.0f, 30.0f, 60, 40);
-	GeometryGenerator::MeshData sphere   = geoGen.CreateSphere(0.5f, 20, 20);
-	GeometryGenerator::MeshData cylinder = geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20);
+	GeometryGenerator geoGen;
+
+	// The spheres and cylinders come with two coarser levels of detail. Fewer stacks cost the cylinder
+	// nothing visible, fewer slices show on the silhouette, so the thresholds keep those for far away.
+	std::vector<std::pair<std::string, GeometryGenerator::MeshData>> meshes;
+	meshes.emplace_back("box", geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3));
+	meshes.emplace_back("grid", geoGen.CreateGrid(20.0f, 30.0f, 60, 40));
+	meshes.emplace_back("sphere", geoGen.CreateSphere(0.5f, 20, 20));
+	meshes.emplace_back("sphere_lod1", geoGen.CreateSphere(0.5f, 12, 10));
+	meshes.emplace_back("sphere_lod2", geoGen.CreateSphere(0.5f, 6, 5));
+	meshes.emplace_back("cylinder", geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20));
+	meshes.emplace_back("cylinder_lod1", geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 10, 2));
+	meshes.emplace_back("cylinder_lod2", geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 6, 1));
 
 	//
 	// We are concatenating all the geometry into one big vertex/index buffer.  So
-	// define the regions in the buffer each submesh covers.
-	//
-
-	// Cache the vertex offsets to each object in the concatenated vertex buffer.
-	UINT boxVertexOffset      = 0;
-	UINT gridVertexOffset     = (UINT)box.Vertices.size();
-	UINT sphereVertexOffset   = gridVertexOffset + (UINT)grid.Vertices.size();
-	UINT cylinderVertexOffset = sphereVertexOffset + (UINT)sphere.Vertices.size();
-
-	// Cache the starting index for each object in the concatenated index buffer.
-	UINT boxIndexOffset      = 0;
-	UINT gridIndexOffset     = (UINT)box.Indices32.size();
-	UINT sphereIndexOffset   = gridIndexOffset + (UINT)grid.Indices32.size();
-	UINT cylinderIndexOffset = sphereIndexOffset + (UINT)sphere.Indices32.size();
-
-	SubmeshGeometry boxSubmesh;
-	boxSubmesh.IndexCount         = (UINT)box.Indices32.size();
-	boxSubmesh.StartIndexLocation = boxIndexOffset;
-	boxSubmesh.BaseVertexLocation = boxVertexOffset;
-
-	SubmeshGeometry gridSubmesh;
-	gridSubmesh.IndexCount         = (UINT)grid.Indices32.size();
-	gridSubmesh.StartIndexLocation = gridIndexOffset;
-	gridSubmesh.BaseVertexLocation = gridVertexOffset;
-
-	SubmeshGeometry sphereSubmesh;
-	sphereSubmesh.IndexCount         = (UINT)sphere.Indices32.size();
-	sphereSubmesh.StartIndexLocation = sphereIndexOffset;
-	sphereSubmesh.BaseVertexLocation = sphereVertexOffset;
-
-	SubmeshGeometry cylinderSubmesh;
-	cylinderSubmesh.IndexCount         = (UINT)cylinder.Indices32.size();
-	cylinderSubmesh.StartIndexLocation = cylinderIndexOffset;
-	cylinderSubmesh.BaseVertexLocation = cylinderVertexOffset;
-
-	//
-	// Extract the vertex elements we are interested in and pack the
-	// vertices of all the meshes into one vertex buffer.
+	// define the regions in the buffer each submesh covers, and extract the vertex
+	// elements we are interested in.
 	//
 
-	auto totalVertexCount =
-			box.Vertices.size() +
-			grid.Vertices.size() +
-			sphere.Vertices.size() +
-			cylinder.Vertices.size();
-
-	std::vector<Vertex> vertices(totalVertexCount);
+	auto geo  = std::make_unique<MeshGeometry>();
+	geo->Name = "shapeGeo";
 
-	UINT k = 0;
-	for (size_t i = 0; i < box.Vertices.size(); ++i, ++k)
+	std::vector<Vertex>        vertices;
+	std::vector<std::uint16_t> indices;
+	for (auto& mesh : meshes)
 	{
-		vertices[k].Pos    = box.Vertices[i].Position;
-		vertices[k].Normal = box.Vertices[i].Normal;
-		vertices[k].TexC   = box.Vertices[i].TexC;
-	}
+		GeometryGenerator::MeshData& data = mesh.second;
 
-	for (size_t i = 0; i < grid.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos    = grid.Vertices[i].Position;
-		vertices[k].Normal = grid.Vertices[i].Normal;
-		vertices[k].TexC   = grid.Vertices[i].TexC;
-	}
+		SubmeshGeometry submesh;
+		submesh.IndexCount         = (UINT)data.Indices32.size();
+		submesh.StartIndexLocation = (UINT)indices.size();
+		submesh.BaseVertexLocation = (INT)vertices.size();
+		BoundingBox::CreateFromPoints(submesh.Bounds, data.Vertices.size(), &data.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+		geo->DrawArgs[mesh.first] = submesh;
 
-	for (size_t i = 0; i < sphere.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos    = sphere.Vertices[i].Position;
-		vertices[k].Normal = sphere.Vertices[i].Normal;
-		vertices[k].TexC   = sphere.Vertices[i].TexC;
-	}
+		for (const auto& v : data.Vertices)
+		{
+			Vertex vertex;
+			vertex.Pos    = v.Position;
+			vertex.Normal = v.Normal;
+			vertex.TexC   = v.TexC;
+			vertices.push_back(vertex);
+		}
 
-	for (size_t i = 0; i < cylinder.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos    = cylinder.Vertices[i].Position;
-		vertices[k].Normal = cylinder.Vertices[i].Normal;
-		vertices[k].TexC   = cylinder.Vertices[i].TexC;
+		indices.insert(indices.end(), std::begin(data.GetIndices16()), std::end(data.GetIndices16()));
 	}
 
-	std::vector<std::uint16_t> indices;
-	indices.insert(indices.end(), std::begin(box.GetIndices16()), std::end(box.GetIndices16()));
-	indices.insert(indices.end(), std::begin(grid.GetIndices16()), std::end(grid.GetIndices16()));
-	indices.insert(indices.end(), std::begin(sphere.GetIndices16()), std::end(sphere.GetIndices16()));
-	indices.insert(indices.end(), std::begin(cylinder.GetIndices16()), std::end(cylinder.GetIndices16()));
-
 	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
-	auto geo  = std::make_unique<MeshGeometry>();
-	geo->Name = "shapeGeo";
-
 	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
 	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
@@ -550,10 +573,24 @@ void CameraAndDynamicIndexingApp::BuildShapeGeometry()
 	geo->IndexFormat          = DXGI_FORMAT_R16_UINT;
 	geo->IndexBufferByteSize  = ibByteSize;
 
-	geo->DrawArgs["box"]      = boxSubmesh;
-	geo->DrawArgs["grid"]     = gridSubmesh;
-	geo->DrawArgs["sphere"]   = sphereSubmesh;
-	geo->DrawArgs["cylinder"] = cylinderSubmesh;
+	//
+	// LOD chains, thresholds in pixels of projected bounding sphere diameter. The grid is the floor and
+	// is never dropped.
+	//
+
+	auto buildChain = [&](const std::string& name, std::vector<std::string> levels, std::vector<float> minScreenSizes)
+	{
+		LodChain& chain = mLodChains[name];
+		for (const auto& level : levels)
+			chain.Levels.push_back(geo->DrawArgs[level]);
+		chain.MinScreenSize = std::move(minScreenSizes);
+		BoundingSphere::CreateFromBoundingBox(chain.Bounds, chain.Levels[0].Bounds);
+	};
+
+	buildChain("box", {"box"}, {2.0f});
+	buildChain("grid", {"grid"}, {0.0f});
+	buildChain("sphere", {"sphere", "sphere_lod1", "sphere_lod2"}, {100.0f, 30.0f, 2.0f});
+	buildChain("cylinder", {"cylinder", "cylinder_lod1", "cylinder_lod2"}, {200.0f, 60.0f, 2.0f});
 
 	mGeometries[geo->Name] = std::move(geo);
 }
@@ -607,7 +644,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto bricks0                 = std::make_unique<Material>();
 	bricks0->Name                = "bricks0";
 	bricks0->MatCBIndex          = 0;
-	bricks0->DiffuseSrvHeapIndex = 0;
+	bricks0->DiffuseSrvHeapIndex = mTextureStreamer->GetSrvHeapIndex(mStreamedTextureIds["bricksTex"]);
 	bricks0->DiffuseAlbedo       = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 	bricks0->FresnelR0           = XMFLOAT3(0.02f, 0.02f, 0.02f);
 	bricks0->Roughness           = 0.1f;
@@ -615,7 +652,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto stone0                 = std::make_unique<Material>();
 	stone0->Name                = "stone0";
 	stone0->MatCBIndex          = 1;
-	stone0->DiffuseSrvHeapIndex = 1;
+	stone0->DiffuseSrvHeapIndex = mTextureStreamer->GetSrvHeapIndex(mStreamedTextureIds["stoneTex"]);
 	stone0->DiffuseAlbedo       = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 	stone0->FresnelR0           = XMFLOAT3(0.05f, 0.05f, 0.05f);
 	stone0->Roughness           = 0.3f;
@@ -623,7 +660,7 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto tile0                 = std::make_unique<Material>();
 	tile0->Name                = "tile0";
 	tile0->MatCBIndex          = 2;
-	tile0->DiffuseSrvHeapIndex = 2;
+	tile0->DiffuseSrvHeapIndex = mTextureStreamer->GetSrvHeapIndex(mStreamedTextureIds["tileTex"]);
 	tile0->DiffuseAlbedo       = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 	tile0->FresnelR0           = XMFLOAT3(0.02f, 0.02f, 0.02f);
 	tile0->Roughness           = 0.3f;
@@ -631,11 +668,16 @@ void CameraAndDynamicIndexingApp::BuildMaterials()
 	auto crate0                 = std::make_unique<Material>();
 	crate0->Name                = "crate0";
 	crate0->MatCBIndex          = 3;
-	crate0->DiffuseSrvHeapIndex = 3;
+	crate0->DiffuseSrvHeapIndex = mTextureStreamer->GetSrvHeapIndex(mStreamedTextureIds["crateTex"]);
 	crate0->DiffuseAlbedo       = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
 	crate0->FresnelR0           = XMFLOAT3(0.05f, 0.05f, 0.05f);
 	crate0->Roughness           = 0.2f;
 
+	mMaterialTextureIds[bricks0.get()] = mStreamedTextureIds["bricksTex"];
+	mMaterialTextureIds[stone0.get()]  = mStreamedTextureIds["stoneTex"];
+	mMaterialTextureIds[tile0.get()]   = mStreamedTextureIds["tileTex"];
+	mMaterialTextureIds[crate0.get()]  = mStreamedTextureIds["crateTex"];
+
 	mMaterials["bricks0"] = std::move(bricks0);
 	mMaterials["stone0"]  = std::move(stone0);
 	mMaterials["tile0"]   = std::move(tile0);
@@ -654,6 +696,8 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 	boxRitem->IndexCount         = boxRitem->Geo->DrawArgs["box"].IndexCount;
 	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
 	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	boxRitem->TexRepeatWorldSize = 2.0f;
+	boxRitem->Lods               = &mLodChains["box"];
 	mAllRitems.push_back(std::move(boxRitem));
 
 	auto gridRitem   = std::make_unique<RenderItem>();
@@ -666,6 +710,8 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 	gridRitem->IndexCount         = gridRitem->Geo->DrawArgs["grid"].IndexCount;
 	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
 	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+	gridRitem->TexRepeatWorldSize = 30.0f / 8.0f;
+	gridRitem->Lods               = &mLodChains["grid"];
 	mAllRitems.push_back(std::move(gridRitem));
 
 	XMMATRIX brickTexTransform = XMMatrixScaling(1.0f, 1.0f, 1.0f);
@@ -692,6 +738,8 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 		leftCylRitem->IndexCount         = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		leftCylRitem->TexRepeatWorldSize = 3.0f;
+		leftCylRitem->Lods               = &mLodChains["cylinder"];
 
 		XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
 		XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -702,6 +750,8 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 		rightCylRitem->IndexCount         = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		rightCylRitem->TexRepeatWorldSize = 3.0f;
+		rightCylRitem->Lods               = &mLodChains["cylinder"];
 
 		XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
 		leftSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -712,6 +762,8 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 		leftSphereRitem->IndexCount         = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		leftSphereRitem->TexRepeatWorldSize = 1.0f;
+		leftSphereRitem->Lods               = &mLodChains["sphere"];
 
 		XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
 		rightSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -722,6 +774,8 @@ void CameraAndDynamicIndexingApp::BuildRenderItems()
 		rightSphereRitem->IndexCount         = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		rightSphereRitem->TexRepeatWorldSize = 1.0f;
+		rightSphereRitem->Lods               = &mLodChains["sphere"];
 
 		mAllRitems.push_back(std::move(leftCylRitem));
 		mAllRitems.push_back(std::move(rightCylRitem));
@@ -5,6 +5,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TextureStreamer.h"
+#include "../../Common/LodSelector.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -33,6 +35,13 @@ struct RenderItem
 	UINT IndexCount         = 0;
 	UINT StartIndexLocation = 0;
 	int  BaseVertexLocation = 0;
+
+	// World-space size covered by one repeat of the diffuse texture. Drives the mip streaming feedback.
+	float TexRepeatWorldSize = 1.0f;
+
+	// Levels of detail to draw from; UpdateLods copies the chosen one into the draw parameters above.
+	const LodChain* Lods = nullptr;
+	LodState        Lod;
 };
 
 class CameraAndDynamicIndexingApp : public D3DApp
@@ -59,6 +68,8 @@ private:
 	void UpdateObjectCBs(const GameTimer& gt);
 	void UpdateMaterialBuffer(const GameTimer& gt);
 	void UpdateMainPassCB(const GameTimer& gt);
+	void UpdateLods(const GameTimer& gt);
+	void UpdateTextureStreaming(const GameTimer& gt);
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -87,10 +98,22 @@ private:
 	std::unordered_map<std::string, ComPtr<ID3DBlob>>              mShaders;
 	std::unordered_map<std::string, ComPtr<ID3D12PipelineState>>   mPSOs;
 
+	// Diffuse textures are streamed: only the small mips are loaded up front.
+	DDSCatalog                            mTextureCatalog;
+	std::unique_ptr<TextureStreamer>      mTextureStreamer;
+	std::unordered_map<std::string, UINT> mStreamedTextureIds; // texture name -> streamer id
+	std::unordered_map<Material*, UINT>   mMaterialTextureIds; // material -> streamer id of its diffuse map
+
 	std::vector<D3D12_INPUT_ELEMENT_DESC>    mInputLayout;
 	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
 	std::vector<RenderItem*>                 mOpaqueRitems;
+	std::vector<RenderItem*>                 mDrawRitems; // opaque items left after LOD selection, rebuilt every frame
 	PassConstants                            mMainPassCB;
 	Camera                                   mCamera;
 	POINT                                    mLastMousePos;
+
+	std::unordered_map<std::string, LodChain> mLodChains;
+	LodSelector                               mLodSelector;
+	bool                                      mLodEnabled = true;
+	std::wstring                              mAppCaption;
 };
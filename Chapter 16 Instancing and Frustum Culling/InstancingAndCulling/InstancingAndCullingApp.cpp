@@ -51,8 +51,6 @@ void InstancingAndCullingApp::OnResize()
 	D3DApp::OnResize();
 
 	mCamera.SetLens(0.25f * MathHelper::Pi, AspectRatio(), 1.0f, 1000.0f);
-
-	BoundingFrustum::CreateFromMatrix(mCamFrustum, mCamera.GetProj());
 }
 
 void InstancingAndCullingApp::Update(const GameTimer& gt)
@@ -150,10 +148,17 @@ void InstancingAndCullingApp::Draw(const GameTimer& gt)
 
 void InstancingAndCullingApp::OnMouseDown(WPARAM btnState, int x, int y)
 {
-	mLastMousePos.x = x;
-	mLastMousePos.y = y;
+	if ((btnState & MK_LBUTTON) != 0)
+	{
+		mLastMousePos.x = x;
+		mLastMousePos.y = y;
 
-	SetCapture(mhMainWnd);
+		SetCapture(mhMainWnd);
+	}
+	else if ((btnState & MK_RBUTTON) != 0)
+	{
+		Pick(x, y);
+	}
 }
 
 void InstancingAndCullingApp::OnMouseUp(WPARAM btnState, int x, int y)
@@ -199,13 +204,25 @@ void InstancingAndCullingApp::OnKeyboardInput(const GameTimer& gt)
 	if (GetAsyncKeyState('2') & 0x8000)
 		mFrustumCullingEnabled = false;
 
+	if (GetAsyncKeyState('3') & 0x8000)
+		mDeterministicCulling = true;
+
+	if (GetAsyncKeyState('4') & 0x8000)
+		mDeterministicCulling = false;
+
+	if (GetAsyncKeyState('5') & 0x8000)
+		mHierarchicalCulling = true;
+
+	if (GetAsyncKeyState('6') & 0x8000)
+		mHierarchicalCulling = false;
+
 	mCamera.UpdateViewMatrix();
 }
 
 void InstancingAndCullingApp::UpdateInstanceData(const GameTimer& gt)
 {
-	XMMATRIX view    = mCamera.GetView();
-	XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
+	// Extract the world space frustum planes once; every instance is tested against them directly.
+	const FrustumCuller::Frustum frustum = FrustumCuller::ExtractPlanes(XMMatrixMultiply(mCamera.GetView(), mCamera.GetProj()));
 
 	auto currInstanceBuffer = mCurrFrameResource->InstanceBuffer.get();
 
@@ -213,42 +230,70 @@ void InstancingAndCullingApp::UpdateInstanceData(const GameTimer& gt)
 	{
 		const auto& instanceData = e->Instances;
 
-		int visibleInstanceCount = 0;
-
-		for (UINT i = 0; i < (UINT)instanceData.size(); ++i)
+		// Called from the culling threads: slot is the instance's place in the compacted buffer.
+		auto writeInstance = [&](UINT slot, UINT index)
 		{
-			XMMATRIX world        = XMLoadFloat4x4(&instanceData[i].World);
-			XMMATRIX texTransform = XMLoadFloat4x4(&instanceData[i].TexTransform);
+			const auto& instance = instanceData[index];
 
-			XMMATRIX invWorld = XMMatrixInverse(&XMMatrixDeterminant(world), world);
+			XMMATRIX world        = XMLoadFloat4x4(&instance.World);
+			XMMATRIX texTransform = XMLoadFloat4x4(&instance.TexTransform);
 
-			// View space to the object's local space.
-			XMMATRIX viewToLocal = XMMatrixMultiply(invView, invWorld);
+			InstanceData data;
+			XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+			XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
+			data.MaterialIndex = instance.MaterialIndex;
 
-			// Transform the camera frustum from view space to the object's local space.
-			BoundingFrustum localSpaceFrustum;
-			mCamFrustum.Transform(localSpaceFrustum, viewToLocal);
+			// Write the instance data to structured buffer for the visible objects.
+			currInstanceBuffer->StreamData(slot, data);
+		};
 
-			// Perform the box/frustum intersection test in local space.
-			if ((localSpaceFrustum.Contains(e->Bounds) != DirectX::DISJOINT) || (mFrustumCullingEnabled == false))
-			{
-				InstanceData data;
-				XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
-				XMStoreFloat4x4(&data.TexTransform, XMMatrixTranspose(texTransform));
-				data.MaterialIndex = instanceData[i].MaterialIndex;
+		UINT visibleInstanceCount = (UINT)instanceData.size();
+		if (mFrustumCullingEnabled && mHierarchicalCulling)
+		{
+			// The tree rejects or accepts whole subtrees; only the writes are spread across threads.
+			mVisibleInstances.resize(instanceData.size());
+			visibleInstanceCount = e->InstanceBvh.Cull(frustum, mVisibleInstances.data());
 
-				// Write the instance data to structured buffer for the visible objects.
-				currInstanceBuffer->CopyData(visibleInstanceCount++, data);
-			}
+			const UINT chunkCount = (visibleInstanceCount + FrustumCuller::kParallelChunkSize - 1) / FrustumCuller::kParallelChunkSize;
+			ParallelFor(chunkCount, mCullThreadCount, [&](uint32_t chunk)
+			{
+				const UINT first = chunk * FrustumCuller::kParallelChunkSize;
+				const UINT last  = std::min(first + FrustumCuller::kParallelChunkSize, visibleInstanceCount);
+				for (UINT i = first; i < last; ++i)
+					writeInstance(i, mVisibleInstances[i]);
+			});
+		}
+		else if (mFrustumCullingEnabled)
+		{
+			visibleInstanceCount = e->InstanceBounds.CullParallel(frustum,
+			                                                      mCullThreadCount,
+			                                                      mDeterministicCulling,
+			                                                      mCullScratch,
+			                                                      writeInstance);
+		}
+		else
+		{
+			const UINT chunkCount = (visibleInstanceCount + FrustumCuller::kParallelChunkSize - 1) / FrustumCuller::kParallelChunkSize;
+			ParallelFor(chunkCount, mCullThreadCount, [&](uint32_t chunk)
+			{
+				const UINT first = chunk * FrustumCuller::kParallelChunkSize;
+				const UINT last  = std::min(first + FrustumCuller::kParallelChunkSize, visibleInstanceCount);
+				for (UINT i = first; i < last; ++i)
+					writeInstance(i, i);
+			});
 		}
 
+		// The workers' streaming stores are ordered by ParallelFor's atomic counter; this covers the calling thread.
+		StreamFence();
+
 		e->InstanceCount = visibleInstanceCount;
 
 		std::wostringstream outs;
 		outs.precision(6);
 		outs << L"Instancing and Culling Demo" <<
 				L"    " << e->InstanceCount <<
-				L" objects visible out of " << e->Instances.size();
+				L" objects visible out of " << e->Instances.size() <<
+				mPickedText;
 		mMainWndCaption = outs.str();
 	}
 }
@@ -607,6 +652,11 @@ void InstancingAndCullingApp::BuildGeometryFromFile(const std::string& fileName)
 
 	geo->DrawArgs[fileName] = submesh;
 
+	// Shared by every instance of the mesh when picking.
+	auto meshBvh = std::make_unique<TriangleBvh>();
+	meshBvh->Build(*geo, submesh);
+	mMeshBvhs[fileName] = std::move(meshBvh);
+
 	mGeometries[geo->Name] = std::move(geo);
 }
 
@@ -770,11 +820,33 @@ void InstancingAndCullingApp::BuildRenderItems()
 		}
 	}
 
+	// The instances never move, so their world space bounds are computed once.
+	std::vector<BoundingBox> worldBounds(mInstanceCount);
+	skullRitem->InstanceBounds.Reserve(mInstanceCount);
+	for (UINT i = 0; i < mInstanceCount; ++i)
+	{
+		skullRitem->Bounds.Transform(worldBounds[i], XMLoadFloat4x4(&skullRitem->Instances[i].World));
+		skullRitem->InstanceBounds.Add(worldBounds[i]);
+	}
+	skullRitem->InstanceBvh.Build(worldBounds.data(), mInstanceCount);
+
 	mAllRitems.push_back(std::move(skullRitem));
 
 	// All the render items are opaque.
 	for (auto& e : mAllRitems)
 		mOpaqueRitems.push_back(e.get());
+
+	// One pick instance per drawn instance; they all point at the mesh tree of their geometry.
+	for (auto& e : mAllRitems)
+	{
+		const TriangleBvh* meshBvh = mMeshBvhs[e->Geo->Name].get();
+		for (UINT i = 0; i < (UINT)e->Instances.size(); ++i)
+		{
+			mPickScene.AddInstance(meshBvh, XMLoadFloat4x4(&e->Instances[i].World));
+			mPickTargets.push_back({e.get(), i});
+		}
+	}
+	mPickScene.Build();
 }
 
 void InstancingAndCullingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
@@ -797,6 +869,37 @@ void InstancingAndCullingApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList
 	}
 }
 
+void InstancingAndCullingApp::Pick(int sx, int sy)
+{
+	XMFLOAT4X4 P = mCamera.GetProj4x4f();
+
+	// Compute picking ray in view space.
+	float vx = (+2.0f * sx / mClientWidth - 1.0f) / P(0, 0);
+	float vy = (-2.0f * sy / mClientHeight + 1.0f) / P(1, 1);
+
+	// Move it to world space; the two-level tree takes it into the space of each candidate instance.
+	XMMATRIX V         = mCamera.GetView();
+	XMMATRIX invView   = XMMatrixInverse(&XMMatrixDeterminant(V), V);
+	XMVECTOR rayOrigin = XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f), invView);
+	XMVECTOR rayDir    = XMVector3Normalize(XMVector3TransformNormal(XMVectorSet(vx, vy, 1.0f, 0.0f), invView));
+
+	TwoLevelBvh::TraceStats stats;
+	TwoLevelBvh::Hit        hit;
+	std::wostringstream     outs;
+	if (mPickScene.Intersect(rayOrigin, rayDir, MathHelper::Infinity, hit, &stats))
+	{
+		outs << L"    picked instance " << mPickTargets[hit.Instance].second <<
+				L", triangle " << hit.Mesh.Triangle <<
+				L" at distance " << hit.Mesh.T;
+	}
+	else
+	{
+		outs << L"    picked nothing";
+	}
+	outs << L" (" << stats.InstancesTested << L" of " << mPickScene.InstanceCount() << L" instances tested)";
+	mPickedText = outs.str();
+}
+
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> InstancingAndCullingApp::GetStaticSamplers()
 {
 	// Applications usually only need a handful of samplers.  So just define them all up front
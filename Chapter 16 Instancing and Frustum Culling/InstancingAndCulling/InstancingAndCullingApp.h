@@ -5,6 +5,9 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/FrustumCuller.h"
+#include "../../Common/SceneBvh.h"
+#include "../../Common/TwoLevelBvh.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -27,7 +30,9 @@ struct RenderItem
 	D3D12_PRIMITIVE_TOPOLOGY PrimitiveType = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
 	BoundingBox               Bounds;
-	std::vector<InstanceData> Instances; // store instance data for all instances of this render item in the scene
+	std::vector<InstanceData> Instances;      // store instance data for all instances of this render item in the scene
+	FrustumCuller             InstanceBounds; // world space bounds of every instance, in the order of Instances
+	SceneBvh                  InstanceBvh;    // hierarchy over the same bounds, for hierarchical culling
 
 	// DrawIndexedInstanced parameters.
 	UINT IndexCount         = 0;
@@ -61,6 +66,7 @@ private:
 	void UpdateInstanceData(const GameTimer& gt);
 	void UpdateMaterialBuffer(const GameTimer& gt);
 	void UpdateMainPassCB(const GameTimer& gt);
+	void Pick(int sx, int sy);
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -82,6 +88,7 @@ private:
 	ComPtr<ID3D12RootSignature>                                    mRootSignature          = nullptr;
 	ComPtr<ID3D12DescriptorHeap>                                   mSrvDescriptorHeap      = nullptr;
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
+	std::unordered_map<std::string, std::unique_ptr<TriangleBvh>>  mMeshBvhs; // bottom level of mPickScene, one per MeshGeometry
 	std::unordered_map<std::string, std::unique_ptr<Material>>     mMaterials;
 	std::unordered_map<std::string, std::unique_ptr<Texture>>      mTextures;
 	std::unordered_map<std::string, ComPtr<ID3DBlob>>              mShaders;
@@ -91,7 +98,14 @@ private:
 	std::vector<RenderItem*>                                       mOpaqueRitems;
 	UINT                                                           mInstanceCount         = 0; // total instance to draw
 	bool                                                           mFrustumCullingEnabled = true;
-	BoundingFrustum                                                mCamFrustum; // BoundingFrustum is provided by DirectX collision library
+	bool                                                           mDeterministicCulling  = true; // keep visible instances in scene order
+	UINT                                                           mCullThreadCount       = 0;    // 0 = one per hardware thread
+	FrustumCuller::ParallelScratch                                 mCullScratch;
+	bool                                                           mHierarchicalCulling   = false; // cull through RenderItem::InstanceBvh
+	std::vector<UINT>                                              mVisibleInstances;              // indices written by SceneBvh::Cull
+	TwoLevelBvh                                                    mPickScene;                     // every instance of every render item
+	std::vector<std::pair<RenderItem*, UINT>>                      mPickTargets;                   // render item and instance of every mPickScene instance
+	std::wstring                                                   mPickedText;                    // caption suffix describing the last pick
 	PassConstants                                                  mMainPassCB;
 	Camera                                                         mCamera;
 	POINT                                                          mLastMousePos;
@@ -7,6 +7,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TriangleBvh.h"
+#include "../../Common/MeshWelder.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -34,6 +36,7 @@ struct RenderItem
 	UINT                     IndexCount         = 0;
 	UINT                     StartIndexLocation = 0;
 	int                      BaseVertexLocation = 0;
+	const TriangleBvh*       Bvh                = nullptr; // triangles of the submesh, for picking
 };
 
 enum class RenderLayer : int
@@ -89,6 +92,7 @@ private:
 	ComPtr<ID3D12RootSignature>                                    mRootSignature          = nullptr;
 	ComPtr<ID3D12DescriptorHeap>                                   mSrvDescriptorHeap      = nullptr;
 	std::unordered_map<std::string, std::unique_ptr<MeshGeometry>> mGeometries;
+	std::unordered_map<std::string, std::unique_ptr<TriangleBvh>>  mMeshBvhs; // per submesh, built from the CPU copies of the buffers
 	std::unordered_map<std::string, std::unique_ptr<Material>>     mMaterials;
 	std::unordered_map<std::string, std::unique_ptr<Texture>>      mTextures;
 	std::unordered_map<std::string, ComPtr<ID3DBlob>>              mShaders;
@@ -571,7 +575,7 @@ void PickingApp::BuildCarGeometry()
 	fin >> ignore;
 	fin >> ignore;
 
-	std::vector<std::int32_t> indices(3 * tcount);
+	std::vector<std::uint32_t> indices(3 * tcount);
 	for (UINT i = 0; i < tcount; ++i)
 	{
 		fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
@@ -579,13 +583,22 @@ void PickingApp::BuildCarGeometry()
 
 	fin.close();
 
+	// car.txt repeats the vertices shared by neighbouring faces; weld the ones whose position and normal match.
+	MeshWelder::Options weldOptions;
+	weldOptions.Attributes        = {{offsetof(Vertex, Pos), 3, 0.0f}, {offsetof(Vertex, Normal), 3, 0.0f}};
+	weldOptions.RemoveDegenerates = true;
+
+	const MeshWelder::Report welded = MeshWelder::Weld(vertices.data(), sizeof(Vertex), vcount, indices.data(), (UINT)indices.size(), weldOptions);
+	vertices.resize(welded.VertexCountAfter);
+	indices.resize(welded.TriangleCountAfter * 3);
+
 	//
 	// Pack the indices of all the meshes into one index buffer.
 	//
 
 	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint32_t);
 
 	auto geo  = std::make_unique<MeshGeometry>();
 	geo->Name = "carGeo";
@@ -615,6 +628,10 @@ void PickingApp::BuildCarGeometry()
 
 	geo->DrawArgs["car"] = submesh;
 
+	auto carBvh = std::make_unique<TriangleBvh>();
+	carBvh->Build(*geo, submesh);
+	mMeshBvhs["car"] = std::move(carBvh);
+
 	mGeometries[geo->Name] = std::move(geo);
 }
 
@@ -726,6 +743,7 @@ void PickingApp::BuildRenderItems()
 	carRitem->IndexCount         = carRitem->Geo->DrawArgs["car"].IndexCount;
 	carRitem->StartIndexLocation = carRitem->Geo->DrawArgs["car"].StartIndexLocation;
 	carRitem->BaseVertexLocation = carRitem->Geo->DrawArgs["car"].BaseVertexLocation;
+	carRitem->Bvh                = mMeshBvhs["car"].get();
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(carRitem.get());
 
 	auto pickedRitem           = std::make_unique<RenderItem>();
@@ -859,8 +877,6 @@ void PickingApp::Pick(int sx, int sy)
 	// of objects that can be selected.   
 	for (auto ri : mRitemLayer[(int)RenderLayer::Opaque])
 	{
-		auto geo = ri->Geo;
-
 		// Skip invisible render-items.
 		if (ri->Visible == false)
 			continue;
@@ -876,57 +892,21 @@ void PickingApp::Pick(int sx, int sy)
 		// Make the ray direction unit length for the intersection tests.
 		rayDir = XMVector3Normalize(rayDir);
 
-		// If we hit the bounding box of the Mesh, then we might have picked a Mesh triangle,
-		// so do the ray/triangle tests.
-		//
-		// If we did not hit the bounding box, then it is impossible that we hit 
-		// the Mesh, so do not waste effort doing ray/triangle tests.
-		float tmin = 0.0f;
-		if (ri->Bounds.Intersects(rayOrigin, rayDir, tmin))
+		// The BVH rejects the ray at the root box if it misses the Mesh, then only tests the
+		// triangles in the leaves the ray passes through, nearest first.
+		TriangleBvh::Hit hit;
+		if (ri->Bvh != nullptr && ri->Bvh->Intersect(rayOrigin, rayDir, MathHelper::Infinity, hit))
 		{
-			// NOTE: For the demo, we know what to cast the vertex/index data to.  If we were mixing
-			// formats, some metadata would be needed to figure out what to cast it to.
-			auto vertices = (Vertex*)geo->VertexBufferCPU->GetBufferPointer();
-			auto indices  = (std::uint32_t*)geo->IndexBufferCPU->GetBufferPointer();
-			UINT triCount = ri->IndexCount / 3;
-
-			// Find the nearest ray/triangle intersection.
-			tmin = MathHelper::Infinity;
-			for (UINT i = 0; i < triCount; ++i)
-			{
-				// Indices for this triangle.
-				UINT i0 = indices[i * 3 + 0];
-				UINT i1 = indices[i * 3 + 1];
-				UINT i2 = indices[i * 3 + 2];
-
-				// Vertices for this triangle.
-				XMVECTOR v0 = XMLoadFloat3(&vertices[i0].Pos);
-				XMVECTOR v1 = XMLoadFloat3(&vertices[i1].Pos);
-				XMVECTOR v2 = XMLoadFloat3(&vertices[i2].Pos);
-
-				// We have to iterate over all the triangles in order to find the nearest intersection.
-				float t = 0.0f;
-				if (TriangleTests::Intersects(rayOrigin, rayDir, v0, v1, v2, t))
-				{
-					if (t < tmin)
-					{
-						// This is the new nearest picked triangle.
-						tmin                = t;
-						UINT pickedTriangle = i;
-
-						mPickedRitem->Visible            = true;
-						mPickedRitem->IndexCount         = 3;
-						mPickedRitem->BaseVertexLocation = 0;
-
-						// Picked render item needs same world matrix as object picked.
-						mPickedRitem->World          = ri->World;
-						mPickedRitem->NumFramesDirty = gNumFrameResources;
-
-						// Offset to the picked triangle in the mesh index buffer.
-						mPickedRitem->StartIndexLocation = 3 * pickedTriangle;
-					}
-				}
-			}
+			mPickedRitem->Visible            = true;
+			mPickedRitem->IndexCount         = 3;
+			mPickedRitem->BaseVertexLocation = ri->BaseVertexLocation;
+
+			// Picked render item needs same world matrix as object picked.
+			mPickedRitem->World          = ri->World;
+			mPickedRitem->NumFramesDirty = gNumFrameResources;
+
+			// Offset to the picked triangle in the mesh index buffer.
+			mPickedRitem->StartIndexLocation = ri->StartIndexLocation + 3 * hit.Triangle;
 		}
 	}
 }
@@ -7,6 +7,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/MultiViewCuller.h"
 #include "FrameResource.h"
 #include "CubeRenderTarget.h"
 
@@ -52,6 +53,10 @@ struct RenderItem
 	UINT IndexCount         = 0;
 	UINT StartIndexLocation = 0;
 	int  BaseVertexLocation = 0;
+
+	// Local space bounds of the submesh and the object index returned by MultiViewCuller::AddObject.
+	BoundingBox Bounds;
+	UINT        CullIndex = 0;
 };
 
 enum class RenderLayer : int
@@ -89,6 +94,7 @@ private:
 	void UpdateMaterialBuffer(const GameTimer& gt);
 	void UpdateMainPassCB(const GameTimer& gt);
 	void UpdateCubeMapFacePassCBs();
+	void CullRenderItems();
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -132,6 +138,12 @@ private:
 	// Render items divided by PSO.
 	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+	// Opaque items and reflectors culled against the camera and the six cube map faces, rebuilt every frame.
+	MultiViewCuller          mViewCuller;
+	std::vector<RenderItem*> mCameraOpaqueRitems;
+	std::vector<RenderItem*> mCameraReflectorRitems;
+	std::vector<RenderItem*> mCubeFaceOpaqueRitems[6];
+
 	UINT mSkyTexHeapIndex     = 0;
 	UINT mDynamicTexHeapIndex = 0; //! NEW!!!
 
@@ -288,6 +300,7 @@ void DynamicCubeMapApp::Update(const GameTimer& gt)
 	UpdateObjectCBs(gt);
 	UpdateMaterialBuffer(gt);
 	UpdateMainPassCB(gt);
+	CullRenderItems();
 }
 
 void DynamicCubeMapApp::Draw(const GameTimer& gt)
@@ -354,12 +367,12 @@ void DynamicCubeMapApp::Draw(const GameTimer& gt)
 	dynamicTexDescriptor.Offset((UINT)mDynamicTexHeapIndex, mCbvSrvUavDescriptorSize);
 	mCommandList->SetGraphicsRootDescriptorTable(3, dynamicTexDescriptor);
 
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::OpaqueDynamicReflectors]);
+	DrawRenderItems(mCommandList.Get(), mCameraReflectorRitems);
 
 	// Use the static "background" cube map for the other objects (including the sky)
 	mCommandList->SetGraphicsRootDescriptorTable(3, skyTexDescriptor);
 
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+	DrawRenderItems(mCommandList.Get(), mCameraOpaqueRitems);
 
 	mCommandList->SetPipelineState(mPSOs["sky"].Get());
 	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
@@ -563,6 +576,26 @@ void DynamicCubeMapApp::UpdateCubeMapFacePassCBs()
 	}
 }
 
+void DynamicCubeMapApp::CullRenderItems()
+{
+	BoundingBox skullBounds;
+	mSkullRitem->Bounds.Transform(skullBounds, XMLoadFloat4x4(&mSkullRitem->World));
+	mViewCuller.SetObject(mSkullRitem->CullIndex, skullBounds);
+
+	// Seven views (the camera and the six cube map faces) tested in one pass over the items.
+	mViewCuller.ClearViews();
+	const UINT cameraView = mViewCuller.AddView(XMMatrixMultiply(mCamera.GetView(), mCamera.GetProj()));
+	UINT       faceViews[6];
+	for (int i = 0; i < 6; ++i)
+		faceViews[i] = mViewCuller.AddView(XMMatrixMultiply(mCubeMapCamera[i].GetView(), mCubeMapCamera[i].GetProj()));
+	mViewCuller.Cull();
+
+	mViewCuller.BuildDrawList(cameraView, mRitemLayer[(int)RenderLayer::Opaque], mCameraOpaqueRitems);
+	mViewCuller.BuildDrawList(cameraView, mRitemLayer[(int)RenderLayer::OpaqueDynamicReflectors], mCameraReflectorRitems);
+	for (int i = 0; i < 6; ++i)
+		mViewCuller.BuildDrawList(faceViews[i], mRitemLayer[(int)RenderLayer::Opaque], mCubeFaceOpaqueRitems[i]);
+}
+
 void DynamicCubeMapApp::LoadTextures()
 {
 	std::vector<std::string> texNames =
@@ -926,6 +959,12 @@ void DynamicCubeMapApp::BuildShapeGeometry()
 	cylinderSubmesh.StartIndexLocation = cylinderIndexOffset;
 	cylinderSubmesh.BaseVertexLocation = cylinderVertexOffset;
 
+	// Local bounds of every shape, used for culling.
+	BoundingBox::CreateFromPoints(boxSubmesh.Bounds, box.Vertices.size(), &box.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(gridSubmesh.Bounds, grid.Vertices.size(), &grid.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(sphereSubmesh.Bounds, sphere.Vertices.size(), &sphere.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(cylinderSubmesh.Bounds, cylinder.Vertices.size(), &cylinder.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+
 	//
 	// Extract the vertex elements we are interested in and pack the
 	// vertices of all the meshes into one vertex buffer.
@@ -1135,6 +1174,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 	skyRitem->IndexCount         = skyRitem->Geo->DrawArgs["sphere"].IndexCount;
 	skyRitem->StartIndexLocation = skyRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	skyRitem->BaseVertexLocation = skyRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	skyRitem->Bounds             = skyRitem->Geo->DrawArgs["sphere"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Sky].push_back(skyRitem.get());
 	mAllRitems.push_back(std::move(skyRitem));
@@ -1149,6 +1189,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 	skullRitem->IndexCount         = skullRitem->Geo->DrawArgs["skull"].IndexCount;
 	skullRitem->StartIndexLocation = skullRitem->Geo->DrawArgs["skull"].StartIndexLocation;
 	skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
+	skullRitem->Bounds             = skullRitem->Geo->DrawArgs["skull"].Bounds;
 
 	mSkullRitem = skullRitem.get();
 
@@ -1165,6 +1206,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 	boxRitem->IndexCount         = boxRitem->Geo->DrawArgs["box"].IndexCount;
 	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
 	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	boxRitem->Bounds             = boxRitem->Geo->DrawArgs["box"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(boxRitem.get());
 	mAllRitems.push_back(std::move(boxRitem));
@@ -1179,6 +1221,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 	globeRitem->IndexCount         = globeRitem->Geo->DrawArgs["sphere"].IndexCount;
 	globeRitem->StartIndexLocation = globeRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	globeRitem->BaseVertexLocation = globeRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	globeRitem->Bounds             = globeRitem->Geo->DrawArgs["sphere"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::OpaqueDynamicReflectors].push_back(globeRitem.get());
 	mAllRitems.push_back(std::move(globeRitem));
@@ -1193,6 +1236,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 	gridRitem->IndexCount         = gridRitem->Geo->DrawArgs["grid"].IndexCount;
 	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
 	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+	gridRitem->Bounds             = gridRitem->Geo->DrawArgs["grid"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(gridRitem.get());
 	mAllRitems.push_back(std::move(gridRitem));
@@ -1221,6 +1265,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 		leftCylRitem->IndexCount         = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		leftCylRitem->Bounds             = leftCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
 		XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
 		XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -1231,6 +1276,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 		rightCylRitem->IndexCount         = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		rightCylRitem->Bounds             = rightCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
 		XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
 		leftSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -1241,6 +1287,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 		leftSphereRitem->IndexCount         = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		leftSphereRitem->Bounds             = leftSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
 		XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
 		rightSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -1251,6 +1298,7 @@ void DynamicCubeMapApp::BuildRenderItems()
 		rightSphereRitem->IndexCount         = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		rightSphereRitem->Bounds             = rightSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(leftCylRitem.get());
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(rightCylRitem.get());
@@ -1262,6 +1310,20 @@ void DynamicCubeMapApp::BuildRenderItems()
 		mAllRitems.push_back(std::move(leftSphereRitem));
 		mAllRitems.push_back(std::move(rightSphereRitem));
 	}
+
+	// Only the skull moves; its bounds are refreshed every frame in CullRenderItems.
+	for (RenderItem* ri : mRitemLayer[(int)RenderLayer::Opaque])
+	{
+		BoundingBox worldBounds;
+		ri->Bounds.Transform(worldBounds, XMLoadFloat4x4(&ri->World));
+		ri->CullIndex = mViewCuller.AddObject(worldBounds);
+	}
+	for (RenderItem* ri : mRitemLayer[(int)RenderLayer::OpaqueDynamicReflectors])
+	{
+		BoundingBox worldBounds;
+		ri->Bounds.Transform(worldBounds, XMLoadFloat4x4(&ri->World));
+		ri->CullIndex = mViewCuller.AddObject(worldBounds);
+	}
 }
 
 void DynamicCubeMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
@@ -1315,7 +1377,7 @@ void DynamicCubeMapApp::DrawSceneToCubeMap()
 		D3D12_GPU_VIRTUAL_ADDRESS passCBAddress = passCB->GetGPUVirtualAddress() + (1 + i) * passCBByteSize;
 		mCommandList->SetGraphicsRootConstantBufferView(1, passCBAddress);
 
-		DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+		DrawRenderItems(mCommandList.Get(), mCubeFaceOpaqueRitems[i]);
 
 		mCommandList->SetPipelineState(mPSOs["sky"].Get());
 		DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Sky]);
@@ -12,6 +12,12 @@ struct ObjectConstants
 	UINT     ObjPad0;
 	UINT     ObjPad1;
 	UINT     ObjPad2;
+
+	// VertexPacker::Quantization of the mesh, to rebuild its packed positions.
+	DirectX::XMFLOAT3 PosOffset = { 0.0f, 0.0f, 0.0f };
+	float    ObjPad3;
+	DirectX::XMFLOAT3 PosScale = { 1.0f, 1.0f, 1.0f };
+	float    ObjPad4;
 };
 
 struct PassConstants
@@ -55,13 +61,7 @@ struct MaterialData
 	UINT MaterialPad2;
 };
 
-struct Vertex
-{
-    DirectX::XMFLOAT3 Pos;
-    DirectX::XMFLOAT3 Normal;
-	DirectX::XMFLOAT2 TexC;
-	DirectX::XMFLOAT3 TangentU;
-};
+// Vertices are VertexPacker::PackedVertex.
 
 // Stores the resources needed for the CPU to build the command lists
 // for a frame.  
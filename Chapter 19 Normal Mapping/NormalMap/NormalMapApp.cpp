@@ -7,6 +7,7 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/VertexPacker.h"
 #include "FrameResource.h"
 
 using Microsoft::WRL::ComPtr;
@@ -49,6 +50,9 @@ struct RenderItem
 	UINT IndexCount         = 0;
 	UINT StartIndexLocation = 0;
 	int  BaseVertexLocation = 0;
+
+	// Quantization of the packed positions of the submesh, from its bounds.
+	VertexPacker::Quantization PosQuantization;
 };
 
 enum class RenderLayer : int
@@ -371,6 +375,8 @@ void NormalMapApp::UpdateObjectCBs(const GameTimer& gt)
 			XMStoreFloat4x4(&objConstants.World, XMMatrixTranspose(world));
 			XMStoreFloat4x4(&objConstants.TexTransform, XMMatrixTranspose(texTransform));
 			objConstants.MaterialIndex = e->Mat->MatCBIndex;
+			objConstants.PosOffset     = e->PosQuantization.Offset;
+			objConstants.PosScale      = e->PosQuantization.Scale;
 
 			currObjectCB->CopyData(e->ObjCBIndex, objConstants);
 
@@ -597,13 +603,7 @@ void NormalMapApp::BuildShadersAndInputLayout()
 	mShaders["skyVS"] = d3dUtil::CompileShader(L"Shaders\\Sky.hlsl", nullptr, "VS", "vs_5_1");
 	mShaders["skyPS"] = d3dUtil::CompileShader(L"Shaders\\Sky.hlsl", nullptr, "PS", "ps_5_1");
 
-	mInputLayout =
-	{
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-	};
+	mInputLayout = VertexPacker::InputLayout();
 }
 
 void NormalMapApp::BuildShapeGeometry()
@@ -652,8 +652,8 @@ void NormalMapApp::BuildShapeGeometry()
 	cylinderSubmesh.BaseVertexLocation = cylinderVertexOffset;
 
 	//
-	// Extract the vertex elements we are interested in and pack the
-	// vertices of all the meshes into one vertex buffer.
+	// Pack the vertices of all the meshes into one vertex buffer, each
+	// quantized inside its own bounds.
 	//
 
 	auto totalVertexCount =
@@ -662,40 +662,17 @@ void NormalMapApp::BuildShapeGeometry()
 			sphere.Vertices.size() +
 			cylinder.Vertices.size();
 
-	std::vector<Vertex> vertices(totalVertexCount);
-
-	UINT k = 0;
-	for (size_t i = 0; i < box.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos      = box.Vertices[i].Position;
-		vertices[k].Normal   = box.Vertices[i].Normal;
-		vertices[k].TexC     = box.Vertices[i].TexC;
-		vertices[k].TangentU = box.Vertices[i].TangentU;
-	}
-
-	for (size_t i = 0; i < grid.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos      = grid.Vertices[i].Position;
-		vertices[k].Normal   = grid.Vertices[i].Normal;
-		vertices[k].TexC     = grid.Vertices[i].TexC;
-		vertices[k].TangentU = grid.Vertices[i].TangentU;
-	}
+	std::vector<VertexPacker::PackedVertex> vertices(totalVertexCount);
 
-	for (size_t i = 0; i < sphere.Vertices.size(); ++i, ++k)
+	auto pack = [&](const GeometryGenerator::MeshData& mesh, SubmeshGeometry& submesh)
 	{
-		vertices[k].Pos      = sphere.Vertices[i].Position;
-		vertices[k].Normal   = sphere.Vertices[i].Normal;
-		vertices[k].TexC     = sphere.Vertices[i].TexC;
-		vertices[k].TangentU = sphere.Vertices[i].TangentU;
-	}
-
-	for (size_t i = 0; i < cylinder.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos      = cylinder.Vertices[i].Position;
-		vertices[k].Normal   = cylinder.Vertices[i].Normal;
-		vertices[k].TexC     = cylinder.Vertices[i].TexC;
-		vertices[k].TangentU = cylinder.Vertices[i].TangentU;
-	}
+		BoundingBox::CreateFromPoints(submesh.Bounds, mesh.Vertices.size(), &mesh.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+		VertexPacker::Pack(&vertices[submesh.BaseVertexLocation], VertexStreams::Describe(mesh), VertexPacker::QuantizationOf(submesh.Bounds));
+	};
+	pack(box, boxSubmesh);
+	pack(grid, gridSubmesh);
+	pack(sphere, sphereSubmesh);
+	pack(cylinder, cylinderSubmesh);
 
 	std::vector<std::uint16_t> indices;
 	indices.insert(indices.end(), std::begin(box.GetIndices16()), std::end(box.GetIndices16()));
@@ -703,7 +680,7 @@ void NormalMapApp::BuildShapeGeometry()
 	indices.insert(indices.end(), std::begin(sphere.GetIndices16()), std::end(sphere.GetIndices16()));
 	indices.insert(indices.end(), std::begin(cylinder.GetIndices16()), std::end(cylinder.GetIndices16()));
 
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
+	const UINT vbByteSize = (UINT)vertices.size() * sizeof(VertexPacker::PackedVertex);
 	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
 	auto geo  = std::make_unique<MeshGeometry>();
@@ -721,7 +698,7 @@ void NormalMapApp::BuildShapeGeometry()
 	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
 	                                                   mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
 
-	geo->VertexByteStride     = sizeof(Vertex);
+	geo->VertexByteStride     = sizeof(VertexPacker::PackedVertex);
 	geo->VertexBufferByteSize = vbByteSize;
 	geo->IndexFormat          = DXGI_FORMAT_R16_UINT;
 	geo->IndexBufferByteSize  = ibByteSize;
@@ -857,6 +834,7 @@ void NormalMapApp::BuildRenderItems()
 	skyRitem->IndexCount         = skyRitem->Geo->DrawArgs["sphere"].IndexCount;
 	skyRitem->StartIndexLocation = skyRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	skyRitem->BaseVertexLocation = skyRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	skyRitem->PosQuantization    = VertexPacker::QuantizationOf(skyRitem->Geo->DrawArgs["sphere"].Bounds);
 
 	mRitemLayer[(int)RenderLayer::Sky].push_back(skyRitem.get());
 	mAllRitems.push_back(std::move(skyRitem));
@@ -871,6 +849,7 @@ void NormalMapApp::BuildRenderItems()
 	boxRitem->IndexCount         = boxRitem->Geo->DrawArgs["box"].IndexCount;
 	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
 	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	boxRitem->PosQuantization    = VertexPacker::QuantizationOf(boxRitem->Geo->DrawArgs["box"].Bounds);
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(boxRitem.get());
 	mAllRitems.push_back(std::move(boxRitem));
@@ -885,6 +864,7 @@ void NormalMapApp::BuildRenderItems()
 	globeRitem->IndexCount         = globeRitem->Geo->DrawArgs["sphere"].IndexCount;
 	globeRitem->StartIndexLocation = globeRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	globeRitem->BaseVertexLocation = globeRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	globeRitem->PosQuantization    = VertexPacker::QuantizationOf(globeRitem->Geo->DrawArgs["sphere"].Bounds);
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(globeRitem.get());
 	mAllRitems.push_back(std::move(globeRitem));
@@ -899,6 +879,7 @@ void NormalMapApp::BuildRenderItems()
 	gridRitem->IndexCount         = gridRitem->Geo->DrawArgs["grid"].IndexCount;
 	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
 	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+	gridRitem->PosQuantization    = VertexPacker::QuantizationOf(gridRitem->Geo->DrawArgs["grid"].Bounds);
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(gridRitem.get());
 	mAllRitems.push_back(std::move(gridRitem));
@@ -927,6 +908,7 @@ void NormalMapApp::BuildRenderItems()
 		leftCylRitem->IndexCount         = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		leftCylRitem->PosQuantization    = VertexPacker::QuantizationOf(leftCylRitem->Geo->DrawArgs["cylinder"].Bounds);
 
 		XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
 		XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -937,6 +919,7 @@ void NormalMapApp::BuildRenderItems()
 		rightCylRitem->IndexCount         = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		rightCylRitem->PosQuantization    = VertexPacker::QuantizationOf(rightCylRitem->Geo->DrawArgs["cylinder"].Bounds);
 
 		XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
 		leftSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -947,6 +930,7 @@ void NormalMapApp::BuildRenderItems()
 		leftSphereRitem->IndexCount         = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		leftSphereRitem->PosQuantization    = VertexPacker::QuantizationOf(leftSphereRitem->Geo->DrawArgs["sphere"].Bounds);
 
 		XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
 		rightSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -957,6 +941,7 @@ void NormalMapApp::BuildRenderItems()
 		rightSphereRitem->IndexCount         = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		rightSphereRitem->PosQuantization    = VertexPacker::QuantizationOf(rightSphereRitem->Geo->DrawArgs["sphere"].Bounds);
 
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(leftCylRitem.get());
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(rightCylRitem.get());
@@ -18,6 +18,9 @@
 // Include structures and functions for lighting.
 #include "LightingUtil.hlsl"
 
+// Decoders for the packed vertex format.
+#include "../../../Common/VertexPacking.hlsl"
+
 struct MaterialData
 {
 	float4   DiffuseAlbedo;
@@ -57,6 +60,10 @@ uint     gMaterialIndex;
 uint     gObjPad0;
 uint     gObjPad1;
 uint     gObjPad2;
+float3   gPosOffset;
+float    gObjPad3;
+float3   gPosScale;
+float    gObjPad4;
 };
 
 // Constant data that varies per material.
@@ -21,9 +21,9 @@
 struct VertexIn
 {
 	float3 PosL    : POSITION;
-    float3 NormalL : NORMAL;
+    float2 NormalL : NORMAL;
 	float2 TexC    : TEXCOORD;
-	float3 TangentU : TANGENT;
+	float2 TangentU : TANGENT;
 };
 
 struct VertexOut
@@ -43,13 +43,14 @@ VertexOut VS(VertexIn vin)
 	MaterialData matData = gMaterialData[gMaterialIndex];
 	
     // Transform to world space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    float3 posL = DecodePosition(vin.PosL, gPosOffset, gPosScale);
+    float4 posW = mul(float4(posL, 1.0f), gWorld);
     vout.PosW = posW.xyz;
 
     // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
-    vout.NormalW = mul(vin.NormalL, (float3x3)gWorld);
+    vout.NormalW = mul(OctDecode(vin.NormalL), (float3x3)gWorld);
 	
-	vout.TangentW = mul(vin.TangentU, (float3x3)gWorld);
+	vout.TangentW = mul(OctDecode(vin.TangentU), (float3x3)gWorld);
 
     // Transform to homogeneous clip space.
     vout.PosH = mul(posW, gViewProj);
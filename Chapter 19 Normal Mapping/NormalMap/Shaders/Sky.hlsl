@@ -8,7 +8,7 @@
 struct VertexIn
 {
 	float3 PosL    : POSITION;
-	float3 NormalL : NORMAL;
+	float2 NormalL : NORMAL;
 	float2 TexC    : TEXCOORD;
 };
 
@@ -23,10 +23,10 @@ VertexOut VS(VertexIn vin)
 	VertexOut vout;
 
 	// Use local vertex position as cubemap lookup vector.
-	vout.PosL = vin.PosL;
+	vout.PosL = DecodePosition(vin.PosL, gPosOffset, gPosScale);
 	
 	// Transform to world space.
-	float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+	float4 posW = mul(float4(vout.PosL, 1.0f), gWorld);
 
 	// Always center sky about camera.
 	posW.xyz += gEyePosW;
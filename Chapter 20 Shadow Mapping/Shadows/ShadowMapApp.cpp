@@ -105,6 +105,7 @@ void ShadowMapApp::Update(const GameTimer& gt)
 	UpdateShadowTransform(gt);
 	UpdateMainPassCB(gt);
 	UpdateShadowPassCB(gt);
+	CullRenderItems();
 }
 
 void ShadowMapApp::Draw(const GameTimer& gt)
@@ -153,7 +154,7 @@ void ShadowMapApp::Draw(const GameTimer& gt)
 	mCommandList->SetGraphicsRootDescriptorTable(3, skyShadowTexStartLoc);
 
 	mCommandList->SetPipelineState(mPSOs["opaque"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+	DrawRenderItems(mCommandList.Get(), mCameraOpaqueRitems);
 
 	mCommandList->SetPipelineState(mPSOs["debug"].Get());
 	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Debug]);
@@ -339,6 +340,18 @@ void ShadowMapApp::UpdateShadowTransform(const GameTimer& gt)
 	XMStoreFloat4x4(&mShadowTransform, S);
 }
 
+void ShadowMapApp::CullRenderItems()
+{
+	// The camera and the light see the same items: test them against both frusta in one pass.
+	mViewCuller.ClearViews();
+	const UINT cameraView = mViewCuller.AddView(XMMatrixMultiply(mCamera.GetView(), mCamera.GetProj()));
+	const UINT shadowView = mViewCuller.AddView(XMMatrixMultiply(XMLoadFloat4x4(&mLightView), XMLoadFloat4x4(&mLightProj)));
+	mViewCuller.Cull();
+
+	mViewCuller.BuildDrawList(cameraView, mRitemLayer[(int)RenderLayer::Opaque], mCameraOpaqueRitems);
+	mViewCuller.BuildDrawList(shadowView, mRitemLayer[(int)RenderLayer::Opaque], mShadowOpaqueRitems);
+}
+
 void ShadowMapApp::UpdateMainPassCB(const GameTimer& gt)
 {
 	XMMATRIX view = mCamera.GetView();
@@ -438,13 +451,13 @@ void ShadowMapApp::LoadTextures()
 		mTextures[texMap->Name] = std::move(texMap);
 	}
 
+	// Read all files in parallel and upload them through one shared upload heap.
+	TextureBatchLoader loader(md3dDevice.Get());
 	for (auto& tex : mTextures)
 	{
-		tex.second->Resource = d3dUtil::CreateTexture(md3dDevice.Get(),
-		                                              mCommandList.Get(),
-		                                              tex.second->Filename.c_str(),
-		                                              tex.second->UploadHeap);
+		loader.Add(tex.second.get());
 	}
+	loader.Load(mCommandList.Get());
 }
 
 void ShadowMapApp::BuildRootSignature()
@@ -641,6 +654,13 @@ void ShadowMapApp::BuildShapeGeometry()
 	quadSubmesh.StartIndexLocation = quadIndexOffset;
 	quadSubmesh.BaseVertexLocation = quadVertexOffset;
 
+	// Local bounds of every shape, used for culling.
+	BoundingBox::CreateFromPoints(boxSubmesh.Bounds, box.Vertices.size(), &box.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(gridSubmesh.Bounds, grid.Vertices.size(), &grid.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(sphereSubmesh.Bounds, sphere.Vertices.size(), &sphere.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(cylinderSubmesh.Bounds, cylinder.Vertices.size(), &cylinder.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(quadSubmesh.Bounds, quad.Vertices.size(), &quad.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+
 	//
 	// Extract the vertex elements we are interested in and pack the
 	// vertices of all the meshes into one vertex buffer.
@@ -1027,6 +1047,7 @@ void ShadowMapApp::BuildRenderItems()
 	skyRitem->IndexCount         = skyRitem->Geo->DrawArgs["sphere"].IndexCount;
 	skyRitem->StartIndexLocation = skyRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	skyRitem->BaseVertexLocation = skyRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	skyRitem->Bounds             = skyRitem->Geo->DrawArgs["sphere"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Sky].push_back(skyRitem.get());
 	mAllRitems.push_back(std::move(skyRitem));
@@ -1041,6 +1062,7 @@ void ShadowMapApp::BuildRenderItems()
 	quadRitem->IndexCount         = quadRitem->Geo->DrawArgs["quad"].IndexCount;
 	quadRitem->StartIndexLocation = quadRitem->Geo->DrawArgs["quad"].StartIndexLocation;
 	quadRitem->BaseVertexLocation = quadRitem->Geo->DrawArgs["quad"].BaseVertexLocation;
+	quadRitem->Bounds             = quadRitem->Geo->DrawArgs["quad"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Debug].push_back(quadRitem.get());
 	mAllRitems.push_back(std::move(quadRitem));
@@ -1055,6 +1077,7 @@ void ShadowMapApp::BuildRenderItems()
 	boxRitem->IndexCount         = boxRitem->Geo->DrawArgs["box"].IndexCount;
 	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
 	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	boxRitem->Bounds             = boxRitem->Geo->DrawArgs["box"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(boxRitem.get());
 	mAllRitems.push_back(std::move(boxRitem));
@@ -1069,6 +1092,7 @@ void ShadowMapApp::BuildRenderItems()
 	skullRitem->IndexCount         = skullRitem->Geo->DrawArgs["skull"].IndexCount;
 	skullRitem->StartIndexLocation = skullRitem->Geo->DrawArgs["skull"].StartIndexLocation;
 	skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
+	skullRitem->Bounds             = skullRitem->Geo->DrawArgs["skull"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(skullRitem.get());
 	mAllRitems.push_back(std::move(skullRitem));
@@ -1083,6 +1107,7 @@ void ShadowMapApp::BuildRenderItems()
 	gridRitem->IndexCount         = gridRitem->Geo->DrawArgs["grid"].IndexCount;
 	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
 	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+	gridRitem->Bounds             = gridRitem->Geo->DrawArgs["grid"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(gridRitem.get());
 	mAllRitems.push_back(std::move(gridRitem));
@@ -1111,6 +1136,7 @@ void ShadowMapApp::BuildRenderItems()
 		leftCylRitem->IndexCount         = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		leftCylRitem->Bounds             = leftCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
 		XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
 		XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -1121,6 +1147,7 @@ void ShadowMapApp::BuildRenderItems()
 		rightCylRitem->IndexCount         = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		rightCylRitem->Bounds             = rightCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
 		XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
 		leftSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -1131,6 +1158,7 @@ void ShadowMapApp::BuildRenderItems()
 		leftSphereRitem->IndexCount         = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		leftSphereRitem->Bounds             = leftSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
 		XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
 		rightSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -1141,6 +1169,7 @@ void ShadowMapApp::BuildRenderItems()
 		rightSphereRitem->IndexCount         = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		rightSphereRitem->Bounds             = rightSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(leftCylRitem.get());
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(rightCylRitem.get());
@@ -1152,6 +1181,14 @@ void ShadowMapApp::BuildRenderItems()
 		mAllRitems.push_back(std::move(leftSphereRitem));
 		mAllRitems.push_back(std::move(rightSphereRitem));
 	}
+
+	// Nothing moves, so the world bounds of every item that gets culled are computed once.
+	for (RenderItem* ri : mRitemLayer[(int)RenderLayer::Opaque])
+	{
+		BoundingBox worldBounds;
+		ri->Bounds.Transform(worldBounds, XMLoadFloat4x4(&ri->World));
+		ri->CullIndex = mViewCuller.AddObject(worldBounds);
+	}
 }
 
 void ShadowMapApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
@@ -1209,7 +1246,7 @@ void ShadowMapApp::DrawSceneToShadowMap()
 
 	mCommandList->SetPipelineState(mPSOs["shadow_opaque"].Get());
 
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+	DrawRenderItems(mCommandList.Get(), mShadowOpaqueRitems);
 
 	// Change back to GENERIC_READ so we can read the texture in a shader.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mShadowMap->Resource(),
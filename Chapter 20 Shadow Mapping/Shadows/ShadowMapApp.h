@@ -5,6 +5,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TextureBatchLoader.h"
+#include "../../Common/MultiViewCuller.h"
 #include "FrameResource.h"
 #include "ShadowMap.h"
 
@@ -30,6 +32,9 @@ struct RenderItem
 	UINT IndexCount         = 0;
 	UINT StartIndexLocation = 0;
 	int  BaseVertexLocation = 0;
+
+	BoundingBox Bounds;        // local space bounds of the submesh
+	UINT        CullIndex = 0; // object index in MultiViewCuller
 };
 
 enum class RenderLayer : int
@@ -66,6 +71,7 @@ private:
 	void UpdateShadowTransform(const GameTimer& gt);
 	void UpdateMainPassCB(const GameTimer& gt);
 	void UpdateShadowPassCB(const GameTimer& gt);
+	void CullRenderItems();
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -105,6 +111,11 @@ private:
 	// Render items divided by PSO.
 	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+	// Opaque items culled against the camera and the light, rebuilt every frame.
+	MultiViewCuller          mViewCuller;
+	std::vector<RenderItem*> mCameraOpaqueRitems;
+	std::vector<RenderItem*> mShadowOpaqueRitems;
+
 	UINT                       mSkyShadowTexStartHeapIndex = 0;
 	PassConstants              mMainPassCB;   // index 0 of pass cbuffer.
 	PassConstants              mShadowPassCB; // index 1 of pass cbuffer.
@@ -134,6 +134,7 @@ void SsaoApp::Update(const GameTimer& gt)
 	UpdateMainPassCB(gt);
 	UpdateShadowPassCB(gt);
 	UpdateSsaoCB(gt);
+	CullRenderItems();
 }
 
 void SsaoApp::Draw(const GameTimer& gt)
@@ -233,7 +234,7 @@ void SsaoApp::Draw(const GameTimer& gt)
 	mCommandList->SetGraphicsRootDescriptorTable(3, skyTexDescriptor);
 
 	mCommandList->SetPipelineState(mPSOs["opaque"].Get());
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+	DrawRenderItems(mCommandList.Get(), mCameraOpaqueRitems);
 
 	mCommandList->SetPipelineState(mPSOs["debug"].Get());
 	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Debug]);
@@ -410,6 +411,19 @@ void SsaoApp::UpdateShadowTransform(const GameTimer& gt)
 	XMStoreFloat4x4(&mShadowTransform, S);
 }
 
+void SsaoApp::CullRenderItems()
+{
+	// The normal/depth and main passes share the camera view; the shadow pass uses the light.
+	// Both frusta are tested in one pass over the items.
+	mViewCuller.ClearViews();
+	const UINT cameraView = mViewCuller.AddView(XMMatrixMultiply(mCamera.GetView(), mCamera.GetProj()));
+	const UINT shadowView = mViewCuller.AddView(XMMatrixMultiply(XMLoadFloat4x4(&mLightView), XMLoadFloat4x4(&mLightProj)));
+	mViewCuller.Cull();
+
+	mViewCuller.BuildDrawList(cameraView, mRitemLayer[(int)RenderLayer::Opaque], mCameraOpaqueRitems);
+	mViewCuller.BuildDrawList(shadowView, mRitemLayer[(int)RenderLayer::Opaque], mShadowOpaqueRitems);
+}
+
 void SsaoApp::UpdateMainPassCB(const GameTimer& gt)
 {
 	XMMATRIX view = mCamera.GetView();
@@ -554,13 +568,13 @@ void SsaoApp::LoadTextures()
 		mTextures[texMap->Name] = std::move(texMap);
 	}
 
+	// Read all files in parallel and upload them through one shared upload heap.
+	TextureBatchLoader loader(md3dDevice.Get());
 	for (auto& tex : mTextures)
 	{
-		tex.second->Resource = d3dUtil::CreateTexture(md3dDevice.Get(),
-		                                              mCommandList.Get(),
-		                                              tex.second->Filename.c_str(),
-		                                              tex.second->UploadHeap);
+		loader.Add(tex.second.get());
 	}
+	loader.Load(mCommandList.Get());
 }
 
 void SsaoApp::BuildRootSignature()
@@ -867,6 +881,13 @@ void SsaoApp::BuildShapeGeometry()
 	quadSubmesh.StartIndexLocation = quadIndexOffset;
 	quadSubmesh.BaseVertexLocation = quadVertexOffset;
 
+	// Local bounds of every shape, used for culling.
+	BoundingBox::CreateFromPoints(boxSubmesh.Bounds, box.Vertices.size(), &box.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(gridSubmesh.Bounds, grid.Vertices.size(), &grid.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(sphereSubmesh.Bounds, sphere.Vertices.size(), &sphere.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(cylinderSubmesh.Bounds, cylinder.Vertices.size(), &cylinder.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+	BoundingBox::CreateFromPoints(quadSubmesh.Bounds, quad.Vertices.size(), &quad.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+
 	//
 	// Extract the vertex elements we are interested in and pack the
 	// vertices of all the meshes into one vertex buffer.
@@ -979,12 +1000,6 @@ void SsaoApp::BuildSkullGeometry()
 	fin >> ignore >> tcount;
 	fin >> ignore >> ignore >> ignore >> ignore;
 
-	XMFLOAT3 vMinf3(+MathHelper::Infinity, +MathHelper::Infinity, +MathHelper::Infinity);
-	XMFLOAT3 vMaxf3(-MathHelper::Infinity, -MathHelper::Infinity, -MathHelper::Infinity);
-
-	XMVECTOR vMin = XMLoadFloat3(&vMinf3);
-	XMVECTOR vMax = XMLoadFloat3(&vMaxf3);
-
 	std::vector<Vertex> vertices(vcount);
 	for (UINT i = 0; i < vcount; ++i)
 	{
@@ -992,41 +1007,13 @@ void SsaoApp::BuildSkullGeometry()
 		fin >> vertices[i].Normal.x >> vertices[i].Normal.y >> vertices[i].Normal.z;
 
 		vertices[i].TexC = {0.0f, 0.0f};
-
-		XMVECTOR P = XMLoadFloat3(&vertices[i].Pos);
-
-		XMVECTOR N = XMLoadFloat3(&vertices[i].Normal);
-
-		// Generate a tangent vector so normal mapping works.  We aren't applying
-		// a texture map to the skull, so we just need any tangent vector so that
-		// the math works out to give us the original interpolated vertex normal.
-		XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-		if (fabsf(XMVectorGetX(XMVector3Dot(N, up))) < 1.0f - 0.001f)
-		{
-			XMVECTOR T = XMVector3Normalize(XMVector3Cross(up, N));
-			XMStoreFloat3(&vertices[i].TangentU, T);
-		}
-		else
-		{
-			up         = XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
-			XMVECTOR T = XMVector3Normalize(XMVector3Cross(N, up));
-			XMStoreFloat3(&vertices[i].TangentU, T);
-		}
-
-
-		vMin = XMVectorMin(vMin, P);
-		vMax = XMVectorMax(vMax, P);
 	}
 
-	BoundingBox bounds;
-	XMStoreFloat3(&bounds.Center, 0.5f * (vMin + vMax));
-	XMStoreFloat3(&bounds.Extents, 0.5f * (vMax - vMin));
-
 	fin >> ignore;
 	fin >> ignore;
 	fin >> ignore;
 
-	std::vector<std::int32_t> indices(3 * tcount);
+	std::vector<std::uint32_t> indices(3 * tcount);
 	for (UINT i = 0; i < tcount; ++i)
 	{
 		fin >> indices[i * 3 + 0] >> indices[i * 3 + 1] >> indices[i * 3 + 2];
@@ -1034,13 +1021,29 @@ void SsaoApp::BuildSkullGeometry()
 
 	fin.close();
 
+	// Generate tangents so normal mapping works. The skull has no texture coordinates, so every vertex
+	// gets a tangent from its normal, which is all the flat normal map needs; a textured model would get
+	// tangents that follow its texture.
+	VertexStreams tangentData;
+	tangentData.VertexCount = vcount;
+	tangentData.Stride      = sizeof(Vertex);
+	tangentData.Positions   = &vertices[0].Pos;
+	tangentData.Normals     = &vertices[0].Normal;
+	tangentData.TexCoords   = &vertices[0].TexC;
+	TangentGenerator::Generate(tangentData, indices.data(), (UINT)indices.size(), &vertices[0].TangentU);
+
 	//
-	// Pack the indices of all the meshes into one index buffer.
+	// Draw with 16-bit indices, in as many parts as the vertex count needs.
 	//
 
+	IndexSplitter::Result split = IndexSplitter::Split(indices.data(), (UINT)indices.size(), vcount, &vertices[0].Pos, sizeof(Vertex));
+	vertices.reserve(vertices.size() + split.ExtraVertices.size());
+	for (std::uint32_t v : split.ExtraVertices)
+		vertices.push_back(vertices[v]);
+
 	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::int32_t);
+	const UINT ibByteSize = (UINT)split.Indices.size() * sizeof(std::uint16_t);
 
 	auto geo  = std::make_unique<MeshGeometry>();
 	geo->Name = "skullGeo";
@@ -1049,26 +1052,21 @@ void SsaoApp::BuildSkullGeometry()
 	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
 
 	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), split.Indices.data(), ibByteSize);
 
 	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
 	                                                    mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
 
 	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-	                                                   mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+	                                                   mCommandList.Get(), split.Indices.data(), ibByteSize, geo->IndexBufferUploader);
 
 	geo->VertexByteStride     = sizeof(Vertex);
 	geo->VertexBufferByteSize = vbByteSize;
-	geo->IndexFormat          = DXGI_FORMAT_R32_UINT;
+	geo->IndexFormat          = DXGI_FORMAT_R16_UINT;
 	geo->IndexBufferByteSize  = ibByteSize;
 
-	SubmeshGeometry submesh;
-	submesh.IndexCount         = (UINT)indices.size();
-	submesh.StartIndexLocation = 0;
-	submesh.BaseVertexLocation = 0;
-	submesh.Bounds             = bounds;
-
-	geo->DrawArgs["skull"] = submesh;
+	// "skull", then "skull_1", "skull_2", ... for any further parts; each part has the bounds of its triangles.
+	mSkullPartCount = IndexSplitter::AddDrawArgs(*geo, "skull", split, 0, 0);
 
 	mGeometries[geo->Name] = std::move(geo);
 }
@@ -1315,6 +1313,7 @@ void SsaoApp::BuildRenderItems()
 	skyRitem->IndexCount         = skyRitem->Geo->DrawArgs["sphere"].IndexCount;
 	skyRitem->StartIndexLocation = skyRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 	skyRitem->BaseVertexLocation = skyRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+	skyRitem->Bounds             = skyRitem->Geo->DrawArgs["sphere"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Sky].push_back(skyRitem.get());
 	mAllRitems.push_back(std::move(skyRitem));
@@ -1329,6 +1328,7 @@ void SsaoApp::BuildRenderItems()
 	quadRitem->IndexCount         = quadRitem->Geo->DrawArgs["quad"].IndexCount;
 	quadRitem->StartIndexLocation = quadRitem->Geo->DrawArgs["quad"].StartIndexLocation;
 	quadRitem->BaseVertexLocation = quadRitem->Geo->DrawArgs["quad"].BaseVertexLocation;
+	quadRitem->Bounds             = quadRitem->Geo->DrawArgs["quad"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Debug].push_back(quadRitem.get());
 	mAllRitems.push_back(std::move(quadRitem));
@@ -1343,23 +1343,32 @@ void SsaoApp::BuildRenderItems()
 	boxRitem->IndexCount         = boxRitem->Geo->DrawArgs["box"].IndexCount;
 	boxRitem->StartIndexLocation = boxRitem->Geo->DrawArgs["box"].StartIndexLocation;
 	boxRitem->BaseVertexLocation = boxRitem->Geo->DrawArgs["box"].BaseVertexLocation;
+	boxRitem->Bounds             = boxRitem->Geo->DrawArgs["box"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(boxRitem.get());
 	mAllRitems.push_back(std::move(boxRitem));
 
-	auto skullRitem = std::make_unique<RenderItem>();
-	XMStoreFloat4x4(&skullRitem->World, XMMatrixScaling(0.4f, 0.4f, 0.4f) * XMMatrixTranslation(0.0f, 1.0f, 0.0f));
-	skullRitem->TexTransform       = MathHelper::Identity4x4();
-	skullRitem->ObjCBIndex         = 3;
-	skullRitem->Mat                = mMaterials["skullMat"].get();
-	skullRitem->Geo                = mGeometries["skullGeo"].get();
-	skullRitem->PrimitiveType      = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-	skullRitem->IndexCount         = skullRitem->Geo->DrawArgs["skull"].IndexCount;
-	skullRitem->StartIndexLocation = skullRitem->Geo->DrawArgs["skull"].StartIndexLocation;
-	skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs["skull"].BaseVertexLocation;
-
-	mRitemLayer[(int)RenderLayer::Opaque].push_back(skullRitem.get());
-	mAllRitems.push_back(std::move(skullRitem));
+	// The first part of the skull takes its usual slot; parts past it, if the splitter made any, go last.
+	auto addSkullPart = [&](UINT part, UINT objCBIndex)
+	{
+		const std::string name = IndexSplitter::PartName("skull", part);
+
+		auto skullRitem = std::make_unique<RenderItem>();
+		XMStoreFloat4x4(&skullRitem->World, XMMatrixScaling(0.4f, 0.4f, 0.4f) * XMMatrixTranslation(0.0f, 1.0f, 0.0f));
+		skullRitem->TexTransform       = MathHelper::Identity4x4();
+		skullRitem->ObjCBIndex         = objCBIndex;
+		skullRitem->Mat                = mMaterials["skullMat"].get();
+		skullRitem->Geo                = mGeometries["skullGeo"].get();
+		skullRitem->PrimitiveType      = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+		skullRitem->IndexCount         = skullRitem->Geo->DrawArgs[name].IndexCount;
+		skullRitem->StartIndexLocation = skullRitem->Geo->DrawArgs[name].StartIndexLocation;
+		skullRitem->BaseVertexLocation = skullRitem->Geo->DrawArgs[name].BaseVertexLocation;
+		skullRitem->Bounds             = skullRitem->Geo->DrawArgs[name].Bounds;
+
+		mRitemLayer[(int)RenderLayer::Opaque].push_back(skullRitem.get());
+		mAllRitems.push_back(std::move(skullRitem));
+	};
+	addSkullPart(0, 3);
 
 	auto gridRitem   = std::make_unique<RenderItem>();
 	gridRitem->World = MathHelper::Identity4x4();
@@ -1371,6 +1380,7 @@ void SsaoApp::BuildRenderItems()
 	gridRitem->IndexCount         = gridRitem->Geo->DrawArgs["grid"].IndexCount;
 	gridRitem->StartIndexLocation = gridRitem->Geo->DrawArgs["grid"].StartIndexLocation;
 	gridRitem->BaseVertexLocation = gridRitem->Geo->DrawArgs["grid"].BaseVertexLocation;
+	gridRitem->Bounds             = gridRitem->Geo->DrawArgs["grid"].Bounds;
 
 	mRitemLayer[(int)RenderLayer::Opaque].push_back(gridRitem.get());
 	mAllRitems.push_back(std::move(gridRitem));
@@ -1399,6 +1409,7 @@ void SsaoApp::BuildRenderItems()
 		leftCylRitem->IndexCount         = leftCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		leftCylRitem->StartIndexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		leftCylRitem->BaseVertexLocation = leftCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		leftCylRitem->Bounds             = leftCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
 		XMStoreFloat4x4(&rightCylRitem->World, leftCylWorld);
 		XMStoreFloat4x4(&rightCylRitem->TexTransform, brickTexTransform);
@@ -1409,6 +1420,7 @@ void SsaoApp::BuildRenderItems()
 		rightCylRitem->IndexCount         = rightCylRitem->Geo->DrawArgs["cylinder"].IndexCount;
 		rightCylRitem->StartIndexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].StartIndexLocation;
 		rightCylRitem->BaseVertexLocation = rightCylRitem->Geo->DrawArgs["cylinder"].BaseVertexLocation;
+		rightCylRitem->Bounds             = rightCylRitem->Geo->DrawArgs["cylinder"].Bounds;
 
 		XMStoreFloat4x4(&leftSphereRitem->World, leftSphereWorld);
 		leftSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -1419,6 +1431,7 @@ void SsaoApp::BuildRenderItems()
 		leftSphereRitem->IndexCount         = leftSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		leftSphereRitem->StartIndexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		leftSphereRitem->BaseVertexLocation = leftSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		leftSphereRitem->Bounds             = leftSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
 		XMStoreFloat4x4(&rightSphereRitem->World, rightSphereWorld);
 		rightSphereRitem->TexTransform       = MathHelper::Identity4x4();
@@ -1429,6 +1442,7 @@ void SsaoApp::BuildRenderItems()
 		rightSphereRitem->IndexCount         = rightSphereRitem->Geo->DrawArgs["sphere"].IndexCount;
 		rightSphereRitem->StartIndexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].StartIndexLocation;
 		rightSphereRitem->BaseVertexLocation = rightSphereRitem->Geo->DrawArgs["sphere"].BaseVertexLocation;
+		rightSphereRitem->Bounds             = rightSphereRitem->Geo->DrawArgs["sphere"].Bounds;
 
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(leftCylRitem.get());
 		mRitemLayer[(int)RenderLayer::Opaque].push_back(rightCylRitem.get());
@@ -1440,6 +1454,17 @@ void SsaoApp::BuildRenderItems()
 		mAllRitems.push_back(std::move(leftSphereRitem));
 		mAllRitems.push_back(std::move(rightSphereRitem));
 	}
+
+	for (UINT part = 1; part < mSkullPartCount; ++part)
+		addSkullPart(part, objCBIndex++);
+
+	// Nothing moves, so the world bounds of every item that gets culled are computed once.
+	for (RenderItem* ri : mRitemLayer[(int)RenderLayer::Opaque])
+	{
+		BoundingBox worldBounds;
+		ri->Bounds.Transform(worldBounds, XMLoadFloat4x4(&ri->World));
+		ri->CullIndex = mViewCuller.AddObject(worldBounds);
+	}
 }
 
 void SsaoApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
@@ -1489,7 +1514,7 @@ void SsaoApp::DrawSceneToShadowMap()
 
 	mCommandList->SetPipelineState(mPSOs["shadow_opaque"].Get());
 
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+	DrawRenderItems(mCommandList.Get(), mShadowOpaqueRitems);
 
 	// Change back to GENERIC_READ so we can read the texture in a shader.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mShadowMap->Resource(),
@@ -1522,7 +1547,7 @@ void SsaoApp::DrawNormalsAndDepth()
 
 	mCommandList->SetPipelineState(mPSOs["drawNormals"].Get());
 
-	DrawRenderItems(mCommandList.Get(), mRitemLayer[(int)RenderLayer::Opaque]);
+	DrawRenderItems(mCommandList.Get(), mCameraOpaqueRitems);
 
 	// Change back to GENERIC_READ so we can read the texture in a shader.
 	mCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(normalMap,
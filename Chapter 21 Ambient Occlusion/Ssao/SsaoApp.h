@@ -5,6 +5,10 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/TextureBatchLoader.h"
+#include "../../Common/MultiViewCuller.h"
+#include "../../Common/IndexSplitter.h"
+#include "../../Common/TangentGenerator.h"
 #include "FrameResource.h"
 #include "ShadowMap.h"
 #include "Ssao.h"
@@ -46,6 +50,10 @@ struct RenderItem
 	UINT IndexCount         = 0;
 	UINT StartIndexLocation = 0;
 	int  BaseVertexLocation = 0;
+
+	// Local space bounds of the submesh and the object index returned by MultiViewCuller::AddObject.
+	BoundingBox Bounds;
+	UINT        CullIndex = 0;
 };
 
 enum class RenderLayer : int
@@ -84,6 +92,7 @@ private:
 	void UpdateMainPassCB(const GameTimer& gt);
 	void UpdateShadowPassCB(const GameTimer& gt);
 	void UpdateSsaoCB(const GameTimer& gt);
+	void CullRenderItems();
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -125,12 +134,20 @@ private:
 
 	std::vector<D3D12_INPUT_ELEMENT_DESC> mInputLayout;
 
+	// Draw ranges the skull was split into for 16-bit indices.
+	UINT mSkullPartCount = 0;
+
 	// List of all the render items.
 	std::vector<std::unique_ptr<RenderItem>> mAllRitems;
 
 	// Render items divided by PSO.
 	std::vector<RenderItem*> mRitemLayer[(int)RenderLayer::Count];
 
+	// Opaque items culled against the camera and the light, rebuilt every frame.
+	MultiViewCuller          mViewCuller;
+	std::vector<RenderItem*> mCameraOpaqueRitems;
+	std::vector<RenderItem*> mShadowOpaqueRitems;
+
 	UINT mSkyTexHeapIndex     = 0;
 	UINT mShadowMapHeapIndex  = 0;
 	UINT mSsaoHeapIndexStart  = 0;
@@ -17,6 +17,12 @@ struct ObjectConstants
 struct SkinnedConstants
 {
     DirectX::XMFLOAT4X4 BoneTransforms[96];
+
+	// VertexPacker::Quantization of the model, to rebuild its packed bind pose positions.
+	DirectX::XMFLOAT3 PosOffset = { 0.0f, 0.0f, 0.0f };
+	float SkinnedPad0 = 0.0f;
+	DirectX::XMFLOAT3 PosScale = { 1.0f, 1.0f, 1.0f };
+	float SkinnedPad1 = 0.0f;
 };
 
 struct PassConstants
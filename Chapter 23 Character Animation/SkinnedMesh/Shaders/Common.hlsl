@@ -18,6 +18,9 @@
 // Include structures and functions for lighting.
 #include "LightingUtil.hlsl"
 
+// Decoders for the packed vertex format of the skinned model.
+#include "../../../Common/VertexPacking.hlsl"
+
 struct MaterialData
 {
 	float4   DiffuseAlbedo;
@@ -65,6 +68,10 @@ cbuffer cbPerObject : register(b0)
 cbuffer cbSkinned : register(b1)
 {
     float4x4 gBoneTransforms[96];
+    float3   gPosOffset; // VertexPacker::Quantization of the skinned model
+    float    gSkinnedPad0;
+    float3   gPosScale;
+    float    gSkinnedPad1;
 };
 
 // Constant data that varies per material.
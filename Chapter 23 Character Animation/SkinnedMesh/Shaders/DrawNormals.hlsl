@@ -20,13 +20,19 @@
 
 struct VertexIn
 {
+#ifdef SKINNED
+    // VertexPacker::PackedSkinnedVertex.
+    float3 PosL        : POSITION;
+    float2 NormalL     : NORMAL;
+    float2 TexC        : TEXCOORD;
+    float2 TangentL    : TANGENT;
+    float4 BoneWeights : WEIGHTS;
+    uint4  BoneIndices : BONEINDICES;
+#else
 	float3 PosL    : POSITION;
     float3 NormalL : NORMAL;
 	float2 TexC    : TEXCOORD;
 	float3 TangentL : TANGENT;
-#ifdef SKINNED
-    float3 BoneWeights : WEIGHTS;
-    uint4 BoneIndices  : BONEINDICES;
 #endif
 };
 
@@ -46,11 +52,12 @@ VertexOut VS(VertexIn vin)
 	MaterialData matData = gMaterialData[gMaterialIndex];
 	
 #ifdef SKINNED
-    float weights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-    weights[0] = vin.BoneWeights.x;
-    weights[1] = vin.BoneWeights.y;
-    weights[2] = vin.BoneWeights.z;
-    weights[3] = 1.0f - weights[0] - weights[1] - weights[2];
+    // The weights are stored as four bytes that sum to one.
+    float weights[4] = { vin.BoneWeights.x, vin.BoneWeights.y, vin.BoneWeights.z, vin.BoneWeights.w };
+
+    float3 bindPosL = DecodePosition(vin.PosL, gPosOffset, gPosScale);
+    float3 bindNormalL = OctDecode(vin.NormalL);
+    float3 bindTangentL = OctDecode(vin.TangentL);
 
     float3 posL = float3(0.0f, 0.0f, 0.0f);
     float3 normalL = float3(0.0f, 0.0f, 0.0f);
@@ -60,22 +67,22 @@ VertexOut VS(VertexIn vin)
         // Assume no nonuniform scaling when transforming normals, so 
         // that we do not have to use the inverse-transpose.
 
-        posL += weights[i] * mul(float4(vin.PosL, 1.0f), gBoneTransforms[vin.BoneIndices[i]]).xyz;
-        normalL += weights[i] * mul(vin.NormalL, (float3x3)gBoneTransforms[vin.BoneIndices[i]]);
-        tangentL += weights[i] * mul(vin.TangentL.xyz, (float3x3)gBoneTransforms[vin.BoneIndices[i]]);
+        posL += weights[i] * mul(float4(bindPosL, 1.0f), gBoneTransforms[vin.BoneIndices[i]]).xyz;
+        normalL += weights[i] * mul(bindNormalL, (float3x3)gBoneTransforms[vin.BoneIndices[i]]);
+        tangentL += weights[i] * mul(bindTangentL, (float3x3)gBoneTransforms[vin.BoneIndices[i]]);
     }
-
-    vin.PosL = posL;
-    vin.NormalL = normalL;
-    vin.TangentL.xyz = tangentL;
+#else
+    float3 posL = vin.PosL;
+    float3 normalL = vin.NormalL;
+    float3 tangentL = vin.TangentL;
 #endif
 
     // Assumes nonuniform scaling; otherwise, need to use inverse-transpose of world matrix.
-    vout.NormalW = mul(vin.NormalL, (float3x3)gWorld);
-	vout.TangentW = mul(vin.TangentL, (float3x3)gWorld);
+    vout.NormalW = mul(normalL, (float3x3)gWorld);
+	vout.TangentW = mul(tangentL, (float3x3)gWorld);
 
     // Transform to homogeneous clip space.
-    float4 posW = mul(float4(vin.PosL, 1.0f), gWorld);
+    float4 posW = mul(float4(posL, 1.0f), gWorld);
     vout.PosH = mul(posW, gViewProj);
 	
 	// Output vertex attributes for interpolation across triangle.
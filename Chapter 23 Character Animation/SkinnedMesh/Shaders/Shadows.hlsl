@@ -10,7 +10,8 @@ struct VertexIn
 	float3 PosL    : POSITION;
 	float2 TexC    : TEXCOORD;
 #ifdef SKINNED
-    float3 BoneWeights : WEIGHTS;
+    // VertexPacker::PackedSkinnedVertex: PosL is quantized.
+    float4 BoneWeights : WEIGHTS;
     uint4 BoneIndices  : BONEINDICES;
 #endif
 };
@@ -28,11 +29,10 @@ VertexOut VS(VertexIn vin)
 	MaterialData matData = gMaterialData[gMaterialIndex];
 	
 #ifdef SKINNED
-    float weights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-    weights[0] = vin.BoneWeights.x;
-    weights[1] = vin.BoneWeights.y;
-    weights[2] = vin.BoneWeights.z;
-    weights[3] = 1.0f - weights[0] - weights[1] - weights[2];
+    // The weights are stored as four bytes that sum to one.
+    float weights[4] = { vin.BoneWeights.x, vin.BoneWeights.y, vin.BoneWeights.z, vin.BoneWeights.w };
+
+    float3 bindPosL = DecodePosition(vin.PosL, gPosOffset, gPosScale);
 
     float3 posL = float3(0.0f, 0.0f, 0.0f);
     for(int i = 0; i < 4; ++i)
@@ -40,7 +40,7 @@ VertexOut VS(VertexIn vin)
         // Assume no nonuniform scaling when transforming normals, so 
         // that we do not have to use the inverse-transpose.
 
-        posL += weights[i] * mul(float4(vin.PosL, 1.0f), gBoneTransforms[vin.BoneIndices[i]]).xyz;
+        posL += weights[i] * mul(float4(bindPosL, 1.0f), gBoneTransforms[vin.BoneIndices[i]]).xyz;
     }
 
     vin.PosL = posL;
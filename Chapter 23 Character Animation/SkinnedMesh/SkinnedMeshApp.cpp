@@ -7,6 +7,8 @@
 #include "../../Common/UploadBuffer.h"
 #include "../../Common/GeometryGenerator.h"
 #include "../../Common/Camera.h"
+#include "../../Common/SkinnedMeshBvh.h"
+#include "../../Common/VertexPacker.h"
 #include "FrameResource.h"
 #include "ShadowMap.h"
 #include "Ssao.h"
@@ -120,6 +122,8 @@ private:
 	void UpdateMainPassCB(const GameTimer& gt);
 	void UpdateShadowPassCB(const GameTimer& gt);
 	void UpdateSsaoCB(const GameTimer& gt);
+	void UpdatePicking(const GameTimer& gt);
+	void Pick(int sx, int sy);
 
 	void LoadTextures();
 	void BuildRootSignature();
@@ -189,6 +193,11 @@ private:
 	std::vector<M3DLoader::Subset>        mSkinnedSubsets;
 	std::vector<M3DLoader::M3dMaterial>   mSkinnedMats;
 	std::vector<std::string>              mSkinnedTextureNames;
+	SkinnedMeshBvh                        mSkinnedBvh;          // every subset of the skinned model, for picking
+	VertexPacker::Quantization            mSkinnedQuantization; // of the packed positions of the skinned model
+	bool                                  mPickPending = false; // right click waiting for the next animation update
+	POINT                                 mPickPos;
+	bool                                  mLazyPicking = true;  // pose the picking tree only when a pick is waiting
 
 	Camera mCamera;
 
@@ -370,6 +379,7 @@ void SkinnedMeshApp::Update(const GameTimer& gt)
 	AnimateMaterials(gt);
 	UpdateObjectCBs(gt);
 	UpdateSkinnedCBs(gt);
+	UpdatePicking(gt);
 	UpdateMaterialBuffer(gt);
 	UpdateShadowTransform(gt);
 	UpdateMainPassCB(gt);
@@ -509,10 +519,20 @@ void SkinnedMeshApp::Draw(const GameTimer& gt)
 
 void SkinnedMeshApp::OnMouseDown(WPARAM btnState, int x, int y)
 {
-	mLastMousePos.x = x;
-	mLastMousePos.y = y;
+	if ((btnState & MK_LBUTTON) != 0)
+	{
+		mLastMousePos.x = x;
+		mLastMousePos.y = y;
 
-	SetCapture(mhMainWnd);
+		SetCapture(mhMainWnd);
+	}
+	else if ((btnState & MK_RBUTTON) != 0)
+	{
+		// Picked after the animation update, against the pose drawn this frame.
+		mPickPending = true;
+		mPickPos.x   = x;
+		mPickPos.y   = y;
+	}
 }
 
 void SkinnedMeshApp::OnMouseUp(WPARAM btnState, int x, int y)
@@ -552,6 +572,12 @@ void SkinnedMeshApp::OnKeyboardInput(const GameTimer& gt)
 	if (GetAsyncKeyState('D') & 0x8000)
 		mCamera.Strafe(10.0f * dt);
 
+	if (GetAsyncKeyState('1') & 0x8000)
+		mLazyPicking = true;
+
+	if (GetAsyncKeyState('2') & 0x8000)
+		mLazyPicking = false;
+
 	mCamera.UpdateViewMatrix();
 }
 
@@ -596,10 +622,35 @@ void SkinnedMeshApp::UpdateSkinnedCBs(const GameTimer& gt)
 	          std::begin(mSkinnedModelInst->FinalTransforms),
 	          std::end(mSkinnedModelInst->FinalTransforms),
 	          &skinnedConstants.BoneTransforms[0]);
+	skinnedConstants.PosOffset = mSkinnedQuantization.Offset;
+	skinnedConstants.PosScale  = mSkinnedQuantization.Scale;
 
 	currSkinnedCB->CopyData(0, skinnedConstants);
 }
 
+void SkinnedMeshApp::UpdatePicking(const GameTimer& gt)
+{
+	const XMFLOAT4X4* boneTransforms = mSkinnedModelInst->FinalTransforms.data();
+
+	// Without lazy picking the whole mesh is skinned and refitted every frame, as something querying every
+	// frame (hover highlighting, say) would need. Lazy picking does nothing until a click is waiting, and
+	// then only skins the parts of the mesh the ray gets near.
+	if (!mLazyPicking)
+	{
+		mSkinnedBvh.SetPose(boneTransforms);
+		mSkinnedBvh.SkinAll(0);
+	}
+
+	if (!mPickPending)
+		return;
+
+	if (mLazyPicking)
+		mSkinnedBvh.SetPose(boneTransforms);
+
+	Pick(mPickPos.x, mPickPos.y);
+	mPickPending = false;
+}
+
 void SkinnedMeshApp::UpdateMaterialBuffer(const GameTimer& gt)
 {
 	auto currMaterialBuffer = mCurrFrameResource->MaterialBuffer.get();
@@ -1116,15 +1167,8 @@ void SkinnedMeshApp::BuildShadersAndInputLayout()
 		{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
 	};
 
-	mSkinnedInputLayout =
-	{
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"WEIGHTS", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 44, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"BONEINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, 56, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0}
-	};
+	// The skinned model is packed to 28 bytes a vertex; the shaders decode it with VertexPacking.hlsl.
+	mSkinnedInputLayout = VertexPacker::SkinnedInputLayout();
 }
 
 void SkinnedMeshApp::BuildShapeGeometry()
@@ -1289,29 +1333,51 @@ void SkinnedMeshApp::LoadSkinnedModel()
 	mSkinnedModelInst->ClipName = "Take1";
 	mSkinnedModelInst->TimePos  = 0.0f;
 
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(SkinnedVertex);
+	// The positions are quantized inside the bind pose bounds; the bones move them after decoding.
+	VertexStreams streams;
+	streams.VertexCount = (UINT)vertices.size();
+	streams.Stride      = sizeof(M3DLoader::SkinnedVertex);
+	streams.Positions   = &vertices[0].Pos;
+	streams.Normals     = &vertices[0].Normal;
+	streams.TangentUs   = &vertices[0].TangentU;
+	streams.TexCoords   = &vertices[0].TexC;
+	streams.BoneWeights = &vertices[0].BoneWeights;
+	streams.BoneIndices = vertices[0].BoneIndices;
+
+	BoundingBox bounds;
+	BoundingBox::CreateFromPoints(bounds, vertices.size(), &vertices[0].Pos, sizeof(M3DLoader::SkinnedVertex));
+	mSkinnedQuantization = VertexPacker::QuantizationOf(bounds);
+
+	std::vector<VertexPacker::PackedSkinnedVertex> packedVertices(vertices.size());
+	VertexPacker::Pack(packedVertices.data(), streams, mSkinnedQuantization);
+
+	const UINT vbByteSize = (UINT)packedVertices.size() * sizeof(VertexPacker::PackedSkinnedVertex);
 	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
 	auto geo  = std::make_unique<MeshGeometry>();
 	geo->Name = mSkinnedModelFilename;
 
 	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
+	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), packedVertices.data(), vbByteSize);
 
 	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
 	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
 
 	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-	                                                    mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
+	                                                    mCommandList.Get(), packedVertices.data(), vbByteSize, geo->VertexBufferUploader);
 
 	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
 	                                                   mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
 
-	geo->VertexByteStride     = sizeof(SkinnedVertex);
+	geo->VertexByteStride     = sizeof(VertexPacker::PackedSkinnedVertex);
 	geo->VertexBufferByteSize = vbByteSize;
 	geo->IndexFormat          = DXGI_FORMAT_R16_UINT;
 	geo->IndexBufferByteSize  = ibByteSize;
 
+	std::vector<std::uint32_t> indices32(indices.begin(), indices.end());
+	mSkinnedBvh.Build(&vertices[0].Pos, &vertices[0].BoneWeights, vertices[0].BoneIndices, sizeof(M3DLoader::SkinnedVertex),
+	                  (UINT)vertices.size(), indices32.data(), (UINT)indices32.size(), (UINT)mSkinnedInfo.BoneCount());
+
 	for (UINT i = 0; i < (UINT)mSkinnedSubsets.size(); ++i)
 	{
 		SubmeshGeometry submesh;
@@ -1759,6 +1825,49 @@ void SkinnedMeshApp::BuildRenderItems()
 	}
 }
 
+void SkinnedMeshApp::Pick(int sx, int sy)
+{
+	XMFLOAT4X4 P = mCamera.GetProj4x4f();
+
+	// Compute picking ray in view space.
+	float vx = (+2.0f * sx / mClientWidth - 1.0f) / P(0, 0);
+	float vy = (-2.0f * sy / mClientHeight + 1.0f) / P(1, 1);
+
+	XMVECTOR rayOrigin = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+	XMVECTOR rayDir    = XMVectorSet(vx, vy, 1.0f, 0.0f);
+
+	// Every subset of the soldier shares one world matrix; the tree is in the space the bones skin into.
+	XMMATRIX V        = mCamera.GetView();
+	XMMATRIX invView  = XMMatrixInverse(&XMMatrixDeterminant(V), V);
+	XMMATRIX W        = XMLoadFloat4x4(&mRitemLayer[(int)RenderLayer::SkinnedOpaque][0]->World);
+	XMMATRIX invWorld = XMMatrixInverse(&XMMatrixDeterminant(W), W);
+	XMMATRIX toLocal  = XMMatrixMultiply(invView, invWorld);
+	rayOrigin         = XMVector3TransformCoord(rayOrigin, toLocal);
+	rayDir            = XMVector3TransformNormal(rayDir, toLocal);
+
+	SkinnedMeshBvh::QueryStats stats;
+	TriangleBvh::Hit           hit;
+	std::wostringstream        outs;
+	outs << L"Skinned Mesh Demo    ";
+	if (mSkinnedBvh.Intersect(rayOrigin, rayDir, MathHelper::Infinity, hit, &stats))
+	{
+		std::string material;
+		for (UINT i = 0; i < (UINT)mSkinnedSubsets.size(); ++i)
+		{
+			if (hit.Triangle >= mSkinnedSubsets[i].FaceStart && hit.Triangle < mSkinnedSubsets[i].FaceStart + mSkinnedSubsets[i].FaceCount)
+				material = mSkinnedMats[i].Name;
+		}
+		outs << L"picked triangle " << hit.Triangle << L" (" << std::wstring(material.begin(), material.end()) << L")";
+	}
+	else
+	{
+		outs << L"picked nothing";
+	}
+	outs << L", skinned " << stats.VerticesSkinned << L" of " << mSkinnedBvh.VertexCount() << L" vertices" <<
+			(mLazyPicking ? L" (lazy)" : L" (every frame)");
+	mMainWndCaption = outs.str();
+}
+
 void SkinnedMeshApp::DrawRenderItems(ID3D12GraphicsCommandList* cmdList, const std::vector<RenderItem*>& ritems)
 {
 	UINT objCBByteSize     = d3dUtil::CalcConstantBufferByteSize(sizeof(ObjectConstants));
@@ -543,11 +543,11 @@ void TexColumnsApp::BuildShadersAndInputLayout()
 
 void TexColumnsApp::BuildShapeGeometry()
 {
-	GeometryGenerator           geoGen;
-	GeometryGenerator::MeshData box      = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3);
-	GeometryGenerator::MeshData grid     = geoGen.CreateGrid(20.0f, 30.0f, 60, 40);
-	GeometryGenerator::MeshData sphere   = geoGen.CreateSphere(0.5f, 20, 20);
-	GeometryGenerator::MeshData cylinder = geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20);
+	GeometryGenerator                 geoGen;
+	const GeometryGenerator::MeshSize box      = GeometryGenerator::BoxSize(3);
+	const GeometryGenerator::MeshSize grid     = GeometryGenerator::GridSize(60, 40);
+	const GeometryGenerator::MeshSize sphere   = GeometryGenerator::SphereSize(20, 20);
+	const GeometryGenerator::MeshSize cylinder = GeometryGenerator::CylinderSize(20, 20);
 
 	//
 	// We are concatenating all the geometry into one big vertex/index buffer.  So
@@ -556,101 +556,76 @@ void TexColumnsApp::BuildShapeGeometry()
 
 	// Cache the vertex offsets to each object in the concatenated vertex buffer.
 	UINT boxVertexOffset      = 0;
-	UINT gridVertexOffset     = (UINT)box.Vertices.size();
-	UINT sphereVertexOffset   = gridVertexOffset + (UINT)grid.Vertices.size();
-	UINT cylinderVertexOffset = sphereVertexOffset + (UINT)sphere.Vertices.size();
+	UINT gridVertexOffset     = box.VertexCount;
+	UINT sphereVertexOffset   = gridVertexOffset + grid.VertexCount;
+	UINT cylinderVertexOffset = sphereVertexOffset + sphere.VertexCount;
 
 	// Cache the starting index for each object in the concatenated index buffer.
 	UINT boxIndexOffset      = 0;
-	UINT gridIndexOffset     = (UINT)box.Indices32.size();
-	UINT sphereIndexOffset   = gridIndexOffset + (UINT)grid.Indices32.size();
-	UINT cylinderIndexOffset = sphereIndexOffset + (UINT)sphere.Indices32.size();
+	UINT gridIndexOffset     = box.IndexCount;
+	UINT sphereIndexOffset   = gridIndexOffset + grid.IndexCount;
+	UINT cylinderIndexOffset = sphereIndexOffset + sphere.IndexCount;
 
 	SubmeshGeometry boxSubmesh;
-	boxSubmesh.IndexCount         = (UINT)box.Indices32.size();
+	boxSubmesh.IndexCount         = box.IndexCount;
 	boxSubmesh.StartIndexLocation = boxIndexOffset;
 	boxSubmesh.BaseVertexLocation = boxVertexOffset;
 
 	SubmeshGeometry gridSubmesh;
-	gridSubmesh.IndexCount         = (UINT)grid.Indices32.size();
+	gridSubmesh.IndexCount         = grid.IndexCount;
 	gridSubmesh.StartIndexLocation = gridIndexOffset;
 	gridSubmesh.BaseVertexLocation = gridVertexOffset;
 
 	SubmeshGeometry sphereSubmesh;
-	sphereSubmesh.IndexCount         = (UINT)sphere.Indices32.size();
+	sphereSubmesh.IndexCount         = sphere.IndexCount;
 	sphereSubmesh.StartIndexLocation = sphereIndexOffset;
 	sphereSubmesh.BaseVertexLocation = sphereVertexOffset;
 
 	SubmeshGeometry cylinderSubmesh;
-	cylinderSubmesh.IndexCount         = (UINT)cylinder.Indices32.size();
+	cylinderSubmesh.IndexCount         = cylinder.IndexCount;
 	cylinderSubmesh.StartIndexLocation = cylinderIndexOffset;
 	cylinderSubmesh.BaseVertexLocation = cylinderVertexOffset;
 
-	//
-	// Extract the vertex elements we are interested in and pack the
-	// vertices of all the meshes into one vertex buffer.
-	//
+	const UINT vbByteSize = (cylinderVertexOffset + cylinder.VertexCount) * sizeof(Vertex);
+	const UINT ibByteSize = (cylinderIndexOffset + cylinder.IndexCount) * sizeof(std::uint16_t);
 
-	auto totalVertexCount =
-			box.Vertices.size() +
-			grid.Vertices.size() +
-			sphere.Vertices.size() +
-			cylinder.Vertices.size();
+	auto geo  = std::make_unique<MeshGeometry>();
+	geo->Name = "shapeGeo";
 
-	std::vector<Vertex> vertices(totalVertexCount);
+	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
+	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
 
-	UINT k = 0;
-	for (size_t i = 0; i < box.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos    = box.Vertices[i].Position;
-		vertices[k].Normal = box.Vertices[i].Normal;
-		vertices[k].TexC   = box.Vertices[i].TexC;
-	}
+	//
+	// Generate the shapes straight into the CPU copies of the buffers, with only the
+	// vertex elements we are interested in.
+	//
 
-	for (size_t i = 0; i < grid.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos    = grid.Vertices[i].Position;
-		vertices[k].Normal = grid.Vertices[i].Normal;
-		vertices[k].TexC   = grid.Vertices[i].TexC;
-	}
+	Vertex*        vertices = static_cast<Vertex*>(geo->VertexBufferCPU->GetBufferPointer());
+	std::uint16_t* indices  = static_cast<std::uint16_t*>(geo->IndexBufferCPU->GetBufferPointer());
 
-	for (size_t i = 0; i < sphere.Vertices.size(); ++i, ++k)
-	{
-		vertices[k].Pos    = sphere.Vertices[i].Position;
-		vertices[k].Normal = sphere.Vertices[i].Normal;
-		vertices[k].TexC   = sphere.Vertices[i].TexC;
-	}
+	GeometryGenerator::MeshBuffers out;
+	out.Layout.Stride   = sizeof(Vertex);
+	out.Layout.Position = {offsetof(Vertex, Pos), GeometryGenerator::VertexLayout::Float3};
+	out.Layout.Normal   = {offsetof(Vertex, Normal), GeometryGenerator::VertexLayout::Float3};
+	out.Layout.TexC     = {offsetof(Vertex, TexC), GeometryGenerator::VertexLayout::Float2};
+	out.Indices16       = true;
 
-	for (size_t i = 0; i < cylinder.Vertices.size(); ++i, ++k)
+	auto at = [&](UINT vertexOffset, UINT indexOffset) -> const GeometryGenerator::MeshBuffers&
 	{
-		vertices[k].Pos    = cylinder.Vertices[i].Position;
-		vertices[k].Normal = cylinder.Vertices[i].Normal;
-		vertices[k].TexC   = cylinder.Vertices[i].TexC;
-	}
-
-	std::vector<std::uint16_t> indices;
-	indices.insert(indices.end(), std::begin(box.GetIndices16()), std::end(box.GetIndices16()));
-	indices.insert(indices.end(), std::begin(grid.GetIndices16()), std::end(grid.GetIndices16()));
-	indices.insert(indices.end(), std::begin(sphere.GetIndices16()), std::end(sphere.GetIndices16()));
-	indices.insert(indices.end(), std::begin(cylinder.GetIndices16()), std::end(cylinder.GetIndices16()));
-
-	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
-	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
-
-	auto geo  = std::make_unique<MeshGeometry>();
-	geo->Name = "shapeGeo";
-
-	ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
-	CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertices.data(), vbByteSize);
-
-	ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
-	CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indices.data(), ibByteSize);
+		out.Vertices = vertices + vertexOffset;
+		out.Indices  = indices + indexOffset;
+		return out;
+	};
+	geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3, at(boxVertexOffset, boxIndexOffset));
+	geoGen.CreateGrid(20.0f, 30.0f, 60, 40, at(gridVertexOffset, gridIndexOffset));
+	geoGen.CreateSphere(0.5f, 20, 20, at(sphereVertexOffset, sphereIndexOffset));
+	geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20, at(cylinderVertexOffset, cylinderIndexOffset));
 
 	geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-	                                                    mCommandList.Get(), vertices.data(), vbByteSize, geo->VertexBufferUploader);
+	                                                    mCommandList.Get(), vertices, vbByteSize, geo->VertexBufferUploader);
 
 	geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(md3dDevice.Get(),
-	                                                   mCommandList.Get(), indices.data(), ibByteSize, geo->IndexBufferUploader);
+	                                                   mCommandList.Get(), indices, ibByteSize, geo->IndexBufferUploader);
 
 	geo->VertexByteStride     = sizeof(Vertex);
 	geo->VertexBufferByteSize = vbByteSize;
@@ -0,0 +1,202 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include <algorithm>
+#include <cfloat>
+
+/**
+ * \brief Pieces shared by the BVH builders and traversals (TriangleBvh, SceneBvh, TwoLevelBvh, SkinnedMeshBvh)
+ * and the SIMD culling code. Only included by their .cpp files.
+ */
+class BvhUtil
+{
+public:
+	static constexpr UINT kBinCount = 16; // bins per axis of the surface area heuristic
+
+	struct Box
+	{
+		DirectX::XMFLOAT3 Min;
+		DirectX::XMFLOAT3 Max;
+	};
+
+	// What the slab test needs of a ray.
+	struct Ray
+	{
+		DirectX::XMFLOAT3 Origin;
+		DirectX::XMFLOAT3 InvDirection;
+	};
+
+	// Half the surface area; only ratios matter to the heuristic.
+	static float HalfArea(const DirectX::XMFLOAT3& min, const DirectX::XMFLOAT3& max)
+	{
+		const float dx = max.x - min.x;
+		const float dy = max.y - min.y;
+		const float dz = max.z - min.z;
+		return dx * dy + dy * dz + dz * dx;
+	}
+
+	static void Grow(DirectX::XMFLOAT3& min, DirectX::XMFLOAT3& max, const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax)
+	{
+		min.x = std::min(min.x, boxMin.x);
+		min.y = std::min(min.y, boxMin.y);
+		min.z = std::min(min.z, boxMin.z);
+		max.x = std::max(max.x, boxMax.x);
+		max.y = std::max(max.y, boxMax.y);
+		max.z = std::max(max.z, boxMax.z);
+	}
+
+	static float Component(const DirectX::XMFLOAT3& v, int axis)
+	{
+		return (&v.x)[axis];
+	}
+
+	// One bit per lane, set where the lane of mask is all ones.
+	static UINT LaneMask(DirectX::FXMVECTOR mask)
+	{
+#if defined(_XM_SSE_INTRINSICS_)
+		return (UINT)_mm_movemask_ps(mask);
+#else
+		return (DirectX::XMVectorGetIntX(mask) ? 1u : 0u) |
+		       (DirectX::XMVectorGetIntY(mask) ? 2u : 0u) |
+		       (DirectX::XMVectorGetIntZ(mask) ? 4u : 0u) |
+		       (DirectX::XMVectorGetIntW(mask) ? 8u : 0u);
+#endif
+	}
+
+	static float SafeInverse(float d)
+	{
+		// Keeps 0 * inf out of the slab test when the origin lies on a slab plane.
+		return 1.0f / (fabsf(d) > 1e-20f ? d : copysignf(1e-20f, d));
+	}
+
+	// Slab test against a node with Min and Max; entry receives the distance at which the ray enters the box (0 if it starts inside).
+	template <typename Node>
+	static bool IntersectBox(const Ray& ray, const Node& node, float tMax, float& entry)
+	{
+		const float tx0 = (node.Min.x - ray.Origin.x) * ray.InvDirection.x;
+		const float tx1 = (node.Max.x - ray.Origin.x) * ray.InvDirection.x;
+		const float ty0 = (node.Min.y - ray.Origin.y) * ray.InvDirection.y;
+		const float ty1 = (node.Max.y - ray.Origin.y) * ray.InvDirection.y;
+		const float tz0 = (node.Min.z - ray.Origin.z) * ray.InvDirection.z;
+		const float tz1 = (node.Max.z - ray.Origin.z) * ray.InvDirection.z;
+
+		const float tNear = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+		const float tFar  = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), tMax));
+
+		entry = tNear;
+		return tNear <= tFar;
+	}
+
+	/**
+	 * \brief Splits items[0, count) of a node with the binned surface area heuristic.
+	 * The items are reordered so the left child takes the first ones; the return value is how many, 0 to keep
+	 * the node a leaf. Nodes of more than 4 * maxLeafSize items are split even when a leaf would cost less.
+	 * \param centroids, bounds Centroid and box of every item, indexed by item
+	 */
+	template <typename ItemBox>
+	static UINT PartitionSah(UINT*                    items,
+	                         UINT                     count,
+	                         const DirectX::XMFLOAT3& nodeMin,
+	                         const DirectX::XMFLOAT3& nodeMax,
+	                         const DirectX::XMFLOAT3* centroids,
+	                         const ItemBox*           bounds,
+	                         UINT                     maxLeafSize)
+	{
+		using DirectX::XMFLOAT3;
+
+		XMFLOAT3 centroidMin = centroids[items[0]];
+		XMFLOAT3 centroidMax = centroidMin;
+		for (UINT i = 1; i < count; ++i)
+			Grow(centroidMin, centroidMax, centroids[items[i]], centroids[items[i]]);
+
+		struct Bin
+		{
+			XMFLOAT3 Min;
+			XMFLOAT3 Max;
+			UINT     Count;
+		};
+
+		// Best split over every axis and every plane between the bins.
+		float bestCost  = FLT_MAX;
+		int   bestAxis  = -1;
+		UINT  bestSplit = 0;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const float axisMin = Component(centroidMin, axis);
+			const float extent  = Component(centroidMax, axis) - axisMin;
+			if (extent <= 0.0f)
+				continue;
+
+			Bin bins[kBinCount];
+			for (auto& bin : bins)
+			{
+				bin.Min   = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+				bin.Max   = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+				bin.Count = 0;
+			}
+
+			const float scale = kBinCount / extent;
+			for (UINT i = 0; i < count; ++i)
+			{
+				const UINT item = items[i];
+				const UINT b    = std::min((UINT)((Component(centroids[item], axis) - axisMin) * scale), kBinCount - 1);
+				Grow(bins[b].Min, bins[b].Max, bounds[item].Min, bounds[item].Max);
+				++bins[b].Count;
+			}
+
+			// Sweep from the right to get the cost of every right side, then from the left.
+			float    rightArea[kBinCount];
+			UINT     rightCount[kBinCount];
+			XMFLOAT3 min   = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+			XMFLOAT3 max   = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			UINT     total = 0;
+			for (UINT b = kBinCount - 1; b > 0; --b)
+			{
+				if (bins[b].Count > 0)
+					Grow(min, max, bins[b].Min, bins[b].Max);
+				total        += bins[b].Count;
+				rightCount[b] = total;
+				rightArea[b]  = total > 0 ? HalfArea(min, max) : 0.0f;
+			}
+
+			min   = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+			max   = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			total = 0;
+			for (UINT b = 0; b < kBinCount - 1; ++b)
+			{
+				if (bins[b].Count > 0)
+					Grow(min, max, bins[b].Min, bins[b].Max);
+				total += bins[b].Count;
+				if (total == 0 || rightCount[b + 1] == 0)
+					continue;
+
+				const float cost = total * HalfArea(min, max) + rightCount[b + 1] * rightArea[b + 1];
+				if (cost < bestCost)
+				{
+					bestCost  = cost;
+					bestAxis  = axis;
+					bestSplit = b + 1;
+				}
+			}
+		}
+
+		// Every centroid is in the same place: no plane separates them.
+		if (bestAxis < 0)
+			return 0;
+
+		const float leafCost = count * HalfArea(nodeMin, nodeMax);
+		if (bestCost >= leafCost && count <= 4 * maxLeafSize)
+			return 0;
+
+		const float axisMin = Component(centroidMin, bestAxis);
+		const float scale   = kBinCount / (Component(centroidMax, bestAxis) - axisMin);
+		UINT*       middle  = std::partition(items, items + count, [&](UINT item)
+		{
+			return std::min((UINT)((Component(centroids[item], bestAxis) - axisMin) * scale), kBinCount - 1) < bestSplit;
+		});
+
+		const UINT leftCount = (UINT)(middle - items);
+		return leftCount < count ? leftCount : 0;
+	}
+};
@@ -0,0 +1,318 @@
+#include "DDSCatalog.h"
+#include <chrono>
+#include <cwctype>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr uint32_t kIndexMagic   = 0x43534444; // "DDSC"
+	constexpr uint32_t kIndexVersion = 1;
+
+	template <typename T>
+	void WritePod(std::ofstream& fout, const T& value)
+	{
+		fout.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template <typename T>
+	bool ReadPod(std::ifstream& fin, T& value)
+	{
+		fin.read(reinterpret_cast<char*>(&value), sizeof(T));
+		return (bool)fin;
+	}
+
+	UINT64 ToUInt64(DWORD high, DWORD low)
+	{
+		return (UINT64(high) << 32) | UINT64(low);
+	}
+
+	bool HasDDSExtension(const wchar_t* name)
+	{
+		size_t length = wcslen(name);
+		return length >= 4 && _wcsicmp(name + length - 4, L".dds") == 0;
+	}
+}
+
+DDSCatalog::ScanStats DDSCatalog::ScanDirectory(const std::wstring& directory, bool recursive)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	std::wstring root   = NormalizePath(directory);
+	std::wstring prefix = root.empty() || root.back() == L'/' ? root : root + L"/";
+
+	ScanStats         stats;
+	std::vector<bool> seen(mEntries.size(), false); // entries whose file was found and parsed by this scan
+	Scan(prefix, recursive, seen, stats);
+	RemoveUnseen(prefix, recursive, seen, stats);
+
+	auto end           = std::chrono::high_resolution_clock::now();
+	stats.Milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	return stats;
+}
+
+void DDSCatalog::Scan(const std::wstring& directory, bool recursive, std::vector<bool>& seen, ScanStats& stats)
+{
+	std::wstring prefix = directory.empty() || directory.back() == L'/' ? directory : directory + L"/";
+
+	// The find data already carries the file size and write time, so unchanged files are never opened.
+	WIN32_FIND_DATAW findData;
+	HANDLE           find = FindFirstFileExW((prefix + L"*").c_str(),
+	                                         FindExInfoBasic,
+	                                         &findData,
+	                                         FindExSearchNameMatch,
+	                                         nullptr,
+	                                         FIND_FIRST_EX_LARGE_FETCH);
+	if (find == INVALID_HANDLE_VALUE)
+		return;
+
+	do
+	{
+		std::wstring path = prefix + findData.cFileName;
+
+		if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			if (recursive && wcscmp(findData.cFileName, L".") != 0 && wcscmp(findData.cFileName, L"..") != 0)
+				Scan(path, recursive, seen, stats);
+			continue;
+		}
+
+		if (!HasDDSExtension(findData.cFileName))
+			continue;
+
+		Entry entry;
+		entry.Filename  = path;
+		entry.FileSize  = ToUInt64(findData.nFileSizeHigh, findData.nFileSizeLow);
+		entry.WriteTime = ToUInt64(findData.ftLastWriteTime.dwHighDateTime, findData.ftLastWriteTime.dwLowDateTime);
+
+		UINT index = IndexOf(path);
+		if (index != kNotFound && mEntries[index].FileSize == entry.FileSize && mEntries[index].WriteTime == entry.WriteTime)
+		{
+			seen[index] = true;
+			++stats.FilesSkipped;
+			continue;
+		}
+
+		if (ReadHeader(path, entry))
+		{
+			index = Insert(std::move(entry));
+			if (index >= seen.size())
+				seen.resize(index + 1, false);
+			seen[index] = true;
+			++stats.FilesParsed;
+		}
+		else
+		{
+			++stats.FilesFailed;
+		}
+	}
+	while (FindNextFileW(find, &findData));
+
+	FindClose(find);
+}
+
+void DDSCatalog::RemoveUnseen(const std::wstring& prefix, bool recursive, const std::vector<bool>& seen, ScanStats& stats)
+{
+	const std::wstring prefixKey = MakeKey(prefix);
+
+	std::vector<Entry> kept;
+	kept.reserve(mEntries.size());
+	for (UINT i = 0; i < (UINT)mEntries.size(); ++i)
+	{
+		// Entries outside the scanned directory were not looked for, so they stay.
+		std::wstring key     = MakeKey(mEntries[i].Filename);
+		bool         scanned = key.compare(0, prefixKey.size(), prefixKey) == 0 &&
+		                       (recursive || key.find(L'/', prefixKey.size()) == std::wstring::npos);
+
+		if (scanned && !seen[i])
+			++stats.FilesRemoved;
+		else
+			kept.push_back(std::move(mEntries[i]));
+	}
+
+	if (stats.FilesRemoved == 0)
+		return;
+
+	Clear();
+	for (auto& entry : kept)
+		Insert(std::move(entry));
+}
+
+UINT DDSCatalog::AddFile(const std::wstring& filename)
+{
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExW(filename.c_str(), GetFileExInfoStandard, &attributes))
+		return kNotFound;
+
+	Entry entry;
+	entry.Filename  = NormalizePath(filename);
+	entry.FileSize  = ToUInt64(attributes.nFileSizeHigh, attributes.nFileSizeLow);
+	entry.WriteTime = ToUInt64(attributes.ftLastWriteTime.dwHighDateTime, attributes.ftLastWriteTime.dwLowDateTime);
+
+	UINT index = IndexOf(filename);
+	if (index != kNotFound && mEntries[index].FileSize == entry.FileSize && mEntries[index].WriteTime == entry.WriteTime)
+		return index;
+
+	if (!ReadHeader(filename, entry))
+		return kNotFound;
+
+	return Insert(std::move(entry));
+}
+
+const DDSCatalog::Entry* DDSCatalog::Find(const std::wstring& filename) const
+{
+	UINT index = IndexOf(filename);
+	return index != kNotFound ? &mEntries[index] : nullptr;
+}
+
+UINT DDSCatalog::IndexOf(const std::wstring& filename) const
+{
+	auto it = mLookup.find(MakeKey(filename));
+	return it != mLookup.end() ? it->second : kNotFound;
+}
+
+void DDSCatalog::Clear()
+{
+	mEntries.clear();
+	mLookup.clear();
+}
+
+bool DDSCatalog::Load(const std::wstring& indexFilename)
+{
+	Clear();
+
+	std::ifstream fin(indexFilename, std::ios::binary);
+	if (!fin)
+		return false;
+
+	// The entries are stored as raw structs, so an index written by a build with different layouts is stale.
+	uint32_t magic = 0, version = 0, infoSize = 0, layoutSize = 0, count = 0;
+	if (!ReadPod(fin, magic) || !ReadPod(fin, version) || !ReadPod(fin, infoSize) ||
+		!ReadPod(fin, layoutSize) || !ReadPod(fin, count))
+		return false;
+
+	if (magic != kIndexMagic || version != kIndexVersion ||
+		infoSize != sizeof(DDS_TEXTURE_INFO) || layoutSize != sizeof(DDS_SUBRESOURCE_LAYOUT))
+		return false;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Entry    entry;
+		uint32_t nameLength  = 0;
+		uint32_t layoutCount = 0;
+
+		if (!ReadPod(fin, nameLength))
+			break;
+		entry.Filename.resize(nameLength);
+		fin.read(reinterpret_cast<char*>(&entry.Filename[0]), std::streamsize(nameLength) * sizeof(wchar_t));
+
+		if (!ReadPod(fin, entry.FileSize) || !ReadPod(fin, entry.WriteTime) ||
+			!ReadPod(fin, entry.Info) || !ReadPod(fin, layoutCount))
+			break;
+
+		entry.Layouts.resize(layoutCount);
+		fin.read(reinterpret_cast<char*>(entry.Layouts.data()), std::streamsize(layoutCount) * layoutSize);
+		if (!fin)
+			break;
+
+		Insert(std::move(entry));
+	}
+
+	if (mEntries.size() != count)
+	{
+		Clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool DDSCatalog::Save(const std::wstring& indexFilename) const
+{
+	std::ofstream fout(indexFilename, std::ios::binary | std::ios::trunc);
+	if (!fout)
+		return false;
+
+	WritePod(fout, kIndexMagic);
+	WritePod(fout, kIndexVersion);
+	WritePod(fout, uint32_t(sizeof(DDS_TEXTURE_INFO)));
+	WritePod(fout, uint32_t(sizeof(DDS_SUBRESOURCE_LAYOUT)));
+	WritePod(fout, uint32_t(mEntries.size()));
+
+	for (const auto& entry : mEntries)
+	{
+		WritePod(fout, uint32_t(entry.Filename.size()));
+		fout.write(reinterpret_cast<const char*>(entry.Filename.data()),
+		           std::streamsize(entry.Filename.size()) * sizeof(wchar_t));
+		WritePod(fout, entry.FileSize);
+		WritePod(fout, entry.WriteTime);
+		WritePod(fout, entry.Info);
+		WritePod(fout, uint32_t(entry.Layouts.size()));
+		fout.write(reinterpret_cast<const char*>(entry.Layouts.data()),
+		           std::streamsize(entry.Layouts.size()) * sizeof(DDS_SUBRESOURCE_LAYOUT));
+	}
+
+	return bool(fout.flush());
+}
+
+D3D12_RESOURCE_DESC DDSCatalog::MakeResourceDesc(const DDS_TEXTURE_INFO& info)
+{
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension           = info.dimension;
+	desc.Width               = info.width;
+	desc.Height              = info.height;
+	desc.DepthOrArraySize    = UINT16(info.dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? info.depth : info.arraySize);
+	desc.MipLevels           = UINT16(info.mipLevels);
+	desc.Format              = info.format;
+	desc.SampleDesc.Count    = 1;
+	desc.SampleDesc.Quality  = 0;
+	desc.Layout              = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+	desc.Flags               = D3D12_RESOURCE_FLAG_NONE;
+	return desc;
+}
+
+std::wstring DDSCatalog::NormalizePath(const std::wstring& filename)
+{
+	std::wstring path = filename;
+	std::replace(path.begin(), path.end(), L'\\', L'/');
+	return path;
+}
+
+std::wstring DDSCatalog::MakeKey(const std::wstring& filename)
+{
+	std::wstring key = NormalizePath(filename);
+	std::transform(key.begin(), key.end(), key.begin(), [](wchar_t c) { return (wchar_t)std::towlower(c); });
+	return key;
+}
+
+bool DDSCatalog::ReadHeader(const std::wstring& filename, Entry& entry)
+{
+	uint8_t       header[DDS_MAX_HEADER_SIZE] = {};
+	std::ifstream fin(filename, std::ios::binary);
+	if (!fin)
+		return false;
+	fin.read(reinterpret_cast<char*>(header), sizeof(header));
+
+	// The layouts are computed from the header alone; make sure the file actually holds all of that data.
+	if (FAILED(GetDDSTextureInfoFromMemory(header, (size_t)fin.gcount(), entry.Info, &entry.Layouts)))
+		return false;
+
+	return entry.FileSize == 0 || entry.FileSize >= entry.Info.headerSize + entry.Info.dataSize;
+}
+
+UINT DDSCatalog::Insert(Entry&& entry)
+{
+	std::wstring key = MakeKey(entry.Filename);
+
+	auto it = mLookup.find(key);
+	if (it != mLookup.end())
+	{
+		mEntries[it->second] = std::move(entry);
+		return it->second;
+	}
+
+	UINT index   = (UINT)mEntries.size();
+	mLookup[key] = index;
+	mEntries.push_back(std::move(entry));
+	return index;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "d3dUtil.h"
+
+/**
+ * \brief Header-only index of DDS files.
+ * Scanning reads only the first DDS_MAX_HEADER_SIZE (148) bytes of each file, so a whole texture
+ * directory can be catalogued without touching pixel data. Every entry records the format, dimensions,
+ * mip count, array size and the file offset of every subresource, which is enough to size heaps
+ * (see MakeResourceDesc()) or plan streaming reads before anything is loaded.
+ *
+ * The catalog can be saved to and loaded from a small binary index file. A later scan only re-reads files
+ * whose size or last write time changed since the index was written, and drops the entries of files that
+ * are gone.
+ */
+class DDSCatalog
+{
+public:
+	struct Entry
+	{
+		std::wstring                                 Filename;      // path as passed to the scan, '/' separated
+		UINT64                                       FileSize  = 0;
+		UINT64                                       WriteTime = 0; // FILETIME of the last write
+		DirectX::DDS_TEXTURE_INFO                    Info      = {};
+		std::vector<DirectX::DDS_SUBRESOURCE_LAYOUT> Layouts;       // slice major, mips within each slice
+	};
+
+	struct ScanStats
+	{
+		UINT   FilesParsed  = 0; // headers that were read from disk
+		UINT   FilesSkipped = 0; // files whose catalog entry was still up to date
+		UINT   FilesFailed  = 0; // unreadable files or unsupported headers
+		UINT   FilesRemoved = 0; // entries dropped because their file is gone or no longer parses
+		double Milliseconds = 0.0;
+	};
+
+	static constexpr UINT kNotFound = UINT(-1);
+
+	DDSCatalog() = default;
+
+	/**
+	 * \brief Adds or refreshes every *.dds file in a directory, and removes the entries of the directory
+	 * whose file was not found (or, with recursive, of its sub-directories).
+	 * \param directory Directory to scan, e.g. L"../../Textures"
+	 * \param recursive Also scan sub-directories
+	 * \return counts and timing of the scan
+	 */
+	ScanStats ScanDirectory(const std::wstring& directory, bool recursive = false);
+
+	// Adds or refreshes a single file. Returns its index into Entries(), or kNotFound if the file could not be parsed.
+	UINT AddFile(const std::wstring& filename);
+
+	// Looks a file up by the path it was scanned with (case and slash direction do not matter).
+	// The pointer is valid until the catalog is next changed.
+	const Entry* Find(const std::wstring& filename) const;
+
+	const std::vector<Entry>& Entries() const { return mEntries; }
+
+	void Clear();
+
+	// Binary index file. Load() returns false (and leaves the catalog empty) for a missing or stale index;
+	// Save() returns false if the file could not be written.
+	bool Load(const std::wstring& indexFilename);
+	bool Save(const std::wstring& indexFilename) const;
+
+	// Resource description of the whole mip chain, e.g. for ID3D12Device::GetResourceAllocationInfo().
+	static D3D12_RESOURCE_DESC MakeResourceDesc(const DirectX::DDS_TEXTURE_INFO& info);
+
+private:
+	static std::wstring NormalizePath(const std::wstring& filename);
+	static std::wstring MakeKey(const std::wstring& filename);
+	static bool         ReadHeader(const std::wstring& filename, Entry& entry);
+
+	UINT IndexOf(const std::wstring& filename) const;
+	void Scan(const std::wstring& directory, bool recursive, std::vector<bool>& seen, ScanStats& stats);
+	void RemoveUnseen(const std::wstring& prefix, bool recursive, const std::vector<bool>& seen, ScanStats& stats);
+	UINT Insert(Entry&& entry);
+
+private:
+	std::vector<Entry>                     mEntries;
+	std::unordered_map<std::wstring, UINT> mLookup; // MakeKey(filename) -> index into mEntries
+};
@@ -15,9 +15,11 @@
 //--------------------------------------------------------------------------------------
 
 #include "DDSTextureLoader.h"
+#include "MipGenerator.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <memory>
 #include <new>
 
@@ -1557,6 +1559,205 @@ namespace
         UNREFERENCED_PARAMETER(texture);
     #endif
     }
+
+    //--------------------------------------------------------------------------------------
+    // Header-only equivalent of the validation done by CreateTextureFromDDS. Does not need
+    // a device, so multi-planar formats are reported with their combined surface size.
+    //--------------------------------------------------------------------------------------
+    HRESULT GetTextureInfo(_In_ const DDS_HEADER* header, bool hasDXT10Header, DDS_TEXTURE_INFO& info) noexcept
+    {
+        info = {};
+        info.width = header->width;
+        info.height = header->height;
+        info.depth = header->depth;
+        info.arraySize = 1;
+        info.mipLevels = (header->mipMapCount == 0) ? 1u : header->mipMapCount;
+        info.headerSize = sizeof(uint32_t) + sizeof(DDS_HEADER) + (hasDXT10Header ? sizeof(DDS_HEADER_DXT10) : 0);
+
+        if (hasDXT10Header)
+        {
+            auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>(reinterpret_cast<const char*>(header) + sizeof(DDS_HEADER));
+
+            info.arraySize = d3d10ext->arraySize;
+            if (info.arraySize == 0)
+            {
+                return HRESULT_E_INVALID_DATA;
+            }
+
+            switch (d3d10ext->dxgiFormat)
+            {
+            case DXGI_FORMAT_AI44:
+            case DXGI_FORMAT_IA44:
+            case DXGI_FORMAT_P8:
+            case DXGI_FORMAT_A8P8:
+                return HRESULT_E_NOT_SUPPORTED;
+
+            default:
+                if (BitsPerPixel(d3d10ext->dxgiFormat) == 0)
+                {
+                    return HRESULT_E_NOT_SUPPORTED;
+                }
+            }
+
+            info.format = d3d10ext->dxgiFormat;
+
+            switch (d3d10ext->resourceDimension)
+            {
+            case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
+                if ((header->flags & DDS_HEIGHT) && info.height != 1)
+                {
+                    return HRESULT_E_INVALID_DATA;
+                }
+                info.height = info.depth = 1;
+                break;
+
+            case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
+                if (d3d10ext->miscFlag & 0x4 /* RESOURCE_MISC_TEXTURECUBE */)
+                {
+                    info.arraySize *= 6;
+                    info.isCubeMap = true;
+                }
+                info.depth = 1;
+                break;
+
+            case D3D12_RESOURCE_DIMENSION_TEXTURE3D:
+                if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
+                {
+                    return HRESULT_E_INVALID_DATA;
+                }
+
+                if (info.arraySize > 1)
+                {
+                    return HRESULT_E_NOT_SUPPORTED;
+                }
+                break;
+
+            default:
+                return HRESULT_E_NOT_SUPPORTED;
+            }
+
+            info.dimension = static_cast<D3D12_RESOURCE_DIMENSION>(d3d10ext->resourceDimension);
+        }
+        else
+        {
+            info.format = GetDXGIFormat(header->ddspf);
+
+            if (info.format == DXGI_FORMAT_UNKNOWN)
+            {
+                return HRESULT_E_NOT_SUPPORTED;
+            }
+
+            if (header->flags & DDS_HEADER_FLAGS_VOLUME)
+            {
+                info.dimension = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+            }
+            else
+            {
+                if (header->caps2 & DDS_CUBEMAP)
+                {
+                    if ((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                    {
+                        return HRESULT_E_NOT_SUPPORTED;
+                    }
+
+                    info.arraySize = 6;
+                    info.isCubeMap = true;
+                }
+
+                info.depth = 1;
+                info.dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            }
+        }
+
+        if (info.mipLevels > D3D12_REQ_MIP_LEVELS)
+        {
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        if (info.dimension != D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+        {
+            info.depth = 1;
+        }
+        else if (info.depth == 0)
+        {
+            info.depth = 1;
+        }
+
+        info.alphaMode = GetAlphaMode(header);
+
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // DDS_LOADER_GENERATE_MIPS: replaces ddsData with a copy of the file whose chain runs
+    // down to 1x1. The existing levels are kept and the missing ones are box filtered from
+    // the last of them. Files that already have a full chain, or whose format MipGenerator
+    // does not handle, are left untouched.
+    //--------------------------------------------------------------------------------------
+    HRESULT GenerateMissingMips(
+        bool forceSRGB,
+        std::unique_ptr<uint8_t[]>& ddsData,
+        const DDS_HEADER** header,
+        const uint8_t** bitData,
+        size_t* bitSize) noexcept
+    {
+        const bool hasDXT10Header = ((*header)->ddspf.flags & DDS_FOURCC) &&
+            (MAKEFOURCC('D', 'X', '1', '0') == (*header)->ddspf.fourCC);
+
+        DDS_TEXTURE_INFO info;
+        HRESULT hr = GetTextureInfo(*header, hasDXT10Header, info);
+        if (FAILED(hr))
+            return hr;
+
+        if (info.dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D || !MipGenerator::IsSupported(info.format))
+            return S_OK;
+
+        const UINT fullMips = MipGenerator::CountMips(info.width, info.height);
+        if (info.mipLevels >= fullMips)
+            return S_OK;
+
+        const size_t srcSliceBytes = MipGenerator::ComputeChainBytes(info.format, info.width, info.height, info.mipLevels);
+        const size_t dstSliceBytes = MipGenerator::ComputeChainBytes(info.format, info.width, info.height, fullMips);
+        if (srcSliceBytes * info.arraySize > *bitSize)
+            return HRESULT_E_HANDLE_EOF;
+
+        const size_t headerBytes = static_cast<size_t>(*bitData - ddsData.get());
+        const size_t newBitSize = dstSliceBytes * info.arraySize;
+
+        std::unique_ptr<uint8_t[]> newData(new (std::nothrow) uint8_t[headerBytes + newBitSize]);
+        if (!newData)
+            return E_OUTOFMEMORY;
+
+        memcpy(newData.get(), ddsData.get(), headerBytes);
+        auto newHeader = reinterpret_cast<DDS_HEADER*>(newData.get() + sizeof(uint32_t));
+        newHeader->mipMapCount = fullMips;
+
+        try
+        {
+            MipGenerator::Options options;
+            options.ForceSrgb = forceSRGB;
+
+            MipGenerator::GenerateChain(info.format, info.width, info.height, info.arraySize,
+                info.mipLevels, *bitData,
+                fullMips, newData.get() + headerBytes,
+                options);
+        }
+        catch (const std::bad_alloc&)
+        {
+            return E_OUTOFMEMORY;
+        }
+        catch (...)
+        {
+            return E_FAIL;
+        }
+
+        ddsData = std::move(newData);
+        *header = newHeader;
+        *bitData = ddsData.get() + headerBytes;
+        *bitSize = newBitSize;
+
+        return S_OK;
+    }
 } // anonymous namespace
 
 
@@ -1720,6 +1921,16 @@ HRESULT DirectX::LoadDDSTextureFromFileEx(
         return hr;
     }
 
+    if (loadFlags & DDS_LOADER_GENERATE_MIPS)
+    {
+        hr = GenerateMissingMips((loadFlags & DDS_LOADER_FORCE_SRGB) != 0,
+            ddsData, &header, &bitData, &bitSize);
+        if (FAILED(hr))
+        {
+            return hr;
+        }
+    }
+
     hr = CreateTextureFromDDS(d3dDevice,
         header, bitData, bitSize, maxsize,
         resFlags, loadFlags,
@@ -1734,4 +1945,116 @@ HRESULT DirectX::LoadDDSTextureFromFileEx(
     }
 
     return hr;
-}
\ No newline at end of file
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GetDDSTextureInfoFromMemory(
+    const uint8_t* headerData,
+    size_t headerDataSize,
+    DDS_TEXTURE_INFO& info,
+    std::vector<DDS_SUBRESOURCE_LAYOUT>* layouts)
+{
+    info = {};
+    if (layouts)
+    {
+        layouts->clear();
+    }
+
+    if (!headerData)
+    {
+        return E_INVALIDARG;
+    }
+
+    if (headerDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
+    {
+        return E_FAIL;
+    }
+
+    auto const dwMagicNumber = *reinterpret_cast<const uint32_t*>(headerData);
+    if (dwMagicNumber != DDS_MAGIC)
+    {
+        return E_FAIL;
+    }
+
+    auto hdr = reinterpret_cast<const DDS_HEADER*>(headerData + sizeof(uint32_t));
+    if (hdr->size != sizeof(DDS_HEADER) ||
+        hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        return E_FAIL;
+    }
+
+    bool bDXT10Header = false;
+    if ((hdr->ddspf.flags & DDS_FOURCC) &&
+        (MAKEFOURCC('D', 'X', '1', '0') == hdr->ddspf.fourCC))
+    {
+        if (headerDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)))
+        {
+            return E_FAIL;
+        }
+
+        bDXT10Header = true;
+    }
+
+    HRESULT hr = GetTextureInfo(hdr, bDXT10Header, info);
+    if (FAILED(hr))
+    {
+        return hr;
+    }
+
+    // Walk the subresources in file order. The layout matches FillInitData.
+    if (layouts)
+    {
+        layouts->reserve(size_t(info.arraySize) * info.mipLevels);
+    }
+
+    size_t offset = info.headerSize;
+    for (uint32_t j = 0; j < info.arraySize; ++j)
+    {
+        size_t w = info.width;
+        size_t h = info.height;
+        size_t d = info.depth;
+        for (uint32_t i = 0; i < info.mipLevels; ++i)
+        {
+            size_t numBytes = 0;
+            size_t rowBytes = 0;
+            size_t numRows = 0;
+            hr = GetSurfaceInfo(w, h, info.format, &numBytes, &rowBytes, &numRows);
+            if (FAILED(hr))
+            {
+                if (layouts)
+                {
+                    layouts->clear();
+                }
+                return hr;
+            }
+
+            if (layouts)
+            {
+                DDS_SUBRESOURCE_LAYOUT layout = {};
+                layout.mipLevel = i;
+                layout.arraySlice = j;
+                layout.width = static_cast<uint32_t>(w);
+                layout.height = static_cast<uint32_t>(h);
+                layout.depth = static_cast<uint32_t>(d);
+                layout.offset = offset;
+                layout.rowPitch = rowBytes;
+                layout.slicePitch = numBytes;
+                layout.numRows = numRows;
+                layout.byteSize = numBytes * d;
+                layouts->push_back(layout);
+            }
+
+            offset += numBytes * d;
+
+            w = std::max<size_t>(w >> 1, 1);
+            h = std::max<size_t>(h >> 1, 1);
+            d = std::max<size_t>(d >> 1, 1);
+        }
+    }
+
+    info.dataSize = offset - info.headerSize;
+
+    return S_OK;
+}
@@ -62,6 +62,7 @@ namespace DirectX
         DDS_LOADER_DEFAULT = 0,
         DDS_LOADER_FORCE_SRGB = 0x1,
         DDS_LOADER_MIP_RESERVE = 0x8,
+        DDS_LOADER_GENERATE_MIPS = 0x10, // RGBA8/RGBA16F/R32F 2D textures with a short chain get the rest built on the CPU (file loaders only)
     };
 
 #ifdef __clang__
@@ -76,6 +77,48 @@ namespace DirectX
 #endif
 #endif
 
+    // Header-only description of a DDS file (no pixel data is touched)
+    struct DDS_TEXTURE_INFO
+    {
+        D3D12_RESOURCE_DIMENSION dimension;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        uint32_t mipLevels;
+        uint32_t arraySize;     // already multiplied by 6 for cube maps
+        DXGI_FORMAT format;
+        bool isCubeMap;
+        DDS_ALPHA_MODE alphaMode;
+        size_t headerSize;      // byte offset of the first subresource in the file
+        size_t dataSize;        // total bytes of pixel data that follow the header
+    };
+
+    // Location of a single subresource (mip/slice) inside a DDS file
+    struct DDS_SUBRESOURCE_LAYOUT
+    {
+        uint32_t mipLevel;
+        uint32_t arraySlice;
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        size_t offset;          // from the start of the file (magic included)
+        size_t rowPitch;
+        size_t slicePitch;
+        size_t numRows;
+        size_t byteSize;        // slicePitch * depth
+    };
+
+    // Largest possible header (magic + DDS_HEADER + DDS_HEADER_DXT10)
+    constexpr size_t DDS_MAX_HEADER_SIZE = 148;
+
+    // Parses only the header bytes of a DDS file. 'layouts' (optional) receives one entry per
+    // subresource in D3D12 subresource order (array slice major, mip minor).
+    HRESULT __cdecl GetDDSTextureInfoFromMemory(
+        _In_reads_bytes_(headerDataSize) const uint8_t* headerData,
+        size_t headerDataSize,
+        DDS_TEXTURE_INFO& info,
+        _Out_opt_ std::vector<DDS_SUBRESOURCE_LAYOUT>* layouts = nullptr);
+
     // Standard version
     HRESULT __cdecl LoadDDSTextureFromMemory(
         _In_ ID3D12Device* d3dDevice,
@@ -0,0 +1,211 @@
+#include "FrustumCuller.h"
+#include "BvhUtil.h"
+
+using namespace DirectX;
+
+namespace
+{
+	inline XMVECTOR LoadStream(const std::vector<float>& stream, UINT index)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(stream.data() + index));
+	}
+
+	// Every plane component splatted across a vector, so the box loops only load boxes.
+	struct PlaneSplats
+	{
+		XMVECTOR Nx[6];
+		XMVECTOR Ny[6];
+		XMVECTOR Nz[6];
+		XMVECTOR D[6];
+		XMVECTOR Ax[6]; // |Nx|
+		XMVECTOR Ay[6];
+		XMVECTOR Az[6];
+	};
+
+	void SplatPlanes(const FrustumCuller::Frustum& frustum, PlaneSplats& splats)
+	{
+		for (int p = 0; p < 6; ++p)
+		{
+			XMVECTOR plane = XMLoadFloat4(&frustum.Planes[p]);
+			splats.Nx[p]   = XMVectorSplatX(plane);
+			splats.Ny[p]   = XMVectorSplatY(plane);
+			splats.Nz[p]   = XMVectorSplatZ(plane);
+			splats.D[p]    = XMVectorSplatW(plane);
+			splats.Ax[p]   = XMVectorAbs(splats.Nx[p]);
+			splats.Ay[p]   = XMVectorAbs(splats.Ny[p]);
+			splats.Az[p]   = XMVectorAbs(splats.Nz[p]);
+		}
+	}
+
+	// One bit per box of the four, set where the box intersects the frustum.
+	inline UINT InsideMask(const PlaneSplats& splats, FXMVECTOR cx, FXMVECTOR cy, FXMVECTOR cz, GXMVECTOR ex, HXMVECTOR ey, HXMVECTOR ez)
+	{
+		// A box is outside a plane when its center is further behind it than its projected radius.
+		XMVECTOR outside = XMVectorFalseInt();
+		for (int p = 0; p < 6; ++p)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(splats.Nx[p], cx, splats.D[p]);
+			distance          = XMVectorMultiplyAdd(splats.Ny[p], cy, distance);
+			distance          = XMVectorMultiplyAdd(splats.Nz[p], cz, distance);
+
+			XMVECTOR radius = XMVectorMultiply(splats.Ax[p], ex);
+			radius          = XMVectorMultiplyAdd(splats.Ay[p], ey, radius);
+			radius          = XMVectorMultiplyAdd(splats.Az[p], ez, radius);
+
+			outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(distance, radius), XMVectorZero()));
+		}
+		return ~BvhUtil::LaneMask(outside) & 0xF;
+	}
+}
+
+FrustumCuller::Frustum FrustumCuller::ExtractPlanes(FXMMATRIX viewProj)
+{
+	// clip = p * viewProj, so column j of viewProj gives clip component j; the rows of the transpose are the columns.
+	XMMATRIX columns = XMMatrixTranspose(viewProj);
+
+	XMVECTOR planes[6] =
+	{
+		XMVectorAdd(columns.r[3], columns.r[0]),      // left:   w + x >= 0
+		XMVectorSubtract(columns.r[3], columns.r[0]), // right:  w - x >= 0
+		XMVectorAdd(columns.r[3], columns.r[1]),      // bottom: w + y >= 0
+		XMVectorSubtract(columns.r[3], columns.r[1]), // top:    w - y >= 0
+		columns.r[2],                                 // near:   z >= 0
+		XMVectorSubtract(columns.r[3], columns.r[2])  // far:    w - z >= 0
+	};
+
+	Frustum frustum;
+	for (int i = 0; i < 6; ++i)
+		XMStoreFloat4(&frustum.Planes[i], XMPlaneNormalize(planes[i]));
+	return frustum;
+}
+
+void FrustumCuller::Clear()
+{
+	mCount = 0;
+	mCenterX.clear();
+	mCenterY.clear();
+	mCenterZ.clear();
+	mExtentX.clear();
+	mExtentY.clear();
+	mExtentZ.clear();
+}
+
+void FrustumCuller::Reserve(UINT count)
+{
+	const size_t padded = (size_t(count) + kBoxesPerIteration - 1) / kBoxesPerIteration * kBoxesPerIteration;
+	for (auto* stream : {&mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ})
+		stream->reserve(padded);
+}
+
+void FrustumCuller::Grow(UINT count)
+{
+	const size_t padded = (size_t(count) + kBoxesPerIteration - 1) / kBoxesPerIteration * kBoxesPerIteration;
+	for (auto* stream : {&mCenterX, &mCenterY, &mCenterZ, &mExtentX, &mExtentY, &mExtentZ})
+		stream->resize(padded, 0.0f);
+	mCount = count;
+}
+
+UINT FrustumCuller::Add(const BoundingBox& box)
+{
+	const UINT index = mCount;
+	Grow(mCount + 1);
+	Set(index, box);
+	return index;
+}
+
+void FrustumCuller::Set(UINT index, const BoundingBox& box)
+{
+	assert(index < mCount);
+	mCenterX[index] = box.Center.x;
+	mCenterY[index] = box.Center.y;
+	mCenterZ[index] = box.Center.z;
+	mExtentX[index] = box.Extents.x;
+	mExtentY[index] = box.Extents.y;
+	mExtentZ[index] = box.Extents.z;
+}
+
+UINT FrustumCuller::Cull(const Frustum& frustum, UINT* visible) const
+{
+	return Cull(frustum, 0, mCount, visible);
+}
+
+UINT FrustumCuller::Cull(const Frustum& frustum, UINT first, UINT last, UINT* visible) const
+{
+	assert(first <= last && last <= mCount);
+
+	PlaneSplats splats;
+	SplatPlanes(frustum, splats);
+
+	UINT visibleCount = 0;
+	for (UINT block = first - first % kBoxesPerIteration; block < last; block += kBoxesPerIteration)
+	{
+		UINT inside = 0;
+
+		// Two groups of four boxes per iteration.
+		for (UINT group = 0; group < kBoxesPerIteration; group += 4)
+		{
+			const UINT i = block + group;
+			inside |= InsideMask(splats,
+			                     LoadStream(mCenterX, i),
+			                     LoadStream(mCenterY, i),
+			                     LoadStream(mCenterZ, i),
+			                     LoadStream(mExtentX, i),
+			                     LoadStream(mExtentY, i),
+			                     LoadStream(mExtentZ, i)) << group;
+		}
+
+		if (block >= first && last - block >= kBoxesPerIteration)
+		{
+			// Branchless compaction: every lane is written, only the visible ones advance the cursor.
+			// Each write lands at or before the slot of its own box, so it stays inside visible[].
+			for (UINT lane = 0; lane < kBoxesPerIteration; ++lane)
+			{
+				visible[visibleCount] = block + lane;
+				visibleCount += (inside >> lane) & 1;
+			}
+		}
+		else
+		{
+			// First or last block of the range: skip the lanes outside [first, last).
+			for (UINT lane = 0; lane < kBoxesPerIteration; ++lane)
+			{
+				const UINT index = block + lane;
+				if (index >= first && index < last && ((inside >> lane) & 1))
+					visible[visibleCount++] = index;
+			}
+		}
+	}
+
+	return visibleCount;
+}
+
+void FrustumCuller::CullViews(const Frustum* frustums, UINT viewCount, uint32_t* viewMasks) const
+{
+	assert(viewCount <= kMaxViews);
+
+	PlaneSplats splats[kMaxViews];
+	for (UINT v = 0; v < viewCount; ++v)
+		SplatPlanes(frustums[v], splats[v]);
+
+	for (UINT i = 0; i < mCount; i += 4)
+	{
+		// Each box is loaded once and tested against every view while it is in registers.
+		const XMVECTOR cx = LoadStream(mCenterX, i);
+		const XMVECTOR cy = LoadStream(mCenterY, i);
+		const XMVECTOR cz = LoadStream(mCenterZ, i);
+		const XMVECTOR ex = LoadStream(mExtentX, i);
+		const XMVECTOR ey = LoadStream(mExtentY, i);
+		const XMVECTOR ez = LoadStream(mExtentZ, i);
+
+		uint32_t masks[4] = {0, 0, 0, 0};
+		for (UINT v = 0; v < viewCount; ++v)
+		{
+			const UINT inside = InsideMask(splats[v], cx, cy, cz, ex, ey, ez);
+			for (UINT lane = 0; lane < 4; ++lane)
+				masks[lane] |= ((inside >> lane) & 1u) << v;
+		}
+
+		for (UINT lane = 0; lane < 4 && i + lane < mCount; ++lane)
+			viewMasks[i + lane] = masks[lane];
+	}
+}
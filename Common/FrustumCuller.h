@@ -0,0 +1,159 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "ParallelFor.h"
+
+/**
+ * \brief Culls world space AABBs against the six planes of a view frustum.
+ * The boxes are stored as structure-of-arrays streams (center x/y/z, extent x/y/z), so one plane test
+ * covers four boxes per vector and the loop handles eight boxes per iteration. Survivors are written
+ * as a compacted list of indices.
+ *
+ * The planes are extracted once per view from the view-projection matrix, which replaces the
+ * per-instance matrix inverse and frustum transform of BoundingFrustum::Transform + Contains.
+ * The test is a plane/box overlap test: it never rejects a visible box, but may keep a few boxes
+ * that lie just outside a frustum corner.
+ */
+class FrustumCuller
+{
+public:
+	// Plane i is (a, b, c, d) with a*x + b*y + c*z + d >= 0 inside; normals have unit length.
+	struct Frustum
+	{
+		DirectX::XMFLOAT4 Planes[6];
+	};
+
+	// Left, right, bottom, top, near and far planes of the clip volume of viewProj (D3D depth 0..1).
+	static Frustum ExtractPlanes(DirectX::FXMMATRIX viewProj);
+
+	void Clear();
+	void Reserve(UINT count);
+
+	// Appends a world space box and returns its index.
+	UINT Add(const DirectX::BoundingBox& box);
+
+	// Replaces box index (e.g. after the object moved).
+	void Set(UINT index, const DirectX::BoundingBox& box);
+
+	UINT Size() const { return mCount; }
+
+	/**
+	 * \brief Writes the indices of the boxes that intersect the frustum, in increasing order.
+	 * \param visible Receives up to Size() indices
+	 * \return the number of visible boxes
+	 */
+	UINT Cull(const Frustum& frustum, UINT* visible) const;
+
+	// Same test for the boxes [first, last); used to split the work across threads.
+	UINT Cull(const Frustum& frustum, UINT first, UINT last, UINT* visible) const;
+
+	static constexpr UINT kMaxViews = 32;
+
+	/**
+	 * \brief Tests every box against viewCount (up to kMaxViews) frustums in a single pass over the boxes.
+	 * Bit v of viewMasks[i] is set when box i intersects frustums[v], so a camera, a shadow map and six cube
+	 * faces cost one walk over the bounds instead of eight.
+	 * \param viewMasks Receives Size() masks
+	 */
+	void CullViews(const Frustum* frustums, UINT viewCount, uint32_t* viewMasks) const;
+
+	// Per-call working memory of CullParallel; keep one around to avoid reallocating every frame.
+	struct ParallelScratch
+	{
+		std::vector<UINT> Indices;     // visible indices of each chunk, at the chunk's own offset
+		std::vector<UINT> ChunkCounts; // visible count of each chunk, then its output offset
+	};
+
+	/**
+	 * \brief Culls every box on up to threadCount threads (0 = one per hardware thread) and calls
+	 * write(slot, index) once per visible box, where slot is its position in the compacted output.
+	 * Chunks of kParallelChunkSize boxes are culled independently.
+	 *
+	 * With deterministic set, the chunks are culled first, their counts prefix summed and the survivors
+	 * written in a second pass, so slots follow box order exactly as Cull would produce them. Otherwise
+	 * each chunk reserves its output range with an atomic bump as soon as it is culled and writes at once,
+	 * which saves the second pass but orders the chunks by completion.
+	 * write is called concurrently for different slots and must not throw.
+	 * \return the number of visible boxes
+	 */
+	template <typename Write>
+	UINT CullParallel(const Frustum&   frustum,
+	                  UINT             threadCount,
+	                  bool             deterministic,
+	                  ParallelScratch& scratch,
+	                  const Write&     write) const;
+
+	static constexpr UINT kParallelChunkSize = 4096;
+
+private:
+	// The streams are padded to a multiple of kBoxesPerIteration so the kernel never needs a scalar tail.
+	static constexpr UINT kBoxesPerIteration = 8;
+
+	void Grow(UINT count);
+
+private:
+	UINT               mCount = 0;
+	std::vector<float> mCenterX;
+	std::vector<float> mCenterY;
+	std::vector<float> mCenterZ;
+	std::vector<float> mExtentX;
+	std::vector<float> mExtentY;
+	std::vector<float> mExtentZ;
+};
+
+template <typename Write>
+UINT FrustumCuller::CullParallel(const Frustum&   frustum,
+                                 UINT             threadCount,
+                                 bool             deterministic,
+                                 ParallelScratch& scratch,
+                                 const Write&     write) const
+{
+	const UINT chunkCount = (mCount + kParallelChunkSize - 1) / kParallelChunkSize;
+	scratch.Indices.resize(mCount);
+	scratch.ChunkCounts.resize(chunkCount);
+
+	if (!deterministic)
+	{
+		std::atomic<UINT> next(0);
+		ParallelFor(chunkCount, threadCount, [&](uint32_t chunk)
+		{
+			const UINT first   = chunk * kParallelChunkSize;
+			const UINT last    = std::min(first + kParallelChunkSize, mCount);
+			UINT*      indices = scratch.Indices.data() + first;
+
+			const UINT count = Cull(frustum, first, last, indices);
+			const UINT base  = next.fetch_add(count, std::memory_order_relaxed);
+			for (UINT i = 0; i < count; ++i)
+				write(base + i, indices[i]);
+		});
+		return next.load();
+	}
+
+	ParallelFor(chunkCount, threadCount, [&](uint32_t chunk)
+	{
+		const UINT first           = chunk * kParallelChunkSize;
+		const UINT last            = std::min(first + kParallelChunkSize, mCount);
+		scratch.ChunkCounts[chunk] = Cull(frustum, first, last, scratch.Indices.data() + first);
+	});
+
+	// Exclusive prefix sum: ChunkCounts[c] becomes the first output slot of chunk c.
+	UINT visibleCount = 0;
+	for (UINT& count : scratch.ChunkCounts)
+	{
+		const UINT chunkVisible = count;
+		count = visibleCount;
+		visibleCount += chunkVisible;
+	}
+
+	ParallelFor(chunkCount, threadCount, [&](uint32_t chunk)
+	{
+		const UINT  first   = chunk * kParallelChunkSize;
+		const UINT  base    = scratch.ChunkCounts[chunk];
+		const UINT  end     = chunk + 1 < chunkCount ? scratch.ChunkCounts[chunk + 1] : visibleCount;
+		const UINT* indices = scratch.Indices.data() + first;
+		for (UINT i = 0; i < end - base; ++i)
+			write(base + i, indices[i]);
+	});
+
+	return visibleCount;
+}
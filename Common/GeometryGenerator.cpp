@@ -1,8 +1,177 @@
 #include "GeometryGenerator.h"
+#include <DirectXPackedVector.h>
 #include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
 
 using namespace DirectX;
 
+namespace
+{
+	/**
+	 * \brief Open addressing table from a mesh edge, keyed by its two vertex indices in either order, to the
+	 * index of the vertex at its midpoint. Sized once for the most edges the triangles can have, so it never grows.
+	 */
+	class EdgeMidpoints
+	{
+	public:
+		explicit EdgeMidpoints(std::uint32_t maxEdges)
+		{
+			// At most three quarters full; a closed mesh has half as many edges as maxEdges.
+			std::uint32_t capacity = 16;
+			while (capacity < maxEdges + maxEdges / 3 + 1)
+				capacity *= 2;
+
+			mMask = capacity - 1;
+			mKeys.assign(capacity, kEmpty);
+			mValues.resize(capacity);
+		}
+
+		// Maps the edge to vertex if it is new and returns true; returns false if the edge is already there.
+		bool Insert(std::uint32_t a, std::uint32_t b, std::uint32_t vertex)
+		{
+			const std::uint64_t key  = Key(a, b);
+			std::uint32_t       slot = Slot(key);
+			for (; mKeys[slot] != kEmpty; slot = (slot + 1) & mMask)
+			{
+				if (mKeys[slot] == key)
+					return false;
+			}
+
+			mKeys[slot]   = key;
+			mValues[slot] = vertex;
+			return true;
+		}
+
+		// Midpoint vertex of an edge already inserted.
+		std::uint32_t Find(std::uint32_t a, std::uint32_t b) const
+		{
+			const std::uint64_t key  = Key(a, b);
+			std::uint32_t       slot = Slot(key);
+			while (mKeys[slot] != key)
+				slot = (slot + 1) & mMask;
+			return mValues[slot];
+		}
+
+	private:
+		static constexpr std::uint64_t kEmpty = ~0ull; // no edge joins vertex 0xffffffff to itself
+
+		static std::uint64_t Key(std::uint32_t a, std::uint32_t b)
+		{
+			return a < b ? (std::uint64_t)a << 32 | b : (std::uint64_t)b << 32 | a;
+		}
+
+		std::uint32_t Slot(std::uint64_t key) const
+		{
+			return (std::uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mMask;
+		}
+
+	private:
+		std::vector<std::uint64_t> mKeys;
+		std::vector<std::uint32_t> mValues;
+		std::uint32_t              mMask;
+	};
+
+	constexpr std::uint64_t EdgeMidpoints::kEmpty;
+
+	/**
+	 * \brief Writes the attributes a VertexLayout asks for, and the indices in order, into MeshBuffers.
+	 * Values are stored with memcpy, so the buffers need no alignment.
+	 */
+	class MeshWriter
+	{
+	public:
+		using Layout = GeometryGenerator::VertexLayout;
+
+		MeshWriter(const GeometryGenerator::MeshBuffers& out, const GeometryGenerator::MeshSize& size)
+			: mOut(out)
+		{
+			assert(out.Vertices != nullptr && out.Indices != nullptr && out.Layout.Position.Type != Layout::None);
+
+			// Checked in every build, before anything is written: a truncated index would silently draw the wrong vertex.
+			if (out.Indices16 && size.VertexCount > 65536)
+				throw std::length_error("16-bit indices cannot reach every vertex; use 32-bit indices");
+		}
+
+		bool HasNormal() const { return mOut.Layout.Normal.Type != Layout::None; }
+		bool HasTangent() const { return mOut.Layout.TangentU.Type != Layout::None; }
+		bool HasTexC() const { return mOut.Layout.TexC.Type != Layout::None; }
+
+		void Position(std::uint32_t v, const XMFLOAT3& p) { Write(v, mOut.Layout.Position, p.x, p.y, p.z, 1.0f); }
+		void Normal(std::uint32_t v, const XMFLOAT3& n) { Write(v, mOut.Layout.Normal, n.x, n.y, n.z, 0.0f); }
+		void TangentU(std::uint32_t v, const XMFLOAT3& t) { Write(v, mOut.Layout.TangentU, t.x, t.y, t.z, 0.0f); }
+		void TexC(std::uint32_t v, float u, float tv) { Write(v, mOut.Layout.TexC, u, tv, 0.0f, 0.0f); }
+
+		// Every attribute of a ready made vertex.
+		void Vertex(std::uint32_t v, const GeometryGenerator::Vertex& vertex)
+		{
+			Position(v, vertex.Position);
+			Normal(v, vertex.Normal);
+			TangentU(v, vertex.TangentU);
+			TexC(v, vertex.TexC.x, vertex.TexC.y);
+		}
+
+		void Triangle(std::uint32_t a, std::uint32_t b, std::uint32_t c)
+		{
+			Index(a);
+			Index(b);
+			Index(c);
+		}
+
+		std::uint32_t IndexCount() const { return mIndexCount; }
+
+	private:
+		void Write(std::uint32_t v, const Layout::Attribute& attribute, float x, float y, float z, float w)
+		{
+			std::uint8_t* dst = static_cast<std::uint8_t*>(mOut.Vertices) + (size_t)v * mOut.Layout.Stride + attribute.Offset;
+			const float   values[4] = {x, y, z, w};
+			switch (attribute.Type)
+			{
+			case Layout::Float2:
+				memcpy(dst, values, 2 * sizeof(float));
+				break;
+			case Layout::Float3:
+				memcpy(dst, values, 3 * sizeof(float));
+				break;
+			case Layout::Float4:
+				memcpy(dst, values, 4 * sizeof(float));
+				break;
+			case Layout::Half2:
+			case Layout::Half4:
+			{
+				const int          count = attribute.Type == Layout::Half2 ? 2 : 4;
+				PackedVector::HALF halves[4];
+				for (int i = 0; i < count; ++i)
+					halves[i] = PackedVector::XMConvertFloatToHalf(values[i]);
+				memcpy(dst, halves, count * sizeof(PackedVector::HALF));
+				break;
+			}
+			case Layout::None:
+				break;
+			}
+		}
+
+		void Index(std::uint32_t index)
+		{
+			if (mOut.Indices16)
+			{
+				assert(index <= 0xffff && "16-bit indices cannot reach every vertex"); // the constructor checked the vertex count
+				const std::uint16_t index16 = static_cast<std::uint16_t>(index);
+				memcpy(static_cast<std::uint16_t*>(mOut.Indices) + mIndexCount++, &index16, sizeof(index16));
+			}
+			else
+			{
+				memcpy(static_cast<std::uint32_t*>(mOut.Indices) + mIndexCount++, &index, sizeof(index));
+			}
+		}
+
+	private:
+		const GeometryGenerator::MeshBuffers& mOut;
+		std::uint32_t                         mIndexCount = 0;
+	};
+}
+
 GeometryGenerator::MeshData GeometryGenerator::CreateBox(float  width,
                                                          float  height,
                                                          float  depth,
@@ -15,46 +184,7 @@ GeometryGenerator::MeshData GeometryGenerator::CreateBox(float  width,
 	//
 
 	Vertex v[24];
-
-	float w2 = 0.5f * width;
-	float h2 = 0.5f * height;
-	float d2 = 0.5f * depth;
-
-	// Fill in the front face vertex data.
-	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[1] = Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[2] = Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[3] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-	// Fill in the back face vertex data.
-	v[4] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[5] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[6] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[7] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the top face vertex data.
-	v[8]  = Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[9]  = Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[10] = Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[11] = Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-	// Fill in the bottom face vertex data.
-	v[12] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[13] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[14] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[15] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the left face vertex data.
-	v[16] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[17] = Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[18] = Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-	v[19] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
-
-	// Fill in the right face vertex data.
-	v[20] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[21] = Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
-	v[22] = Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[23] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+	BoxCorners(width, height, depth, v);
 
 	meshData.Vertices.assign(&v[0], &v[24]);
 
@@ -117,12 +247,60 @@ GeometryGenerator::MeshData GeometryGenerator::CreateBox(float  width,
 	// Put a cap on the number of subdivisions.
 	numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
 
+	// Every face ends up a (2^n + 1) x (2^n + 1) grid of vertices with 2 * 4^n triangles.
+	const uint32 edgeVertices = (1u << numSubdivisions) + 1;
+	meshData.Vertices.reserve(6 * edgeVertices * edgeVertices);
+	meshData.Indices32.reserve(36 << 2 * numSubdivisions);
+
 	for (uint32 i = 0; i < numSubdivisions; ++i)
 		Subdivide(meshData);
 
 	return meshData;
 }
 
+void GeometryGenerator::BoxCorners(float width, float height, float depth, Vertex v[24])
+{
+	float w2 = 0.5f * width;
+	float h2 = 0.5f * height;
+	float d2 = 0.5f * depth;
+
+	// Fill in the front face vertex data.
+	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[1] = Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[2] = Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[3] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+
+	// Fill in the back face vertex data.
+	v[4] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[5] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[6] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[7] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+	// Fill in the top face vertex data.
+	v[8]  = Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[9]  = Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[10] = Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+	v[11] = Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+
+	// Fill in the bottom face vertex data.
+	v[12] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+	v[13] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+	v[14] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
+	v[15] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+
+	// Fill in the left face vertex data.
+	v[16] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
+	v[17] = Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
+	v[18] = Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
+	v[19] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
+
+	// Fill in the right face vertex data.
+	v[20] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
+	v[21] = Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
+	v[22] = Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
+	v[23] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+}
+
 GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount)
 {
 	MeshData meshData;
@@ -236,13 +414,6 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 
 void GeometryGenerator::Subdivide(MeshData& meshData)
 {
-	// Save a copy of the input geometry.
-	MeshData inputCopy = meshData;
-
-
-	meshData.Vertices.resize(0);
-	meshData.Indices32.resize(0);
-
 	//       v1
 	//       *
 	//      / \
@@ -253,47 +424,51 @@ void GeometryGenerator::Subdivide(MeshData& meshData)
 	// *-----*-----*
 	// v0    m2     v2
 
-	uint32 numTris = (uint32)inputCopy.Indices32.size() / 3;
-	for (uint32 i = 0; i < numTris; ++i)
+	const uint32 numTris = (uint32)meshData.Indices32.size() / 3;
+
+	// Triangles sharing an edge share its midpoint: the first one to reach the edge appends the vertex,
+	// the others look it up. The input vertices keep their indices.
+	EdgeMidpoints midpoints(3 * numTris);
+	for (uint32 i = 0; i < 3 * numTris; ++i)
 	{
-		Vertex v0 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 0]];
-		Vertex v1 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 1]];
-		Vertex v2 = inputCopy.Vertices[inputCopy.Indices32[i * 3 + 2]];
-
-		//
-		// Generate the midpoints.
-		//
-
-		Vertex m0 = MidPoint(v0, v1);
-		Vertex m1 = MidPoint(v1, v2);
-		Vertex m2 = MidPoint(v0, v2);
-
-		//
-		// Add new geometry.
-		//
-
-		meshData.Vertices.push_back(v0); // 0
-		meshData.Vertices.push_back(v1); // 1
-		meshData.Vertices.push_back(v2); // 2
-		meshData.Vertices.push_back(m0); // 3
-		meshData.Vertices.push_back(m1); // 4
-		meshData.Vertices.push_back(m2); // 5
-
-		meshData.Indices32.push_back(i * 6 + 0);
-		meshData.Indices32.push_back(i * 6 + 3);
-		meshData.Indices32.push_back(i * 6 + 5);
-
-		meshData.Indices32.push_back(i * 6 + 3);
-		meshData.Indices32.push_back(i * 6 + 4);
-		meshData.Indices32.push_back(i * 6 + 5);
-
-		meshData.Indices32.push_back(i * 6 + 5);
-		meshData.Indices32.push_back(i * 6 + 4);
-		meshData.Indices32.push_back(i * 6 + 2);
-
-		meshData.Indices32.push_back(i * 6 + 3);
-		meshData.Indices32.push_back(i * 6 + 1);
-		meshData.Indices32.push_back(i * 6 + 4);
+		const uint32 a = meshData.Indices32[i];
+		const uint32 b = meshData.Indices32[i % 3 == 2 ? i - 2 : i + 1];
+		if (midpoints.Insert(a, b, (uint32)meshData.Vertices.size()))
+		{
+			Vertex m = MidPoint(meshData.Vertices[a], meshData.Vertices[b]);
+			meshData.Vertices.push_back(m);
+		}
+	}
+
+	// Triangle i becomes triangles 4i..4i+3. Going from the last triangle to the first, the four
+	// never overwrite a triangle that is still to be read.
+	meshData.Indices32.resize(12 * (size_t)numTris);
+	for (uint32 i = numTris; i-- > 0;)
+	{
+		const uint32 v0 = meshData.Indices32[i * 3 + 0];
+		const uint32 v1 = meshData.Indices32[i * 3 + 1];
+		const uint32 v2 = meshData.Indices32[i * 3 + 2];
+
+		const uint32 m0 = midpoints.Find(v0, v1);
+		const uint32 m1 = midpoints.Find(v1, v2);
+		const uint32 m2 = midpoints.Find(v0, v2);
+
+		uint32* out = &meshData.Indices32[i * 12];
+		out[0]  = v0;
+		out[1]  = m0;
+		out[2]  = m2;
+
+		out[3]  = m0;
+		out[4]  = m1;
+		out[5]  = m2;
+
+		out[6]  = m2;
+		out[7]  = m1;
+		out[8]  = v2;
+
+		out[9]  = m0;
+		out[10] = v1;
+		out[11] = m1;
 	}
 }
 
@@ -357,6 +532,11 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
 		10, 1, 6, 11, 0, 9, 2, 11, 9, 5, 2, 9, 11, 2, 7
 	};
 
+	// Every level splits each triangle in four and adds a vertex per edge, so n levels end with
+	// 20 * 4^n triangles and 10 * 4^n + 2 vertices.
+	meshData.Vertices.reserve(10 * (1u << 2 * numSubdivisions) + 2);
+	meshData.Indices32.reserve(60 << 2 * numSubdivisions);
+
 	meshData.Vertices.resize(12);
 	meshData.Indices32.assign(&k[0], &k[60]);
 
@@ -726,3 +906,291 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCycle(uint32 numSubdivision
 
 	return meshData;
 }
+
+GeometryGenerator::MeshSize GeometryGenerator::BoxSize(uint32 numSubdivisions)
+{
+	const uint32 edgeVertices = (1u << std::min<uint32>(numSubdivisions, 6u)) + 1;
+	return {6 * edgeVertices * edgeVertices, 6 * (edgeVertices - 1) * (edgeVertices - 1) * 6};
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::SphereSize(uint32 sliceCount, uint32 stackCount)
+{
+	return {2 + (stackCount - 1) * (sliceCount + 1), 6 * sliceCount * (stackCount - 1)};
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::CylinderSize(uint32 sliceCount, uint32 stackCount)
+{
+	return {(stackCount + 1) * (sliceCount + 1) + 2 * (sliceCount + 2), 6 * sliceCount * stackCount + 6 * sliceCount};
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GridSize(uint32 m, uint32 n)
+{
+	return {m * n, 6 * (m - 1) * (n - 1)};
+}
+
+GeometryGenerator::VertexLayout GeometryGenerator::DefaultLayout()
+{
+	VertexLayout layout;
+	layout.Stride   = sizeof(Vertex);
+	layout.Position = {offsetof(Vertex, Position), VertexLayout::Float3};
+	layout.Normal   = {offsetof(Vertex, Normal), VertexLayout::Float3};
+	layout.TangentU = {offsetof(Vertex, TangentU), VertexLayout::Float3};
+	layout.TexC     = {offsetof(Vertex, TexC), VertexLayout::Float2};
+	return layout;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::CreateBox(float width, float height, float depth, uint32 numSubdivisions, const MeshBuffers& out)
+{
+	const MeshSize size = BoxSize(numSubdivisions);
+	MeshWriter     writer(out, size);
+
+	Vertex v[24];
+	BoxCorners(width, height, depth, v);
+
+	// Each face is a grid between its corners; a corner with texture coordinates (a, b) is grid vertex
+	// (a, b) * (edgeVertices - 1), so the cells take the triangles of the face in the same winding.
+	const uint32 edgeVertices = (1u << std::min<uint32>(numSubdivisions, 6u)) + 1;
+	const float  step         = 1.0f / (edgeVertices - 1);
+	for (uint32 f = 0; f < 6; ++f)
+	{
+		const Vertex* corners = &v[4 * f];
+		XMVECTOR      origin  = XMVectorZero();
+		XMVECTOR      uEdge   = XMVectorZero();
+		XMVECTOR      vEdge   = XMVectorZero();
+		for (uint32 k = 0; k < 4; ++k)
+		{
+			const XMVECTOR p = XMLoadFloat3(&corners[k].Position);
+			if (corners[k].TexC.x == 0.0f && corners[k].TexC.y == 0.0f)
+				origin = p;
+			else if (corners[k].TexC.y == 0.0f)
+				uEdge = p;
+			else if (corners[k].TexC.x == 0.0f)
+				vEdge = p;
+		}
+		uEdge = uEdge - origin;
+		vEdge = vEdge - origin;
+
+		const uint32 base = f * edgeVertices * edgeVertices;
+		for (uint32 row = 0; row < edgeVertices; ++row)
+		{
+			for (uint32 column = 0; column < edgeVertices; ++column)
+			{
+				const uint32 vertex = base + row * edgeVertices + column;
+				const float  tu     = column * step;
+				const float  tv     = row * step;
+
+				XMFLOAT3 position;
+				XMStoreFloat3(&position, origin + tu * uEdge + tv * vEdge);
+				writer.Position(vertex, position);
+				writer.Normal(vertex, corners[0].Normal);
+				writer.TangentU(vertex, corners[0].TangentU);
+				writer.TexC(vertex, tu, tv);
+			}
+		}
+
+		auto gridVertex = [&](const Vertex& corner, uint32 row, uint32 column)
+		{
+			return base + (row + (uint32)corner.TexC.y) * edgeVertices + column + (uint32)corner.TexC.x;
+		};
+		for (uint32 row = 0; row + 1 < edgeVertices; ++row)
+		{
+			for (uint32 column = 0; column + 1 < edgeVertices; ++column)
+			{
+				writer.Triangle(gridVertex(corners[0], row, column), gridVertex(corners[1], row, column), gridVertex(corners[2], row, column));
+				writer.Triangle(gridVertex(corners[0], row, column), gridVertex(corners[2], row, column), gridVertex(corners[3], row, column));
+			}
+		}
+	}
+
+	assert(writer.IndexCount() == size.IndexCount);
+	return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount, const MeshBuffers& out)
+{
+	const MeshSize size = SphereSize(sliceCount, stackCount);
+	MeshWriter     writer(out, size);
+
+	// The same vertices as the MeshData version: the top pole, the rings from the top down, the bottom pole.
+	writer.Vertex(0, Vertex(0.0f, +radius, 0.0f, 0.0f, +1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f));
+
+	const float phiStep   = XM_PI / stackCount;
+	const float thetaStep = 2.0f * XM_PI / sliceCount;
+	uint32      vertex    = 1;
+	for (uint32 i = 1; i <= stackCount - 1; ++i)
+	{
+		const float phi = i * phiStep;
+		for (uint32 j = 0; j <= sliceCount; ++j, ++vertex)
+		{
+			const float theta = j * thetaStep;
+
+			XMFLOAT3 position;
+			position.x = radius * sinf(phi) * cosf(theta);
+			position.y = radius * cosf(phi);
+			position.z = radius * sinf(phi) * sinf(theta);
+			writer.Position(vertex, position);
+
+			if (writer.HasNormal())
+			{
+				XMFLOAT3 normal;
+				XMStoreFloat3(&normal, XMVector3Normalize(XMLoadFloat3(&position)));
+				writer.Normal(vertex, normal);
+			}
+
+			if (writer.HasTangent())
+			{
+				// Partial derivative of P with respect to theta
+				XMFLOAT3 tangent(-radius * sinf(phi) * sinf(theta), 0.0f, +radius * sinf(phi) * cosf(theta));
+				XMStoreFloat3(&tangent, XMVector3Normalize(XMLoadFloat3(&tangent)));
+				writer.TangentU(vertex, tangent);
+			}
+
+			if (writer.HasTexC())
+				writer.TexC(vertex, theta / XM_2PI, phi / XM_PI);
+		}
+	}
+
+	const uint32 southPoleIndex = vertex;
+	writer.Vertex(southPoleIndex, Vertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f));
+
+	// Top stack, inner stacks, bottom stack, as in the MeshData version.
+	for (uint32 i = 1; i <= sliceCount; ++i)
+		writer.Triangle(0, i + 1, i);
+
+	const uint32 baseIndex       = 1;
+	const uint32 ringVertexCount = sliceCount + 1;
+	for (uint32 i = 0; i < stackCount - 2; ++i)
+	{
+		for (uint32 j = 0; j < sliceCount; ++j)
+		{
+			writer.Triangle(baseIndex + i * ringVertexCount + j, baseIndex + i * ringVertexCount + j + 1, baseIndex + (i + 1) * ringVertexCount + j);
+			writer.Triangle(baseIndex + (i + 1) * ringVertexCount + j, baseIndex + i * ringVertexCount + j + 1,
+			                baseIndex + (i + 1) * ringVertexCount + j + 1);
+		}
+	}
+
+	const uint32 lastRing = southPoleIndex - ringVertexCount;
+	for (uint32 i = 0; i < sliceCount; ++i)
+		writer.Triangle(southPoleIndex, lastRing + i, lastRing + i + 1);
+
+	assert(southPoleIndex + 1 == size.VertexCount && writer.IndexCount() == size.IndexCount);
+	return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount,
+                                                              const MeshBuffers& out)
+{
+	const MeshSize size = CylinderSize(sliceCount, stackCount);
+	MeshWriter     writer(out, size);
+
+	// The same vertices as the MeshData version: the rings from the bottom up, then the top and bottom caps.
+	const float  stackHeight     = height / stackCount;
+	const float  radiusStep      = (topRadius - bottomRadius) / stackCount;
+	const float  dTheta          = 2.0f * XM_PI / sliceCount;
+	const uint32 ringVertexCount = sliceCount + 1;
+	uint32       vertex          = 0;
+	for (uint32 i = 0; i <= stackCount; ++i)
+	{
+		const float y = -0.5f * height + i * stackHeight;
+		const float r = bottomRadius + i * radiusStep;
+		for (uint32 j = 0; j <= sliceCount; ++j, ++vertex)
+		{
+			const float c = cosf(j * dTheta);
+			const float s = sinf(j * dTheta);
+
+			writer.Position(vertex, XMFLOAT3(r * c, y, r * s));
+
+			if (writer.HasTexC())
+				writer.TexC(vertex, (float)j / sliceCount, 1.0f - (float)i / stackCount);
+
+			const XMFLOAT3 tangent(-s, 0.0f, c);
+			writer.TangentU(vertex, tangent);
+
+			if (writer.HasNormal())
+			{
+				// N = T x B, with B the derivative along v as derived in the MeshData version.
+				const float    dr = bottomRadius - topRadius;
+				const XMFLOAT3 bitangent(dr * c, -height, dr * s);
+				XMFLOAT3       normal;
+				XMStoreFloat3(&normal, XMVector3Normalize(XMVector3Cross(XMLoadFloat3(&tangent), XMLoadFloat3(&bitangent))));
+				writer.Normal(vertex, normal);
+			}
+		}
+	}
+
+	for (uint32 i = 0; i < stackCount; ++i)
+	{
+		for (uint32 j = 0; j < sliceCount; ++j)
+		{
+			writer.Triangle(i * ringVertexCount + j, (i + 1) * ringVertexCount + j, (i + 1) * ringVertexCount + j + 1);
+			writer.Triangle(i * ringVertexCount + j, (i + 1) * ringVertexCount + j + 1, i * ringVertexCount + j + 1);
+		}
+	}
+
+	// Caps: a ring of their own, for the normals and texture coordinates, around a center vertex.
+	for (int cap = 0; cap < 2; ++cap)
+	{
+		const bool  top    = cap == 0;
+		const float radius = top ? topRadius : bottomRadius;
+		const float y      = top ? 0.5f * height : -0.5f * height;
+		const float ny     = top ? 1.0f : -1.0f;
+
+		const uint32 baseIndex = vertex;
+		for (uint32 i = 0; i <= sliceCount; ++i, ++vertex)
+		{
+			const float x = radius * cosf(i * dTheta);
+			const float z = radius * sinf(i * dTheta);
+			writer.Vertex(vertex, Vertex(x, y, z, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, x / height + 0.5f, z / height + 0.5f));
+		}
+
+		const uint32 centerIndex = vertex++;
+		writer.Vertex(centerIndex, Vertex(0.0f, y, 0.0f, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f));
+
+		for (uint32 i = 0; i < sliceCount; ++i)
+		{
+			if (top)
+				writer.Triangle(centerIndex, baseIndex + i + 1, baseIndex + i);
+			else
+				writer.Triangle(centerIndex, baseIndex + i, baseIndex + i + 1);
+		}
+	}
+
+	assert(vertex == size.VertexCount && writer.IndexCount() == size.IndexCount);
+	return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::CreateGrid(float width, float depth, uint32 m, uint32 n, const MeshBuffers& out)
+{
+	const MeshSize size = GridSize(m, n);
+	MeshWriter     writer(out, size);
+
+	const float halfWidth = 0.5f * width;
+	const float halfDepth = 0.5f * depth;
+	const float dx        = width / (n - 1);
+	const float dz        = depth / (m - 1);
+	const float du        = 1.0f / (n - 1);
+	const float dv        = 1.0f / (m - 1);
+	for (uint32 i = 0; i < m; ++i)
+	{
+		const float z = halfDepth - i * dz;
+		for (uint32 j = 0; j < n; ++j)
+		{
+			const float x = -halfWidth + j * dx;
+			writer.Position(i * n + j, XMFLOAT3(x, 0.0f, z));
+			writer.Normal(i * n + j, XMFLOAT3(0.0f, 1.0f, 0.0f));
+			writer.TangentU(i * n + j, XMFLOAT3(1.0f, 0.0f, 0.0f));
+			writer.TexC(i * n + j, j * du, i * dv);
+		}
+	}
+
+	for (uint32 i = 0; i < m - 1; ++i)
+	{
+		for (uint32 j = 0; j < n - 1; ++j)
+		{
+			writer.Triangle(i * n + j, i * n + j + 1, (i + 1) * n + j);
+			writer.Triangle((i + 1) * n + j, i * n + j + 1, (i + 1) * n + j + 1);
+		}
+	}
+
+	return size;
+}
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <DirectXMath.h>
+#include <stdexcept>
 #include <vector>
 
 /**
@@ -60,8 +61,12 @@ public:
 		std::vector<Vertex> Vertices;
 		std::vector<uint32> Indices32;
 
+		// Only for meshes of at most 65536 vertices; split larger ones with IndexSplitter.
 		std::vector<uint16>& GetIndices16()
 		{
+			// Checked in every build: a truncated index would silently draw the wrong vertex.
+			if (Vertices.size() > 65536)
+				throw std::length_error("16-bit indices cannot reach every vertex; use IndexSplitter");
 			if (mIndices16.empty())
 			{
 				mIndices16.resize(Indices32.size());
@@ -78,6 +83,54 @@ public:
 		std::vector<uint16> mIndices16;
 	};
 
+	/**
+	 * \brief Where the strided Create* overloads write each attribute of a vertex, as the matching
+	 * D3D12_INPUT_ELEMENT_DESC would read it. Attributes left None are neither written nor computed.
+	 */
+	struct VertexLayout
+	{
+		enum Format : std::uint8_t
+		{
+			None,
+			Float2, // DXGI_FORMAT_R32G32_FLOAT
+			Float3, // DXGI_FORMAT_R32G32B32_FLOAT
+			Float4, // DXGI_FORMAT_R32G32B32A32_FLOAT; w is 1 for positions and 0 for directions
+			Half2,  // DXGI_FORMAT_R16G16_FLOAT
+			Half4,  // DXGI_FORMAT_R16G16B16A16_FLOAT; w as for Float4
+		};
+
+		struct Attribute
+		{
+			uint32 Offset = 0; // bytes from the start of the vertex
+			Format Type   = None;
+		};
+
+		uint32    Stride = 0;
+		Attribute Position;
+		Attribute Normal;
+		Attribute TangentU;
+		Attribute TexC;
+	};
+
+	// Vertex and index counts of a mesh, to size the buffers before a strided overload fills them.
+	struct MeshSize
+	{
+		uint32 VertexCount = 0;
+		uint32 IndexCount  = 0;
+	};
+
+	/**
+	 * \brief Caller memory a strided overload writes to, front to back and never read, so it may be a
+	 * mapped upload heap. Indices start from 0 at Vertices; draw with a BaseVertexLocation.
+	 */
+	struct MeshBuffers
+	{
+		VertexLayout Layout;
+		void*        Vertices  = nullptr; // at least VertexCount * Layout.Stride bytes
+		void*        Indices   = nullptr; // at least IndexCount indices
+		bool         Indices16 = false;   // uint16 indices rather than uint32; std::length_error past 65536 vertices
+	};
+
 	/// Creates a box centered at the origin with the given dimensions, where each
     /// face has m rows and n columns of vertices.
 	MeshData CreateBox(float width, float height, float depth, uint32 numSubdivisions);
@@ -106,9 +159,32 @@ public:
 	// create a line strip approximating a circle
 	MeshData CreateCycle(uint32 numSubdivisions, float radius);
 
+	// Sizes of the meshes the Create* functions make with the same tessellation.
+	static MeshSize BoxSize(uint32 numSubdivisions);
+	static MeshSize SphereSize(uint32 sliceCount, uint32 stackCount);
+	static MeshSize CylinderSize(uint32 sliceCount, uint32 stackCount);
+	static MeshSize GridSize(uint32 m, uint32 n);
+
+	// The layout of Vertex, with every attribute.
+	static VertexLayout DefaultLayout();
+
+	/// The same meshes written straight into the buffers of out, with no MeshData in between; they
+	/// return the size written. The sphere, cylinder and grid match their MeshData versions vertex for
+	/// vertex. The subdivided box builds each face as a grid rather than by repeated Subdivide, so it
+	/// covers the same triangles with its vertices in another order.
+	MeshSize CreateBox(float width, float height, float depth, uint32 numSubdivisions, const MeshBuffers& out);
+	MeshSize CreateSphere(float radius, uint32 sliceCount, uint32 stackCount, const MeshBuffers& out);
+	MeshSize CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, const MeshBuffers& out);
+	MeshSize CreateGrid(float width, float depth, uint32 m, uint32 n, const MeshBuffers& out);
+
 private:
+	// Splits every triangle in four, in place. Triangles sharing an edge share the vertex added on it.
 	void   Subdivide(MeshData& meshData);
 	Vertex MidPoint(const Vertex& v0, const Vertex& v1);
 	void   BuildCylinderTopCap(float topRadius, float height, uint32 sliceCount, MeshData& meshData);
 	void   BuildCylinderBottomCap(float bottomRadius, float height, uint32 sliceCount, MeshData& meshData);
+
+	// The four corners of every face of the box, front, back, top, bottom, left and right; the two
+	// triangles of face f are (4f, 4f+1, 4f+2) and (4f, 4f+2, 4f+3).
+	static void BoxCorners(float width, float height, float depth, Vertex v[24]);
 };
@@ -0,0 +1,157 @@
+#include "IndexSplitter.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+constexpr UINT IndexSplitter::kMaxVertices;
+
+namespace
+{
+	// Consecutive vertices [Lo, Hi] of the vertex buffer and the triangles drawn from them.
+	struct Window
+	{
+		uint32_t              Lo;
+		uint32_t              Hi;
+		std::vector<uint32_t> Triangles;
+	};
+}
+
+IndexSplitter::Result IndexSplitter::Split(const uint32_t* indices, UINT indexCount, UINT vertexCount, const XMFLOAT3* positions, UINT stride,
+                                           UINT maxVertices)
+{
+	assert(maxVertices >= 3 && maxVertices <= kMaxVertices);
+
+	const UINT triangleCount = indexCount / 3;
+
+	std::vector<Window>   windows;
+	std::vector<uint32_t> leftOver;
+	for (UINT t = 0; t < triangleCount; ++t)
+	{
+		const uint32_t* tri = &indices[t * 3];
+		const uint32_t  lo  = std::min(std::min(tri[0], tri[1]), tri[2]);
+		const uint32_t  hi  = std::max(std::max(tri[0], tri[1]), tri[2]);
+		if (hi - lo >= maxVertices)
+		{
+			leftOver.push_back(t);
+			continue;
+		}
+
+		// The newest window is the likeliest to be near; older ones catch triangles that come back to them.
+		bool placed = false;
+		for (size_t w = windows.size(); w-- > 0 && !placed;)
+		{
+			Window&        window = windows[w];
+			const uint32_t newLo  = std::min(window.Lo, lo);
+			const uint32_t newHi  = std::max(window.Hi, hi);
+			if (newHi - newLo < maxVertices)
+			{
+				window.Lo = newLo;
+				window.Hi = newHi;
+				window.Triangles.push_back(t);
+				placed = true;
+			}
+		}
+		if (!placed)
+			windows.push_back({lo, hi, {t}});
+	}
+
+	Result result;
+	result.Indices.reserve(indexCount);
+
+	// Bounds of the part just written, whose index i is vertex vertexOf(i) of the original buffer.
+	auto finishPart = [&](SubmeshGeometry& part, const auto& vertexOf)
+	{
+		part.IndexCount = (UINT)result.Indices.size() - part.StartIndexLocation;
+		if (positions != nullptr)
+		{
+			XMVECTOR boxMin = XMVectorReplicate(+FLT_MAX);
+			XMVECTOR boxMax = XMVectorReplicate(-FLT_MAX);
+			for (UINT i = part.StartIndexLocation; i < part.StartIndexLocation + part.IndexCount; ++i)
+			{
+				const uint8_t* position = reinterpret_cast<const uint8_t*>(positions) + (size_t)vertexOf(result.Indices[i]) * stride;
+				const XMVECTOR p        = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(position));
+				boxMin                  = XMVectorMin(boxMin, p);
+				boxMax                  = XMVectorMax(boxMax, p);
+			}
+			BoundingBox::CreateFromPoints(part.Bounds, boxMin, boxMax);
+		}
+		result.Parts.push_back(part);
+	};
+
+	for (const Window& window : windows)
+	{
+		SubmeshGeometry part;
+		part.StartIndexLocation = (UINT)result.Indices.size();
+		part.BaseVertexLocation = (INT)window.Lo;
+		for (uint32_t t : window.Triangles)
+		{
+			for (UINT k = 0; k < 3; ++k)
+				result.Indices.push_back((uint16_t)(indices[t * 3 + k] - window.Lo));
+		}
+		finishPart(part, [&](uint16_t i) { return window.Lo + i; });
+	}
+
+	// Triangles too wide for any window draw from copies of their vertices, up to maxVertices per part.
+	std::vector<uint32_t> copyOf(leftOver.empty() ? 0 : vertexCount, ~0u); // index into ExtraVertices of the newest copy
+	size_t                next = 0;
+	while (next < leftOver.size())
+	{
+		const uint32_t  first = (uint32_t)result.ExtraVertices.size();
+		SubmeshGeometry part;
+		part.StartIndexLocation = (UINT)result.Indices.size();
+		part.BaseVertexLocation = (INT)(vertexCount + first);
+
+		auto inPart = [&](uint32_t v) { return copyOf[v] != ~0u && copyOf[v] >= first; };
+		for (; next < leftOver.size(); ++next)
+		{
+			const uint32_t* tri   = &indices[leftOver[next] * 3];
+			UINT            added = 0;
+			for (UINT k = 0; k < 3; ++k)
+				added += !inPart(tri[k]) && (k < 1 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1]) ? 1 : 0;
+			if (result.ExtraVertices.size() - first + added > maxVertices)
+				break;
+
+			for (UINT k = 0; k < 3; ++k)
+			{
+				if (!inPart(tri[k]))
+				{
+					copyOf[tri[k]] = (uint32_t)result.ExtraVertices.size();
+					result.ExtraVertices.push_back(tri[k]);
+				}
+				result.Indices.push_back((uint16_t)(copyOf[tri[k]] - first));
+			}
+		}
+		finishPart(part, [&](uint16_t i) { return result.ExtraVertices[first + i]; });
+	}
+
+	return result;
+}
+
+IndexSplitter::Result IndexSplitter::Split(GeometryGenerator::MeshData& mesh, UINT maxVertices)
+{
+	const UINT vertexCount = (UINT)mesh.Vertices.size();
+	Result     result      = Split(mesh.Indices32.data(), (UINT)mesh.Indices32.size(), vertexCount,
+	                               vertexCount > 0 ? &mesh.Vertices[0].Position : nullptr, sizeof(GeometryGenerator::Vertex), maxVertices);
+
+	mesh.Vertices.reserve(vertexCount + result.ExtraVertices.size());
+	for (uint32_t v : result.ExtraVertices)
+		mesh.Vertices.push_back(mesh.Vertices[v]);
+	return result;
+}
+
+UINT IndexSplitter::AddDrawArgs(MeshGeometry& geo, const std::string& name, const Result& result, UINT startIndexLocation, INT baseVertexLocation)
+{
+	for (UINT p = 0; p < (UINT)result.Parts.size(); ++p)
+	{
+		SubmeshGeometry part     = result.Parts[p];
+		part.StartIndexLocation += startIndexLocation;
+		part.BaseVertexLocation += baseVertexLocation;
+		geo.DrawArgs[PartName(name, p)] = part;
+	}
+	return (UINT)result.Parts.size();
+}
+
+std::string IndexSplitter::PartName(const std::string& name, UINT part)
+{
+	return part == 0 ? name : name + "_" + std::to_string(part);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+
+/**
+ * \brief Splits an indexed triangle list with more vertices than 16-bit indices reach into parts that
+ * each fit, so large meshes can keep DXGI_FORMAT_R16_UINT index buffers.
+ *
+ * Every part is a window of at most maxVertices consecutive vertices of the original vertex buffer, drawn
+ * with the start of its window as BaseVertexLocation. Parts overlap freely, so the vertices on the
+ * boundary between two parts are shared rather than copied. Triangles go to the newest part whose window
+ * can grow to take them, in input order, and keep that order within their part. Only a triangle whose
+ * own vertices lie further apart than a window is left over; those are gathered into extra parts over
+ * copies of their vertices, appended after the vertex buffer.
+ *
+ * The windows are tight when the vertex buffer is in the order the triangles use it, as after
+ * MeshOptimizer::OptimizeVertexFetch or in the generated grids and spheres; then nothing is copied.
+ */
+class IndexSplitter
+{
+public:
+	static constexpr UINT kMaxVertices = 65536;
+
+	struct Result
+	{
+		std::vector<uint16_t>        Indices;       // every part back to back, relative to its BaseVertexLocation
+		std::vector<SubmeshGeometry> Parts;         // StartIndexLocation into Indices, BaseVertexLocation into the vertex buffer
+		std::vector<uint32_t>        ExtraVertices; // vertices to copy, in this order, after the last vertex of the buffer
+	};
+
+	/**
+	 * \brief Splits indexCount indices into vertexCount vertices.
+	 * \param positions If not null, every part gets the bounding box of its triangles; stride in bytes.
+	 */
+	static Result Split(const uint32_t* indices, UINT indexCount, UINT vertexCount, const DirectX::XMFLOAT3* positions, UINT stride,
+	                    UINT maxVertices = kMaxVertices);
+
+	// Splits a generated mesh and appends its extra vertices to mesh.Vertices.
+	static Result Split(GeometryGenerator::MeshData& mesh, UINT maxVertices = kMaxVertices);
+
+	/**
+	 * \brief Adds the parts to geo->DrawArgs as name, name_1, name_2, ..., offset by where the mesh starts
+	 * in the shared buffers of geo. Returns the number of parts.
+	 */
+	static UINT AddDrawArgs(MeshGeometry& geo, const std::string& name, const Result& result, UINT startIndexLocation, INT baseVertexLocation);
+
+	// DrawArgs name of a part added by AddDrawArgs.
+	static std::string PartName(const std::string& name, UINT part);
+};
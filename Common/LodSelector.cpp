@@ -0,0 +1,56 @@
+#include "LodSelector.h"
+
+using namespace DirectX;
+
+void LodSelector::BeginFrame(FXMVECTOR eyePos, float fovY, float viewportHeight)
+{
+	XMStoreFloat3(&mEyePos, eyePos);
+	mPixelsPerUnit = viewportHeight / (2.0f * tanf(0.5f * fovY));
+	mStats         = Stats();
+}
+
+float LodSelector::ScreenSize(const BoundingSphere& worldSphere) const
+{
+	const float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&worldSphere.Center) - XMLoadFloat3(&mEyePos)));
+	if (distance <= worldSphere.Radius)
+		return FLT_MAX;
+
+	return 2.0f * worldSphere.Radius * mPixelsPerUnit / distance;
+}
+
+bool LodSelector::Select(const LodChain& chain, FXMMATRIX world, LodState& state)
+{
+	assert(!chain.Levels.empty() && chain.Levels.size() == chain.MinScreenSize.size());
+
+	BoundingSphere worldSphere;
+	chain.Bounds.Transform(worldSphere, world);
+	const float size = ScreenSize(worldSphere);
+
+	// Level count means dropped. Thresholds at or below the current level are lowered, the ones above it
+	// raised, so the item stays where it is until its size clearly crosses into another level.
+	const UINT levelCount = (UINT)chain.Levels.size();
+	const UINT current    = state.Visible ? state.Level : levelCount;
+
+	UINT level = 0;
+	while (level < levelCount)
+	{
+		const float bias = level >= current ? 1.0f - Hysteresis : 1.0f + Hysteresis;
+		if (size >= chain.MinScreenSize[level] * bias)
+			break;
+		++level;
+	}
+
+	++mStats.ItemsTested;
+	mStats.TrianglesFull += chain.Levels[0].IndexCount / 3;
+
+	state.Visible = level < levelCount;
+	if (!state.Visible)
+	{
+		++mStats.ItemsCulled;
+		return false;
+	}
+
+	state.Level = level;
+	mStats.TrianglesSubmitted += chain.Levels[level].IndexCount / 3;
+	return true;
+}
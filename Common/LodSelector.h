@@ -0,0 +1,60 @@
+#pragma once
+
+#include "d3dUtil.h"
+
+/**
+ * \brief The levels of detail of one mesh, finest first.
+ * Levels[i] is drawn while the projected diameter of Bounds is at least MinScreenSize[i] pixels. Below the
+ * last threshold the object contributes too little to be worth a draw call and is dropped; a last threshold
+ * of 0 keeps it forever.
+ */
+struct LodChain
+{
+	std::vector<SubmeshGeometry> Levels;
+	std::vector<float>           MinScreenSize; // decreasing, one per level
+	DirectX::BoundingSphere      Bounds;        // local space, encloses every level
+};
+
+// Level chosen for one render item, kept between frames for the hysteresis.
+struct LodState
+{
+	UINT Level   = 0;
+	bool Visible = true;
+};
+
+/**
+ * \brief Picks a level of detail for every render item from the screen size of its bounding sphere.
+ * The size is the projected diameter in pixels at the distance of the sphere from the eye, so it does not
+ * change as the camera turns. Each threshold is widened by Hysteresis around the current level: an item
+ * must shrink below (1 - Hysteresis) * threshold to coarsen and grow past (1 + Hysteresis) * threshold to
+ * refine, which keeps items sitting on a threshold from switching every frame.
+ */
+class LodSelector
+{
+public:
+	struct Stats
+	{
+		UINT   ItemsTested        = 0;
+		UINT   ItemsCulled        = 0;
+		UINT64 TrianglesFull      = 0; // triangles if every item was drawn at its finest level
+		UINT64 TrianglesSubmitted = 0;
+	};
+
+	float Hysteresis = 0.1f;
+
+	// Starts a frame: clears the stats and caches the eye position and the pixels per unit at distance 1.
+	void BeginFrame(DirectX::FXMVECTOR eyePos, float fovY, float viewportHeight);
+
+	// Projected diameter in pixels of a world space sphere; infinite when the eye is inside it.
+	float ScreenSize(const DirectX::BoundingSphere& worldSphere) const;
+
+	// Updates state for chain drawn with world and returns whether the item is drawn this frame.
+	bool Select(const LodChain& chain, DirectX::FXMMATRIX world, LodState& state);
+
+	const Stats& GetStats() const { return mStats; }
+
+private:
+	DirectX::XMFLOAT3 mEyePos        = {0.0f, 0.0f, 0.0f};
+	float             mPixelsPerUnit = 1.0f;
+	Stats             mStats;
+};
@@ -0,0 +1,516 @@
+#include "MeshOptimizer.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+constexpr UINT  MeshOptimizer::kDefaultCacheSize;
+constexpr float MeshOptimizer::kDefaultOverdrawThreshold;
+
+namespace
+{
+	// Triangles around every vertex: those of vertex v are Triangles[Offsets[v]] .. Triangles[Offsets[v + 1] - 1].
+	struct VertexTriangles
+	{
+		std::vector<uint32_t> Offsets;
+		std::vector<uint32_t> Triangles;
+	};
+
+	template <typename Index>
+	void BuildVertexTriangles(const Index* indices, UINT indexCount, UINT vertexCount, VertexTriangles& adjacency)
+	{
+		adjacency.Offsets.assign(vertexCount + 1, 0);
+		for (UINT i = 0; i < indexCount; ++i)
+			++adjacency.Offsets[indices[i] + 1];
+
+		for (UINT v = 0; v < vertexCount; ++v)
+			adjacency.Offsets[v + 1] += adjacency.Offsets[v];
+
+		// Fill with a running cursor per vertex, then shift the cursors back into offsets.
+		adjacency.Triangles.resize(indexCount);
+		for (UINT i = 0; i < indexCount; ++i)
+			adjacency.Triangles[adjacency.Offsets[indices[i]]++] = i / 3;
+
+		for (UINT v = vertexCount; v > 0; --v)
+			adjacency.Offsets[v] = adjacency.Offsets[v - 1];
+		adjacency.Offsets[0] = 0;
+	}
+
+	template <typename Index>
+	MeshOptimizer::CacheStats AnalyzeCache(const Index* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+	{
+		// A FIFO cache as timestamps: a vertex is cached if fewer than cacheSize misses happened since it was loaded.
+		std::vector<uint32_t> loadedAt(vertexCount, 0);
+		std::vector<uint8_t>  referenced(vertexCount, 0);
+		uint32_t              time       = cacheSize + 1;
+		UINT                  vertexUsed = 0;
+
+		MeshOptimizer::CacheStats stats;
+		for (UINT i = 0; i < indexCount; ++i)
+		{
+			const Index v = indices[i];
+			if (time - loadedAt[v] > cacheSize)
+			{
+				loadedAt[v] = time++;
+				++stats.Transforms;
+			}
+
+			vertexUsed    += referenced[v] ? 0 : 1;
+			referenced[v]  = 1;
+		}
+
+		stats.Acmr = indexCount > 0 ? stats.Transforms / (indexCount / 3.0f) : 0.0f;
+		stats.Atvr = vertexUsed > 0 ? stats.Transforms / (float)vertexUsed : 0.0f;
+		return stats;
+	}
+
+	template <typename Index>
+	void Tipsify(Index* dst, const Index* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+	{
+		const UINT triangleCount = indexCount / 3;
+
+		VertexTriangles adjacency;
+		BuildVertexTriangles(indices, triangleCount * 3, vertexCount, adjacency);
+
+		// Triangles not emitted yet around every vertex.
+		std::vector<uint32_t> live(vertexCount);
+		for (UINT v = 0; v < vertexCount; ++v)
+			live[v] = adjacency.Offsets[v + 1] - adjacency.Offsets[v];
+
+		// dst may alias indices, so the result is collected aside.
+		std::vector<Index>    output;
+		std::vector<uint32_t> loadedAt(vertexCount, 0);
+		std::vector<uint8_t>  emitted(triangleCount, 0);
+		std::vector<uint32_t> deadEnds;   // vertices of emitted triangles, the most recent on top
+		std::vector<uint32_t> candidates; // vertices of the triangles emitted by the current fan
+		output.reserve(triangleCount * 3);
+		deadEnds.reserve(triangleCount * 3);
+
+		uint32_t time   = cacheSize + 1;
+		UINT     cursor = 0; // vertices before it have no live triangles left
+		int64_t  fan    = vertexCount > 0 ? 0 : -1;
+
+		while (fan >= 0)
+		{
+			// Emit every remaining triangle around the fan vertex.
+			candidates.clear();
+			for (UINT a = adjacency.Offsets[(size_t)fan]; a < adjacency.Offsets[(size_t)fan + 1]; ++a)
+			{
+				const uint32_t t = adjacency.Triangles[a];
+				if (emitted[t])
+					continue;
+
+				for (UINT k = 0; k < 3; ++k)
+				{
+					const Index v = indices[t * 3 + k];
+					output.push_back(v);
+					deadEnds.push_back(v);
+					candidates.push_back(v);
+					--live[v];
+					if (time - loadedAt[v] > cacheSize)
+						loadedAt[v] = time++;
+				}
+				emitted[t] = 1;
+			}
+
+			// Next fan: the candidate that will still be in the cache once its remaining triangles are
+			// emitted (each can add two vertices) and has been there longest; those about to be evicted are
+			// worth using first.
+			int64_t  next     = -1;
+			uint32_t priority = 0;
+			for (const uint32_t v : candidates)
+			{
+				if (live[v] == 0)
+					continue;
+
+				const uint32_t age = time - loadedAt[v];
+				const uint32_t p   = age + 2 * live[v] <= cacheSize ? age : 0;
+				if (next < 0 || p > priority)
+				{
+					next     = v;
+					priority = p;
+				}
+			}
+
+			// Dead end: back to the most recent vertex with triangles left, or else the first such vertex.
+			while (next < 0 && !deadEnds.empty())
+			{
+				const uint32_t v = deadEnds.back();
+				deadEnds.pop_back();
+				if (live[v] > 0)
+					next = v;
+			}
+
+			for (; next < 0 && cursor < vertexCount; ++cursor)
+			{
+				if (live[cursor] > 0)
+					next = cursor;
+			}
+
+			fan = next;
+		}
+
+		// Exporters sometimes already did better; keep their order then.
+		const UINT before = AnalyzeCache(indices, triangleCount * 3, vertexCount, cacheSize).Transforms;
+		const UINT after  = AnalyzeCache(output.data(), triangleCount * 3, vertexCount, cacheSize).Transforms;
+		if (after < before)
+			std::copy(output.begin(), output.end(), dst);
+		else if (dst != indices)
+			std::copy(indices, indices + triangleCount * 3, dst);
+	}
+
+	inline XMVECTOR LoadPosition(const XMFLOAT3* positions, UINT stride, uint32_t v)
+	{
+		return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + (size_t)v * stride));
+	}
+
+	template <typename Index>
+	void SortClusters(std::vector<Index>& output, const Index* indices, UINT indexCount, const XMFLOAT3* positions, UINT stride,
+	                  UINT vertexCount, float threshold, UINT cacheSize)
+	{
+		const UINT triangleCount = indexCount / 3;
+
+		// FIFO cache as timestamps, as in AnalyzeCache; moving time on by more than the cache size empties it.
+		std::vector<uint32_t> loadedAt(vertexCount, 0);
+		uint32_t              time = cacheSize + 1;
+		auto                  misses = [&](UINT t)
+		{
+			UINT count = 0;
+			for (UINT k = 0; k < 3; ++k)
+			{
+				const Index v = indices[t * 3 + k];
+				if (time - loadedAt[v] > cacheSize)
+				{
+					loadedAt[v] = time++;
+					++count;
+				}
+			}
+			return count;
+		};
+
+		// A triangle that misses on all three vertices starts a new fan: nothing in the cache is reused
+		// there, so the triangles can be cut into runs at no cost.
+		std::vector<UINT> runStarts;
+		for (UINT t = 0; t < triangleCount; ++t)
+		{
+			if (misses(t) == 3)
+				runStarts.push_back(t);
+		}
+		runStarts.push_back(triangleCount);
+
+		// Cut every run further wherever the triangles since the last cut, drawn from an empty cache, are
+		// within threshold of the ACMR of the whole run.
+		std::vector<UINT> clusterStarts;
+		for (size_t r = 0; r + 1 < runStarts.size(); ++r)
+		{
+			const UINT first = runStarts[r];
+			const UINT last  = runStarts[r + 1];
+
+			time += cacheSize + 1;
+			UINT runMisses = 0;
+			for (UINT t = first; t < last; ++t)
+				runMisses += misses(t);
+			const float target = threshold * runMisses / (last - first);
+
+			time += cacheSize + 1;
+			UINT start         = first;
+			UINT clusterMisses = 0;
+			clusterStarts.push_back(first);
+			for (UINT t = first; t < last; ++t)
+			{
+				clusterMisses += misses(t);
+				if (t + 1 < last && clusterMisses <= target * (t + 1 - start))
+				{
+					clusterStarts.push_back(t + 1);
+					start         = t + 1;
+					clusterMisses = 0;
+					time         += cacheSize + 1;
+				}
+			}
+		}
+		clusterStarts.push_back(triangleCount);
+
+		// Area weighted centre and normal of every cluster and of the whole mesh.
+		const UINT            clusterCount = (UINT)clusterStarts.size() - 1;
+		std::vector<XMFLOAT4> centroids(clusterCount);
+		std::vector<XMFLOAT3> normals(clusterCount);
+		XMVECTOR              meshCentroid = XMVectorZero();
+		float                 meshArea     = 0.0f;
+		for (UINT c = 0; c < clusterCount; ++c)
+		{
+			XMVECTOR centroid = XMVectorZero();
+			XMVECTOR normal   = XMVectorZero();
+			float    area     = 0.0f;
+			for (UINT t = clusterStarts[c]; t < clusterStarts[c + 1]; ++t)
+			{
+				const XMVECTOR p0 = LoadPosition(positions, stride, indices[t * 3 + 0]);
+				const XMVECTOR p1 = LoadPosition(positions, stride, indices[t * 3 + 1]);
+				const XMVECTOR p2 = LoadPosition(positions, stride, indices[t * 3 + 2]);
+				const XMVECTOR n  = XMVector3Cross(p1 - p0, p2 - p0);
+				const float    a  = XMVectorGetX(XMVector3Length(n));
+
+				centroid += (a / 3.0f) * (p0 + p1 + p2);
+				normal   += n;
+				area     += a;
+			}
+
+			meshCentroid += centroid;
+			meshArea     += area;
+			XMStoreFloat4(&centroids[c], area > 0.0f ? centroid / area : XMVectorZero());
+			XMStoreFloat3(&normals[c], XMVector3Normalize(normal));
+		}
+		meshCentroid = meshArea > 0.0f ? meshCentroid / meshArea : XMVectorZero();
+
+		// The further out along its own normal a cluster lies, the more of the mesh it hides.
+		std::vector<float> outwardness(clusterCount);
+		std::vector<UINT>  order(clusterCount);
+		for (UINT c = 0; c < clusterCount; ++c)
+		{
+			outwardness[c] = XMVectorGetX(XMVector3Dot(XMLoadFloat4(&centroids[c]) - meshCentroid, XMLoadFloat3(&normals[c])));
+			order[c]       = c;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](UINT a, UINT b) { return outwardness[a] > outwardness[b]; });
+
+		output.clear();
+		output.reserve(triangleCount * 3);
+		for (const UINT c : order)
+			output.insert(output.end(), indices + clusterStarts[c] * 3, indices + clusterStarts[c + 1] * 3);
+	}
+
+	template <typename Index>
+	void OrderForOverdraw(Index* dst, const Index* indices, UINT indexCount, const XMFLOAT3* positions, UINT stride, UINT vertexCount,
+	                      float threshold, UINT cacheSize)
+	{
+		// Clusters start on a cache that still holds the end of some other cluster rather than an empty one,
+		// so the result can miss a little more than the threshold allows. The cut threshold is then halved
+		// towards 1, and the input order is kept if that never fits.
+		const UINT         triangleIndices = indexCount / 3 * 3;
+		const float        limit           = threshold * AnalyzeCache(indices, triangleIndices, vertexCount, cacheSize).Acmr;
+		std::vector<Index> output;
+		float              cut             = threshold;
+		for (UINT attempt = 0; attempt < 4; ++attempt, cut = 1.0f + 0.5f * (cut - 1.0f))
+		{
+			SortClusters(output, indices, triangleIndices, positions, stride, vertexCount, cut, cacheSize);
+			if (AnalyzeCache(output.data(), triangleIndices, vertexCount, cacheSize).Acmr <= limit)
+			{
+				std::copy(output.begin(), output.end(), dst);
+				return;
+			}
+		}
+
+		if (dst != indices)
+			std::copy(indices, indices + triangleIndices, dst);
+	}
+
+	template <typename Index>
+	MeshOptimizer::OverdrawStats MeasureOverdraw(const Index* indices, UINT indexCount, const XMFLOAT3* positions, UINT stride,
+	                                             UINT vertexCount, UINT viewCount, UINT resolution)
+	{
+		MeshOptimizer::OverdrawStats stats;
+		if (indexCount < 3 || vertexCount == 0 || viewCount == 0 || resolution == 0)
+			return stats;
+
+		XMVECTOR boundsMin = LoadPosition(positions, stride, 0);
+		XMVECTOR boundsMax = boundsMin;
+		for (UINT v = 1; v < vertexCount; ++v)
+		{
+			boundsMin = XMVectorMin(boundsMin, LoadPosition(positions, stride, v));
+			boundsMax = XMVectorMax(boundsMax, LoadPosition(positions, stride, v));
+		}
+		const XMVECTOR center = 0.5f * (boundsMin + boundsMax);
+		const float    radius = std::max(0.5f * XMVectorGetX(XMVector3Length(boundsMax - boundsMin)), 1e-6f);
+		const float    scale  = resolution / (2.0f * radius);
+
+		std::vector<XMFLOAT3> screen(vertexCount); // x right and y down in pixels, z along the view direction
+		std::vector<float>    depth((size_t)resolution * resolution);
+
+		for (UINT view = 0; view < viewCount; ++view)
+		{
+			// Directions on a Fibonacci spiral over the sphere.
+			const float    y         = 1.0f - (2.0f * view + 1.0f) / viewCount;
+			const float    ring      = sqrtf(std::max(0.0f, 1.0f - y * y));
+			const float    phi       = 2.39996323f * view;
+			const XMVECTOR direction = XMVectorSet(ring * cosf(phi), y, ring * sinf(phi), 0.0f);
+			const XMVECTOR axis      = fabsf(y) < 0.99f ? XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) : XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+			const XMVECTOR right     = XMVector3Normalize(XMVector3Cross(axis, direction));
+			const XMVECTOR up        = XMVector3Cross(direction, right);
+
+			for (UINT v = 0; v < vertexCount; ++v)
+			{
+				const XMVECTOR p = LoadPosition(positions, stride, v) - center;
+				screen[v].x      = (XMVectorGetX(XMVector3Dot(p, right)) + radius) * scale;
+				screen[v].y      = (radius - XMVectorGetX(XMVector3Dot(p, up))) * scale;
+				screen[v].z      = XMVectorGetX(XMVector3Dot(p, direction));
+			}
+			std::fill(depth.begin(), depth.end(), FLT_MAX);
+
+			for (UINT t = 0; t < indexCount / 3; ++t)
+			{
+				// Back faces are culled, as with the default rasterizer state.
+				const XMVECTOR p0 = LoadPosition(positions, stride, indices[t * 3 + 0]);
+				const XMVECTOR p1 = LoadPosition(positions, stride, indices[t * 3 + 1]);
+				const XMVECTOR p2 = LoadPosition(positions, stride, indices[t * 3 + 2]);
+				if (XMVectorGetX(XMVector3Dot(XMVector3Cross(p1 - p0, p2 - p0), direction)) >= 0.0f)
+					continue;
+
+				const XMFLOAT3* s[3] = {&screen[indices[t * 3 + 0]], &screen[indices[t * 3 + 1]], &screen[indices[t * 3 + 2]]};
+				float           area = (s[1]->x - s[0]->x) * (s[2]->y - s[0]->y) - (s[1]->y - s[0]->y) * (s[2]->x - s[0]->x);
+				if (area == 0.0f)
+					continue;
+				if (area < 0.0f)
+				{
+					std::swap(s[1], s[2]);
+					area = -area;
+				}
+
+				const int x0 = std::max(0, (int)floorf(std::min(std::min(s[0]->x, s[1]->x), s[2]->x)));
+				const int x1 = std::min((int)resolution - 1, (int)ceilf(std::max(std::max(s[0]->x, s[1]->x), s[2]->x)));
+				const int y0 = std::max(0, (int)floorf(std::min(std::min(s[0]->y, s[1]->y), s[2]->y)));
+				const int y1 = std::min((int)resolution - 1, (int)ceilf(std::max(std::max(s[0]->y, s[1]->y), s[2]->y)));
+
+				for (int py = y0; py <= y1; ++py)
+				{
+					for (int px = x0; px <= x1; ++px)
+					{
+						// Edge functions at the pixel centre. A pixel exactly on an edge goes to one of the two
+						// triangles sharing it, whichever walks the edge in the chosen direction, so shared edges
+						// are not counted twice.
+						float w[3];
+						bool  inside = true;
+						for (UINT e = 0; e < 3 && inside; ++e)
+						{
+							const XMFLOAT3& a  = *s[(e + 1) % 3];
+							const XMFLOAT3& b  = *s[(e + 2) % 3];
+							const float     dx = b.x - a.x;
+							const float     dy = b.y - a.y;
+							w[e]               = dx * (py + 0.5f - a.y) - dy * (px + 0.5f - a.x);
+							inside             = w[e] > 0.0f || (w[e] == 0.0f && (dy > 0.0f || (dy == 0.0f && dx < 0.0f)));
+						}
+						if (!inside)
+							continue;
+
+						const float z       = (w[0] * s[0]->z + w[1] * s[1]->z + w[2] * s[2]->z) / area;
+						float&      depthAt = depth[(size_t)py * resolution + px];
+						if (z < depthAt)
+						{
+							depthAt = z;
+							++stats.PixelsShaded;
+						}
+					}
+				}
+			}
+
+			for (const float d : depth)
+				stats.PixelsCovered += d < FLT_MAX ? 1 : 0;
+		}
+
+		stats.Overdraw = stats.PixelsCovered > 0 ? (float)((double)stats.PixelsShaded / stats.PixelsCovered) : 0.0f;
+		return stats;
+	}
+
+	template <typename Index>
+	UINT ReorderVertices(void* vertices, UINT vertexStride, UINT vertexCount, Index* indices, UINT indexCount, std::vector<uint32_t>* remapOut)
+	{
+		std::vector<uint32_t> remap(vertexCount, ~0u);
+		uint32_t              next = 0;
+		for (UINT i = 0; i < indexCount; ++i)
+		{
+			uint32_t& r = remap[indices[i]];
+			if (r == ~0u)
+				r = next++;
+			indices[i] = (Index)r;
+		}
+
+		// One copy of the vertices that are kept, in their new order, then back over the original buffer.
+		uint8_t*             bytes = static_cast<uint8_t*>(vertices);
+		std::vector<uint8_t> reordered((size_t)next * vertexStride);
+		for (UINT v = 0; v < vertexCount; ++v)
+		{
+			if (remap[v] != ~0u)
+				memcpy(&reordered[(size_t)remap[v] * vertexStride], bytes + (size_t)v * vertexStride, vertexStride);
+		}
+		if (next > 0)
+			memcpy(bytes, reordered.data(), reordered.size());
+
+		if (remapOut != nullptr)
+			remapOut->swap(remap);
+		return next;
+	}
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const uint16_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+{
+	return AnalyzeCache(indices, indexCount, vertexCount, cacheSize);
+}
+
+MeshOptimizer::CacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+{
+	return AnalyzeCache(indices, indexCount, vertexCount, cacheSize);
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint16_t* dst, const uint16_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+{
+	Tipsify(dst, indices, indexCount, vertexCount, cacheSize);
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize)
+{
+	Tipsify(dst, indices, indexCount, vertexCount, cacheSize);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint16_t* dst, const uint16_t* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride,
+                                     UINT vertexCount, float threshold, UINT cacheSize)
+{
+	OrderForOverdraw(dst, indices, indexCount, positions, vertexStride, vertexCount, threshold, cacheSize);
+}
+
+void MeshOptimizer::OptimizeOverdraw(uint32_t* dst, const uint32_t* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride,
+                                     UINT vertexCount, float threshold, UINT cacheSize)
+{
+	OrderForOverdraw(dst, indices, indexCount, positions, vertexStride, vertexCount, threshold, cacheSize);
+}
+
+MeshOptimizer::OverdrawStats MeshOptimizer::AnalyzeOverdraw(const uint16_t* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride,
+                                                            UINT vertexCount, UINT viewCount, UINT resolution)
+{
+	return MeasureOverdraw(indices, indexCount, positions, vertexStride, vertexCount, viewCount, resolution);
+}
+
+MeshOptimizer::OverdrawStats MeshOptimizer::AnalyzeOverdraw(const uint32_t* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride,
+                                                            UINT vertexCount, UINT viewCount, UINT resolution)
+{
+	return MeasureOverdraw(indices, indexCount, positions, vertexStride, vertexCount, viewCount, resolution);
+}
+
+UINT MeshOptimizer::OptimizeVertexFetch(void* vertices, UINT vertexStride, UINT vertexCount, uint16_t* indices, UINT indexCount, std::vector<uint32_t>* remap)
+{
+	return ReorderVertices(vertices, vertexStride, vertexCount, indices, indexCount, remap);
+}
+
+UINT MeshOptimizer::OptimizeVertexFetch(void* vertices, UINT vertexStride, UINT vertexCount, uint32_t* indices, UINT indexCount, std::vector<uint32_t>* remap)
+{
+	return ReorderVertices(vertices, vertexStride, vertexCount, indices, indexCount, remap);
+}
+
+MeshOptimizer::Report MeshOptimizer::Optimize(GeometryGenerator::MeshData& mesh, const Options& options)
+{
+	const UINT cacheSize   = options.CacheSize;
+	const UINT indexCount  = (UINT)mesh.Indices32.size();
+	const UINT vertexCount = (UINT)mesh.Vertices.size();
+
+	Report report;
+	report.VertexCountBefore = vertexCount;
+	report.Before            = AnalyzeVertexCache(mesh.Indices32.data(), indexCount, vertexCount, cacheSize);
+
+	OptimizeVertexCache(mesh.Indices32.data(), mesh.Indices32.data(), indexCount, vertexCount, cacheSize);
+	if (options.OverdrawThreshold > 0.0f && vertexCount > 0)
+	{
+		OptimizeOverdraw(mesh.Indices32.data(), mesh.Indices32.data(), indexCount, &mesh.Vertices[0].Position,
+		                 sizeof(GeometryGenerator::Vertex), vertexCount, options.OverdrawThreshold, cacheSize);
+	}
+	report.VertexCountAfter = OptimizeVertexFetch(mesh.Vertices.data(), sizeof(GeometryGenerator::Vertex), vertexCount,
+	                                              mesh.Indices32.data(), indexCount);
+	mesh.Vertices.resize(report.VertexCountAfter);
+
+	report.After = AnalyzeVertexCache(mesh.Indices32.data(), indexCount, report.VertexCountAfter, cacheSize);
+	return report;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+
+/**
+ * \brief Offline reordering of indexed triangle lists, for meshes that are drawn many times.
+ *
+ * OptimizeVertexCache reorders triangles with Tipsify (Sander, Nehab and Barczak, "Fast Triangle
+ * Reordering for Vertex Locality and Reduced Overdraw", 2007): it fans around one vertex at a time and
+ * moves on to the neighbour that is most likely still in the post-transform cache, in linear time.
+ * OptimizeVertexFetch then renumbers vertices in the order the triangles first use them, so the input
+ * assembler reads the vertex buffer front to back, and drops vertices no triangle uses.
+ *
+ * OptimizeOverdraw, also from that paper, is for opaque meshes drawn with early depth rejection. It cuts
+ * the cache ordered triangles into clusters wherever that costs little cache reuse, and draws first the
+ * clusters that face out of the mesh, since those tend to hide the others from most directions.
+ *
+ * AnalyzeVertexCache measures an index buffer against a FIFO cache: ACMR is vertex shader invocations
+ * per triangle (0.5 at best for large regular meshes, 3 at worst) and ATVR invocations per vertex
+ * (1 at best). AnalyzeOverdraw rasterizes the mesh from several directions on the CPU and counts pixels
+ * that pass the depth test per pixel covered.
+ *
+ * Index buffers may be 16 or 32-bit. Vertex buffers are raw bytes with any stride.
+ */
+class MeshOptimizer
+{
+public:
+	// Entries of the post-transform cache assumed by default; most GPUs reuse at least this many.
+	static constexpr UINT kDefaultCacheSize = 16;
+
+	// ACMR OptimizeOverdraw may give up, as a factor: 1.05 lets it grow by 5%.
+	static constexpr float kDefaultOverdrawThreshold = 1.05f;
+
+	struct CacheStats
+	{
+		UINT  Transforms = 0;    // cache misses, that is vertex shader invocations
+		float Acmr       = 0.0f; // transforms per triangle
+		float Atvr       = 0.0f; // transforms per vertex referenced by the triangles
+	};
+
+	struct OverdrawStats
+	{
+		UINT64 PixelsCovered = 0;    // summed over the views
+		UINT64 PixelsShaded  = 0;    // fragments that passed the depth test when drawn
+		float  Overdraw      = 0.0f; // shaded per covered, 1 at best
+	};
+
+	struct Options
+	{
+		UINT  CacheSize         = kDefaultCacheSize;
+		float OverdrawThreshold = 0.0f; // above 0, also orders for overdraw with this threshold; only for opaque meshes
+	};
+
+	struct Report
+	{
+		CacheStats Before;
+		CacheStats After;
+		UINT       VertexCountBefore = 0;
+		UINT       VertexCountAfter  = 0; // vertices no triangle uses are dropped
+	};
+
+	static CacheStats AnalyzeVertexCache(const uint16_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize = kDefaultCacheSize);
+	static CacheStats AnalyzeVertexCache(const uint32_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize = kDefaultCacheSize);
+
+	// Reorders the triangles of indices for the post-transform cache, unless their order already misses the
+	// cache less. dst may be the same buffer as indices.
+	static void OptimizeVertexCache(uint16_t* dst, const uint16_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize = kDefaultCacheSize);
+	static void OptimizeVertexCache(uint32_t* dst, const uint32_t* indices, UINT indexCount, UINT vertexCount, UINT cacheSize = kDefaultCacheSize);
+
+	/**
+	 * \brief Reorders the triangles of a cache optimized index buffer to draw outward facing ones first.
+	 * \param positions Position of the first vertex; consecutive vertices are vertexStride bytes apart.
+	 * \param threshold Clusters are cut where ACMR stays within this factor of the input's. dst may be indices.
+	 */
+	static void OptimizeOverdraw(uint16_t* dst, const uint16_t* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride,
+	                             UINT vertexCount, float threshold = kDefaultOverdrawThreshold, UINT cacheSize = kDefaultCacheSize);
+	static void OptimizeOverdraw(uint32_t* dst, const uint32_t* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride,
+	                             UINT vertexCount, float threshold = kDefaultOverdrawThreshold, UINT cacheSize = kDefaultCacheSize);
+
+	// Draws the mesh back face culled into a resolution x resolution depth buffer from viewCount orthographic
+	// views spread evenly around it.
+	static OverdrawStats AnalyzeOverdraw(const uint16_t* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride,
+	                                     UINT vertexCount, UINT viewCount = 8, UINT resolution = 256);
+	static OverdrawStats AnalyzeOverdraw(const uint32_t* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride,
+	                                     UINT vertexCount, UINT viewCount = 8, UINT resolution = 256);
+
+	/**
+	 * \brief Renumbers vertices by first use in place, in both buffers, and returns how many are left.
+	 * \param remap If not null, receives the new index of every old vertex, or ~0u for dropped ones, so
+	 * other streams of the same mesh can follow.
+	 */
+	static UINT OptimizeVertexFetch(void* vertices, UINT vertexStride, UINT vertexCount, uint16_t* indices, UINT indexCount, std::vector<uint32_t>* remap = nullptr);
+	static UINT OptimizeVertexFetch(void* vertices, UINT vertexStride, UINT vertexCount, uint32_t* indices, UINT indexCount, std::vector<uint32_t>* remap = nullptr);
+
+	// Cache order, then overdraw order if asked for, then fetch order on a generated mesh. Call it before
+	// GetIndices16(), which keeps the copy it makes.
+	static Report Optimize(GeometryGenerator::MeshData& mesh, const Options& options);
+};
@@ -0,0 +1,850 @@
+#include "MeshSimplifier.h"
+#include <cfloat>
+#include <queue>
+
+using namespace DirectX;
+
+namespace
+{
+	// A quadric is 11 floats: A00 A11 A22 A01 A02 A12 of the symmetric matrix, B0 B1 B2, C and the weight W.
+	// It evaluates to p^T A p + 2 B.p + C, the weighted sum of squared distances of p from its planes.
+	const UINT kQuadricSize = 11;
+
+	// Border edges are held in place by a plane through the edge, perpendicular to its triangle, weighted
+	// this many times the squared edge length. Seams are held more loosely; both sides of a seam add theirs.
+	const float kBorderWeight = 10.0f;
+	const float kSeamWeight   = 1.0f;
+
+	void AddPlane(float* q, const XMFLOAT3& n, float d, float w)
+	{
+		q[0]  += w * n.x * n.x;
+		q[1]  += w * n.y * n.y;
+		q[2]  += w * n.z * n.z;
+		q[3]  += w * n.x * n.y;
+		q[4]  += w * n.x * n.z;
+		q[5]  += w * n.y * n.z;
+		q[6]  += w * n.x * d;
+		q[7]  += w * n.y * d;
+		q[8]  += w * n.z * d;
+		q[9]  += w * d * d;
+		q[10] += w;
+	}
+
+	float EvaluateQuadric(const float* q, const XMFLOAT3& p)
+	{
+		return q[0] * p.x * p.x + q[1] * p.y * p.y + q[2] * p.z * p.z +
+		       2.0f * (q[3] * p.x * p.y + q[4] * p.x * p.z + q[5] * p.y * p.z) +
+		       2.0f * (q[6] * p.x + q[7] * p.y + q[8] * p.z) + q[9];
+	}
+
+	enum class VertexKind : uint8_t
+	{
+		Manifold, // interior: moves onto any neighbour
+		Border,   // on one open border: moves along it
+		Seam,     // one of two wedges of a seam: moves along it with its twin
+		Locked
+	};
+
+	/**
+	 * Half-edge collapses over a copy of the index buffer. Run can be called again with a lower target to
+	 * carry on from where the last call stopped.
+	 */
+	class EdgeCollapser
+	{
+	public:
+		EdgeCollapser(const uint32_t* indices, UINT indexCount, const VertexStreams& vertices, const MeshSimplifier::Options& options);
+
+		void Run(UINT targetTriangleCount);
+
+		UINT  LiveTriangles() const { return mLiveTriangles; }
+		float Error() const { return sqrtf(mMaxError) * mExtent; }
+		void  Collect(std::vector<uint32_t>& indices) const;
+
+	private:
+		struct Candidate
+		{
+			float    Cost;
+			uint32_t Vertex;
+			uint32_t Version;
+
+			bool operator>(const Candidate& rhs) const
+			{
+				return Cost > rhs.Cost || (Cost == rhs.Cost && Vertex > rhs.Vertex);
+			}
+		};
+
+		void BuildPositionRings(const VertexStreams& vertices);
+		void BuildTriangleLists();
+		void ClassifyVertices(bool lockBorders, std::vector<uint8_t>& openEdges);
+		void BuildQuadrics(const std::vector<uint8_t>& openEdges);
+
+		bool  HasPositionOpposite(uint32_t a, uint32_t b) const;
+		bool  Flips(uint32_t u, uint32_t v) const;
+		float AttributeError(uint32_t u, uint32_t v) const;
+		float SkinError(uint32_t u, uint32_t v) const;
+
+		void UpdateCandidate(uint32_t u, bool checkFlips);
+		void Consider(uint32_t u, uint32_t v, bool checkFlips, float& bestCost);
+		void Perform(uint32_t u);
+		void Collapse(uint32_t u, uint32_t v);
+		void GatherNeighbours(uint32_t v);
+
+	private:
+		UINT  mVertexCount    = 0;
+		UINT  mAttributeCount = 0; // floats per vertex in mAttributes
+		UINT  mAttributeSize  = 0; // floats per attribute quadric
+		float mExtent         = 1.0f;
+		float mSkinWeight     = 0.0f;
+		float mMaxErrorLimit  = 0.0f; // squared, in unit box units
+		float mMaxError       = 0.0f;
+
+		std::vector<XMFLOAT3> mPositions;  // scaled into a unit box
+		std::vector<float>    mAttributes; // weighted normal and texture coordinates
+		std::vector<float>    mBoneWeights;
+		std::vector<BYTE>     mBoneIndices;
+		std::vector<uint32_t> mPositionOf; // first vertex at the same position
+		std::vector<uint32_t> mNextWedge;  // ring through the vertices at the same position
+
+		std::vector<uint32_t> mTriangles;
+		std::vector<uint8_t>  mDead;
+		UINT                  mLiveTriangles = 0;
+
+		// Triangles around vertex v are mPool[mListFirst[v]] .. mPool[mListFirst[v] + mListCount[v] - 1]; a
+		// collapse appends the merged list and leaves the old ones behind.
+		std::vector<uint32_t> mListFirst;
+		std::vector<uint32_t> mListCount;
+		std::vector<uint32_t> mPool;
+
+		std::vector<VertexKind> mKind;
+		std::vector<uint32_t>   mOpenOutTo;  // the other end of the open edge leaving a border or seam vertex
+		std::vector<uint32_t>   mOpenInFrom; // and of the one arriving
+
+		std::vector<float> mPositionQuadrics;  // per position, indexed by mPositionOf
+		std::vector<float> mAttributeQuadrics; // per vertex
+
+		std::vector<uint8_t>  mRemoved;
+		std::vector<uint32_t> mVersion;
+		std::vector<uint32_t> mTarget;
+		std::vector<uint32_t> mTwinTarget;
+		std::vector<float>    mPositionError; // of the candidate of every vertex
+
+		std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> mQueue;
+
+		std::vector<uint32_t> mStamp;
+		uint32_t              mStampValue = 0;
+		std::vector<uint32_t> mNeighbours;
+	};
+
+	EdgeCollapser::EdgeCollapser(const uint32_t* indices, UINT indexCount, const VertexStreams& vertices,
+	                             const MeshSimplifier::Options& options)
+	{
+		mVertexCount = vertices.VertexCount;
+		BuildPositionRings(vertices);
+
+		mMaxErrorLimit = options.MaxError * options.MaxError;
+
+		mAttributeCount = (vertices.Normals != nullptr ? 3 : 0) + (vertices.TexCoords != nullptr ? 2 : 0);
+		mAttributeSize  = kQuadricSize + 4 * mAttributeCount;
+		mAttributes.resize((size_t)mVertexCount * mAttributeCount);
+		for (UINT v = 0; v < mVertexCount; ++v)
+		{
+			float* a = &mAttributes[(size_t)v * mAttributeCount];
+			if (vertices.Normals != nullptr)
+			{
+				const XMFLOAT3& n = vertices.At(vertices.Normals, v);
+				*a++ = n.x * options.NormalWeight;
+				*a++ = n.y * options.NormalWeight;
+				*a++ = n.z * options.NormalWeight;
+			}
+			if (vertices.TexCoords != nullptr)
+			{
+				const XMFLOAT2& uv = vertices.At(vertices.TexCoords, v);
+				*a++ = uv.x * options.TexCoordWeight;
+				*a++ = uv.y * options.TexCoordWeight;
+			}
+		}
+
+		if (vertices.BoneWeights != nullptr && vertices.BoneIndices != nullptr)
+		{
+			mSkinWeight = options.BoneWeightWeight * options.BoneWeightWeight;
+			mBoneWeights.resize((size_t)mVertexCount * 4);
+			mBoneIndices.resize((size_t)mVertexCount * 4);
+			for (UINT v = 0; v < mVertexCount; ++v)
+			{
+				const XMFLOAT3& w     = vertices.At(vertices.BoneWeights, v);
+				const BYTE*     bones = &vertices.At(vertices.BoneIndices, v);
+				mBoneWeights[v * 4 + 0] = w.x;
+				mBoneWeights[v * 4 + 1] = w.y;
+				mBoneWeights[v * 4 + 2] = w.z;
+				mBoneWeights[v * 4 + 3] = 1.0f - w.x - w.y - w.z;
+				for (UINT i = 0; i < 4; ++i)
+					mBoneIndices[v * 4 + i] = bones[i];
+			}
+		}
+
+		// Triangles with two corners at one position have no area to lose; they go first.
+		mTriangles.assign(indices, indices + indexCount / 3 * 3);
+		mDead.assign(indexCount / 3, 0);
+		for (UINT t = 0; t < indexCount / 3; ++t)
+		{
+			const uint32_t p0 = mPositionOf[mTriangles[t * 3 + 0]];
+			const uint32_t p1 = mPositionOf[mTriangles[t * 3 + 1]];
+			const uint32_t p2 = mPositionOf[mTriangles[t * 3 + 2]];
+			mDead[t]          = p0 == p1 || p0 == p2 || p1 == p2;
+			mLiveTriangles   += mDead[t] ? 0 : 1;
+		}
+
+		std::vector<uint8_t> openEdges;
+		BuildTriangleLists();
+		ClassifyVertices(options.LockBorders, openEdges);
+		BuildQuadrics(openEdges);
+
+		mRemoved.assign(mVertexCount, 0);
+		mVersion.assign(mVertexCount, 0);
+		mTarget.assign(mVertexCount, ~0u);
+		mTwinTarget.assign(mVertexCount, ~0u);
+		mPositionError.assign(mVertexCount, 0.0f);
+		mStamp.assign(mVertexCount, 0);
+		for (UINT v = 0; v < mVertexCount; ++v)
+			UpdateCandidate(v, false);
+	}
+
+	void EdgeCollapser::BuildPositionRings(const VertexStreams& vertices)
+	{
+		mPositions.resize(mVertexCount);
+		XMVECTOR lo = XMVectorReplicate(FLT_MAX);
+		XMVECTOR hi = XMVectorReplicate(-FLT_MAX);
+		for (UINT v = 0; v < mVertexCount; ++v)
+		{
+			mPositions[v] = vertices.At(vertices.Positions, v);
+			lo            = XMVectorMin(lo, XMLoadFloat3(&mPositions[v]));
+			hi            = XMVectorMax(hi, XMLoadFloat3(&mPositions[v]));
+		}
+
+		// Equal positions are found before scaling, so rounding cannot split or join them.
+		UINT tableSize = 1;
+		while (tableSize < mVertexCount * 2)
+			tableSize *= 2;
+
+		std::vector<uint32_t> table(tableSize, ~0u);
+		mPositionOf.resize(mVertexCount);
+		mNextWedge.resize(mVertexCount);
+		for (UINT v = 0; v < mVertexCount; ++v)
+		{
+			// Adding 0 turns -0 into +0, which compares equal.
+			const XMFLOAT3 p(mPositions[v].x + 0.0f, mPositions[v].y + 0.0f, mPositions[v].z + 0.0f);
+			uint32_t       bits[3];
+			memcpy(bits, &p, sizeof(bits));
+
+			uint32_t slot = (bits[0] * 73856093u ^ bits[1] * 19349663u ^ bits[2] * 83492791u) & (tableSize - 1);
+			for (;; slot = (slot + 1) & (tableSize - 1))
+			{
+				const uint32_t other = table[slot];
+				if (other == ~0u)
+				{
+					table[slot]    = v;
+					mPositionOf[v] = v;
+					mNextWedge[v]  = v;
+					break;
+				}
+				if (mPositions[other].x == p.x && mPositions[other].y == p.y && mPositions[other].z == p.z)
+				{
+					mPositionOf[v]    = other;
+					mNextWedge[v]     = mNextWedge[other];
+					mNextWedge[other] = v;
+					break;
+				}
+			}
+		}
+
+		XMFLOAT3 extent;
+		XMStoreFloat3(&extent, hi - lo);
+		mExtent = std::max(extent.x, std::max(extent.y, extent.z));
+		if (!(mExtent > 0.0f))
+			mExtent = 1.0f;
+
+		for (UINT v = 0; v < mVertexCount; ++v)
+			XMStoreFloat3(&mPositions[v], (XMLoadFloat3(&mPositions[v]) - lo) / mExtent);
+	}
+
+	void EdgeCollapser::BuildTriangleLists()
+	{
+		const UINT triangleCount = (UINT)mDead.size();
+
+		mListFirst.assign(mVertexCount + 1, 0);
+		mListCount.assign(mVertexCount, 0);
+		for (UINT t = 0; t < triangleCount; ++t)
+			if (!mDead[t])
+				for (UINT k = 0; k < 3; ++k)
+					++mListCount[mTriangles[t * 3 + k]];
+
+		for (UINT v = 0; v < mVertexCount; ++v)
+			mListFirst[v + 1] = mListFirst[v] + mListCount[v];
+
+		// Room for the lists a collapse appends, about a dozen entries each.
+		mPool.reserve((size_t)mListFirst[mVertexCount] * 3);
+		mPool.resize(mListFirst[mVertexCount]);
+		std::vector<uint32_t> cursor(mListFirst.begin(), mListFirst.end() - 1);
+		for (UINT t = 0; t < triangleCount; ++t)
+			if (!mDead[t])
+				for (UINT k = 0; k < 3; ++k)
+					mPool[cursor[mTriangles[t * 3 + k]]++] = t;
+
+		mListFirst.pop_back();
+	}
+
+	// Whether some triangle has the edge b -> a, between any vertices at the positions of b and a.
+	bool EdgeCollapser::HasPositionOpposite(uint32_t a, uint32_t b) const
+	{
+		uint32_t wedge = b;
+		do
+		{
+			for (uint32_t i = 0; i < mListCount[wedge]; ++i)
+			{
+				const uint32_t t = mPool[mListFirst[wedge] + i];
+				for (UINT k = 0; k < 3; ++k)
+					if (mTriangles[t * 3 + k] == wedge && mPositionOf[mTriangles[t * 3 + (k + 1) % 3]] == mPositionOf[a])
+						return true;
+			}
+			wedge = mNextWedge[wedge];
+		} while (wedge != b);
+		return false;
+	}
+
+	// openEdges receives whether the edge from corner k to corner k + 1 of every triangle is open.
+	void EdgeCollapser::ClassifyVertices(bool lockBorders, std::vector<uint8_t>& openEdges)
+	{
+		// An edge a -> b is open when no triangle has b -> a between the same two vertices.
+		openEdges.assign(mTriangles.size(), 0);
+		std::vector<uint8_t> openOut(mVertexCount, 0);
+		std::vector<uint8_t> openIn(mVertexCount, 0);
+		mOpenOutTo.assign(mVertexCount, ~0u);
+		mOpenInFrom.assign(mVertexCount, ~0u);
+		for (UINT t = 0; t < (UINT)mDead.size(); ++t)
+		{
+			if (mDead[t])
+				continue;
+
+			for (UINT k = 0; k < 3; ++k)
+			{
+				const uint32_t a = mTriangles[t * 3 + k];
+				const uint32_t b = mTriangles[t * 3 + (k + 1) % 3];
+
+				bool opposite = false;
+				for (uint32_t i = 0; i < mListCount[b] && !opposite; ++i)
+				{
+					const uint32_t s = mPool[mListFirst[b] + i];
+					for (UINT j = 0; j < 3; ++j)
+						opposite |= mTriangles[s * 3 + j] == b && mTriangles[s * 3 + (j + 1) % 3] == a;
+				}
+
+				if (!opposite)
+				{
+					openEdges[t * 3 + k] = 1;
+					openOut[a]           = (uint8_t)std::min(openOut[a] + 1, 255);
+					openIn[b]            = (uint8_t)std::min(openIn[b] + 1, 255);
+					mOpenOutTo[a]        = b;
+					mOpenInFrom[b]       = a;
+				}
+			}
+		}
+
+		auto simpleOpen = [&](uint32_t v) { return openOut[v] == 1 && openIn[v] == 1; };
+
+		mKind.assign(mVertexCount, VertexKind::Locked);
+		for (UINT v = 0; v < mVertexCount; ++v)
+		{
+			if (mListCount[v] == 0 || mPositionOf[v] != v)
+				continue;
+
+			const uint32_t twin = mNextWedge[v];
+			if (twin == v)
+			{
+				if (openOut[v] == 0 && openIn[v] == 0)
+					mKind[v] = VertexKind::Manifold;
+				else if (simpleOpen(v) && !lockBorders && !HasPositionOpposite(v, mOpenOutTo[v]) && !HasPositionOpposite(mOpenInFrom[v], v))
+					mKind[v] = VertexKind::Border;
+			}
+			else if (mNextWedge[twin] == v && mListCount[twin] > 0 && simpleOpen(v) && simpleOpen(twin))
+			{
+				// Two wedges whose open edges pair up across the seam: v leaves towards the position twin
+				// arrives from, and the other way round.
+				const bool paired = mPositionOf[mOpenOutTo[v]] == mPositionOf[mOpenInFrom[twin]] &&
+				                    mPositionOf[mOpenInFrom[v]] == mPositionOf[mOpenOutTo[twin]] &&
+				                    HasPositionOpposite(v, mOpenOutTo[v]) && HasPositionOpposite(mOpenInFrom[v], v);
+				if (paired)
+				{
+					mKind[v]    = VertexKind::Seam;
+					mKind[twin] = VertexKind::Seam;
+				}
+			}
+		}
+	}
+
+	void EdgeCollapser::BuildQuadrics(const std::vector<uint8_t>& openEdges)
+	{
+		mPositionQuadrics.assign((size_t)mVertexCount * kQuadricSize, 0.0f);
+		mAttributeQuadrics.assign((size_t)mVertexCount * mAttributeSize, 0.0f);
+
+		std::vector<float> triangleQuadric(mAttributeSize);
+		for (UINT t = 0; t < (UINT)mDead.size(); ++t)
+		{
+			if (mDead[t])
+				continue;
+
+			const uint32_t* tri = &mTriangles[t * 3];
+			const XMVECTOR  p0  = XMLoadFloat3(&mPositions[tri[0]]);
+			const XMVECTOR  e1  = XMLoadFloat3(&mPositions[tri[1]]) - p0;
+			const XMVECTOR  e2  = XMLoadFloat3(&mPositions[tri[2]]) - p0;
+			const float     d00 = XMVectorGetX(XMVector3Dot(e1, e1));
+			const float     d01 = XMVectorGetX(XMVector3Dot(e1, e2));
+			const float     d11 = XMVectorGetX(XMVector3Dot(e2, e2));
+			const float     det = d00 * d11 - d01 * d01; // |e1 x e2|^2
+			if (!(det > 0.0f))
+				continue;
+
+			const float    area   = 0.5f * sqrtf(det);
+			const XMVECTOR normal = XMVector3Normalize(XMVector3Cross(e1, e2));
+			XMFLOAT3       n;
+			XMStoreFloat3(&n, normal);
+			for (UINT k = 0; k < 3; ++k)
+				AddPlane(&mPositionQuadrics[(size_t)mPositionOf[tri[k]] * kQuadricSize], n, -XMVectorGetX(XMVector3Dot(normal, p0)), area);
+
+			// Open edges: a plane through the edge, perpendicular to the triangle.
+			for (UINT k = 0; k < 3; ++k)
+			{
+				const uint32_t a = tri[k];
+				const uint32_t b = tri[(k + 1) % 3];
+				if (!openEdges[t * 3 + k])
+					continue;
+
+				const XMVECTOR pa     = XMLoadFloat3(&mPositions[a]);
+				const XMVECTOR edge   = XMLoadFloat3(&mPositions[b]) - pa;
+				const XMVECTOR across = XMVector3Normalize(XMVector3Cross(edge, normal));
+				const float    weight = XMVectorGetX(XMVector3LengthSq(edge)) * (HasPositionOpposite(a, b) ? kSeamWeight : kBorderWeight);
+				XMFLOAT3       m;
+				XMStoreFloat3(&m, across);
+				AddPlane(&mPositionQuadrics[(size_t)mPositionOf[a] * kQuadricSize], m, -XMVectorGetX(XMVector3Dot(across, pa)), weight);
+				AddPlane(&mPositionQuadrics[(size_t)mPositionOf[b] * kQuadricSize], m, -XMVectorGetX(XMVector3Dot(across, pa)), weight);
+			}
+
+			if (mAttributeCount == 0)
+				continue;
+
+			// Every attribute channel, interpolated linearly over the triangle, is g.p + d with the gradient
+			// g in the plane of the triangle; its error at (p, a) is (g.p + d - a)^2, weighted by area.
+			std::fill(triangleQuadric.begin(), triangleQuadric.end(), 0.0f);
+			float* gradients = &triangleQuadric[kQuadricSize];
+			float* offsets   = gradients + 3 * mAttributeCount;
+			for (UINT c = 0; c < mAttributeCount; ++c)
+			{
+				const float    a0  = mAttributes[(size_t)tri[0] * mAttributeCount + c];
+				const float    da1 = mAttributes[(size_t)tri[1] * mAttributeCount + c] - a0;
+				const float    da2 = mAttributes[(size_t)tri[2] * mAttributeCount + c] - a0;
+				const XMVECTOR g   = ((d11 * da1 - d01 * da2) * e1 + (d00 * da2 - d01 * da1) * e2) / det;
+				const float    d   = a0 - XMVectorGetX(XMVector3Dot(g, p0));
+
+				XMFLOAT3 gradient;
+				XMStoreFloat3(&gradient, g);
+				AddPlane(&triangleQuadric[0], gradient, d, area);
+
+				gradients[c * 3 + 0] = area * gradient.x;
+				gradients[c * 3 + 1] = area * gradient.y;
+				gradients[c * 3 + 2] = area * gradient.z;
+				offsets[c]           = area * d;
+			}
+			triangleQuadric[10] = area; // the weight counts once per triangle, not once per channel
+
+			for (UINT k = 0; k < 3; ++k)
+			{
+				float* q = &mAttributeQuadrics[(size_t)tri[k] * mAttributeSize];
+				for (UINT i = 0; i < mAttributeSize; ++i)
+					q[i] += triangleQuadric[i];
+			}
+		}
+	}
+
+	// Error of the attribute quadric of u at the position and attributes of v.
+	float EdgeCollapser::AttributeError(uint32_t u, uint32_t v) const
+	{
+		if (mAttributeCount == 0)
+			return 0.0f;
+
+		const float* q = &mAttributeQuadrics[(size_t)u * mAttributeSize];
+		if (!(q[10] > 0.0f))
+			return 0.0f;
+
+		const XMFLOAT3& p         = mPositions[v];
+		const float*    a         = &mAttributes[(size_t)v * mAttributeCount];
+		const float*    gradients = q + kQuadricSize;
+		const float*    offsets   = gradients + 3 * mAttributeCount;
+
+		float error = EvaluateQuadric(q, p);
+		for (UINT c = 0; c < mAttributeCount; ++c)
+		{
+			const float interpolated = gradients[c * 3 + 0] * p.x + gradients[c * 3 + 1] * p.y + gradients[c * 3 + 2] * p.z + offsets[c];
+			error += a[c] * (q[10] * a[c] - 2.0f * interpolated);
+		}
+		return std::max(error, 0.0f) / q[10];
+	}
+
+	// Squared difference of the bone weights of u and v, bone by bone.
+	float EdgeCollapser::SkinError(uint32_t u, uint32_t v) const
+	{
+		if (mSkinWeight == 0.0f)
+			return 0.0f;
+
+		BYTE  bones[8];
+		float weights[8];
+		for (UINT i = 0; i < 4; ++i)
+		{
+			bones[i]       = mBoneIndices[u * 4 + i];
+			weights[i]     = mBoneWeights[u * 4 + i];
+			bones[i + 4]   = mBoneIndices[v * 4 + i];
+			weights[i + 4] = -mBoneWeights[v * 4 + i];
+		}
+
+		float error = 0.0f;
+		for (UINT i = 0; i < 8; ++i)
+		{
+			if (weights[i] == 0.0f)
+				continue;
+
+			float difference = weights[i];
+			for (UINT j = i + 1; j < 8; ++j)
+			{
+				if (bones[j] == bones[i])
+				{
+					difference += weights[j];
+					weights[j]  = 0.0f;
+				}
+			}
+			error += difference * difference;
+		}
+		return error * mSkinWeight;
+	}
+
+	// Whether moving u onto v turns a surviving triangle around u over, or nearly so.
+	bool EdgeCollapser::Flips(uint32_t u, uint32_t v) const
+	{
+		const XMVECTOR target = XMLoadFloat3(&mPositions[v]);
+		for (uint32_t i = 0; i < mListCount[u]; ++i)
+		{
+			const uint32_t t = mPool[mListFirst[u] + i];
+			if (mDead[t])
+				continue;
+
+			XMVECTOR before[3];
+			XMVECTOR after[3];
+			bool     dies = false;
+			for (UINT k = 0; k < 3; ++k)
+			{
+				const uint32_t c = mTriangles[t * 3 + k];
+				dies            |= c != u && mPositionOf[c] == mPositionOf[v];
+				before[k]        = XMLoadFloat3(&mPositions[c]);
+				after[k]         = c == u ? target : before[k];
+			}
+			if (dies)
+				continue;
+
+			const XMVECTOR n0 = XMVector3Cross(before[1] - before[0], before[2] - before[0]);
+			const XMVECTOR n1 = XMVector3Cross(after[1] - after[0], after[2] - after[0]);
+			if (XMVectorGetX(XMVector3Dot(n0, n1)) <= 0.25f * XMVectorGetX(XMVector3Length(n0)) * XMVectorGetX(XMVector3Length(n1)))
+				return true;
+		}
+		return false;
+	}
+
+	void EdgeCollapser::Consider(uint32_t u, uint32_t v, bool checkFlips, float& bestCost)
+	{
+		if (v == u || v == ~0u || mRemoved[v])
+			return;
+
+		uint32_t twin       = ~0u;
+		uint32_t twinTarget = ~0u;
+		if (mKind[u] != VertexKind::Manifold)
+		{
+			const VertexKind along = mKind[u];
+			if (mKind[v] != along && mKind[v] != VertexKind::Locked)
+				return;
+
+			// Collapsing a border loop of three would close a hole with a sliver.
+			if (mOpenOutTo[mOpenOutTo[u]] == mOpenInFrom[u])
+				return;
+
+			if (along == VertexKind::Seam)
+			{
+				twin       = mNextWedge[u];
+				twinTarget = v == mOpenOutTo[u] ? mOpenInFrom[twin] : mOpenOutTo[twin];
+				if (twinTarget == ~0u || mRemoved[twinTarget] || mPositionOf[twinTarget] != mPositionOf[v])
+					return;
+			}
+		}
+
+		const float* q             = &mPositionQuadrics[(size_t)mPositionOf[u] * kQuadricSize];
+		const float  positionError = q[10] > 0.0f ? std::max(EvaluateQuadric(q, mPositions[v]), 0.0f) / q[10] : 0.0f;
+		if (positionError >= bestCost)
+			return;
+
+		float cost = positionError + AttributeError(u, v) + SkinError(u, v);
+		if (twin != ~0u)
+			cost += AttributeError(twin, twinTarget) + SkinError(twin, twinTarget);
+
+		if (cost >= bestCost || (checkFlips && (Flips(u, v) || (twin != ~0u && Flips(twin, twinTarget)))))
+			return;
+
+		bestCost           = cost;
+		mTarget[u]         = v;
+		mTwinTarget[u]     = twinTarget;
+		mPositionError[u]  = positionError;
+	}
+
+	// Finds the cheapest collapse of u. Checking for flips is left to Run unless that collapse was already
+	// found to flip, since most candidates never reach the top of the queue.
+	void EdgeCollapser::UpdateCandidate(uint32_t u, bool checkFlips)
+	{
+		++mVersion[u];
+		mTarget[u] = ~0u;
+		if (mRemoved[u] || mKind[u] == VertexKind::Locked)
+			return;
+
+		float bestCost = FLT_MAX;
+		if (mKind[u] == VertexKind::Manifold)
+		{
+			++mStampValue;
+			for (uint32_t i = 0; i < mListCount[u]; ++i)
+			{
+				const uint32_t t = mPool[mListFirst[u] + i];
+				if (mDead[t])
+					continue;
+
+				for (UINT k = 0; k < 3; ++k)
+				{
+					const uint32_t v = mTriangles[t * 3 + k];
+					if (mStamp[v] != mStampValue)
+					{
+						mStamp[v] = mStampValue;
+						Consider(u, v, checkFlips, bestCost);
+					}
+				}
+			}
+		}
+		else
+		{
+			Consider(u, mOpenOutTo[u], checkFlips, bestCost);
+			Consider(u, mOpenInFrom[u], checkFlips, bestCost);
+		}
+
+		if (mTarget[u] != ~0u)
+			mQueue.push({bestCost, u, mVersion[u]});
+	}
+
+	void EdgeCollapser::Collapse(uint32_t u, uint32_t v)
+	{
+		for (uint32_t i = 0; i < mListCount[u]; ++i)
+		{
+			const uint32_t t = mPool[mListFirst[u] + i];
+			if (mDead[t])
+				continue;
+
+			uint32_t* tri = &mTriangles[t * 3];
+			for (UINT k = 0; k < 3; ++k)
+				tri[k] = tri[k] == u ? v : tri[k];
+
+			const uint32_t p0 = mPositionOf[tri[0]];
+			const uint32_t p1 = mPositionOf[tri[1]];
+			const uint32_t p2 = mPositionOf[tri[2]];
+			if (p0 == p1 || p0 == p2 || p1 == p2)
+			{
+				mDead[t] = 1;
+				--mLiveTriangles;
+			}
+		}
+
+		// The triangles of both, less the ones that died, become the list of v.
+		const uint32_t first = (uint32_t)mPool.size();
+		for (uint32_t w : {v, u})
+		{
+			for (uint32_t i = 0; i < mListCount[w]; ++i)
+			{
+				const uint32_t t = mPool[mListFirst[w] + i];
+				if (!mDead[t])
+					mPool.push_back(t);
+			}
+		}
+		mListFirst[v] = first;
+		mListCount[v] = (uint32_t)mPool.size() - first;
+
+		float*       dst = &mAttributeQuadrics[(size_t)v * mAttributeSize];
+		const float* src = &mAttributeQuadrics[(size_t)u * mAttributeSize];
+		for (UINT i = 0; i < mAttributeSize; ++i)
+			dst[i] += src[i];
+
+		// The open edges on both sides of u now meet at v.
+		if (mKind[u] != VertexKind::Manifold)
+		{
+			const uint32_t previous = mOpenInFrom[u];
+			const uint32_t next     = mOpenOutTo[u];
+			mOpenOutTo[previous]    = next;
+			mOpenInFrom[next]       = previous;
+		}
+
+		mRemoved[u] = 1;
+	}
+
+	void EdgeCollapser::GatherNeighbours(uint32_t v)
+	{
+		for (uint32_t i = 0; i < mListCount[v]; ++i)
+		{
+			const uint32_t t = mPool[mListFirst[v] + i];
+			for (UINT k = 0; k < 3; ++k)
+			{
+				const uint32_t c = mTriangles[t * 3 + k];
+				if (mStamp[c] != mStampValue)
+				{
+					mStamp[c] = mStampValue;
+					mNeighbours.push_back(c);
+				}
+			}
+		}
+	}
+
+	void EdgeCollapser::Perform(uint32_t u)
+	{
+		const uint32_t v          = mTarget[u];
+		const uint32_t twin       = mKind[u] == VertexKind::Seam ? mNextWedge[u] : ~0u;
+		const uint32_t twinTarget = mTwinTarget[u];
+
+		// Everything around u and v may have a new best collapse, including vertices whose only triangle
+		// with u dies now.
+		++mStampValue;
+		mNeighbours.clear();
+		GatherNeighbours(u);
+		if (twin != ~0u)
+			GatherNeighbours(twin);
+
+		float*       dst = &mPositionQuadrics[(size_t)mPositionOf[v] * kQuadricSize];
+		const float* src = &mPositionQuadrics[(size_t)mPositionOf[u] * kQuadricSize];
+		for (UINT i = 0; i < kQuadricSize; ++i)
+			dst[i] += src[i];
+
+		mMaxError = std::max(mMaxError, mPositionError[u]);
+		Collapse(u, v);
+		if (twin != ~0u)
+			Collapse(twin, twinTarget);
+
+		GatherNeighbours(v);
+		if (twin != ~0u)
+			GatherNeighbours(twinTarget);
+
+		// UpdateCandidate stamps vertices too, so the list is complete before it runs.
+		for (uint32_t n : mNeighbours)
+			UpdateCandidate(n, false);
+	}
+
+	void EdgeCollapser::Run(UINT targetTriangleCount)
+	{
+		while (mLiveTriangles > targetTriangleCount && !mQueue.empty())
+		{
+			const Candidate candidate = mQueue.top();
+			mQueue.pop();
+
+			const uint32_t u = candidate.Vertex;
+			if (candidate.Version != mVersion[u] || mRemoved[u] || mTarget[u] == ~0u)
+				continue;
+
+			const uint32_t v          = mTarget[u];
+			const uint32_t twinTarget = mTwinTarget[u];
+			if (mRemoved[v] || (twinTarget != ~0u && mRemoved[twinTarget]))
+			{
+				UpdateCandidate(u, false);
+				continue;
+			}
+
+			if (mPositionError[u] > mMaxErrorLimit)
+				continue;
+
+			if (Flips(u, v) || (twinTarget != ~0u && Flips(mNextWedge[u], twinTarget)))
+			{
+				UpdateCandidate(u, true);
+				continue;
+			}
+
+			Perform(u);
+		}
+	}
+
+	void EdgeCollapser::Collect(std::vector<uint32_t>& indices) const
+	{
+		indices.clear();
+		indices.reserve((size_t)mLiveTriangles * 3);
+		for (UINT t = 0; t < (UINT)mDead.size(); ++t)
+			if (!mDead[t])
+				indices.insert(indices.end(), &mTriangles[t * 3], &mTriangles[t * 3] + 3);
+	}
+
+	template <typename Index>
+	UINT SimplifyIndices(Index* dst, const Index* indices, UINT indexCount, const VertexStreams& vertices, UINT targetIndexCount,
+	                     const MeshSimplifier::Options& options, float* error)
+	{
+		const std::vector<uint32_t> input(indices, indices + indexCount);
+		EdgeCollapser               collapser(input.data(), indexCount, vertices, options);
+		collapser.Run(targetIndexCount / 3);
+
+		std::vector<uint32_t> output;
+		collapser.Collect(output);
+		for (size_t i = 0; i < output.size(); ++i)
+			dst[i] = (Index)output[i];
+
+		if (error != nullptr)
+			*error = collapser.Error();
+		return (UINT)output.size();
+	}
+
+	template <typename Index>
+	std::vector<MeshSimplifier::Lod> BuildLods(const Index* indices, UINT indexCount, const VertexStreams& vertices,
+	                                           const std::vector<float>& ratios, const MeshSimplifier::Options& options)
+	{
+		const std::vector<uint32_t> input(indices, indices + indexCount);
+		EdgeCollapser               collapser(input.data(), indexCount, vertices, options);
+
+		std::vector<MeshSimplifier::Lod> lods(ratios.size());
+		for (size_t i = 0; i < ratios.size(); ++i)
+		{
+			collapser.Run((UINT)(ratios[i] * (indexCount / 3)));
+			collapser.Collect(lods[i].Indices);
+			lods[i].Error = collapser.Error();
+		}
+		return lods;
+	}
+}
+
+UINT MeshSimplifier::Simplify(uint16_t* dst, const uint16_t* indices, UINT indexCount, const VertexStreams& vertices, UINT targetIndexCount,
+                              const Options& options, float* error)
+{
+	return SimplifyIndices(dst, indices, indexCount, vertices, targetIndexCount, options, error);
+}
+
+UINT MeshSimplifier::Simplify(uint32_t* dst, const uint32_t* indices, UINT indexCount, const VertexStreams& vertices, UINT targetIndexCount,
+                              const Options& options, float* error)
+{
+	return SimplifyIndices(dst, indices, indexCount, vertices, targetIndexCount, options, error);
+}
+
+std::vector<MeshSimplifier::Lod> MeshSimplifier::BuildLodChain(const uint16_t* indices, UINT indexCount, const VertexStreams& vertices,
+                                                               const std::vector<float>& ratios, const Options& options)
+{
+	return BuildLods(indices, indexCount, vertices, ratios, options);
+}
+
+std::vector<MeshSimplifier::Lod> MeshSimplifier::BuildLodChain(const uint32_t* indices, UINT indexCount, const VertexStreams& vertices,
+                                                               const std::vector<float>& ratios, const Options& options)
+{
+	return BuildLods(indices, indexCount, vertices, ratios, options);
+}
+
+std::vector<MeshSimplifier::Lod> MeshSimplifier::BuildLodChain(const GeometryGenerator::MeshData& mesh, const std::vector<float>& ratios,
+                                                               const Options& options)
+{
+	return BuildLods(mesh.Indices32.data(), (UINT)mesh.Indices32.size(), VertexStreams::Describe(mesh), ratios, options);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+#include "VertexStreams.h"
+
+/**
+ * \brief Offline simplification of indexed triangle lists by edge collapse, to build levels of detail for
+ * meshes that come with only one resolution.
+ *
+ * Every collapse moves a vertex onto one of its neighbours (a half-edge collapse), so the simplified
+ * index buffers reference the original vertex buffer and every level of a LodChain can share it. The
+ * cost of a collapse follows Garland and Heckbert, "Surface Simplification Using Quadric Error Metrics"
+ * (1997): every vertex sums the planes of its triangles, weighted by area, and the collapse pays the mean
+ * squared distance of its new position from them. Attributes add the quadrics of Hoppe, "New Quadric
+ * Metric for Simplifying Meshes with Appearance Attributes" (1999), which measure how far normals and
+ * texture coordinates stray from their linear interpolation over the original triangles. Bone weights
+ * add the squared difference of the weights of both vertices.
+ *
+ * Vertices are classified once by the edges around them. Interior vertices move anywhere. Border vertices
+ * (on an edge with one triangle) move along the border only. Seam vertices, two wedges at one position
+ * with different attributes, move along the seam with their twin. Anything else, such as corners where
+ * seams meet, never moves. Collapses that would turn a triangle over are rejected.
+ *
+ * Candidates sit in a priority queue, cheapest first. A collapse only recomputes the vertices around it;
+ * their older entries stay in the queue and are skipped when popped, since their version no longer matches.
+ *
+ * Index buffers may be 16 or 32-bit. Output triangles keep their input order; run
+ * MeshOptimizer::OptimizeVertexCache on every level afterwards.
+ */
+class MeshSimplifier
+{
+public:
+	// Attribute weights scale the attribute before its error is added to the squared distance, which is
+	// measured on the mesh scaled to a unit box.
+	struct Options
+	{
+		float NormalWeight     = 0.02f;
+		float TexCoordWeight   = 0.1f;
+		float BoneWeightWeight = 0.1f;
+		float MaxError         = 0.02f; // fraction of the largest side of the bounds no collapse may move the surface by, as estimated
+		bool  LockBorders      = false; // keep open borders where they are, for meshes that are tiled or stitched
+	};
+
+	struct Lod
+	{
+		std::vector<uint32_t> Indices; // into the vertex buffer given to the simplifier
+		float                 Error;   // largest distance from the original surface, in mesh units, as estimated by the quadrics
+	};
+
+	/**
+	 * \brief Collapses edges until at most targetIndexCount indices are left, or nothing cheaper than
+	 * options.MaxError can go, and returns how many indices are left. dst may be indices.
+	 * \param vertices Only Positions is required; Normals, TexCoords and BoneWeights with BoneIndices add to the error.
+	 * \param error If not null, receives the largest distance from the original surface.
+	 */
+	static UINT Simplify(uint16_t* dst, const uint16_t* indices, UINT indexCount, const VertexStreams& vertices, UINT targetIndexCount,
+	                     const Options& options, float* error = nullptr);
+	static UINT Simplify(uint32_t* dst, const uint32_t* indices, UINT indexCount, const VertexStreams& vertices, UINT targetIndexCount,
+	                     const Options& options, float* error = nullptr);
+
+	/**
+	 * \brief Simplifies once and keeps a level every time the triangle count reaches the next ratio of the
+	 * input's, so later levels pay for one run only and their errors are measured against the original.
+	 * \param ratios Decreasing, for example {0.5f, 0.25f, 0.125f}. A level the simplifier cannot reach gets
+	 * the coarsest result instead.
+	 */
+	static std::vector<Lod> BuildLodChain(const uint16_t* indices, UINT indexCount, const VertexStreams& vertices, const std::vector<float>& ratios,
+	                                      const Options& options);
+	static std::vector<Lod> BuildLodChain(const uint32_t* indices, UINT indexCount, const VertexStreams& vertices, const std::vector<float>& ratios,
+	                                      const Options& options);
+	static std::vector<Lod> BuildLodChain(const GeometryGenerator::MeshData& mesh, const std::vector<float>& ratios, const Options& options);
+};
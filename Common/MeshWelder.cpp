@@ -0,0 +1,210 @@
+#include "MeshWelder.h"
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	const float* AttributeOf(const uint8_t* vertices, UINT vertexStride, uint32_t v, const MeshWelder::Attribute& attribute)
+	{
+		return reinterpret_cast<const float*>(vertices + (size_t)v * vertexStride + attribute.Offset);
+	}
+
+	// Grid cell of a position component: the float bits when welding equal values only, otherwise its
+	// cell of twice the epsilon. Returns the fraction of the way across the cell through fraction.
+	int32_t CellOf(float x, float epsilon, float& fraction)
+	{
+		fraction = 0.5f;
+		if (epsilon <= 0.0f)
+		{
+			int32_t bits;
+			x = x == 0.0f ? 0.0f : x; // -0 and +0 are equal
+			memcpy(&bits, &x, sizeof(bits));
+			return bits;
+		}
+
+		const double cell = std::floor(x / (2.0 * epsilon));
+		fraction          = (float)(x / (2.0 * epsilon) - cell);
+		return (int32_t)std::max(std::min(cell, 2147483647.0), -2147483648.0);
+	}
+
+	uint32_t HashCell(const int32_t cell[3])
+	{
+		return ((uint32_t)cell[0] * 73856093u) ^ ((uint32_t)cell[1] * 19349663u) ^ ((uint32_t)cell[2] * 83492791u);
+	}
+}
+
+UINT MeshWelder::GenerateRemap(std::vector<uint32_t>& remap, const void* vertices, UINT vertexStride, UINT vertexCount,
+                               const std::vector<Attribute>& attributes)
+{
+	assert(!attributes.empty() && attributes[0].Components == 3);
+
+	const uint8_t*   bytes    = static_cast<const uint8_t*>(vertices);
+	const Attribute& position = attributes[0];
+
+	// Linear probing over a power of two at least twice the vertex count keeps the probes short.
+	UINT capacity = 1;
+	while (capacity < vertexCount * 2)
+		capacity *= 2;
+	const uint32_t        mask = capacity - 1;
+	std::vector<uint32_t> table(capacity, ~0u); // kept vertices, by the hash of their cell
+	std::vector<int32_t>  cells((size_t)vertexCount * 3);
+
+	auto matches = [&](uint32_t a, uint32_t b)
+	{
+		for (const Attribute& attribute : attributes)
+		{
+			const float* x = AttributeOf(bytes, vertexStride, a, attribute);
+			const float* y = AttributeOf(bytes, vertexStride, b, attribute);
+			for (UINT c = 0; c < attribute.Components; ++c)
+			{
+				if (!(std::fabs(x[c] - y[c]) <= attribute.Epsilon))
+					return false;
+			}
+		}
+		return true;
+	};
+
+	remap.assign(vertexCount, ~0u);
+	UINT weldedCount = 0;
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		const float* p    = AttributeOf(bytes, vertexStride, v, position);
+		int32_t*     cell = &cells[(size_t)v * 3];
+		int32_t      step[3];
+		for (UINT c = 0; c < 3; ++c)
+		{
+			float fraction;
+			cell[c] = CellOf(p[c], position.Epsilon, fraction);
+			step[c] = position.Epsilon <= 0.0f ? 0 : fraction < 0.5f ? -1 : +1;
+		}
+
+		// A position within the epsilon lies in this cell or in a neighbour on the near side of each axis.
+		// Kept vertices of a cell lie along its probe sequence in vertex order, so the first match in a cell is
+		// its lowest; the lowest over every cell is the first kept vertex that matches.
+		uint32_t found = ~0u;
+		for (UINT n = 0; n < 8; ++n)
+		{
+			if (((n & 1) && step[0] == 0) || ((n & 2) && step[1] == 0) || ((n & 4) && step[2] == 0))
+				continue;
+
+			const int32_t neighbour[3] = {cell[0] + ((n & 1) ? step[0] : 0), cell[1] + ((n & 2) ? step[1] : 0), cell[2] + ((n & 4) ? step[2] : 0)};
+			for (uint32_t slot = HashCell(neighbour) & mask; table[slot] != ~0u; slot = (slot + 1) & mask)
+			{
+				const uint32_t u     = table[slot];
+				const int32_t* other = &cells[(size_t)u * 3];
+				if (u < found && other[0] == neighbour[0] && other[1] == neighbour[1] && other[2] == neighbour[2] && matches(u, v))
+				{
+					found = u;
+					break;
+				}
+			}
+		}
+
+		if (found != ~0u)
+		{
+			remap[v] = remap[found];
+			continue;
+		}
+
+		uint32_t slot = HashCell(cell) & mask;
+		while (table[slot] != ~0u)
+			slot = (slot + 1) & mask;
+		table[slot] = v;
+		remap[v]    = weldedCount++;
+	}
+	return weldedCount;
+}
+
+void MeshWelder::RemapVertices(void* dst, const void* src, UINT vertexStride, UINT vertexCount, const std::vector<uint32_t>& remap)
+{
+	// Welded indices grow in vertex order and never pass the old index, so copying forward is safe in place.
+	uint8_t*       to   = static_cast<uint8_t*>(dst);
+	const uint8_t* from = static_cast<const uint8_t*>(src);
+	uint32_t       next = 0;
+	for (uint32_t v = 0; v < vertexCount; ++v)
+	{
+		if (remap[v] != next)
+			continue;
+		if (to != from || next != v)
+			memmove(to + (size_t)next * vertexStride, from + (size_t)v * vertexStride, vertexStride);
+		++next;
+	}
+}
+
+template <typename Index>
+MeshWelder::Report MeshWelder::WeldVertices(void* vertices, UINT vertexStride, UINT vertexCount, Index* indices, UINT indexCount, const Options& options,
+                                            std::vector<uint32_t>* remap)
+{
+	Report report;
+	report.VertexCountBefore   = vertexCount;
+	report.TriangleCountBefore = indexCount / 3;
+
+	std::vector<uint32_t>  ownRemap;
+	std::vector<uint32_t>& table = remap != nullptr ? *remap : ownRemap;
+	report.VertexCountAfter      = GenerateRemap(table, vertices, vertexStride, vertexCount, options.Attributes);
+	RemapVertices(vertices, vertices, vertexStride, vertexCount, table);
+
+	const uint8_t*   bytes    = static_cast<const uint8_t*>(vertices);
+	const Attribute& position = options.Attributes[0];
+	UINT             kept     = 0;
+	for (UINT i = 0; i + 2 < indexCount; i += 3)
+	{
+		const uint32_t a = table[indices[i]];
+		const uint32_t b = table[indices[i + 1]];
+		const uint32_t c = table[indices[i + 2]];
+		if (options.RemoveDegenerates)
+		{
+			if (a == b || b == c || c == a)
+				continue;
+
+			const XMVECTOR pa   = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(AttributeOf(bytes, vertexStride, a, position)));
+			const XMVECTOR pb   = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(AttributeOf(bytes, vertexStride, b, position)));
+			const XMVECTOR pc   = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(AttributeOf(bytes, vertexStride, c, position)));
+			const XMVECTOR area = XMVector3LengthSq(XMVector3Cross(pb - pa, pc - pa));
+			if (XMVectorGetX(area) == 0.0f)
+				continue;
+		}
+		indices[kept++] = (Index)a;
+		indices[kept++] = (Index)b;
+		indices[kept++] = (Index)c;
+	}
+	report.TriangleCountAfter = kept / 3;
+	return report;
+}
+
+MeshWelder::Report MeshWelder::Weld(void* vertices, UINT vertexStride, UINT vertexCount, uint16_t* indices, UINT indexCount, const Options& options,
+                                    std::vector<uint32_t>* remap)
+{
+	return WeldVertices(vertices, vertexStride, vertexCount, indices, indexCount, options, remap);
+}
+
+MeshWelder::Report MeshWelder::Weld(void* vertices, UINT vertexStride, UINT vertexCount, uint32_t* indices, UINT indexCount, const Options& options,
+                                    std::vector<uint32_t>* remap)
+{
+	return WeldVertices(vertices, vertexStride, vertexCount, indices, indexCount, options, remap);
+}
+
+MeshWelder::Report MeshWelder::Weld(GeometryGenerator::MeshData& mesh, const Options& options)
+{
+	Options meshOptions = options;
+	if (meshOptions.Attributes.empty())
+		meshOptions.Attributes = VertexAttributes(0.0f, 0.0f, 0.0f);
+
+	const Report report = Weld(mesh.Vertices.data(), sizeof(GeometryGenerator::Vertex), (UINT)mesh.Vertices.size(), mesh.Indices32.data(),
+	                           (UINT)mesh.Indices32.size(), meshOptions);
+	mesh.Vertices.resize(report.VertexCountAfter);
+	mesh.Indices32.resize(report.TriangleCountAfter * 3);
+	return report;
+}
+
+std::vector<MeshWelder::Attribute> MeshWelder::VertexAttributes(float positionEpsilon, float normalEpsilon, float texCoordEpsilon)
+{
+	return {
+		{offsetof(GeometryGenerator::Vertex, Position), 3, positionEpsilon},
+		{offsetof(GeometryGenerator::Vertex, Normal), 3, normalEpsilon},
+		{offsetof(GeometryGenerator::Vertex, TangentU), 3, normalEpsilon},
+		{offsetof(GeometryGenerator::Vertex, TexC), 2, texCoordEpsilon},
+	};
+}
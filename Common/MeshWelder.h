@@ -0,0 +1,76 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+
+/**
+ * \brief Merges duplicate vertices of an indexed triangle list, for meshes loaded from files or generated
+ * with a vertex per face corner.
+ *
+ * Vertices weld when every listed attribute matches within its epsilon; bytes outside the attributes are
+ * ignored. The first attribute is the position. Vertices are hashed by the cell of a grid over their
+ * positions into a flat open addressing table, so welding takes linear time. With a position epsilon the
+ * cells are twice the epsilon wide, and each vertex also searches the neighbouring cells on the sides it
+ * is closest to, which holds every position within the epsilon. Epsilon welding is not transitive: a
+ * vertex welds into the first kept vertex it matches, in vertex order.
+ *
+ * Welded vertices are numbered in the order of their first occurrence, so the vertex buffer compacts in
+ * place, and the remap table lets other streams of the same mesh follow. Welding can turn triangles
+ * degenerate; RemoveDegenerates drops those along with any of zero area.
+ *
+ * Index buffers may be 16 or 32-bit. Vertex buffers are raw bytes with any stride.
+ */
+class MeshWelder
+{
+public:
+	// One float attribute of every vertex.
+	struct Attribute
+	{
+		UINT  Offset     = 0;    // bytes from the start of the vertex
+		UINT  Components = 3;    // 1 to 4 floats
+		float Epsilon    = 0.0f; // largest difference per component that still welds; 0 welds equal values only
+	};
+
+	struct Options
+	{
+		std::vector<Attribute> Attributes;                // the first is a float3 position
+		bool                   RemoveDegenerates = false; // drop triangles that weld two corners together or have no area
+	};
+
+	struct Report
+	{
+		UINT VertexCountBefore   = 0;
+		UINT VertexCountAfter    = 0;
+		UINT TriangleCountBefore = 0;
+		UINT TriangleCountAfter  = 0;
+	};
+
+	/**
+	 * \brief Fills remap with the welded index of every vertex and returns how many welded vertices there are.
+	 */
+	static UINT GenerateRemap(std::vector<uint32_t>& remap, const void* vertices, UINT vertexStride, UINT vertexCount,
+	                          const std::vector<Attribute>& attributes);
+
+	// Keeps the first vertex of every welded group: dst[remap[v]] = src[v]. dst may be src.
+	static void RemapVertices(void* dst, const void* src, UINT vertexStride, UINT vertexCount, const std::vector<uint32_t>& remap);
+
+	/**
+	 * \brief Welds in place, in both buffers, and returns the counts before and after.
+	 * \param remap If not null, receives the welded index of every old vertex.
+	 */
+	static Report Weld(void* vertices, UINT vertexStride, UINT vertexCount, uint16_t* indices, UINT indexCount, const Options& options,
+	                   std::vector<uint32_t>* remap = nullptr);
+	static Report Weld(void* vertices, UINT vertexStride, UINT vertexCount, uint32_t* indices, UINT indexCount, const Options& options,
+	                   std::vector<uint32_t>* remap = nullptr);
+
+	// Welds a generated mesh; with no attributes in options, every member of the vertex must be equal.
+	static Report Weld(GeometryGenerator::MeshData& mesh, const Options& options);
+
+	// The members of GeometryGenerator::Vertex with the given epsilons.
+	static std::vector<Attribute> VertexAttributes(float positionEpsilon, float normalEpsilon, float texCoordEpsilon);
+
+private:
+	template <typename Index>
+	static Report WeldVertices(void* vertices, UINT vertexStride, UINT vertexCount, Index* indices, UINT indexCount, const Options& options,
+	                           std::vector<uint32_t>* remap);
+};
@@ -0,0 +1,286 @@
+#include "MeshletMesh.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+constexpr UINT MeshletMesh::kMaxVertices;
+constexpr UINT MeshletMesh::kMaxTriangles;
+
+namespace
+{
+	inline const XMFLOAT3& PositionAt(const XMFLOAT3* positions, UINT stride, uint32_t v)
+	{
+		return *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + (size_t)v * stride);
+	}
+}
+
+void MeshletMesh::Build(const uint16_t* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride, UINT vertexCount,
+                        UINT maxVertices, UINT maxTriangles)
+{
+	BuildMeshlets(indices, indexCount, positions, vertexStride, vertexCount, maxVertices, maxTriangles);
+}
+
+void MeshletMesh::Build(const uint32_t* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride, UINT vertexCount,
+                        UINT maxVertices, UINT maxTriangles)
+{
+	BuildMeshlets(indices, indexCount, positions, vertexStride, vertexCount, maxVertices, maxTriangles);
+}
+
+void MeshletMesh::Build(const GeometryGenerator::MeshData& mesh, UINT maxVertices, UINT maxTriangles)
+{
+	const XMFLOAT3* positions = mesh.Vertices.empty() ? nullptr : &mesh.Vertices[0].Position;
+	BuildMeshlets(mesh.Indices32.data(), (UINT)mesh.Indices32.size(), positions, sizeof(GeometryGenerator::Vertex),
+	              (UINT)mesh.Vertices.size(), maxVertices, maxTriangles);
+}
+
+template <typename Index>
+void MeshletMesh::BuildMeshlets(const Index* indices, UINT indexCount, const XMFLOAT3* positions, UINT vertexStride, UINT vertexCount,
+                                UINT maxVertices, UINT maxTriangles)
+{
+	// Meshlet vertices are addressed with 8 bits.
+	assert(maxVertices >= 3 && maxVertices <= 256 && maxTriangles >= 1);
+
+	const UINT triangleCount = indexCount / 3;
+
+	mMeshlets.clear();
+	mBounds.clear();
+	mVertices.clear();
+	mTriangles.clear();
+	mIndices.clear();
+	mTriangles.reserve(triangleCount * 3);
+	mIndices.reserve(triangleCount * 3);
+
+	// Triangles around every vertex: those of v are triangles[offsets[v]] .. triangles[offsets[v + 1] - 1].
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	std::vector<uint32_t> triangles(triangleCount * 3);
+	for (UINT i = 0; i < triangleCount * 3; ++i)
+		++offsets[indices[i] + 1];
+	for (UINT v = 0; v < vertexCount; ++v)
+		offsets[v + 1] += offsets[v];
+	for (UINT i = 0; i < triangleCount * 3; ++i)
+		triangles[offsets[indices[i]]++] = i / 3;
+	for (UINT v = vertexCount; v > 0; --v)
+		offsets[v] = offsets[v - 1];
+	offsets[0] = 0;
+
+	std::vector<uint32_t> live(vertexCount); // triangles not taken yet around every vertex
+	for (UINT v = 0; v < vertexCount; ++v)
+		live[v] = offsets[v + 1] - offsets[v];
+
+	std::vector<uint8_t>  taken(triangleCount, 0);
+	std::vector<uint32_t> local(vertexCount, ~0u);    // meshlet vertex of every mesh vertex in the current meshlet
+	std::vector<uint32_t> seenIn(triangleCount, ~0u); // meshlet that last queued every triangle as a candidate
+	std::vector<uint32_t> candidates;                 // triangles touching the current meshlet, possibly taken since
+
+	auto newVertices = [&](uint32_t t)
+	{
+		return (local[indices[t * 3 + 0]] == ~0u ? 1u : 0u) + (local[indices[t * 3 + 1]] == ~0u ? 1u : 0u) +
+		       (local[indices[t * 3 + 2]] == ~0u ? 1u : 0u);
+	};
+
+	auto centroid = [&](uint32_t t)
+	{
+		return (XMLoadFloat3(&PositionAt(positions, vertexStride, indices[t * 3 + 0])) +
+		        XMLoadFloat3(&PositionAt(positions, vertexStride, indices[t * 3 + 1])) +
+		        XMLoadFloat3(&PositionAt(positions, vertexStride, indices[t * 3 + 2]))) * (1.0f / 3.0f);
+	};
+
+	UINT cursor = 0; // triangles before it are all taken
+	for (;;)
+	{
+		while (cursor < triangleCount && taken[cursor])
+			++cursor;
+		if (cursor == triangleCount)
+			break;
+
+		Meshlet meshlet;
+		meshlet.FirstVertex   = (UINT)mVertices.size();
+		meshlet.VertexCount   = 0;
+		meshlet.FirstTriangle = (UINT)mTriangles.size() / 3;
+		meshlet.TriangleCount = 0;
+
+		const uint32_t meshletIndex = (UINT)mMeshlets.size();
+		XMVECTOR       centroidSum  = XMVectorZero();
+		candidates.clear();
+
+		uint32_t next = cursor;
+		while (next != ~0u)
+		{
+			// Take the triangle, and queue the triangles around its vertices.
+			for (UINT k = 0; k < 3; ++k)
+			{
+				const uint32_t v = indices[next * 3 + k];
+				if (local[v] == ~0u)
+				{
+					local[v] = meshlet.VertexCount++;
+					mVertices.push_back(v);
+
+					for (UINT a = offsets[v]; a < offsets[v + 1]; ++a)
+					{
+						const uint32_t t = triangles[a];
+						if (!taken[t] && seenIn[t] != meshletIndex)
+						{
+							seenIn[t] = meshletIndex;
+							candidates.push_back(t);
+						}
+					}
+				}
+				mTriangles.push_back((uint8_t)local[v]);
+				mIndices.push_back(v);
+				--live[v];
+			}
+			taken[next] = 1;
+			centroidSum += centroid(next);
+			++meshlet.TriangleCount;
+
+			if (meshlet.TriangleCount == maxTriangles)
+				break;
+
+			// Next: the fewest new vertices; then the fewest triangles left around its vertices, so no small
+			// islands are left behind for meshlets of their own; then the nearest, so the meshlet stays round.
+			const XMVECTOR center   = centroidSum / (float)meshlet.TriangleCount;
+			uint32_t       bestNew  = 4;
+			uint32_t       bestLive = ~0u;
+			float          bestDist = FLT_MAX;
+			next                    = ~0u;
+			for (size_t c = 0; c < candidates.size();)
+			{
+				const uint32_t t = candidates[c];
+				if (taken[t])
+				{
+					candidates[c] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
+				++c;
+
+				const uint32_t added = newVertices(t);
+				if (meshlet.VertexCount + added > maxVertices || added > bestNew)
+					continue;
+
+				const uint32_t around = live[indices[t * 3 + 0]] + live[indices[t * 3 + 1]] + live[indices[t * 3 + 2]];
+				if (added == bestNew && around > bestLive)
+					continue;
+
+				const float dist = XMVectorGetX(XMVector3LengthSq(centroid(t) - center));
+				if (added < bestNew || around < bestLive || dist < bestDist)
+				{
+					next     = t;
+					bestNew  = added;
+					bestLive = around;
+					bestDist = dist;
+				}
+			}
+		}
+
+		for (UINT i = 0; i < meshlet.VertexCount; ++i)
+			local[mVertices[meshlet.FirstVertex + i]] = ~0u;
+
+		Bounds bounds;
+		ComputeBounds(meshlet, positions, vertexStride, bounds);
+		mMeshlets.push_back(meshlet);
+		mBounds.push_back(bounds);
+	}
+}
+
+void MeshletMesh::ComputeBounds(const Meshlet& meshlet, const XMFLOAT3* positions, UINT vertexStride, Bounds& bounds) const
+{
+	XMFLOAT3 points[256];
+	for (UINT i = 0; i < meshlet.VertexCount; ++i)
+		points[i] = PositionAt(positions, vertexStride, mVertices[meshlet.FirstVertex + i]);
+
+	BoundingSphere sphere;
+	BoundingSphere::CreateFromPoints(sphere, meshlet.VertexCount, points, sizeof(XMFLOAT3));
+	bounds.Center = sphere.Center;
+	bounds.Radius = sphere.Radius;
+
+	// The cone axis is the average normal; its half angle reaches the normal furthest from it. Degenerate
+	// triangles are never drawn, so they do not widen it.
+	auto normalOf = [&](UINT t)
+	{
+		const uint8_t* tri = &mTriangles[(meshlet.FirstTriangle + t) * 3];
+		const XMVECTOR p0  = XMLoadFloat3(&points[tri[0]]);
+		const XMVECTOR p1  = XMLoadFloat3(&points[tri[1]]);
+		const XMVECTOR p2  = XMLoadFloat3(&points[tri[2]]);
+		const XMVECTOR n   = XMVector3Cross(p1 - p0, p2 - p0);
+		return XMVectorGetX(XMVector3LengthSq(n)) > 0.0f ? XMVector3Normalize(n) : XMVectorZero();
+	};
+
+	XMVECTOR axis = XMVectorZero();
+	for (UINT t = 0; t < meshlet.TriangleCount; ++t)
+		axis += normalOf(t);
+
+	bounds.ConeAxis   = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	bounds.ConeCutoff = 1.0f;
+	if (XMVectorGetX(XMVector3LengthSq(axis)) == 0.0f)
+		return;
+
+	axis            = XMVector3Normalize(axis);
+	float minCosine = 1.0f;
+	for (UINT t = 0; t < meshlet.TriangleCount; ++t)
+	{
+		const XMVECTOR n = normalOf(t);
+		if (XMVectorGetX(XMVector3LengthSq(n)) > 0.0f)
+			minCosine = std::min(minCosine, XMVectorGetX(XMVector3Dot(axis, n)));
+	}
+
+	XMStoreFloat3(&bounds.ConeAxis, axis);
+
+	// Cones close to a hemisphere or wider almost never face away; leave them to the frustum test.
+	if (minCosine > 0.1f)
+		bounds.ConeCutoff = sqrtf(1.0f - minCosine * minCosine);
+}
+
+UINT MeshletMesh::Cull(const FrustumCuller::Frustum& frustum, FXMVECTOR eye, std::vector<IndexRange>& ranges, CullStats* stats) const
+{
+	XMVECTOR planes[6];
+	for (UINT p = 0; p < 6; ++p)
+		planes[p] = XMLoadFloat4(&frustum.Planes[p]);
+
+	CullStats counters;
+	UINT      visible = 0;
+	for (UINT i = 0; i < (UINT)mMeshlets.size(); ++i)
+	{
+		const Bounds&  bounds = mBounds[i];
+		const XMVECTOR center = XMVectorSet(bounds.Center.x, bounds.Center.y, bounds.Center.z, 1.0f);
+		++counters.MeshletsTested;
+
+		bool outside = false;
+		for (UINT p = 0; p < 6 && !outside; ++p)
+			outside = XMVectorGetX(XMVector4Dot(planes[p], center)) < -bounds.Radius;
+		if (outside)
+		{
+			++counters.FrustumCulled;
+			continue;
+		}
+
+		// Every triangle faces away if the direction from the eye to any point of the sphere is within
+		// 90 degrees minus the cone half angle of the axis.
+		const XMVECTOR toCenter = center - eye;
+		const float    along    = XMVectorGetX(XMVector3Dot(toCenter, XMLoadFloat3(&bounds.ConeAxis)));
+		if (along >= bounds.ConeCutoff * XMVectorGetX(XMVector3Length(toCenter)) + bounds.Radius)
+		{
+			++counters.BackfaceCulled;
+			continue;
+		}
+
+		const Meshlet& meshlet = mMeshlets[i];
+		const UINT     start   = meshlet.FirstTriangle * 3;
+		if (!ranges.empty() && ranges.back().StartIndexLocation + ranges.back().IndexCount == start)
+			ranges.back().IndexCount += meshlet.TriangleCount * 3;
+		else
+			ranges.push_back({start, meshlet.TriangleCount * 3});
+
+		counters.TrianglesVisible += meshlet.TriangleCount;
+		++visible;
+	}
+
+	if (stats != nullptr)
+	{
+		stats->MeshletsTested   += counters.MeshletsTested;
+		stats->FrustumCulled    += counters.FrustumCulled;
+		stats->BackfaceCulled   += counters.BackfaceCulled;
+		stats->TrianglesVisible += counters.TrianglesVisible;
+	}
+	return visible;
+}
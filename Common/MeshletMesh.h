@@ -0,0 +1,99 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "FrustumCuller.h"
+#include "GeometryGenerator.h"
+
+/**
+ * \brief A mesh split into meshlets: small clusters of at most kMaxVertices vertices and kMaxTriangles
+ * triangles, each with a bounding sphere and a normal cone, so parts of a large mesh can be culled on
+ * their own instead of the whole RenderItem at once.
+ *
+ * Meshlets grow greedily from the first triangle not yet taken, adding the neighbouring triangle that
+ * brings the fewest new vertices; among those, the one with the fewest triangles left around it, so no
+ * small islands are stranded, then the nearest. Running MeshOptimizer::OptimizeVertexCache on the
+ * indices beforehand gives the seeds good locality.
+ *
+ * The triangles are kept twice: as an index buffer of the mesh reordered meshlet by meshlet, which Cull
+ * turns into ranges for DrawIndexedInstanced, and as meshlet-local vertex lists and 8-bit triangles, the
+ * layout a mesh shader reads.
+ */
+class MeshletMesh
+{
+public:
+	static constexpr UINT kMaxVertices  = 64;
+	static constexpr UINT kMaxTriangles = 124;
+
+	struct Meshlet
+	{
+		UINT FirstVertex;   // into Vertices()
+		UINT VertexCount;
+		UINT FirstTriangle; // into Triangles(); its indices start at 3 * FirstTriangle in Indices()
+		UINT TriangleCount;
+	};
+
+	// Culling bounds in mesh space.
+	struct Bounds
+	{
+		DirectX::XMFLOAT3 Center;
+		float             Radius;
+		DirectX::XMFLOAT3 ConeAxis;   // average triangle normal
+		float             ConeCutoff; // sine of the half angle of the cone holding every triangle normal; 1 if it cannot be back face culled
+	};
+
+	struct IndexRange
+	{
+		UINT StartIndexLocation;
+		UINT IndexCount;
+	};
+
+	struct CullStats
+	{
+		UINT MeshletsTested   = 0;
+		UINT FrustumCulled    = 0; // meshlets outside the frustum
+		UINT BackfaceCulled   = 0; // meshlets inside it but facing away from the eye
+		UINT TrianglesVisible = 0;
+	};
+
+	/**
+	 * \brief Splits a triangle list into meshlets.
+	 * \param positions Position of the first vertex; consecutive vertices are vertexStride bytes apart.
+	 */
+	void Build(const uint16_t* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride, UINT vertexCount,
+	           UINT maxVertices = kMaxVertices, UINT maxTriangles = kMaxTriangles);
+	void Build(const uint32_t* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride, UINT vertexCount,
+	           UINT maxVertices = kMaxVertices, UINT maxTriangles = kMaxTriangles);
+	void Build(const GeometryGenerator::MeshData& mesh, UINT maxVertices = kMaxVertices, UINT maxTriangles = kMaxTriangles);
+
+	/**
+	 * \brief Finds the meshlets that are inside the frustum and not facing away from the eye, and appends
+	 * their index ranges in Indices() to ranges, merging meshlets that follow each other.
+	 * \param frustum, eye In mesh space: planes of world * viewProj and the eye moved by the inverse world matrix.
+	 * \return the number of visible meshlets
+	 */
+	UINT Cull(const FrustumCuller::Frustum& frustum, DirectX::FXMVECTOR eye, std::vector<IndexRange>& ranges, CullStats* stats = nullptr) const;
+
+	UINT MeshletCount() const { return (UINT)mMeshlets.size(); }
+	UINT TriangleCount() const { return (UINT)mIndices.size() / 3; }
+
+	const Meshlet& GetMeshlet(UINT i) const { return mMeshlets[i]; }
+	const Bounds&  GetBounds(UINT i) const { return mBounds[i]; }
+
+	const std::vector<uint32_t>& Vertices() const { return mVertices; }
+	const std::vector<uint8_t>&  Triangles() const { return mTriangles; }
+	const std::vector<uint32_t>& Indices() const { return mIndices; }
+
+private:
+	template <typename Index>
+	void BuildMeshlets(const Index* indices, UINT indexCount, const DirectX::XMFLOAT3* positions, UINT vertexStride, UINT vertexCount,
+	                   UINT maxVertices, UINT maxTriangles);
+
+	void ComputeBounds(const Meshlet& meshlet, const DirectX::XMFLOAT3* positions, UINT vertexStride, Bounds& bounds) const;
+
+private:
+	std::vector<Meshlet>  mMeshlets;
+	std::vector<Bounds>   mBounds;
+	std::vector<uint32_t> mVertices;  // mesh vertex of every meshlet vertex
+	std::vector<uint8_t>  mTriangles; // three meshlet vertices per triangle
+	std::vector<uint32_t> mIndices;   // mesh indices in meshlet order
+};
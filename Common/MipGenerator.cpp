@@ -0,0 +1,537 @@
+#include "MipGenerator.h"
+#include "ParallelFor.h"
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+	enum class TexelLayout
+	{
+		Unorm8x4,
+		Half4,
+		Float1,
+		Unsupported
+	};
+
+	// Destination rows per job: enough to balance across threads without reallocating scratch too often.
+	constexpr UINT kRowsPerJob = 16;
+
+	constexpr double kKaiserAlpha = 4.0;
+	constexpr double kKaiserLobes = 3.0;
+
+	TexelLayout GetTexelLayout(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+			return TexelLayout::Unorm8x4;
+		case DXGI_FORMAT_R16G16B16A16_FLOAT:
+			return TexelLayout::Half4;
+		case DXGI_FORMAT_R32_FLOAT:
+			return TexelLayout::Float1;
+		default:
+			return TexelLayout::Unsupported;
+		}
+	}
+
+	bool IsSrgbFormat(DXGI_FORMAT format)
+	{
+		return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+		       format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+		       format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+	}
+
+	UINT BytesPerTexel(TexelLayout layout)
+	{
+		return layout == TexelLayout::Half4 ? 8 : 4;
+	}
+
+	UINT ChannelCount(TexelLayout layout)
+	{
+		return layout == TexelLayout::Float1 ? 1 : 4;
+	}
+
+	// Destination texel i reads the source texels Index[i * TapCount + k] with Weight[i * TapCount + k].
+	// Every texel has TapCount taps; the unused ones have zero weight.
+	struct FilterTable
+	{
+		UINT               TapCount = 0;
+		std::vector<UINT>  Index;
+		std::vector<float> Weight;
+	};
+
+	// Zeroth order modified Bessel function of the first kind.
+	double BesselI0(double x)
+	{
+		double sum  = 1.0;
+		double term = 1.0;
+		for (int k = 1; k < 32 && term > sum * 1e-12; ++k)
+		{
+			double t = x / (2.0 * k);
+			term *= t * t;
+			sum += term;
+		}
+		return sum;
+	}
+
+	double Sinc(double x)
+	{
+		if (fabs(x) < 1e-6)
+			return 1.0;
+		x *= XM_PI;
+		return sin(x) / x;
+	}
+
+	double KaiserWindow(double t)
+	{
+		if (fabs(t) >= 1.0)
+			return 0.0;
+		return BesselI0(kKaiserAlpha * sqrt(1.0 - t * t)) / BesselI0(kKaiserAlpha);
+	}
+
+	FilterTable BuildFilterTable(UINT srcSize, UINT dstSize, MipGenerator::Filter filter)
+	{
+		const double scale = double(srcSize) / double(dstSize);
+
+		std::vector<std::vector<std::pair<UINT, double>>> taps(dstSize);
+		for (UINT i = 0; i < dstSize; ++i)
+		{
+			auto& texelTaps = taps[i];
+			auto  addTap    = [&texelTaps](UINT index, double weight)
+			{
+				// Clamped edge taps land on the same texel; merge them.
+				for (auto& tap : texelTaps)
+				{
+					if (tap.first == index)
+					{
+						tap.second += weight;
+						return;
+					}
+				}
+				texelTaps.emplace_back(index, weight);
+			};
+
+			if (filter == MipGenerator::Filter::Box)
+			{
+				// Overlap of source texel [j, j + 1) with the footprint [lo, hi).
+				const double lo = i * scale;
+				const double hi = lo + scale;
+				for (UINT j = (UINT)lo; j < srcSize && j < hi; ++j)
+				{
+					double overlap = std::min(hi, j + 1.0) - std::max(lo, double(j));
+					if (overlap > 1e-9)
+						addTap(j, overlap / scale);
+				}
+			}
+			else
+			{
+				// Windowed sinc centred on the destination texel, stretched by the scale when minifying.
+				const double stretch = std::max(scale, 1.0);
+				const double center  = (i + 0.5) * scale;
+				const double support = kKaiserLobes * stretch;
+				const int    first   = (int)ceil(center - support - 0.5);
+				const int    last    = (int)floor(center + support - 0.5);
+
+				double sum = 0.0;
+				for (int j = first; j <= last; ++j)
+				{
+					double x = (j + 0.5 - center) / stretch;
+					double w = Sinc(x) * KaiserWindow(x / kKaiserLobes);
+					if (w == 0.0)
+						continue;
+
+					addTap((UINT)std::min(std::max(j, 0), int(srcSize) - 1), w);
+					sum += w;
+				}
+
+				for (auto& tap : texelTaps)
+					tap.second /= sum;
+			}
+		}
+
+		FilterTable table;
+		for (const auto& texelTaps : taps)
+			table.TapCount = std::max(table.TapCount, (UINT)texelTaps.size());
+
+		table.Index.assign(size_t(dstSize) * table.TapCount, 0);
+		table.Weight.assign(size_t(dstSize) * table.TapCount, 0.0f);
+		for (UINT i = 0; i < dstSize; ++i)
+		{
+			for (size_t k = 0; k < taps[i].size(); ++k)
+			{
+				table.Index[size_t(i) * table.TapCount + k]  = taps[i][k].first;
+				table.Weight[size_t(i) * table.TapCount + k] = (float)taps[i][k].second;
+			}
+		}
+
+		return table;
+	}
+
+	// Filters destination rows [rowBegin, rowEnd): a vertical pass into one scratch row, then a horizontal pass.
+	void ResampleRows(const float*        src,
+	                  UINT                srcWidth,
+	                  float*              dst,
+	                  UINT                dstWidth,
+	                  UINT                channelCount,
+	                  const FilterTable&  horizontal,
+	                  const FilterTable&  vertical,
+	                  UINT                rowBegin,
+	                  UINT                rowEnd,
+	                  std::vector<float>& scratch)
+	{
+		const size_t srcPitch  = size_t(srcWidth) * channelCount;
+		const size_t dstPitch  = size_t(dstWidth) * channelCount;
+		const size_t vectorEnd = srcPitch & ~size_t(3);
+		const UINT   hTaps     = horizontal.TapCount;
+
+		scratch.resize(srcPitch);
+		float* row = scratch.data();
+
+		for (UINT y = rowBegin; y < rowEnd; ++y)
+		{
+			//
+			// Vertical pass: row = sum of weight[k] * source row index[k], four floats at a time.
+			//
+			const UINT*  vIndex  = &vertical.Index[size_t(y) * vertical.TapCount];
+			const float* vWeight = &vertical.Weight[size_t(y) * vertical.TapCount];
+
+			for (UINT k = 0; k < vertical.TapCount; ++k)
+			{
+				if (k > 0 && vWeight[k] == 0.0f)
+					continue;
+
+				const float* s = src + size_t(vIndex[k]) * srcPitch;
+				XMVECTOR     w = XMVectorReplicate(vWeight[k]);
+
+				size_t i = 0;
+				if (k == 0)
+				{
+					for (; i < vectorEnd; i += 4)
+					{
+						XMVECTOR v = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(s + i));
+						XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + i), XMVectorMultiply(v, w));
+					}
+					for (; i < srcPitch; ++i)
+						row[i] = s[i] * vWeight[k];
+				}
+				else
+				{
+					for (; i < vectorEnd; i += 4)
+					{
+						XMVECTOR v   = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(s + i));
+						XMVECTOR acc = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + i));
+						XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + i), XMVectorMultiplyAdd(v, w, acc));
+					}
+					for (; i < srcPitch; ++i)
+						row[i] += s[i] * vWeight[k];
+				}
+			}
+
+			//
+			// Horizontal pass: one RGBA texel per vector, or four R32F texels per vector.
+			//
+			float* out = dst + size_t(y) * dstPitch;
+			if (channelCount == 4)
+			{
+				for (UINT x = 0; x < dstWidth; ++x)
+				{
+					const UINT*  hIndex  = &horizontal.Index[size_t(x) * hTaps];
+					const float* hWeight = &horizontal.Weight[size_t(x) * hTaps];
+
+					XMVECTOR sum = XMVectorZero();
+					for (UINT k = 0; k < hTaps; ++k)
+					{
+						XMVECTOR texel = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + size_t(hIndex[k]) * 4));
+						sum            = XMVectorMultiplyAdd(texel, XMVectorReplicate(hWeight[k]), sum);
+					}
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(out + size_t(x) * 4), sum);
+				}
+			}
+			else
+			{
+				UINT x = 0;
+				for (; x + 4 <= dstWidth; x += 4)
+				{
+					const UINT*  hIndex  = &horizontal.Index[size_t(x) * hTaps];
+					const float* hWeight = &horizontal.Weight[size_t(x) * hTaps];
+
+					XMVECTOR sum = XMVectorZero();
+					for (UINT k = 0; k < hTaps; ++k)
+					{
+						XMVECTOR texels  = XMVectorSet(row[hIndex[k]],
+						                               row[hIndex[hTaps + k]],
+						                               row[hIndex[2 * hTaps + k]],
+						                               row[hIndex[3 * hTaps + k]]);
+						XMVECTOR weights = XMVectorSet(hWeight[k],
+						                               hWeight[hTaps + k],
+						                               hWeight[2 * hTaps + k],
+						                               hWeight[3 * hTaps + k]);
+						sum = XMVectorMultiplyAdd(texels, weights, sum);
+					}
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(out + x), sum);
+				}
+
+				for (; x < dstWidth; ++x)
+				{
+					float sum = 0.0f;
+					for (UINT k = 0; k < hTaps; ++k)
+						sum += row[horizontal.Index[size_t(x) * hTaps + k]] * horizontal.Weight[size_t(x) * hTaps + k];
+					out[x] = sum;
+				}
+			}
+		}
+	}
+
+	const float* SrgbToLinearTable()
+	{
+		static const std::array<float, 256> table = []()
+		{
+			std::array<float, 256> values;
+			for (int i = 0; i < 256; ++i)
+			{
+				float c   = i / 255.0f;
+				values[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return values;
+		}();
+		return table.data();
+	}
+
+	void DecodeRow(TexelLayout layout, bool srgb, const uint8_t* src, UINT width, float* dst)
+	{
+		switch (layout)
+		{
+		case TexelLayout::Unorm8x4:
+			if (srgb)
+			{
+				const float* toLinear = SrgbToLinearTable();
+				for (UINT x = 0; x < width; ++x)
+				{
+					dst[4 * x + 0] = toLinear[src[4 * x + 0]];
+					dst[4 * x + 1] = toLinear[src[4 * x + 1]];
+					dst[4 * x + 2] = toLinear[src[4 * x + 2]];
+					dst[4 * x + 3] = src[4 * x + 3] / 255.0f;
+				}
+			}
+			else
+			{
+				for (UINT x = 0; x < width; ++x)
+				{
+					XMVECTOR v = XMLoadUByteN4(reinterpret_cast<const XMUBYTEN4*>(src + 4 * x));
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(dst + 4 * x), v);
+				}
+			}
+			break;
+
+		case TexelLayout::Half4:
+			for (UINT x = 0; x < width; ++x)
+			{
+				XMVECTOR v = XMLoadHalf4(reinterpret_cast<const XMHALF4*>(src + 8 * x));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(dst + 4 * x), v);
+			}
+			break;
+
+		default:
+			memcpy(dst, src, size_t(width) * sizeof(float));
+			break;
+		}
+	}
+
+	void EncodeRow(TexelLayout layout, bool srgb, const float* src, UINT width, uint8_t* dst)
+	{
+		switch (layout)
+		{
+		case TexelLayout::Unorm8x4:
+			for (UINT x = 0; x < width; ++x)
+			{
+				// Saturate first: the Kaiser filter can overshoot.
+				XMVECTOR v = XMVectorSaturate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(src + 4 * x)));
+				if (srgb)
+					v = XMColorRGBToSRGB(v);
+				XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(dst + 4 * x), v);
+			}
+			break;
+
+		case TexelLayout::Half4:
+			for (UINT x = 0; x < width; ++x)
+			{
+				XMVECTOR v = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(src + 4 * x));
+				XMStoreHalf4(reinterpret_cast<XMHALF4*>(dst + 8 * x), v);
+			}
+			break;
+
+		default:
+			memcpy(dst, src, size_t(width) * sizeof(float));
+			break;
+		}
+	}
+}
+
+bool MipGenerator::IsSupported(DXGI_FORMAT format)
+{
+	return GetTexelLayout(format) != TexelLayout::Unsupported;
+}
+
+UINT MipGenerator::CountMips(UINT width, UINT height)
+{
+	UINT mipLevels = 1;
+	for (UINT size = std::max(width, height); size > 1; size /= 2)
+		++mipLevels;
+	return mipLevels;
+}
+
+size_t MipGenerator::ComputeChainBytes(DXGI_FORMAT format, UINT width, UINT height, UINT mipLevels)
+{
+	const size_t bytesPerTexel = BytesPerTexel(GetTexelLayout(format));
+
+	size_t bytes = 0;
+	for (UINT i = 0; i < mipLevels; ++i)
+	{
+		bytes += size_t(width) * height * bytesPerTexel;
+		width  = std::max(width / 2, 1u);
+		height = std::max(height / 2, 1u);
+	}
+	return bytes;
+}
+
+void MipGenerator::GenerateChain(DXGI_FORMAT    format,
+                                 UINT           width,
+                                 UINT           height,
+                                 UINT           arraySize,
+                                 UINT           srcMips,
+                                 const uint8_t* src,
+                                 UINT           dstMips,
+                                 uint8_t*       dst,
+                                 const Options& options)
+{
+	const TexelLayout layout = GetTexelLayout(format);
+	assert(layout != TexelLayout::Unsupported);
+	assert(srcMips >= 1 && srcMips <= dstMips);
+
+	const UINT   channelCount  = ChannelCount(layout);
+	const UINT   bytesPerTexel = BytesPerTexel(layout);
+	const bool   srgb          = layout == TexelLayout::Unorm8x4 && (IsSrgbFormat(format) || options.ForceSrgb);
+	const size_t srcSliceBytes = ComputeChainBytes(format, width, height, srcMips);
+	const size_t dstSliceBytes = ComputeChainBytes(format, width, height, dstMips);
+	const UINT   threadCount   = ResolveThreadCount(options.ThreadCount, ~0u);
+
+	// The existing levels are kept as they are.
+	for (UINT j = 0; j < arraySize; ++j)
+		memcpy(dst + j * dstSliceBytes, src + j * srcSliceBytes, srcSliceBytes);
+
+	if (srcMips == dstMips)
+		return;
+
+	//
+	// Float copy of the last existing level of every slice.
+	//
+	UINT levelWidth  = std::max(width >> (srcMips - 1), 1u);
+	UINT levelHeight = std::max(height >> (srcMips - 1), 1u);
+
+	std::vector<std::vector<float>> current(arraySize);
+	std::vector<std::vector<float>> next(arraySize);
+	for (auto& level : current)
+		level.resize(size_t(levelWidth) * levelHeight * channelCount);
+
+	const size_t lastLevelOffset = ComputeChainBytes(format, width, height, srcMips - 1);
+	const UINT   decodeJobs      = (levelHeight + kRowsPerJob - 1) / kRowsPerJob;
+	ParallelFor(arraySize * decodeJobs, threadCount, [&](UINT job)
+	{
+		const UINT     j        = job / decodeJobs;
+		const UINT     rowBegin = (job % decodeJobs) * kRowsPerJob;
+		const UINT     rowEnd   = std::min(rowBegin + kRowsPerJob, levelHeight);
+		const uint8_t* level    = src + j * srcSliceBytes + lastLevelOffset;
+
+		for (UINT y = rowBegin; y < rowEnd; ++y)
+		{
+			DecodeRow(layout,
+			          srgb,
+			          level + size_t(y) * levelWidth * bytesPerTexel,
+			          levelWidth,
+			          current[j].data() + size_t(y) * levelWidth * channelCount);
+		}
+	});
+
+	//
+	// Each new level is filtered from the float copy of the previous one, then encoded into dst.
+	//
+	size_t dstOffset = srcSliceBytes;
+	for (UINT mip = srcMips; mip < dstMips; ++mip)
+	{
+		const UINT mipWidth  = std::max(levelWidth / 2, 1u);
+		const UINT mipHeight = std::max(levelHeight / 2, 1u);
+
+		const FilterTable horizontal = BuildFilterTable(levelWidth, mipWidth, options.MipFilter);
+		const FilterTable vertical   = BuildFilterTable(levelHeight, mipHeight, options.MipFilter);
+
+		for (auto& level : next)
+			level.resize(size_t(mipWidth) * mipHeight * channelCount);
+
+		const UINT jobsPerSlice = (mipHeight + kRowsPerJob - 1) / kRowsPerJob;
+		ParallelFor(arraySize * jobsPerSlice, threadCount, [&](UINT job)
+		{
+			const UINT j        = job / jobsPerSlice;
+			const UINT rowBegin = (job % jobsPerSlice) * kRowsPerJob;
+			const UINT rowEnd   = std::min(rowBegin + kRowsPerJob, mipHeight);
+
+			std::vector<float> scratch;
+			ResampleRows(current[j].data(),
+			             levelWidth,
+			             next[j].data(),
+			             mipWidth,
+			             channelCount,
+			             horizontal,
+			             vertical,
+			             rowBegin,
+			             rowEnd,
+			             scratch);
+
+			uint8_t* level = dst + j * dstSliceBytes + dstOffset;
+			for (UINT y = rowBegin; y < rowEnd; ++y)
+			{
+				EncodeRow(layout,
+				          srgb,
+				          next[j].data() + size_t(y) * mipWidth * channelCount,
+				          mipWidth,
+				          level + size_t(y) * mipWidth * bytesPerTexel);
+			}
+		});
+
+		std::swap(current, next);
+		dstOffset += size_t(mipWidth) * mipHeight * bytesPerTexel;
+		levelWidth  = mipWidth;
+		levelHeight = mipHeight;
+	}
+}
+
+void MipGenerator::Resample(const float* src,
+                            UINT         srcWidth,
+                            UINT         srcHeight,
+                            float*       dst,
+                            UINT         dstWidth,
+                            UINT         dstHeight,
+                            UINT         channelCount,
+                            Filter       filter,
+                            UINT         threadCount)
+{
+	assert(channelCount == 1 || channelCount == 4);
+
+	const FilterTable horizontal = BuildFilterTable(srcWidth, dstWidth, filter);
+	const FilterTable vertical   = BuildFilterTable(srcHeight, dstHeight, filter);
+
+	const UINT jobCount = (dstHeight + kRowsPerJob - 1) / kRowsPerJob;
+	ParallelFor(jobCount, threadCount, [&](UINT job)
+	{
+		const UINT rowBegin = job * kRowsPerJob;
+		const UINT rowEnd   = std::min(rowBegin + kRowsPerJob, dstHeight);
+
+		std::vector<float> scratch;
+		ResampleRows(src, srcWidth, dst, dstWidth, channelCount, horizontal, vertical, rowBegin, rowEnd, scratch);
+	});
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "d3dUtil.h"
+
+/**
+ * \brief CPU mip chain generator for RGBA8 (UNORM/SRGB, RGBA or BGRA order), RGBA16F and R32F surfaces.
+ * Every level is filtered from the float copy of the level above it, so 8-bit sources are quantized once
+ * per level rather than once per filtering step. sRGB colour is filtered in linear space and alpha is
+ * always linear.
+ *
+ * Sizes that are not powers of two are handled with polyphase filters: each destination texel covers
+ * srcSize / dstSize source texels, so a 5 texel row halves to 2 texels that each see 2.5 source texels.
+ * Edges are clamped.
+ *
+ * The vertical pass runs four floats at a time across whole rows and the horizontal pass runs four
+ * channels (RGBA) or four texels (R32F) at a time. Rows of every array slice are spread across threads.
+ */
+class MipGenerator
+{
+public:
+	enum class Filter
+	{
+		Box,   // area weighted average of the source footprint
+		Kaiser // Kaiser windowed sinc (alpha 4, 3 lobes): sharper, may ring slightly
+	};
+
+	struct Options
+	{
+		Filter MipFilter   = Filter::Box;
+		bool   ForceSrgb   = false; // filter RGBA8 colour in linear space even if the format is not *_SRGB
+		UINT   ThreadCount = 0;     // 0 = one per hardware thread
+	};
+
+	static bool IsSupported(DXGI_FORMAT format);
+
+	// Length of the full chain down to 1x1.
+	static UINT CountMips(UINT width, UINT height);
+
+	// Bytes of mips [0, mipLevels) of one tightly packed array slice.
+	static size_t ComputeChainBytes(DXGI_FORMAT format, UINT width, UINT height, UINT mipLevels);
+
+	/**
+	 * \brief Extends a chain of srcMips levels to dstMips levels.
+	 * Both buffers are tightly packed in DDS order (array slice major, mip minor). The existing levels are
+	 * copied to dst and the missing ones are filtered from the last existing level.
+	 */
+	static void GenerateChain(DXGI_FORMAT    format,
+	                          UINT           width,
+	                          UINT           height,
+	                          UINT           arraySize,
+	                          UINT           srcMips,
+	                          const uint8_t* src,
+	                          UINT           dstMips,
+	                          uint8_t*       dst,
+	                          const Options& options);
+
+	/**
+	 * \brief Resamples a float image with channelCount (1 or 4) interleaved channels per texel.
+	 * The data is filtered as is, so colour must already be linear.
+	 */
+	static void Resample(const float* src,
+	                     UINT         srcWidth,
+	                     UINT         srcHeight,
+	                     float*       dst,
+	                     UINT         dstWidth,
+	                     UINT         dstHeight,
+	                     UINT         channelCount,
+	                     Filter       filter,
+	                     UINT         threadCount);
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "FrustumCuller.h"
+
+/**
+ * \brief Culls the render items of a scene against every view of a frame (camera, shadow map, cube map
+ * faces, ...) in one walk over their bounds, then hands out a draw list per view.
+ *
+ * Objects are world space boxes registered once with AddObject and moved with SetObject. Views are
+ * added every frame from their view-projection matrix; perspective and orthographic projections both work.
+ * Cull() stores one bit per view for every object.
+ */
+class MultiViewCuller
+{
+public:
+	static constexpr UINT kMaxViews = FrustumCuller::kMaxViews;
+
+	UINT AddObject(const DirectX::BoundingBox& worldBounds)
+	{
+		mViewMasks.push_back(~0u);
+		return mBounds.Add(worldBounds);
+	}
+
+	void SetObject(UINT object, const DirectX::BoundingBox& worldBounds)
+	{
+		mBounds.Set(object, worldBounds);
+	}
+
+	void ClearViews()
+	{
+		mViews.clear();
+	}
+
+	// Returns the index of the view, i.e. its bit in the masks.
+	UINT AddView(DirectX::FXMMATRIX viewProj)
+	{
+		assert(mViews.size() < kMaxViews);
+		mViews.push_back(FrustumCuller::ExtractPlanes(viewProj));
+		return (UINT)mViews.size() - 1;
+	}
+
+	void Cull()
+	{
+		mBounds.CullViews(mViews.data(), (UINT)mViews.size(), mViewMasks.data());
+	}
+
+	uint32_t GetViewMask(UINT object) const { return mViewMasks[object]; }
+
+	bool IsVisible(UINT object, UINT view) const { return (mViewMasks[object] >> view & 1u) != 0; }
+
+	/**
+	 * \brief Collects the items of ritems that are visible in view, keeping their order.
+	 * \tparam Item A render item with a CullIndex member returned by AddObject
+	 */
+	template <typename Item>
+	void BuildDrawList(UINT view, const std::vector<Item*>& ritems, std::vector<Item*>& drawList) const
+	{
+		drawList.clear();
+		for (Item* ri : ritems)
+		{
+			if (IsVisible(ri->CullIndex, view))
+				drawList.push_back(ri);
+		}
+	}
+
+private:
+	FrustumCuller                       mBounds;
+	std::vector<FrustumCuller::Frustum> mViews;
+	std::vector<uint32_t>               mViewMasks;
+};
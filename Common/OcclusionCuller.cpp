@@ -0,0 +1,307 @@
+#include "OcclusionCuller.h"
+#include "ParallelFor.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace
+{
+	// Boxes per TestBoxes job.
+	constexpr UINT kBoxesPerJob = 1024;
+}
+
+OcclusionCuller::OcclusionCuller(UINT width, UINT height)
+{
+	mTilesX   = std::max((width + kTileSize - 1) / kTileSize, 1u);
+	mTilesY   = std::max((height + kTileSize - 1) / kTileSize, 1u);
+	mWidth    = mTilesX * kTileSize;
+	mHeight   = mTilesY * kTileSize;
+	mHiZWidth = mWidth / kHiZBlock;
+
+	mDepth.assign(size_t(mWidth) * mHeight, 1.0f);
+	mHiZ.assign(size_t(mHiZWidth) * (mHeight / kHiZBlock), 1.0f);
+	mBins.resize(mTilesX * mTilesY);
+
+	XMStoreFloat4x4(&mViewProj, XMMatrixIdentity());
+}
+
+void OcclusionCuller::BeginFrame(FXMMATRIX viewProj)
+{
+	XMStoreFloat4x4(&mViewProj, viewProj);
+
+	mTriangles.clear();
+	for (auto& bin : mBins)
+		bin.clear();
+	mStats = Stats();
+}
+
+void OcclusionCuller::AddOccluder(FXMMATRIX       world,
+                                  const XMFLOAT3* positions,
+                                  UINT            positionStride,
+                                  UINT            vertexCount,
+                                  const uint32_t* indices,
+                                  UINT            indexCount)
+{
+	const XMMATRIX worldViewProj = XMMatrixMultiply(world, XMLoadFloat4x4(&mViewProj));
+
+	mClipPositions.resize(vertexCount);
+	const BYTE* position = reinterpret_cast<const BYTE*>(positions);
+	for (UINT i = 0; i < vertexCount; ++i, position += positionStride)
+		XMStoreFloat4(&mClipPositions[i], XMVector3Transform(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(position)), worldViewProj));
+
+	const XMVECTOR scale  = XMVectorSet(0.5f * mWidth, -0.5f * mHeight, 1.0f, 1.0f);
+	const XMVECTOR offset = XMVectorSet(0.5f * mWidth, 0.5f * mHeight, 0.0f, 0.0f);
+
+	for (UINT i = 0; i + 2 < indexCount; i += 3)
+	{
+		++mStats.OccluderTriangles;
+
+		XMVECTOR clip[3];
+		bool     crossesNear = false;
+		for (int v = 0; v < 3; ++v)
+		{
+			clip[v]      = XMLoadFloat4(&mClipPositions[indices[i + v]]);
+			crossesNear |= XMVectorGetZ(clip[v]) < 0.0f || XMVectorGetW(clip[v]) <= 0.0f;
+		}
+		if (crossesNear)
+			continue;
+
+		// Perspective divide and viewport transform: x, y in pixels (y down), z in [0, 1].
+		XMVECTOR screen[3];
+		for (int v = 0; v < 3; ++v)
+			screen[v] = XMVectorMultiplyAdd(XMVectorDivide(clip[v], XMVectorSplatW(clip[v])), scale, offset);
+
+		SetupTriangle(screen[0], screen[1], screen[2]);
+	}
+}
+
+void OcclusionCuller::SetupTriangle(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2)
+{
+	const XMVECTOR minP = XMVectorMin(XMVectorMin(p0, p1), p2);
+	const XMVECTOR maxP = XMVectorMax(XMVectorMax(p0, p1), p2);
+
+	Triangle triangle;
+	triangle.MinX = std::max((int)floorf(XMVectorGetX(minP)), 0);
+	triangle.MinY = std::max((int)floorf(XMVectorGetY(minP)), 0);
+	triangle.MaxX = std::min((int)ceilf(XMVectorGetX(maxP)), (int)mWidth - 1);
+	triangle.MaxY = std::min((int)ceilf(XMVectorGetY(maxP)), (int)mHeight - 1);
+	if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY || XMVectorGetZ(minP) > 1.0f)
+		return;
+
+	// Lane i holds edge i, from vertex i to vertex (i + 1) % 3.
+	const XMVECTOR x0 = XMVectorSet(XMVectorGetX(p0), XMVectorGetX(p1), XMVectorGetX(p2), 0.0f);
+	const XMVECTOR y0 = XMVectorSet(XMVectorGetY(p0), XMVectorGetY(p1), XMVectorGetY(p2), 0.0f);
+	const XMVECTOR x1 = XMVectorSwizzle(x0, 1, 2, 0, 3);
+	const XMVECTOR y1 = XMVectorSwizzle(y0, 1, 2, 0, 3);
+
+	XMVECTOR a = XMVectorSubtract(y0, y1);
+	XMVECTOR b = XMVectorSubtract(x1, x0);
+	XMVECTOR c = XMVectorSubtract(XMVectorMultiply(x0, y1), XMVectorMultiply(y0, x1));
+
+	// Twice the signed area: edge 0 evaluated at vertex 2. Flip clockwise triangles so inside is always >= 0.
+	const float area = XMVectorGetX(a) * XMVectorGetX(p2) + XMVectorGetX(b) * XMVectorGetY(p2) + XMVectorGetX(c);
+	if (fabsf(area) < 1.0e-6f)
+		return;
+	if (area < 0.0f)
+	{
+		a = XMVectorNegate(a);
+		b = XMVectorNegate(b);
+		c = XMVectorNegate(c);
+	}
+
+	XMStoreFloat4(&triangle.EdgeA, a);
+	XMStoreFloat4(&triangle.EdgeB, b);
+	XMStoreFloat4(&triangle.EdgeC, c);
+
+	// Depth plane z = dzdx * x + dzdy * y + z0 through the three vertices.
+	const XMVECTOR e1   = XMVectorSubtract(p1, p0);
+	const XMVECTOR e2   = XMVectorSubtract(p2, p0);
+	const float    det  = XMVectorGetX(e1) * XMVectorGetY(e2) - XMVectorGetX(e2) * XMVectorGetY(e1);
+	const float    dzdx = (XMVectorGetZ(e1) * XMVectorGetY(e2) - XMVectorGetZ(e2) * XMVectorGetY(e1)) / det;
+	const float    dzdy = (XMVectorGetX(e1) * XMVectorGetZ(e2) - XMVectorGetX(e2) * XMVectorGetZ(e1)) / det;
+
+	// Evaluated at a texel center it gives the farthest depth of the triangle over that texel.
+	const float farthest = 0.5f * (fabsf(dzdx) + fabsf(dzdy));
+	triangle.Depth       = XMFLOAT4(dzdx, dzdy, XMVectorGetZ(p0) - dzdx * XMVectorGetX(p0) - dzdy * XMVectorGetY(p0) + farthest, 0.0f);
+
+	mTriangles.push_back(triangle);
+}
+
+void OcclusionCuller::Rasterize(UINT threadCount)
+{
+	// Binning stays on one thread so every bin lists its triangles in submission order.
+	for (UINT t = 0; t < (UINT)mTriangles.size(); ++t)
+	{
+		const Triangle& triangle = mTriangles[t];
+		for (UINT ty = triangle.MinY / kTileSize; ty <= (UINT)triangle.MaxY / kTileSize; ++ty)
+		{
+			for (UINT tx = triangle.MinX / kTileSize; tx <= (UINT)triangle.MaxX / kTileSize; ++tx)
+				mBins[ty * mTilesX + tx].push_back(t);
+		}
+	}
+	mStats.RasterizedTriangles = (UINT)mTriangles.size();
+
+	ParallelFor(mTilesX * mTilesY, threadCount, [this](uint32_t tile) { RasterizeTile(tile); });
+}
+
+void OcclusionCuller::RasterizeTile(UINT tile)
+{
+	const int tileX0 = int(tile % mTilesX * kTileSize);
+	const int tileY0 = int(tile / mTilesX * kTileSize);
+	const int tileX1 = tileX0 + kTileSize - 1;
+	const int tileY1 = tileY0 + kTileSize - 1;
+
+	for (int y = tileY0; y <= tileY1; ++y)
+		std::fill_n(&mDepth[size_t(y) * mWidth + tileX0], kTileSize, 1.0f);
+
+	// Pixel centers of four horizontally adjacent pixels, relative to the first one.
+	const XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (UINT t : mBins[tile])
+	{
+		const Triangle& triangle = mTriangles[t];
+
+		// The tile is a multiple of four pixels wide, so aligning the start keeps every group inside it.
+		const int minX = std::max(triangle.MinX, tileX0) & ~3;
+		const int maxX = std::min(triangle.MaxX, tileX1);
+		const int minY = std::max(triangle.MinY, tileY0);
+		const int maxY = std::min(triangle.MaxY, tileY1);
+
+		const XMVECTOR edges = XMLoadFloat4(&triangle.EdgeA);
+		const XMVECTOR a0    = XMVectorSplatX(edges);
+		const XMVECTOR a1    = XMVectorSplatY(edges);
+		const XMVECTOR a2    = XMVectorSplatZ(edges);
+		const XMVECTOR depth = XMLoadFloat4(&triangle.Depth);
+		const XMVECTOR dzdx  = XMVectorSplatX(depth);
+
+		for (int y = minY; y <= maxY; ++y)
+		{
+			// Everything that only depends on y, evaluated at the row's pixel centers.
+			const float    py   = y + 0.5f;
+			const XMVECTOR row0 = XMVectorReplicate(triangle.EdgeB.x * py + triangle.EdgeC.x);
+			const XMVECTOR row1 = XMVectorReplicate(triangle.EdgeB.y * py + triangle.EdgeC.y);
+			const XMVECTOR row2 = XMVectorReplicate(triangle.EdgeB.z * py + triangle.EdgeC.z);
+			const XMVECTOR rowZ = XMVectorReplicate(triangle.Depth.y * py + triangle.Depth.z);
+
+			float* depthRow = &mDepth[size_t(y) * mWidth];
+			for (int x = minX; x <= maxX; x += 4)
+			{
+				const XMVECTOR px = XMVectorAdd(XMVectorReplicate((float)x), laneOffsets);
+
+				XMVECTOR inside = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a0, px, row0), XMVectorZero());
+				inside          = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a1, px, row1), XMVectorZero()));
+				inside          = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(a2, px, row2), XMVectorZero()));
+
+				const XMVECTOR z       = XMVectorMultiplyAdd(dzdx, px, rowZ);
+				const XMVECTOR current = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(depthRow + x));
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(depthRow + x), XMVectorSelect(current, XMVectorMin(current, z), inside));
+			}
+		}
+	}
+
+	// Farthest depth of every block of the tile.
+	for (int blockY = tileY0; blockY <= tileY1; blockY += kHiZBlock)
+	{
+		for (int blockX = tileX0; blockX <= tileX1; blockX += kHiZBlock)
+		{
+			float farthest = 0.0f;
+			for (int y = blockY; y < blockY + (int)kHiZBlock; ++y)
+			{
+				const float* depthRow = &mDepth[size_t(y) * mWidth + blockX];
+				for (UINT x = 0; x < kHiZBlock; ++x)
+					farthest = std::max(farthest, depthRow[x]);
+			}
+			mHiZ[(blockY / kHiZBlock) * mHiZWidth + blockX / kHiZBlock] = farthest;
+		}
+	}
+}
+
+bool OcclusionCuller::IsVisible(const BoundingBox& worldBox) const
+{
+	const XMMATRIX viewProj = XMLoadFloat4x4(&mViewProj);
+	const XMVECTOR center   = XMLoadFloat3(&worldBox.Center);
+	const XMVECTOR extents  = XMLoadFloat3(&worldBox.Extents);
+
+	// Screen rectangle and nearest depth of the eight projected corners.
+	XMVECTOR minP = XMVectorReplicate(FLT_MAX);
+	XMVECTOR maxP = XMVectorReplicate(-FLT_MAX);
+	for (int i = 0; i < 8; ++i)
+	{
+		const XMVECTOR sign   = XMVectorSet(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 0.0f);
+		const XMVECTOR corner = XMVectorMultiplyAdd(extents, sign, center);
+		const XMVECTOR clip   = XMVector3Transform(corner, viewProj);
+
+		// A box reaching in front of the near plane could cover the whole screen: keep it.
+		if (XMVectorGetZ(clip) < 0.0f || XMVectorGetW(clip) <= 0.0f)
+			return true;
+
+		const XMVECTOR ndc = XMVectorDivide(clip, XMVectorSplatW(clip));
+		minP               = XMVectorMin(minP, ndc);
+		maxP               = XMVectorMax(maxP, ndc);
+	}
+
+	const float nearestDepth = XMVectorGetZ(minP);
+
+	// Texels touched by the rectangle and one more on every side, so every point of the rectangle lies between
+	// four tested texel centers; NDC y points up, texel rows go down.
+	const int x0 = std::max((int)floorf((XMVectorGetX(minP) * 0.5f + 0.5f) * mWidth) - 1, 0);
+	const int x1 = std::min((int)floorf((XMVectorGetX(maxP) * 0.5f + 0.5f) * mWidth) + 1, (int)mWidth - 1);
+	const int y0 = std::max((int)floorf((0.5f - XMVectorGetY(maxP) * 0.5f) * mHeight) - 1, 0);
+	const int y1 = std::min((int)floorf((0.5f - XMVectorGetY(minP) * 0.5f) * mHeight) + 1, (int)mHeight - 1);
+
+	// Off screen or beyond the far plane: that is for the frustum test to decide.
+	if (x0 > x1 || y0 > y1 || nearestDepth > 1.0f)
+		return true;
+
+	for (int blockY = y0 / (int)kHiZBlock; blockY <= y1 / (int)kHiZBlock; ++blockY)
+	{
+		for (int blockX = x0 / (int)kHiZBlock; blockX <= x1 / (int)kHiZBlock; ++blockX)
+		{
+			// The whole block is nearer than the box.
+			if (mHiZ[blockY * mHiZWidth + blockX] < nearestDepth)
+				continue;
+
+			// Otherwise look at the texels of the block that the rectangle covers.
+			const int texelX0 = std::max(x0, blockX * (int)kHiZBlock);
+			const int texelX1 = std::min(x1, blockX * (int)kHiZBlock + (int)kHiZBlock - 1);
+			const int texelY0 = std::max(y0, blockY * (int)kHiZBlock);
+			const int texelY1 = std::min(y1, blockY * (int)kHiZBlock + (int)kHiZBlock - 1);
+			for (int y = texelY0; y <= texelY1; ++y)
+			{
+				const float* depthRow = &mDepth[size_t(y) * mWidth];
+				for (int x = texelX0; x <= texelX1; ++x)
+				{
+					if (depthRow[x] >= nearestDepth)
+						return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+UINT OcclusionCuller::TestBoxes(const BoundingBox* boxes, UINT count, uint8_t* visible, UINT threadCount)
+{
+	const UINT        jobCount = (count + kBoxesPerJob - 1) / kBoxesPerJob;
+	std::vector<UINT> jobVisible(jobCount, 0);
+
+	ParallelFor(jobCount, threadCount, [&](uint32_t job)
+	{
+		const UINT first = job * kBoxesPerJob;
+		const UINT last  = std::min(first + kBoxesPerJob, count);
+		for (UINT i = first; i < last; ++i)
+		{
+			visible[i]       = IsVisible(boxes[i]) ? 1 : 0;
+			jobVisible[job] += visible[i];
+		}
+	});
+
+	UINT visibleCount = 0;
+	for (UINT jobVisibleCount : jobVisible)
+		visibleCount += jobVisibleCount;
+
+	mStats.BoxesTested   += count;
+	mStats.BoxesOccluded += count - visibleCount;
+	return visibleCount;
+}
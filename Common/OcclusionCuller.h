@@ -0,0 +1,103 @@
+#pragma once
+
+#include "d3dUtil.h"
+
+/**
+ * \brief CPU occlusion culling against a low resolution depth buffer.
+ * A few large occluder meshes (terrain, walls, buildings) are rasterized into a small float depth buffer,
+ * which is reduced into a hierarchical depth buffer holding the farthest depth of every 8x8 block.
+ * Occludees are tested with the screen rectangle and nearest depth of their projected AABB: a box is
+ * occluded when that depth lies behind every texel around the rectangle.
+ *
+ * The screen is split into 32x32 tiles. Triangles are set up once (edge functions and depth plane,
+ * three edges per vector), binned by screen rectangle and rasterized four pixels at a time, with one
+ * thread per tile. A texel is only ever written by its tile's thread and depth is combined with min,
+ * so the result does not depend on the thread count or the order of the jobs.
+ *
+ * Texels are covered at their centers but take the farthest depth of the triangle over the whole texel,
+ * and the occludee rectangle is grown by a texel, so every point of it lies inside four texel centers that
+ * must all be hidden. A triangle covering those four centers covers the point, so a box can only be culled
+ * wrongly through a gap narrower than a texel between separate occluders.
+ *
+ * Conventions follow D3D: depth 0 is the near plane, 1 the far plane. Triangles that cross the near plane
+ * are dropped, which also only leaves holes.
+ */
+class OcclusionCuller
+{
+public:
+	struct Stats
+	{
+		UINT OccluderTriangles   = 0; // triangles submitted this frame
+		UINT RasterizedTriangles = 0; // triangles left after near plane, degenerate and off-screen rejection
+		UINT BoxesTested         = 0;
+		UINT BoxesOccluded       = 0;
+	};
+
+	static constexpr UINT kTileSize = 32;
+	static constexpr UINT kHiZBlock = 8;
+
+	// width and height are rounded up to whole tiles.
+	OcclusionCuller(UINT width = 320, UINT height = 192);
+
+	UINT Width() const { return mWidth; }
+	UINT Height() const { return mHeight; }
+
+	// Starts a new view: drops the occluders of the previous one. The depth buffer is cleared by Rasterize.
+	void BeginFrame(DirectX::FXMMATRIX viewProj);
+
+	/**
+	 * \brief Transforms and sets up the triangles of an occluder mesh; nothing is rasterized yet.
+	 * \param positions First position; consecutive positions are positionStride bytes apart
+	 */
+	void AddOccluder(DirectX::FXMMATRIX       world,
+	                 const DirectX::XMFLOAT3* positions,
+	                 UINT                     positionStride,
+	                 UINT                     vertexCount,
+	                 const uint32_t*          indices,
+	                 UINT                     indexCount);
+
+	// Bins the occluder triangles and rasterizes every tile on up to threadCount threads (0 = one per hardware thread).
+	void Rasterize(UINT threadCount);
+
+	// True unless the world space box is hidden behind the rasterized occluders.
+	bool IsVisible(const DirectX::BoundingBox& worldBox) const;
+
+	// Tests count boxes in parallel; visible[i] is set to 1 or 0. Returns the number of visible boxes.
+	UINT TestBoxes(const DirectX::BoundingBox* boxes, UINT count, uint8_t* visible, UINT threadCount);
+
+	const float* DepthBuffer() const { return mDepth.data(); }
+	const Stats& GetStats() const { return mStats; }
+
+private:
+	// Edge functions and depth plane of one screen space triangle, in pixel units.
+	struct Triangle
+	{
+		DirectX::XMFLOAT4 EdgeA; // E_i(x, y) = A_i * x + B_i * y + C_i, inside when every E_i >= 0
+		DirectX::XMFLOAT4 EdgeB;
+		DirectX::XMFLOAT4 EdgeC;
+		DirectX::XMFLOAT4 Depth; // z(x, y) = Depth.x * x + Depth.y * y + Depth.z, farthest over the texel at its center
+		int               MinX;
+		int               MinY;
+		int               MaxX;
+		int               MaxY;
+	};
+
+	void SetupTriangle(DirectX::FXMVECTOR p0, DirectX::FXMVECTOR p1, DirectX::FXMVECTOR p2);
+	void RasterizeTile(UINT tile);
+
+private:
+	UINT mWidth    = 0;
+	UINT mHeight   = 0;
+	UINT mTilesX   = 0;
+	UINT mTilesY   = 0;
+	UINT mHiZWidth = 0;
+
+	DirectX::XMFLOAT4X4 mViewProj;
+
+	std::vector<float>             mDepth; // per texel, row major
+	std::vector<float>             mHiZ;   // farthest depth of every kHiZBlock x kHiZBlock block
+	std::vector<Triangle>          mTriangles;
+	std::vector<std::vector<UINT>> mBins;  // triangles overlapping each tile, in submission order
+	std::vector<DirectX::XMFLOAT4> mClipPositions;
+	Stats                          mStats;
+};
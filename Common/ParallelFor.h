@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \brief Number of worker threads to use when the caller passes 0 ("one per hardware thread").
+ */
+inline uint32_t ResolveThreadCount(uint32_t requested, uint32_t workItems)
+{
+	uint32_t threads = requested != 0 ? requested : std::max(std::thread::hardware_concurrency(), 1u);
+	return std::max(std::min(threads, workItems), 1u);
+}
+
+/**
+ * \brief Worker threads shared by every ParallelFor call, started on first use and kept until the process exits.
+ * Per frame callers would otherwise pay for creating and joining threads every call.
+ *
+ * One loop runs at a time. A call made while another is running, including one made from inside a job,
+ * runs on the calling thread alone instead of waiting, so nesting cannot deadlock.
+ */
+class ParallelForPool
+{
+public:
+	using Invoke = void (*)(const void* job, uint32_t i);
+
+	static ParallelForPool& Instance()
+	{
+		static ParallelForPool pool;
+		return pool;
+	}
+
+	// Runs invoke(job, i) for every i in [0, count) on the calling thread and up to helperCount workers.
+	void Run(uint32_t count, uint32_t helperCount, Invoke invoke, const void* job)
+	{
+		Loop loop(count, invoke, job);
+
+		bool idle = false;
+		if (!mBusy.compare_exchange_strong(idle, true))
+		{
+			loop.Work();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			while (mThreads.size() < helperCount)
+				mThreads.emplace_back([this]() { WorkerMain(); });
+
+			mLoop    = &loop;
+			mHelpers = helperCount;
+			mJoined  = 0;
+			++mGeneration;
+		}
+		mWake.notify_all();
+
+		loop.Work();
+
+		// Workers that have not picked the loop up yet must not start on it once it is gone.
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mHelpers = 0;
+			mDone.wait(lock, [this]() { return mActive == 0; });
+			mLoop = nullptr;
+		}
+		mBusy = false;
+	}
+
+	~ParallelForPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+		mWake.notify_all();
+
+		for (auto& thread : mThreads)
+			thread.join();
+	}
+
+private:
+	struct Loop
+	{
+		Loop(uint32_t count, Invoke invoke, const void* job) : Count(count), Call(invoke), Job(job), Next(0) {}
+
+		// Indices are handed out one at a time, so jobs of uneven cost balance well.
+		void Work()
+		{
+			for (uint32_t i = Next++; i < Count; i = Next++)
+				Call(Job, i);
+		}
+
+		uint32_t              Count;
+		Invoke                Call;
+		const void*           Job;
+		std::atomic<uint32_t> Next;
+	};
+
+	ParallelForPool() = default;
+
+	void WorkerMain()
+	{
+		uint64_t seen = 0;
+		for (;;)
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [&]() { return mStop || (mGeneration != seen && mJoined < mHelpers); });
+			if (mStop)
+				return;
+
+			seen       = mGeneration;
+			Loop* loop = mLoop;
+			++mJoined;
+			++mActive;
+			lock.unlock();
+
+			loop->Work();
+
+			lock.lock();
+			if (--mActive == 0)
+				mDone.notify_one();
+		}
+	}
+
+private:
+	std::mutex               mMutex;
+	std::condition_variable  mWake;
+	std::condition_variable  mDone;
+	std::vector<std::thread> mThreads;
+	std::atomic<bool>        mBusy{false};
+	Loop*                    mLoop       = nullptr;
+	uint64_t                 mGeneration = 0;
+	uint32_t                 mHelpers    = 0; // workers allowed to join the current loop
+	uint32_t                 mJoined     = 0;
+	uint32_t                 mActive     = 0; // workers still inside the current loop
+	bool                     mStop       = false;
+};
+
+/**
+ * \brief Runs job(i) for every i in [0, count) on up to threadCount threads (0 = one per hardware thread).
+ * The work runs on the shared ParallelForPool. Indices are handed out one at a time, so jobs of uneven cost
+ * balance well. The calling thread takes part, and the function returns once every job has finished.
+ * Jobs must not throw.
+ */
+template <typename Job>
+void ParallelFor(uint32_t count, uint32_t threadCount, const Job& job)
+{
+	threadCount = ResolveThreadCount(threadCount, count);
+	if (count == 0)
+		return;
+
+	if (threadCount == 1)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+			job(i);
+		return;
+	}
+
+	ParallelForPool::Instance().Run(count, threadCount - 1, [](const void* j, uint32_t i) { (*static_cast<const Job*>(j))(i); }, &job);
+}
@@ -0,0 +1,245 @@
+#include "SceneBvh.h"
+#include "BvhUtil.h"
+#include <cfloat>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr UINT kAllPlanes = 0x3F;
+
+	/**
+	 * \brief Tests a box against the planes whose bit is set in planeMask.
+	 * Clears the bit of every plane the box is fully inside of, so children skip those planes.
+	 * \return false if the box is fully outside one of the planes
+	 */
+	inline bool ClassifyBox(const FrustumCuller::Frustum& frustum, const XMFLOAT3& min, const XMFLOAT3& max, UINT& planeMask)
+	{
+		const float cx = 0.5f * (min.x + max.x);
+		const float cy = 0.5f * (min.y + max.y);
+		const float cz = 0.5f * (min.z + max.z);
+		const float ex = 0.5f * (max.x - min.x);
+		const float ey = 0.5f * (max.y - min.y);
+		const float ez = 0.5f * (max.z - min.z);
+
+		for (UINT p = 0; p < 6; ++p)
+		{
+			const UINT bit = 1u << p;
+			if ((planeMask & bit) == 0)
+				continue;
+
+			const XMFLOAT4& plane    = frustum.Planes[p];
+			const float     distance = plane.x * cx + plane.y * cy + plane.z * cz + plane.w;
+			const float     radius   = fabsf(plane.x) * ex + fabsf(plane.y) * ey + fabsf(plane.z) * ez;
+
+			if (distance + radius < 0.0f)
+				return false;
+			if (distance - radius >= 0.0f)
+				planeMask &= ~bit;
+		}
+		return true;
+	}
+}
+
+void SceneBvh::Build(const BoundingBox* bounds, UINT count)
+{
+	mNodes.clear();
+	mParents.clear();
+	mObjects.resize(count);
+	mObjectLeaves.assign(count, 0);
+	mObjectBounds.resize(count);
+
+	if (count == 0)
+		return;
+
+	std::vector<XMFLOAT3> centroids(count);
+	for (UINT i = 0; i < count; ++i)
+	{
+		const BoundingBox& box = bounds[i];
+		mObjects[i]            = i;
+		mObjectBounds[i].Min   = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+		mObjectBounds[i].Max   = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+		centroids[i]           = box.Center;
+	}
+
+	// A binary tree with leaves of at least one object has at most 2n - 1 nodes.
+	mNodes.reserve(2 * size_t(count));
+	mParents.reserve(2 * size_t(count));
+
+	Node root;
+	root.Left  = 0;
+	root.First = 0;
+	root.Count = count;
+	mNodes.push_back(root);
+	mParents.push_back(0);
+
+	std::vector<UINT> depths(1, 0);
+	depths.reserve(2 * size_t(count));
+
+	// Nodes are fitted and split in creation order, so children always come after their parent.
+	for (UINT node = 0; node < (UINT)mNodes.size(); ++node)
+	{
+		FitNode(node);
+		Subdivide(node, centroids, depths);
+	}
+
+	for (UINT node = 0; node < (UINT)mNodes.size(); ++node)
+	{
+		const Node& n = mNodes[node];
+		if (n.Left == 0)
+		{
+			for (UINT i = n.First; i < n.First + n.Count; ++i)
+				mObjectLeaves[mObjects[i]] = node;
+		}
+	}
+}
+
+void SceneBvh::Subdivide(UINT node, std::vector<XMFLOAT3>& centroids, std::vector<UINT>& depths)
+{
+	const UINT first = mNodes[node].First;
+	const UINT count = mNodes[node].Count;
+	if (count <= kMaxLeafSize || depths[node] + 1 >= kStackSize)
+		return;
+
+	const UINT leftCount = BvhUtil::PartitionSah(mObjects.data() + first,
+	                                             count,
+	                                             mNodes[node].Min,
+	                                             mNodes[node].Max,
+	                                             centroids.data(),
+	                                             mObjectBounds.data(),
+	                                             kMaxLeafSize);
+	if (leftCount == 0)
+		return;
+
+	const UINT left = (UINT)mNodes.size();
+
+	Node child;
+	child.Left  = 0;
+	child.First = first;
+	child.Count = leftCount;
+	mNodes.push_back(child);
+	child.First = first + leftCount;
+	child.Count = count - leftCount;
+	mNodes.push_back(child);
+	mParents.push_back(node);
+	mParents.push_back(node);
+	depths.push_back(depths[node] + 1);
+	depths.push_back(depths[node] + 1);
+
+	mNodes[node].Left = left;
+}
+
+void SceneBvh::FitNode(UINT node)
+{
+	Node& n = mNodes[node];
+	n.Min   = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+	n.Max   = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	if (n.Left != 0)
+	{
+		BvhUtil::Grow(n.Min, n.Max, mNodes[n.Left].Min, mNodes[n.Left].Max);
+		BvhUtil::Grow(n.Min, n.Max, mNodes[n.Left + 1].Min, mNodes[n.Left + 1].Max);
+		return;
+	}
+
+	for (UINT i = n.First; i < n.First + n.Count; ++i)
+	{
+		const Box& box = mObjectBounds[mObjects[i]];
+		BvhUtil::Grow(n.Min, n.Max, box.Min, box.Max);
+	}
+}
+
+void SceneBvh::SetBounds(UINT object, const BoundingBox& box)
+{
+	mObjectBounds[object].Min = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+	mObjectBounds[object].Max = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+}
+
+void SceneBvh::UpdateBounds(UINT object, const BoundingBox& box)
+{
+	SetBounds(object, box);
+
+	UINT node = mObjectLeaves[object];
+	for (;;)
+	{
+		const Node before = mNodes[node];
+		FitNode(node);
+
+		const Node& after = mNodes[node];
+		if (memcmp(&before.Min, &after.Min, sizeof(XMFLOAT3)) == 0 && memcmp(&before.Max, &after.Max, sizeof(XMFLOAT3)) == 0)
+			break;
+		if (node == 0)
+			break;
+		node = mParents[node];
+	}
+}
+
+void SceneBvh::Refit()
+{
+	for (UINT node = (UINT)mNodes.size(); node-- > 0;)
+		FitNode(node);
+}
+
+UINT SceneBvh::Cull(const FrustumCuller::Frustum& frustum, UINT* visible, CullStats* stats) const
+{
+	CullStats counters;
+	UINT      visibleCount = 0;
+
+	if (!mNodes.empty())
+	{
+		struct Entry
+		{
+			UINT Node;
+			UINT PlaneMask; // planes the node is not yet known to be inside of
+		};
+
+		// Depth first; the stack holds at most one sibling per level, and the build caps the depth.
+		Entry stack[kStackSize];
+		UINT  stackSize = 0;
+
+		stack[stackSize++] = {0, kAllPlanes};
+
+		while (stackSize > 0)
+		{
+			const Entry entry = stack[--stackSize];
+
+			const Node& node      = mNodes[entry.Node];
+			UINT        planeMask = entry.PlaneMask;
+
+			++counters.NodesVisited;
+			if (!ClassifyBox(frustum, node.Min, node.Max, planeMask))
+				continue;
+
+			if (planeMask == 0)
+			{
+				// Inside every plane: take the whole subtree without looking at it.
+				++counters.NodesAccepted;
+				memcpy(visible + visibleCount, mObjects.data() + node.First, node.Count * sizeof(UINT));
+				visibleCount += node.Count;
+				continue;
+			}
+
+			if (node.Left != 0)
+			{
+				stack[stackSize++] = {node.Left + 1, planeMask};
+				stack[stackSize++] = {node.Left, planeMask};
+				continue;
+			}
+
+			for (UINT i = node.First; i < node.First + node.Count; ++i)
+			{
+				const UINT object     = mObjects[i];
+				UINT       objectMask = planeMask;
+
+				++counters.ObjectsTested;
+				if (ClassifyBox(frustum, mObjectBounds[object].Min, mObjectBounds[object].Max, objectMask))
+					visible[visibleCount++] = object;
+			}
+		}
+	}
+
+	if (stats != nullptr)
+		*stats = counters;
+	return visibleCount;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "FrustumCuller.h"
+
+/**
+ * \brief Bounding volume hierarchy over world space AABBs of scene objects (render items or instances).
+ * Built top-down with a binned surface area heuristic. Each node owns a contiguous range of the object
+ * permutation, so a subtree that lies fully inside the frustum is accepted with a single copy and a
+ * subtree fully outside any plane is rejected without visiting its children.
+ *
+ * Moving objects are handled by refitting: the topology stays, only the bounds grow or shrink. Refitting
+ * keeps culling correct but the tree gets looser as objects drift apart, so rebuild after large changes.
+ */
+class SceneBvh
+{
+public:
+	struct Node
+	{
+		DirectX::XMFLOAT3 Min;
+		UINT              Left;  // index of the first child, the second one is Left + 1; 0 for a leaf
+		DirectX::XMFLOAT3 Max;
+		UINT              First; // the subtree holds objects ObjectAt(First) .. ObjectAt(First + Count - 1)
+		UINT              Count;
+	};
+
+	struct CullStats
+	{
+		UINT NodesVisited  = 0; // nodes whose box was tested against the planes
+		UINT NodesAccepted = 0; // subtrees taken whole because they are inside every plane
+		UINT ObjectsTested = 0; // objects tested one by one in partially visible leaves
+	};
+
+	static constexpr UINT kStackSize = 64; // traversal stack entries; the build stops splitting deeper
+
+	// Builds the tree from scratch; object i keeps index i in every query.
+	void Build(const DirectX::BoundingBox* bounds, UINT count);
+
+	// Replaces the box of one object and refits its leaf and ancestors, stopping once a node is unchanged.
+	void UpdateBounds(UINT object, const DirectX::BoundingBox& box);
+
+	// Replaces the box of one object without touching the nodes; call Refit() after a batch of them.
+	void SetBounds(UINT object, const DirectX::BoundingBox& box);
+
+	// Recomputes every node from its children, bottom-up.
+	void Refit();
+
+	UINT ObjectCount() const { return (UINT)mObjectBounds.size(); }
+	UINT NodeCount() const { return (UINT)mNodes.size(); }
+	UINT ObjectAt(UINT slot) const { return mObjects[slot]; }
+
+	const Node& GetNode(UINT node) const { return mNodes[node]; }
+
+	/**
+	 * \brief Writes the indices of the objects that intersect the frustum, in tree order.
+	 * \param visible Receives up to ObjectCount() indices
+	 * \param stats Optional traversal counters
+	 * \return the number of visible objects
+	 */
+	UINT Cull(const FrustumCuller::Frustum& frustum, UINT* visible, CullStats* stats = nullptr) const;
+
+private:
+	static constexpr UINT kMaxLeafSize = 4;
+
+	struct Box
+	{
+		DirectX::XMFLOAT3 Min;
+		DirectX::XMFLOAT3 Max;
+	};
+
+	void Subdivide(UINT node, std::vector<DirectX::XMFLOAT3>& centroids, std::vector<UINT>& depths);
+	void FitNode(UINT node);
+
+private:
+	std::vector<Node> mNodes;
+	std::vector<UINT> mParents;      // parent of every node; the root is its own parent
+	std::vector<UINT> mObjects;      // permutation of object indices, leaves own contiguous ranges
+	std::vector<UINT> mObjectLeaves; // leaf node of every object
+	std::vector<Box>  mObjectBounds;
+};
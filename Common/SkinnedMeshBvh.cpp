@@ -0,0 +1,435 @@
+#include "SkinnedMeshBvh.h"
+#include "BvhUtil.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+constexpr UINT SkinnedMeshBvh::kNoCluster;
+constexpr UINT SkinnedMeshBvh::kVertexChunk;
+
+namespace
+{
+	// The box test's ray plus the direction, for the triangle test.
+	struct Ray : BvhUtil::Ray
+	{
+		XMFLOAT3 Direction;
+	};
+
+	// Moller-Trumbore, two-sided.
+	inline bool IntersectTriangle(const Ray& ray, FXMVECTOR v0, FXMVECTOR v1, FXMVECTOR v2, float tMax, float& t, float& u, float& v)
+	{
+		const XMVECTOR d   = XMLoadFloat3(&ray.Direction);
+		const XMVECTOR e1  = v1 - v0;
+		const XMVECTOR e2  = v2 - v0;
+		const XMVECTOR p   = XMVector3Cross(d, e2);
+		const float    det = XMVectorGetX(XMVector3Dot(e1, p));
+		if (fabsf(det) < 1e-12f)
+			return false;
+
+		const float    invDet = 1.0f / det;
+		const XMVECTOR s      = XMLoadFloat3(&ray.Origin) - v0;
+		u                     = XMVectorGetX(XMVector3Dot(s, p)) * invDet;
+		if (u < 0.0f || u > 1.0f)
+			return false;
+
+		const XMVECTOR q = XMVector3Cross(s, e1);
+		v                = XMVectorGetX(XMVector3Dot(d, q)) * invDet;
+		if (v < 0.0f || u + v > 1.0f)
+			return false;
+
+		t = XMVectorGetX(XMVector3Dot(e2, q)) * invDet;
+		return t > 0.0f && t < tMax;
+	}
+
+	inline void SetEmpty(TriangleBvh::Node& node)
+	{
+		node.Min = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		node.Max = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	}
+
+	inline void Grow(TriangleBvh::Node& node, FXMVECTOR min, FXMVECTOR max)
+	{
+		XMStoreFloat3(&node.Min, XMVectorMin(XMLoadFloat3(&node.Min), min));
+		XMStoreFloat3(&node.Max, XMVectorMax(XMLoadFloat3(&node.Max), max));
+	}
+
+	inline void FitInterior(std::vector<TriangleBvh::Node>& nodes, UINT node)
+	{
+		TriangleBvh::Node&       n     = nodes[node];
+		const TriangleBvh::Node& left  = nodes[n.LeftOrFirst];
+		const TriangleBvh::Node& right = nodes[n.LeftOrFirst + 1];
+		XMStoreFloat3(&n.Min, XMVectorMin(XMLoadFloat3(&left.Min), XMLoadFloat3(&right.Min)));
+		XMStoreFloat3(&n.Max, XMVectorMax(XMLoadFloat3(&left.Max), XMLoadFloat3(&right.Max)));
+	}
+}
+
+void SkinnedMeshBvh::Build(const XMFLOAT3* positions,
+                           const XMFLOAT3* boneWeights,
+                           const uint8_t*  boneIndices,
+                           UINT            vertexStride,
+                           UINT            vertexCount,
+                           const uint32_t* indices,
+                           UINT            indexCount,
+                           UINT            boneCount)
+{
+	mIndices.assign(indices, indices + indexCount);
+
+	mVertices.resize(vertexCount);
+	for (UINT i = 0; i < vertexCount; ++i)
+	{
+		const size_t offset = size_t(i) * vertexStride;
+		SkinVertex&  v      = mVertices[i];
+		v.Position          = *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const BYTE*>(positions) + offset);
+		v.Weights           = *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const BYTE*>(boneWeights) + offset);
+		memcpy(v.Bones, boneIndices + offset, sizeof(v.Bones));
+	}
+	mSkinned.resize(vertexCount);
+
+	mBoneTransforms.assign(boneCount, MathHelper::Identity4x4());
+	mPose      = 1;
+	mUpperPose = 0;
+
+	// The topology comes from a tree over the bind pose; leaves are rebased onto mTriangles.
+	TriangleBvh bindPose;
+	bindPose.Build(positions, vertexStride, vertexCount, indices, indexCount);
+
+	mNodes.resize(bindPose.NodeCount());
+	mTriangles.clear();
+	mTriangles.reserve(bindPose.TriangleCount());
+	for (UINT i = 0; i < bindPose.NodeCount(); ++i)
+	{
+		mNodes[i] = bindPose.GetNode(i);
+		if (mNodes[i].Count == 0)
+			continue;
+
+		const UINT first = (UINT)mTriangles.size();
+		for (UINT slot = mNodes[i].LeftOrFirst; slot < mNodes[i].LeftOrFirst + mNodes[i].Count; ++slot)
+			mTriangles.push_back(bindPose.TriangleAt(slot));
+		mNodes[i].LeftOrFirst = first;
+	}
+
+	mNodeClusters.assign(mNodes.size(), kNoCluster);
+	mUpperNodes.clear();
+	mClusters.clear();
+	mClusterNodes.clear();
+	mClusterVertices.clear();
+	mClusterBones.clear();
+
+	if (mNodes.empty())
+		return;
+
+	// Children always come after their parent, so a reverse sweep sums the triangles under every node.
+	std::vector<UINT> triangles(mNodes.size());
+	for (UINT i = (UINT)mNodes.size(); i-- > 0;)
+	{
+		const TriangleBvh::Node& n = mNodes[i];
+		triangles[i]               = n.Count > 0 ? n.Count : triangles[n.LeftOrFirst] + triangles[n.LeftOrFirst + 1];
+	}
+
+	// The highest nodes with few enough triangles become clusters; everything above them is an upper node.
+	std::vector<UINT> stack(1, 0);
+	while (!stack.empty())
+	{
+		const UINT node = stack.back();
+		stack.pop_back();
+
+		if (mNodes[node].Count > 0 || triangles[node] <= kClusterSize)
+		{
+			AddCluster(node);
+			continue;
+		}
+
+		mUpperNodes.push_back(node);
+		stack.push_back(mNodes[node].LeftOrFirst + 1);
+		stack.push_back(mNodes[node].LeftOrFirst);
+	}
+}
+
+void SkinnedMeshBvh::AddCluster(UINT root)
+{
+	Cluster cluster;
+	cluster.FirstNode   = (UINT)mClusterNodes.size();
+	cluster.FirstVertex = (UINT)mClusterVertices.size();
+	cluster.FirstBone   = (UINT)mClusterBones.size();
+	cluster.Pose        = 0;
+
+	// Breadth first, so every node comes before its children.
+	mClusterNodes.push_back(root);
+	for (UINT i = cluster.FirstNode; i < (UINT)mClusterNodes.size(); ++i)
+	{
+		const TriangleBvh::Node& n = mNodes[mClusterNodes[i]];
+		if (n.Count > 0)
+		{
+			for (UINT slot = n.LeftOrFirst; slot < n.LeftOrFirst + n.Count; ++slot)
+			{
+				const uint32_t* tri = &mIndices[3 * mTriangles[slot]];
+				mClusterVertices.insert(mClusterVertices.end(), tri, tri + 3);
+			}
+		}
+		else
+		{
+			mClusterNodes.push_back(n.LeftOrFirst);
+			mClusterNodes.push_back(n.LeftOrFirst + 1);
+		}
+	}
+	cluster.NodeCount = (UINT)mClusterNodes.size() - cluster.FirstNode;
+
+	auto firstVertex = mClusterVertices.begin() + cluster.FirstVertex;
+	std::sort(firstVertex, mClusterVertices.end());
+	mClusterVertices.erase(std::unique(firstVertex, mClusterVertices.end()), mClusterVertices.end());
+	cluster.VertexCount = (UINT)mClusterVertices.size() - cluster.FirstVertex;
+
+	// Bind pose bounds of the cluster vertices per bone that moves them.
+	std::vector<int>      boneSlots(mBoneTransforms.size(), -1);
+	std::vector<UINT>     bones;
+	std::vector<XMFLOAT3> mins, maxs;
+	for (UINT i = cluster.FirstVertex; i < cluster.FirstVertex + cluster.VertexCount; ++i)
+	{
+		const SkinVertex& v          = mVertices[mClusterVertices[i]];
+		const float       weights[4] = {v.Weights.x, v.Weights.y, v.Weights.z, 1.0f - v.Weights.x - v.Weights.y - v.Weights.z};
+		for (int j = 0; j < 4; ++j)
+		{
+			if (weights[j] <= 0.0f)
+				continue;
+
+			int& slot = boneSlots[v.Bones[j]];
+			if (slot < 0)
+			{
+				slot = (int)bones.size();
+				bones.push_back(v.Bones[j]);
+				mins.push_back(v.Position);
+				maxs.push_back(v.Position);
+			}
+			XMStoreFloat3(&mins[slot], XMVectorMin(XMLoadFloat3(&mins[slot]), XMLoadFloat3(&v.Position)));
+			XMStoreFloat3(&maxs[slot], XMVectorMax(XMLoadFloat3(&maxs[slot]), XMLoadFloat3(&v.Position)));
+		}
+	}
+
+	for (size_t i = 0; i < bones.size(); ++i)
+	{
+		BoneBounds b;
+		b.Bone = bones[i];
+		XMStoreFloat3(&b.Center, 0.5f * (XMLoadFloat3(&mins[i]) + XMLoadFloat3(&maxs[i])));
+		XMStoreFloat3(&b.Extents, 0.5f * (XMLoadFloat3(&maxs[i]) - XMLoadFloat3(&mins[i])));
+		mClusterBones.push_back(b);
+	}
+	cluster.BoneCount = (UINT)bones.size();
+
+	mNodeClusters[root] = (UINT)mClusters.size();
+	mClusters.push_back(cluster);
+}
+
+void SkinnedMeshBvh::SetPose(const XMFLOAT4X4* boneTransforms)
+{
+	std::copy(boneTransforms, boneTransforms + mBoneTransforms.size(), mBoneTransforms.begin());
+	++mPose;
+}
+
+void SkinnedMeshBvh::BoundCluster(const Cluster& cluster)
+{
+	// Union of the bone boxes, each moved by its bone: the new center plus the extents through |M|.
+	TriangleBvh::Node& root = mNodes[mClusterNodes[cluster.FirstNode]];
+	SetEmpty(root);
+	for (UINT i = cluster.FirstBone; i < cluster.FirstBone + cluster.BoneCount; ++i)
+	{
+		const BoneBounds& b = mClusterBones[i];
+		const XMMATRIX    M = XMLoadFloat4x4(&mBoneTransforms[b.Bone]);
+
+		const XMVECTOR center  = XMVector3Transform(XMLoadFloat3(&b.Center), M);
+		const XMVECTOR extents = XMVectorAbs(M.r[0]) * XMVectorSplatX(XMLoadFloat3(&b.Extents)) +
+		                         XMVectorAbs(M.r[1]) * XMVectorSplatY(XMLoadFloat3(&b.Extents)) +
+		                         XMVectorAbs(M.r[2]) * XMVectorSplatZ(XMLoadFloat3(&b.Extents));
+		Grow(root, center - extents, center + extents);
+	}
+}
+
+void SkinnedMeshBvh::SkinPosition(UINT index)
+{
+	// Same blend as the vertex shader.
+	const SkinVertex& v          = mVertices[index];
+	const float       weights[4] = {v.Weights.x, v.Weights.y, v.Weights.z, 1.0f - v.Weights.x - v.Weights.y - v.Weights.z};
+	const XMVECTOR    p          = XMLoadFloat3(&v.Position);
+
+	XMVECTOR skinned = XMVectorZero();
+	for (int j = 0; j < 4; ++j)
+		skinned += weights[j] * XMVector3Transform(p, XMLoadFloat4x4(&mBoneTransforms[v.Bones[j]]));
+	XMStoreFloat3(&mSkinned[index], skinned);
+}
+
+void SkinnedMeshBvh::SkinCluster(Cluster& cluster)
+{
+	for (UINT i = cluster.FirstVertex; i < cluster.FirstVertex + cluster.VertexCount; ++i)
+		SkinPosition(mClusterVertices[i]);
+	FitCluster(cluster);
+}
+
+void SkinnedMeshBvh::FitCluster(Cluster& cluster)
+{
+	// Exact bounds, bottom-up.
+	for (UINT i = cluster.FirstNode + cluster.NodeCount; i-- > cluster.FirstNode;)
+	{
+		const UINT         node = mClusterNodes[i];
+		TriangleBvh::Node& n    = mNodes[node];
+		if (n.Count == 0)
+		{
+			FitInterior(mNodes, node);
+			continue;
+		}
+
+		SetEmpty(n);
+		for (UINT slot = n.LeftOrFirst; slot < n.LeftOrFirst + n.Count; ++slot)
+		{
+			const uint32_t* tri = &mIndices[3 * mTriangles[slot]];
+			for (int c = 0; c < 3; ++c)
+				Grow(n, XMLoadFloat3(&mSkinned[tri[c]]), XMLoadFloat3(&mSkinned[tri[c]]));
+		}
+	}
+
+	cluster.Pose = mPose;
+}
+
+void SkinnedMeshBvh::FitUpperNodes()
+{
+	for (UINT i = (UINT)mUpperNodes.size(); i-- > 0;)
+		FitInterior(mNodes, mUpperNodes[i]);
+	mUpperPose = mPose;
+}
+
+void SkinnedMeshBvh::Refit(UINT threadCount)
+{
+	// Clusters already skinned for this pose keep their exact bounds.
+	ParallelFor((UINT)mClusters.size(), threadCount, [&](UINT cluster)
+	{
+		if (mClusters[cluster].Pose != mPose)
+			BoundCluster(mClusters[cluster]);
+	});
+	FitUpperNodes();
+}
+
+void SkinnedMeshBvh::SkinAll(UINT threadCount)
+{
+	// Clusters share the vertices on their borders, so vertices are skinned in ranges of their own before
+	// any cluster reads them for its bounds.
+	const UINT vertexCount = (UINT)mVertices.size();
+	ParallelFor((vertexCount + kVertexChunk - 1) / kVertexChunk, threadCount, [&](UINT chunk)
+	{
+		const UINT end = std::min(vertexCount, (chunk + 1) * kVertexChunk);
+		for (UINT v = chunk * kVertexChunk; v < end; ++v)
+			SkinPosition(v);
+	});
+
+	ParallelFor((UINT)mClusters.size(), threadCount, [&](UINT cluster)
+	{
+		if (mClusters[cluster].Pose != mPose)
+			FitCluster(mClusters[cluster]);
+	});
+	FitUpperNodes();
+}
+
+bool SkinnedMeshBvh::Intersect(FXMVECTOR origin, FXMVECTOR direction, float tMax, TriangleBvh::Hit& hit, QueryStats* stats)
+{
+	if (mNodes.empty())
+		return false;
+
+	// A single query touches few clusters; threads would cost more than they save.
+	if (mUpperPose != mPose)
+		Refit(1);
+
+	Ray ray;
+	XMStoreFloat3(&ray.Origin, origin);
+	XMStoreFloat3(&ray.Direction, direction);
+	ray.InvDirection = XMFLOAT3(BvhUtil::SafeInverse(ray.Direction.x), BvhUtil::SafeInverse(ray.Direction.y), BvhUtil::SafeInverse(ray.Direction.z));
+
+	QueryStats       counters;
+	float            closest = tMax;
+	bool             found   = false;
+	TriangleBvh::Hit best;
+
+	struct Entry
+	{
+		UINT  Node;
+		float T;
+	};
+
+	// Entry distances are taken from bounds that only ever shrink when a cluster is skinned, so they stay
+	// conservative for the pruning below. The topology is a TriangleBvh's, whose build caps the depth.
+	Entry stack[TriangleBvh::kStackSize];
+	UINT  stackSize = 0;
+
+	float entry = 0.0f;
+	if (BvhUtil::IntersectBox(ray, mNodes[0], closest, entry))
+		stack[stackSize++] = {0, entry};
+	++counters.NodesVisited;
+
+	while (stackSize > 0)
+	{
+		const Entry e = stack[--stackSize];
+		if (e.T >= closest)
+			continue;
+
+		// Entering a cluster: skin it now that the ray reaches it.
+		const UINT cluster = mNodeClusters[e.Node];
+		if (cluster != kNoCluster && mClusters[cluster].Pose != mPose)
+		{
+			SkinCluster(mClusters[cluster]);
+			++counters.ClustersSkinned;
+			counters.VerticesSkinned += mClusters[cluster].VertexCount;
+		}
+
+		const TriangleBvh::Node& n = mNodes[e.Node];
+		if (n.Count > 0)
+		{
+			counters.TrianglesTested += n.Count;
+			for (UINT slot = n.LeftOrFirst; slot < n.LeftOrFirst + n.Count; ++slot)
+			{
+				const uint32_t* tri = &mIndices[3 * mTriangles[slot]];
+
+				float t, u, v;
+				if (IntersectTriangle(ray, XMLoadFloat3(&mSkinned[tri[0]]), XMLoadFloat3(&mSkinned[tri[1]]), XMLoadFloat3(&mSkinned[tri[2]]), closest, t, u, v))
+				{
+					found         = true;
+					closest       = t;
+					best.T        = t;
+					best.U        = u;
+					best.V        = v;
+					best.Triangle = mTriangles[slot];
+				}
+			}
+			continue;
+		}
+
+		float      leftEntry, rightEntry;
+		const UINT left     = n.LeftOrFirst;
+		const bool hitLeft  = BvhUtil::IntersectBox(ray, mNodes[left], closest, leftEntry);
+		const bool hitRight = BvhUtil::IntersectBox(ray, mNodes[left + 1], closest, rightEntry);
+		counters.NodesVisited += 2;
+
+		// Push the farther child first so the nearer one is visited next.
+		if (hitLeft && hitRight)
+		{
+			const bool leftFirst = leftEntry <= rightEntry;
+			stack[stackSize++]   = leftFirst ? Entry{left + 1, rightEntry} : Entry{left, leftEntry};
+			stack[stackSize++]   = leftFirst ? Entry{left, leftEntry} : Entry{left + 1, rightEntry};
+		}
+		else if (hitLeft)
+		{
+			stack[stackSize++] = {left, leftEntry};
+		}
+		else if (hitRight)
+		{
+			stack[stackSize++] = {left + 1, rightEntry};
+		}
+	}
+
+	if (stats != nullptr)
+	{
+		stats->NodesVisited    += counters.NodesVisited;
+		stats->TrianglesTested += counters.TrianglesTested;
+		stats->ClustersSkinned += counters.ClustersSkinned;
+		stats->VerticesSkinned += counters.VerticesSkinned;
+	}
+
+	if (found)
+		hit = best;
+	return found;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "TriangleBvh.h"
+
+/**
+ * \brief Ray queries against a skinned mesh in its current pose, without skinning the whole mesh on the CPU.
+ *
+ * The tree is built once over the bind pose. Subtrees of up to kClusterSize triangles form clusters, and every
+ * cluster keeps the bind pose bounds of its vertices per influencing bone. A skinned position is a weighted
+ * average of the vertex moved by each of its bones, so the union of those boxes moved by their bones bounds
+ * the cluster in any pose.
+ *
+ * A query refits the tree above the clusters with those bounds, then skins only the clusters the ray reaches,
+ * refits them bottom-up with their exact bounds and tests their triangles. The work is cached until the next
+ * SetPose(), and nothing is computed until a query is made, so posing every frame only copies the bone
+ * transforms. SkinAll() does the whole mesh up front instead: every vertex once, a range of vertices per job,
+ * then a cluster per job for the bounds, since clusters share the vertices on their borders.
+ *
+ * Queries update the caches, so they are not thread-safe.
+ */
+class SkinnedMeshBvh
+{
+public:
+	struct QueryStats
+	{
+		UINT NodesVisited    = 0;
+		UINT TrianglesTested = 0;
+		UINT ClustersSkinned = 0;
+		UINT VerticesSkinned = 0;
+	};
+
+	static constexpr UINT kClusterSize = 64;
+
+	/**
+	 * \brief Builds the tree over the bind pose.
+	 * \param positions, boneWeights, boneIndices Elements of the first vertex; consecutive vertices are vertexStride
+	 * bytes apart. As in the vertex shader, three weights are stored and the fourth is one minus their sum.
+	 */
+	void Build(const DirectX::XMFLOAT3* positions,
+	           const DirectX::XMFLOAT3* boneWeights,
+	           const uint8_t*           boneIndices,
+	           UINT                     vertexStride,
+	           UINT                     vertexCount,
+	           const uint32_t*          indices,
+	           UINT                     indexCount,
+	           UINT                     boneCount);
+
+	// Poses the mesh for the next queries with the bone transforms sent to the vertex shader. Only copies them.
+	void SetPose(const DirectX::XMFLOAT4X4* boneTransforms);
+
+	// Refits the tree above the clusters to the current pose, a cluster per job. Queries do it on demand.
+	void Refit(UINT threadCount);
+
+	// Skins every vertex and refits the whole tree to the current pose.
+	void SkinAll(UINT threadCount);
+
+	// Closest hit with 0 < t < tMax against the posed mesh, in the space of the bone transforms.
+	bool Intersect(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, TriangleBvh::Hit& hit, QueryStats* stats = nullptr);
+
+	UINT TriangleCount() const { return (UINT)mIndices.size() / 3; }
+	UINT VertexCount() const { return (UINT)mVertices.size(); }
+	UINT ClusterCount() const { return (UINT)mClusters.size(); }
+
+private:
+	static constexpr UINT kNoCluster   = ~0u;
+	static constexpr UINT kVertexChunk = 1024; // vertices per SkinAll() job
+
+	struct SkinVertex
+	{
+		DirectX::XMFLOAT3 Position;
+		DirectX::XMFLOAT3 Weights;
+		uint8_t           Bones[4];
+	};
+
+	struct BoneBounds
+	{
+		DirectX::XMFLOAT3 Center; // bind pose box of the cluster vertices the bone moves
+		UINT              Bone;
+		DirectX::XMFLOAT3 Extents;
+	};
+
+	struct Cluster
+	{
+		UINT FirstNode;   // into mClusterNodes, parents before children; the first one is the cluster root
+		UINT NodeCount;
+		UINT FirstVertex; // into mClusterVertices
+		UINT VertexCount;
+		UINT FirstBone;   // into mClusterBones
+		UINT BoneCount;
+		UINT Pose;        // pose the vertices were skinned for
+	};
+
+	void AddCluster(UINT root);
+	void BoundCluster(const Cluster& cluster);
+	void SkinPosition(UINT index);
+	void SkinCluster(Cluster& cluster);
+	void FitCluster(Cluster& cluster);
+	void FitUpperNodes();
+
+private:
+	std::vector<TriangleBvh::Node>   mNodes;           // bind pose topology; leaves index mTriangles
+	std::vector<UINT>                mTriangles;       // mesh triangle of every leaf slot
+	std::vector<uint32_t>            mIndices;
+	std::vector<SkinVertex>          mVertices;
+	std::vector<DirectX::XMFLOAT3>   mSkinned;         // posed positions, valid for the vertices of up to date clusters
+	std::vector<UINT>                mNodeClusters;    // cluster rooted at every node, kNoCluster elsewhere
+	std::vector<UINT>                mUpperNodes;      // nodes above the clusters, parents before children
+	std::vector<Cluster>             mClusters;
+	std::vector<UINT>                mClusterNodes;
+	std::vector<UINT>                mClusterVertices;
+	std::vector<BoneBounds>          mClusterBones;
+	std::vector<DirectX::XMFLOAT4X4> mBoneTransforms;
+	UINT                             mPose      = 1;
+	UINT                             mUpperPose = 0;   // pose the upper nodes were refitted for
+};
@@ -0,0 +1,185 @@
+#include "TangentGenerator.h"
+#include "ParallelFor.h"
+#include <cmath>
+
+using namespace DirectX;
+
+constexpr UINT TangentGenerator::kChunkSize;
+
+namespace
+{
+	// Angle between two edges leaving a corner; atan2 stays accurate for nearly flat corners.
+	float CornerAngle(FXMVECTOR a, FXMVECTOR b)
+	{
+		return atan2f(XMVectorGetX(XMVector3Length(XMVector3Cross(a, b))), XMVectorGetX(XMVector3Dot(a, b)));
+	}
+}
+
+XMVECTOR XM_CALLCONV TangentGenerator::PerpendicularTo(FXMVECTOR n)
+{
+	const XMVECTOR up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	if (fabsf(XMVectorGetX(XMVector3Dot(n, up))) < 1.0f - 0.001f)
+		return XMVector3Normalize(XMVector3Cross(up, n));
+	return XMVector3Normalize(XMVector3Cross(n, XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f)));
+}
+
+template <typename Index>
+TangentGenerator::Report TangentGenerator::GenerateTangents(const VertexStreams& vertices, const Index* indices, UINT indexCount, XMFLOAT3* tangentUs,
+                                                            float* handedness, UINT threadCount)
+{
+	assert(vertices.Positions != nullptr && vertices.Normals != nullptr && tangentUs != nullptr);
+
+	const UINT vertexCount   = vertices.VertexCount;
+	const UINT triangleCount = indexCount / 3;
+
+	Report report;
+	report.VertexCount   = vertexCount;
+	report.TriangleCount = triangleCount;
+
+	// Unit directions of growing u and v per triangle, zero where the triangle adds nothing, and the angle
+	// at each of its corners. Each triangle writes only its own slots.
+	std::vector<XMFLOAT3> faceTangents(triangleCount);
+	std::vector<XMFLOAT3> faceBitangents(triangleCount);
+	std::vector<float>    cornerAngles((size_t)triangleCount * 3);
+	std::vector<UINT>     skipped((triangleCount + kChunkSize - 1) / kChunkSize, 0);
+	ParallelFor((UINT)skipped.size(), threadCount, [&](UINT chunk)
+	{
+		const UINT end = std::min(triangleCount, (chunk + 1) * kChunkSize);
+		for (UINT t = chunk * kChunkSize; t < end; ++t)
+		{
+			const uint32_t i0 = indices[t * 3 + 0];
+			const uint32_t i1 = indices[t * 3 + 1];
+			const uint32_t i2 = indices[t * 3 + 2];
+			const XMVECTOR p0 = XMLoadFloat3(&vertices.At(vertices.Positions, i0));
+			const XMVECTOR p1 = XMLoadFloat3(&vertices.At(vertices.Positions, i1));
+			const XMVECTOR p2 = XMLoadFloat3(&vertices.At(vertices.Positions, i2));
+			const XMVECTOR e1 = p1 - p0;
+			const XMVECTOR e2 = p2 - p0;
+
+			cornerAngles[t * 3 + 0] = CornerAngle(e1, e2);
+			cornerAngles[t * 3 + 1] = CornerAngle(p2 - p1, -e1);
+			cornerAngles[t * 3 + 2] = CornerAngle(-e2, p1 - p2);
+
+			XMVECTOR tangent   = XMVectorZero();
+			XMVECTOR bitangent = XMVectorZero();
+			if (vertices.TexCoords != nullptr)
+			{
+				const XMFLOAT2& uv0 = vertices.At(vertices.TexCoords, i0);
+				const XMFLOAT2& uv1 = vertices.At(vertices.TexCoords, i1);
+				const XMFLOAT2& uv2 = vertices.At(vertices.TexCoords, i2);
+				const float     du1 = uv1.x - uv0.x;
+				const float     dv1 = uv1.y - uv0.y;
+				const float     du2 = uv2.x - uv0.x;
+				const float     dv2 = uv2.y - uv0.y;
+				const float     det = du1 * dv2 - du2 * dv1;
+
+				// T = (e1 dv2 - e2 dv1) / det and B = (e2 du1 - e1 du2) / det; only the directions are kept.
+				const float sign = det < 0.0f ? -1.0f : 1.0f;
+				tangent          = sign * (e1 * dv2 - e2 * dv1);
+				bitangent        = sign * (e2 * du1 - e1 * du2);
+				if (det != 0.0f && XMVectorGetX(XMVector3LengthSq(tangent)) > 0.0f && XMVectorGetX(XMVector3LengthSq(bitangent)) > 0.0f &&
+				    XMVectorGetX(XMVector3LengthSq(XMVector3Cross(e1, e2))) > 0.0f)
+				{
+					tangent   = XMVector3Normalize(tangent);
+					bitangent = XMVector3Normalize(bitangent);
+				}
+				else
+				{
+					tangent   = XMVectorZero();
+					bitangent = XMVectorZero();
+				}
+			}
+
+			if (XMVector3Equal(tangent, XMVectorZero()))
+				++skipped[chunk];
+			XMStoreFloat3(&faceTangents[t], tangent);
+			XMStoreFloat3(&faceBitangents[t], bitangent);
+		}
+	});
+	for (UINT count : skipped)
+		report.SkippedTriangles += count;
+
+	// The corners of every vertex, in triangle order, so every vertex sums in the same order on any thread.
+	std::vector<uint32_t> firstCorner(vertexCount + 1, 0);
+	std::vector<uint32_t> corners(triangleCount * 3);
+	for (UINT c = 0; c < triangleCount * 3; ++c)
+		++firstCorner[indices[c] + 1];
+	for (UINT v = 0; v < vertexCount; ++v)
+		firstCorner[v + 1] += firstCorner[v];
+	{
+		std::vector<uint32_t> next(firstCorner.begin(), firstCorner.end() - 1);
+		for (UINT c = 0; c < triangleCount * 3; ++c)
+			corners[next[indices[c]]++] = c;
+	}
+
+	const UINT        chunkCount = (vertexCount + kChunkSize - 1) / kChunkSize;
+	std::vector<UINT> fallbacks(chunkCount, 0);
+	std::vector<UINT> mirrored(chunkCount, 0);
+	ParallelFor(chunkCount, threadCount, [&](UINT chunk)
+	{
+		const UINT end = std::min(vertexCount, (chunk + 1) * kChunkSize);
+		for (UINT v = chunk * kChunkSize; v < end; ++v)
+		{
+			XMVECTOR tangent   = XMVectorZero();
+			XMVECTOR bitangent = XMVectorZero();
+			for (uint32_t c = firstCorner[v]; c < firstCorner[v + 1]; ++c)
+			{
+				const uint32_t corner = corners[c];
+				const XMVECTOR weight = XMVectorReplicate(cornerAngles[corner]);
+				tangent               = XMVectorMultiplyAdd(weight, XMLoadFloat3(&faceTangents[corner / 3]), tangent);
+				bitangent             = XMVectorMultiplyAdd(weight, XMLoadFloat3(&faceBitangents[corner / 3]), bitangent);
+			}
+
+			// Gram-Schmidt against the normal; opposing directions across a seam can cancel to nothing.
+			const XMVECTOR normal = XMVector3Normalize(XMLoadFloat3(&vertices.At(vertices.Normals, v)));
+			tangent               = tangent - XMVector3Dot(tangent, normal) * normal;
+			float sign            = 1.0f;
+			if (XMVectorGetX(XMVector3LengthSq(tangent)) > 1e-12f)
+			{
+				tangent = XMVector3Normalize(tangent);
+				if (XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), bitangent)) < 0.0f)
+				{
+					sign = -1.0f;
+					++mirrored[chunk];
+				}
+			}
+			else
+			{
+				tangent = PerpendicularTo(normal);
+				++fallbacks[chunk];
+			}
+
+			XMStoreFloat3(&VertexStreams::At(tangentUs, vertices.Stride, v), tangent);
+			if (handedness != nullptr)
+				handedness[v] = sign;
+		}
+	});
+	for (UINT c = 0; c < chunkCount; ++c)
+	{
+		report.FallbackVertices += fallbacks[c];
+		report.MirroredVertices += mirrored[c];
+	}
+
+	return report;
+}
+
+TangentGenerator::Report TangentGenerator::Generate(const VertexStreams& vertices, const uint16_t* indices, UINT indexCount, XMFLOAT3* tangentUs,
+                                                    float* handedness, UINT threadCount)
+{
+	return GenerateTangents(vertices, indices, indexCount, tangentUs, handedness, threadCount);
+}
+
+TangentGenerator::Report TangentGenerator::Generate(const VertexStreams& vertices, const uint32_t* indices, UINT indexCount, XMFLOAT3* tangentUs,
+                                                    float* handedness, UINT threadCount)
+{
+	return GenerateTangents(vertices, indices, indexCount, tangentUs, handedness, threadCount);
+}
+
+TangentGenerator::Report TangentGenerator::Generate(GeometryGenerator::MeshData& mesh, UINT threadCount)
+{
+	if (mesh.Vertices.empty())
+		return Report();
+
+	return Generate(VertexStreams::Describe(mesh), mesh.Indices32.data(), (UINT)mesh.Indices32.size(), &mesh.Vertices[0].TangentU, nullptr,
+	                threadCount);
+}
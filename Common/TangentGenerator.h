@@ -0,0 +1,59 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+#include "VertexStreams.h"
+
+/**
+ * \brief Builds the TangentU of every vertex of an indexed triangle list from its positions, normals and
+ * texture coordinates, for meshes loaded without tangents.
+ *
+ * Every triangle gets the unit directions in which u and v grow across it. A vertex sums them over its
+ * triangles, weighted by the angle of the triangle at the vertex, so long thin triangles do not pull the
+ * basis over, then removes the normal from the u direction (Gram-Schmidt). The handedness is -1 where
+ * the v direction points against cross(N, T), as on mirrored texture halves. Triangles without area in
+ * position or texture space add nothing, and a vertex left with no usable direction gets a tangent from
+ * its normal alone, around the y axis as the demos have always built it for the skull. That is all a
+ * mesh without texture coordinates needs to take a flat normal map.
+ *
+ * Triangles are handled in parallel, each writing only its own slots; vertices then gather from a list
+ * of their corners built in triangle order, in parallel, each writing only itself. No two jobs write the
+ * same memory and every sum runs in the same order, so the result is bit for bit the same on any number
+ * of threads.
+ */
+class TangentGenerator
+{
+public:
+	static constexpr UINT kChunkSize = 1024; // triangles or vertices per job
+
+	struct Report
+	{
+		UINT VertexCount      = 0;
+		UINT TriangleCount    = 0;
+		UINT SkippedTriangles = 0; // without area in position or texture space
+		UINT FallbackVertices = 0; // tangent from the normal alone
+		UINT MirroredVertices = 0; // handedness -1
+	};
+
+	/**
+	 * \brief Writes the tangents from indexCount indices on up to threadCount threads (0 = one per hardware thread).
+	 * \param vertices Reads Positions, Normals and TexCoords; null TexCoords give every vertex a tangent from its normal.
+	 * \param tangentUs TangentU of the first vertex; the others are vertices.Stride bytes apart, usually in the same buffer.
+	 * \param handedness If not null, receives +1 or -1 per vertex: the bitangent is handedness * cross(N, T).
+	 */
+	static Report Generate(const VertexStreams& vertices, const uint16_t* indices, UINT indexCount, DirectX::XMFLOAT3* tangentUs,
+	                       float* handedness = nullptr, UINT threadCount = 0);
+	static Report Generate(const VertexStreams& vertices, const uint32_t* indices, UINT indexCount, DirectX::XMFLOAT3* tangentUs,
+	                       float* handedness = nullptr, UINT threadCount = 0);
+
+	// Rebuilds the TangentU of a generated or loaded mesh.
+	static Report Generate(GeometryGenerator::MeshData& mesh, UINT threadCount = 0);
+
+	// A unit vector perpendicular to the unit vector n: cross(y, n), or cross(n, z) where n is close to y.
+	static DirectX::XMVECTOR XM_CALLCONV PerpendicularTo(DirectX::FXMVECTOR n);
+
+private:
+	template <typename Index>
+	static Report GenerateTangents(const VertexStreams& vertices, const Index* indices, UINT indexCount, DirectX::XMFLOAT3* tangentUs, float* handedness,
+	                               UINT threadCount);
+};
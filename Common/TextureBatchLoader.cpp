@@ -0,0 +1,162 @@
+#include "TextureBatchLoader.h"
+#include "ParallelFor.h"
+#include <chrono>
+
+using Microsoft::WRL::ComPtr;
+using namespace DirectX;
+
+TextureBatchLoader::TextureBatchLoader(ID3D12Device* device) :
+	md3dDevice(device)
+{
+}
+
+void TextureBatchLoader::Add(Texture* texture, DDS_LOADER_FLAGS flags)
+{
+	PendingTexture pending;
+	pending.Target = texture;
+	pending.Flags  = flags;
+	mPending.push_back(std::move(pending));
+}
+
+ComPtr<ID3D12Resource> TextureBatchLoader::Load(ID3D12GraphicsCommandList* cmdList, UINT maxThreads)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	const UINT textureCount = (UINT)mPending.size();
+	const UINT threadCount  = ResolveThreadCount(maxThreads, textureCount);
+
+	mStats              = Stats();
+	mStats.TextureCount = textureCount;
+	mStats.ThreadCount  = threadCount;
+
+	if (textureCount == 0)
+		return nullptr;
+
+	//
+	// Read, parse and create the default heap textures in parallel. ID3D12Device is free threaded.
+	//
+	ParallelFor(textureCount, threadCount, [this](UINT i)
+	{
+		PendingTexture& pending = mPending[i];
+		pending.Result          = LoadDDSTextureFromFileEx(md3dDevice,
+		                                                   pending.Target->Filename.c_str(),
+		                                                   0,
+		                                                   D3D12_RESOURCE_FLAG_NONE,
+		                                                   pending.Flags,
+		                                                   pending.Resource.GetAddressOf(),
+		                                                   pending.FileData,
+		                                                   pending.Subresources);
+	});
+
+	// Report failures on the calling thread, where ThrowIfFailed can be caught.
+	for (const auto& pending : mPending)
+	{
+		if (FAILED(pending.Result))
+			throw DxException(pending.Result,
+			                  L"LoadDDSTextureFromFileEx(" + pending.Target->Filename + L")",
+			                  AnsiToWString(__FILE__),
+			                  __LINE__);
+	}
+
+	auto loaded             = std::chrono::high_resolution_clock::now();
+	mStats.LoadMilliseconds = std::chrono::duration<double, std::milli>(loaded - start).count();
+
+	//
+	// Suballocate every subresource from one upload buffer.
+	//
+	UINT64 uploadBytes = 0;
+	for (auto& pending : mPending)
+	{
+		const UINT numSubresources = (UINT)pending.Subresources.size();
+		pending.Footprints.resize(numSubresources);
+		pending.NumRows.resize(numSubresources);
+		pending.RowSizes.resize(numSubresources);
+
+		// Each texture starts at a placement aligned offset; the footprints inside it are aligned by D3D.
+		const UINT64 alignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
+		uploadBytes            = (uploadBytes + alignment - 1) & ~(alignment - 1);
+
+		D3D12_RESOURCE_DESC desc       = pending.Resource->GetDesc();
+		UINT64              totalBytes = 0;
+		md3dDevice->GetCopyableFootprints(&desc,
+		                                  0,
+		                                  numSubresources,
+		                                  uploadBytes,
+		                                  pending.Footprints.data(),
+		                                  pending.NumRows.data(),
+		                                  pending.RowSizes.data(),
+		                                  &totalBytes);
+
+		uploadBytes += totalBytes;
+		mStats.Subresources += numSubresources;
+	}
+	mStats.UploadHeapBytes = uploadBytes;
+
+	ComPtr<ID3D12Resource> uploadHeap;
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		              &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		              D3D12_HEAP_FLAG_NONE,
+		              &CD3DX12_RESOURCE_DESC::Buffer(uploadBytes),
+		              D3D12_RESOURCE_STATE_GENERIC_READ,
+		              nullptr,
+		              IID_PPV_ARGS(&uploadHeap)));
+
+	//
+	// Fill the upload buffer in parallel; the textures write disjoint ranges.
+	//
+	BYTE* mappedData = nullptr;
+	ThrowIfFailed(uploadHeap->Map(0, nullptr, reinterpret_cast<void**>(&mappedData)));
+
+	ParallelFor(textureCount, threadCount, [this, mappedData](UINT i)
+	{
+		PendingTexture& pending = mPending[i];
+		for (size_t j = 0; j < pending.Subresources.size(); ++j)
+		{
+			const auto&       footprint = pending.Footprints[j];
+			D3D12_MEMCPY_DEST dest      = {mappedData + footprint.Offset,
+			                               footprint.Footprint.RowPitch,
+			                               SIZE_T(footprint.Footprint.RowPitch) * pending.NumRows[j]};
+			MemcpySubresource(&dest,
+			                  &pending.Subresources[j],
+			                  (SIZE_T)pending.RowSizes[j],
+			                  pending.NumRows[j],
+			                  footprint.Footprint.Depth);
+		}
+
+		// The pixel data now lives in the upload heap.
+		pending.FileData.reset();
+	});
+
+	uploadHeap->Unmap(0, nullptr);
+
+	//
+	// Record all copies, then transition every texture with a single barrier call.
+	//
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	barriers.reserve(textureCount);
+
+	for (auto& pending : mPending)
+	{
+		for (UINT j = 0; j < (UINT)pending.Footprints.size(); ++j)
+		{
+			CD3DX12_TEXTURE_COPY_LOCATION dst(pending.Resource.Get(), j);
+			CD3DX12_TEXTURE_COPY_LOCATION src(uploadHeap.Get(), pending.Footprints[j]);
+			cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+		}
+
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(pending.Resource.Get(),
+		                                                        D3D12_RESOURCE_STATE_COPY_DEST,
+		                                                        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+		pending.Target->Resource   = pending.Resource;
+		pending.Target->UploadHeap = uploadHeap;
+	}
+
+	cmdList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+
+	auto end                  = std::chrono::high_resolution_clock::now();
+	mStats.RecordMilliseconds = std::chrono::duration<double, std::milli>(end - loaded).count();
+
+	mPending.clear();
+	return uploadHeap;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "d3dUtil.h"
+
+/**
+ * \brief Loads a batch of DDS textures with one shared upload heap.
+ * The files are read and parsed on worker threads (each worker also creates the default heap textures),
+ * then every subresource is suballocated from a single upload buffer, filled in parallel, and all copies
+ * and barriers are recorded on the command list in one pass.
+ *
+ * Usage:
+ *		TextureBatchLoader loader(md3dDevice.Get());
+ *		for (auto& tex : mTextures)
+ *			loader.Add(tex.second.get());
+ *		loader.Load(mCommandList.Get());
+ *
+ * Load() fills Texture::Resource and points every Texture::UploadHeap at the shared upload buffer, so the
+ * usual rule applies: keep the textures' upload heaps alive until the command list has executed.
+ */
+class TextureBatchLoader
+{
+public:
+	struct Stats
+	{
+		UINT   TextureCount       = 0;
+		UINT   Subresources       = 0;
+		UINT   ThreadCount        = 0;
+		UINT64 UploadHeapBytes    = 0;
+		double LoadMilliseconds   = 0.0; // read + parse + create textures
+		double RecordMilliseconds = 0.0; // fill the upload heap + record copies
+	};
+
+	explicit TextureBatchLoader(ID3D12Device* device);
+
+	TextureBatchLoader(const TextureBatchLoader& rhs)            = delete;
+	TextureBatchLoader& operator=(const TextureBatchLoader& rhs) = delete;
+
+	// Queues a texture; its Filename must be set. Resource and UploadHeap are filled by Load().
+	// flags go to LoadDDSTextureFromFileEx, e.g. DDS_LOADER_GENERATE_MIPS for files without a full chain.
+	void Add(Texture* texture, DirectX::DDS_LOADER_FLAGS flags = DirectX::DDS_LOADER_DEFAULT);
+
+	/**
+	 * \brief Loads every queued texture and records the uploads on cmdList.
+	 * \param cmdList Open command list that receives the copies and the transitions to PIXEL_SHADER_RESOURCE
+	 * \param maxThreads Upper bound on worker threads (0 = one per hardware thread)
+	 * \return the shared upload buffer (also stored in each Texture::UploadHeap)
+	 */
+	Microsoft::WRL::ComPtr<ID3D12Resource> Load(ID3D12GraphicsCommandList* cmdList, UINT maxThreads = 0);
+
+	const Stats& GetStats() const { return mStats; }
+
+private:
+	struct PendingTexture
+	{
+		Texture*                               Target = nullptr;
+		DirectX::DDS_LOADER_FLAGS              Flags  = DirectX::DDS_LOADER_DEFAULT;
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		std::unique_ptr<uint8_t[]>             FileData;
+		std::vector<D3D12_SUBRESOURCE_DATA>    Subresources;
+		HRESULT                                Result = S_OK;
+
+		// Placement of every subresource inside the shared upload buffer.
+		std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Footprints;
+		std::vector<UINT>                               NumRows;
+		std::vector<UINT64>                             RowSizes;
+	};
+
+private:
+	ID3D12Device*               md3dDevice = nullptr;
+	std::vector<PendingTexture> mPending;
+	Stats                       mStats;
+};
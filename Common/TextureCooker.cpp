@@ -0,0 +1,1277 @@
+#include "TextureCooker.h"
+#include "ParallelFor.h"
+#include <chrono>
+#include <cfloat>
+#include <cwctype>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+	//
+	// DDS output structures (see DDS.h in DirectXTex).
+	//
+#pragma pack(push, 1)
+	struct DdsPixelFormat
+	{
+		uint32_t Size;
+		uint32_t Flags;
+		uint32_t FourCC;
+		uint32_t RGBBitCount;
+		uint32_t RBitMask;
+		uint32_t GBitMask;
+		uint32_t BBitMask;
+		uint32_t ABitMask;
+	};
+
+	struct DdsHeader
+	{
+		uint32_t       Size;
+		uint32_t       Flags;
+		uint32_t       Height;
+		uint32_t       Width;
+		uint32_t       PitchOrLinearSize;
+		uint32_t       Depth;
+		uint32_t       MipMapCount;
+		uint32_t       Reserved1[11];
+		DdsPixelFormat PixelFormat;
+		uint32_t       Caps;
+		uint32_t       Caps2;
+		uint32_t       Caps3;
+		uint32_t       Caps4;
+		uint32_t       Reserved2;
+	};
+
+	struct DdsHeaderDxt10
+	{
+		uint32_t DxgiFormat;
+		uint32_t ResourceDimension;
+		uint32_t MiscFlag;
+		uint32_t ArraySize;
+		uint32_t MiscFlags2;
+	};
+#pragma pack(pop)
+
+	static_assert(sizeof(DdsHeader) == 124, "DDS header size mismatch");
+	static_assert(sizeof(DdsHeaderDxt10) == 20, "DDS DX10 header size mismatch");
+
+	constexpr uint32_t kDdsMagic           = 0x20534444; // "DDS "
+	constexpr uint32_t kFourCCDX10         = 0x30315844; // "DX10"
+	constexpr uint32_t kPixelFormatFourCC  = 0x4;
+	constexpr uint32_t kHeaderFlags        = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps|height|width|pixelformat|mipcount|linearsize
+	constexpr uint32_t kCapsTexture        = 0x1000;
+	constexpr uint32_t kCapsComplex        = 0x8;
+	constexpr uint32_t kCapsMipMap         = 0x400000;
+	constexpr uint32_t kCaps2CubeMap       = 0xFE00; // cube map with all faces
+	constexpr uint32_t kMiscTextureCube    = 0x4;
+	constexpr uint32_t kDimensionTexture2D = 3;
+
+	// BC7 interpolation weights for 2 and 4-bit indices (out of 64).
+	constexpr uint32_t kBC7Weights2[4]  = {0, 21, 43, 64};
+	constexpr uint32_t kBC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+	float SrgbToLinear(float c)
+	{
+		return c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+	}
+
+	float LinearToSrgb(float c)
+	{
+		return c <= 0.0031308f ? c * 12.92f : 1.055f * powf(c, 1.0f / 2.4f) - 0.055f;
+	}
+
+	bool IsSrgb(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	UINT BlockBytes(TextureCooker::BlockFormat format)
+	{
+		return format == TextureCooker::BlockFormat::BC1 ? 8 : 16;
+	}
+
+	DXGI_FORMAT ToDxgiFormat(TextureCooker::BlockFormat format, bool srgb)
+	{
+		switch (format)
+		{
+		case TextureCooker::BlockFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+		case TextureCooker::BlockFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+		case TextureCooker::BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+		case TextureCooker::BlockFormat::BC7: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
+	uint8_t ToUnorm8(float v)
+	{
+		return (uint8_t)(MathHelper::Clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+	}
+
+	//
+	// Bit packing for BC7.
+	//
+	struct BitWriter
+	{
+		uint8_t* Data     = nullptr;
+		UINT     Position = 0;
+
+		void Write(uint32_t value, UINT bits)
+		{
+			for (UINT i = 0; i < bits; ++i, ++Position)
+			{
+				if ((value >> i) & 1)
+					Data[Position >> 3] |= uint8_t(1 << (Position & 7));
+			}
+		}
+	};
+
+	struct BitReader
+	{
+		const uint8_t* Data     = nullptr;
+		UINT           Position = 0;
+
+		uint32_t Read(UINT bits)
+		{
+			uint32_t value = 0;
+			for (UINT i = 0; i < bits; ++i, ++Position)
+				value |= uint32_t((Data[Position >> 3] >> (Position & 7)) & 1) << i;
+			return value;
+		}
+	};
+
+	//
+	// Shared encoder pieces. A block is kept both as 16 vectors (for endpoint fitting) and
+	// as structure-of-arrays (for index selection, 4 texels per vector op).
+	//
+	struct BlockSoA
+	{
+		alignas(16) float Channel[4][16];
+	};
+
+	void ToSoA(const XMVECTOR texels[16], BlockSoA& soa)
+	{
+		for (UINT i = 0; i < 16; ++i)
+		{
+			XMFLOAT4 t;
+			XMStoreFloat4(&t, texels[i]);
+			soa.Channel[0][i] = t.x;
+			soa.Channel[1][i] = t.y;
+			soa.Channel[2][i] = t.z;
+			soa.Channel[3][i] = t.w;
+		}
+	}
+
+	// Picks the closest palette entry for every texel; returns the summed squared error.
+	float SelectIndices(const BlockSoA& soa, const XMFLOAT4* palette, UINT paletteSize, UINT channels, uint8_t indices[16])
+	{
+		XMVECTOR totalError = XMVectorZero();
+
+		for (UINT group = 0; group < 4; ++group)
+		{
+			XMVECTOR values[4];
+			for (UINT c = 0; c < channels; ++c)
+				values[c] = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&soa.Channel[c][4 * group]));
+
+			XMVECTOR bestError = XMVectorReplicate(FLT_MAX);
+			XMVECTOR bestIndex = XMVectorZero();
+
+			for (UINT p = 0; p < paletteSize; ++p)
+			{
+				const float* entry = &palette[p].x;
+
+				XMVECTOR error = XMVectorZero();
+				for (UINT c = 0; c < channels; ++c)
+				{
+					XMVECTOR diff = XMVectorSubtract(values[c], XMVectorReplicate(entry[c]));
+					error         = XMVectorMultiplyAdd(diff, diff, error);
+				}
+
+				XMVECTOR closer = XMVectorLess(error, bestError);
+				bestError       = XMVectorSelect(bestError, error, closer);
+				bestIndex       = XMVectorSelect(bestIndex, XMVectorReplicate((float)p), closer);
+			}
+
+			totalError = XMVectorAdd(totalError, bestError);
+
+			XMFLOAT4A index;
+			XMStoreFloat4A(&index, bestIndex);
+			indices[4 * group + 0] = (uint8_t)index.x;
+			indices[4 * group + 1] = (uint8_t)index.y;
+			indices[4 * group + 2] = (uint8_t)index.z;
+			indices[4 * group + 3] = (uint8_t)index.w;
+		}
+
+		XMFLOAT4 sum;
+		XMStoreFloat4(&sum, totalError);
+		return sum.x + sum.y + sum.z + sum.w;
+	}
+
+	// Endpoints at the extremes of the block's principal axis (PCA by power iteration).
+	void FitEndpoints(const XMVECTOR texels[16], XMVECTOR& lo, XMVECTOR& hi)
+	{
+		XMVECTOR mean   = XMVectorZero();
+		XMVECTOR minVal = texels[0];
+		XMVECTOR maxVal = texels[0];
+		for (UINT i = 0; i < 16; ++i)
+		{
+			mean   = XMVectorAdd(mean, texels[i]);
+			minVal = XMVectorMin(minVal, texels[i]);
+			maxVal = XMVectorMax(maxVal, texels[i]);
+		}
+		mean = XMVectorScale(mean, 1.0f / 16.0f);
+
+		XMVECTOR axis = XMVectorSubtract(maxVal, minVal);
+		if (XMVectorGetX(XMVector4LengthSq(axis)) < 1e-10f)
+		{
+			lo = hi = mean;
+			return;
+		}
+
+		XMMATRIX covariance(XMVectorZero(), XMVectorZero(), XMVectorZero(), XMVectorZero());
+		for (UINT i = 0; i < 16; ++i)
+		{
+			XMVECTOR d      = XMVectorSubtract(texels[i], mean);
+			covariance.r[0] = XMVectorMultiplyAdd(d, XMVectorSplatX(d), covariance.r[0]);
+			covariance.r[1] = XMVectorMultiplyAdd(d, XMVectorSplatY(d), covariance.r[1]);
+			covariance.r[2] = XMVectorMultiplyAdd(d, XMVectorSplatZ(d), covariance.r[2]);
+			covariance.r[3] = XMVectorMultiplyAdd(d, XMVectorSplatW(d), covariance.r[3]);
+		}
+
+		axis = XMVector4Normalize(axis);
+		for (UINT iteration = 0; iteration < 4; ++iteration)
+		{
+			XMVECTOR next = XMVector4Transform(axis, covariance);
+			if (XMVectorGetX(XMVector4LengthSq(next)) < 1e-12f)
+				break;
+			axis = XMVector4Normalize(next);
+		}
+
+		float tMin = FLT_MAX, tMax = -FLT_MAX;
+		for (UINT i = 0; i < 16; ++i)
+		{
+			float t = XMVectorGetX(XMVector4Dot(XMVectorSubtract(texels[i], mean), axis));
+			tMin    = std::min(tMin, t);
+			tMax    = std::max(tMax, t);
+		}
+
+		lo = XMVectorSaturate(XMVectorMultiplyAdd(axis, XMVectorReplicate(tMin), mean));
+		hi = XMVectorSaturate(XMVectorMultiplyAdd(axis, XMVectorReplicate(tMax), mean));
+	}
+
+	// Solves for the endpoints a, b minimising sum |(1 - w) a + w b - texel|^2 for fixed weights.
+	bool LeastSquaresEndpoints(const XMVECTOR texels[16], const float weights[16], XMVECTOR& a, XMVECTOR& b)
+	{
+		float    aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		XMVECTOR ax = XMVectorZero();
+		XMVECTOR bx = XMVectorZero();
+		for (UINT i = 0; i < 16; ++i)
+		{
+			float w = weights[i];
+			float u = 1.0f - w;
+			aa += u * u;
+			ab += u * w;
+			bb += w * w;
+			ax = XMVectorMultiplyAdd(texels[i], XMVectorReplicate(u), ax);
+			bx = XMVectorMultiplyAdd(texels[i], XMVectorReplicate(w), bx);
+		}
+
+		float det = aa * bb - ab * ab;
+		if (fabsf(det) < 1e-6f)
+			return false;
+
+		float invDet = 1.0f / det;
+		a            = XMVectorSaturate(XMVectorScale(XMVectorSubtract(XMVectorScale(ax, bb), XMVectorScale(bx, ab)), invDet));
+		b            = XMVectorSaturate(XMVectorScale(XMVectorSubtract(XMVectorScale(bx, aa), XMVectorScale(ax, ab)), invDet));
+		return true;
+	}
+
+	uint16_t Pack565(FXMVECTOR color)
+	{
+		XMFLOAT4 c;
+		XMStoreFloat4(&c, XMVectorSaturate(color));
+		uint32_t r = (uint32_t)(c.x * 31.0f + 0.5f);
+		uint32_t g = (uint32_t)(c.y * 63.0f + 0.5f);
+		uint32_t b = (uint32_t)(c.z * 31.0f + 0.5f);
+		return uint16_t((r << 11) | (g << 5) | b);
+	}
+
+	void Unpack565(uint16_t color, uint32_t rgb[3])
+	{
+		uint32_t r = (color >> 11) & 31;
+		uint32_t g = (color >> 5) & 63;
+		uint32_t b = color & 31;
+		rgb[0]     = (r << 3) | (r >> 2);
+		rgb[1]     = (g << 2) | (g >> 4);
+		rgb[2]     = (b << 3) | (b >> 2);
+	}
+
+	// BC1 colour block (always written in 4-colour mode, which BC3 also uses).
+	void EncodeColorBlock(const XMFLOAT4 texels[16], uint8_t block[8])
+	{
+		XMVECTOR colors[16];
+		for (UINT i = 0; i < 16; ++i)
+			colors[i] = XMVectorSetW(XMLoadFloat4(&texels[i]), 0.0f);
+
+		BlockSoA soa;
+		ToSoA(colors, soa);
+
+		XMVECTOR lo, hi;
+		FitEndpoints(colors, lo, hi);
+
+		float bestError = FLT_MAX;
+		for (UINT iteration = 0; iteration < 2; ++iteration)
+		{
+			uint16_t c0 = Pack565(hi);
+			uint16_t c1 = Pack565(lo);
+			if (c0 < c1)
+				std::swap(c0, c1);
+
+			uint32_t e0[3], e1[3];
+			Unpack565(c0, e0);
+			Unpack565(c1, e1);
+
+			XMFLOAT4 palette[4];
+			for (UINT k = 0; k < 4; ++k)
+			{
+				float* p = &palette[k].x;
+				for (UINT c = 0; c < 3; ++c)
+				{
+					uint32_t v = k == 0 ? e0[c] : k == 1 ? e1[c] : k == 2 ? (2 * e0[c] + e1[c]) / 3 : (e0[c] + 2 * e1[c]) / 3;
+					p[c]       = v / 255.0f;
+				}
+				palette[k].w = 0.0f;
+			}
+
+			// Equal endpoints would decode in 3-colour mode, where only index 0 is safe.
+			uint8_t indices[16];
+			float   error = SelectIndices(soa, palette, c0 == c1 ? 1 : 4, 3, indices);
+
+			if (error < bestError)
+			{
+				bestError = error;
+
+				uint32_t bits = 0;
+				for (UINT i = 0; i < 16; ++i)
+					bits |= uint32_t(indices[i]) << (2 * i);
+
+				block[0] = uint8_t(c0 & 0xFF);
+				block[1] = uint8_t(c0 >> 8);
+				block[2] = uint8_t(c1 & 0xFF);
+				block[3] = uint8_t(c1 >> 8);
+				block[4] = uint8_t(bits & 0xFF);
+				block[5] = uint8_t((bits >> 8) & 0xFF);
+				block[6] = uint8_t((bits >> 16) & 0xFF);
+				block[7] = uint8_t(bits >> 24);
+			}
+
+			// Refit the endpoints to the chosen indices and try once more.
+			if (c0 == c1)
+				break;
+
+			const float weightOf[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+			float       weights[16];
+			for (UINT i = 0; i < 16; ++i)
+				weights[i] = weightOf[indices[i]];
+
+			if (!LeastSquaresEndpoints(colors, weights, hi, lo))
+				break;
+		}
+	}
+
+	void DecodeColorBlock(const uint8_t* block, bool forceFourColor, XMFLOAT4 texels[16])
+	{
+		uint16_t c0   = uint16_t(block[0] | (block[1] << 8));
+		uint16_t c1   = uint16_t(block[2] | (block[3] << 8));
+		uint32_t bits = uint32_t(block[4]) | (uint32_t(block[5]) << 8) | (uint32_t(block[6]) << 16) | (uint32_t(block[7]) << 24);
+
+		uint32_t e0[3], e1[3];
+		Unpack565(c0, e0);
+		Unpack565(c1, e1);
+
+		XMFLOAT4 palette[4];
+		bool     fourColor = forceFourColor || c0 > c1;
+		for (UINT k = 0; k < 4; ++k)
+		{
+			float* p = &palette[k].x;
+			for (UINT c = 0; c < 3; ++c)
+			{
+				uint32_t v;
+				if (k < 2)
+					v = k == 0 ? e0[c] : e1[c];
+				else if (fourColor)
+					v = k == 2 ? (2 * e0[c] + e1[c]) / 3 : (e0[c] + 2 * e1[c]) / 3;
+				else
+					v = k == 2 ? (e0[c] + e1[c]) / 2 : 0;
+				p[c] = v / 255.0f;
+			}
+			palette[k].w = (!fourColor && k == 3) ? 0.0f : 1.0f;
+		}
+
+		for (UINT i = 0; i < 16; ++i)
+			texels[i] = palette[(bits >> (2 * i)) & 3];
+	}
+
+	void DecodeBC4Block(const uint8_t* block, float values[16])
+	{
+		uint32_t e0 = block[0];
+		uint32_t e1 = block[1];
+
+		float palette[8];
+		palette[0] = e0 / 255.0f;
+		palette[1] = e1 / 255.0f;
+		if (e0 > e1)
+		{
+			for (UINT i = 2; i < 8; ++i)
+				palette[i] = (((8 - i) * e0 + (i - 1) * e1) / 7) / 255.0f;
+		}
+		else
+		{
+			for (UINT i = 2; i < 6; ++i)
+				palette[i] = (((6 - i) * e0 + (i - 1) * e1) / 5) / 255.0f;
+			palette[6] = 0.0f;
+			palette[7] = 1.0f;
+		}
+
+		uint64_t bits = 0;
+		for (UINT i = 0; i < 6; ++i)
+			bits |= uint64_t(block[2 + i]) << (8 * i);
+
+		for (UINT i = 0; i < 16; ++i)
+			values[i] = palette[(bits >> (3 * i)) & 7];
+	}
+
+	// Decodes the two single-subset modes EncodeBC7 writes: mode 5 (separate alpha) and mode 6.
+	bool DecodeBC7Block(const uint8_t* block, XMFLOAT4 texels[16])
+	{
+		BitReader reader;
+		reader.Data = block;
+
+		if ((block[0] & 0x7F) == 0x40)
+		{
+			reader.Position = 7;
+
+			uint32_t endpoints[2][4];
+			for (UINT c = 0; c < 4; ++c)
+			{
+				endpoints[0][c] = reader.Read(7);
+				endpoints[1][c] = reader.Read(7);
+			}
+
+			uint32_t pbits[2];
+			pbits[0] = reader.Read(1);
+			pbits[1] = reader.Read(1);
+			for (UINT e = 0; e < 2; ++e)
+			{
+				for (UINT c = 0; c < 4; ++c)
+					endpoints[e][c] = (endpoints[e][c] << 1) | pbits[e];
+			}
+
+			for (UINT i = 0; i < 16; ++i)
+			{
+				uint32_t index = reader.Read(i == 0 ? 3 : 4);
+				uint32_t w     = kBC7Weights4[index];
+				float*   t     = &texels[i].x;
+				for (UINT c = 0; c < 4; ++c)
+					t[c] = (((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6) / 255.0f;
+			}
+
+			return true;
+		}
+
+		if ((block[0] & 0x3F) == 0x20)
+		{
+			reader.Position   = 6;
+			uint32_t rotation = reader.Read(2);
+
+			uint32_t endpoints[2][4];
+			for (UINT c = 0; c < 3; ++c)
+			{
+				endpoints[0][c] = reader.Read(7);
+				endpoints[1][c] = reader.Read(7);
+				endpoints[0][c] = (endpoints[0][c] << 1) | (endpoints[0][c] >> 6);
+				endpoints[1][c] = (endpoints[1][c] << 1) | (endpoints[1][c] >> 6);
+			}
+			endpoints[0][3] = reader.Read(8);
+			endpoints[1][3] = reader.Read(8);
+
+			uint32_t colorIndices[16], alphaIndices[16];
+			for (UINT i = 0; i < 16; ++i)
+				colorIndices[i] = reader.Read(i == 0 ? 1 : 2);
+			for (UINT i = 0; i < 16; ++i)
+				alphaIndices[i] = reader.Read(i == 0 ? 1 : 2);
+
+			for (UINT i = 0; i < 16; ++i)
+			{
+				float* t = &texels[i].x;
+				for (UINT c = 0; c < 4; ++c)
+				{
+					uint32_t w = kBC7Weights2[c == 3 ? alphaIndices[i] : colorIndices[i]];
+					t[c]       = (((64 - w) * endpoints[0][c] + w * endpoints[1][c] + 32) >> 6) / 255.0f;
+				}
+				if (rotation != 0)
+					std::swap(t[3], t[rotation - 1]);
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	// 7-bit endpoint plus shared p-bit, picking the p-bit with the smaller error.
+	void QuantizeBC7Endpoint(FXMVECTOR endpoint, uint32_t quantized[4], uint32_t& pbit)
+	{
+		XMFLOAT4 v;
+		XMStoreFloat4(&v, XMVectorSaturate(endpoint));
+		const float* values = &v.x;
+
+		float bestError = FLT_MAX;
+		for (uint32_t p = 0; p < 2; ++p)
+		{
+			uint32_t candidate[4];
+			float    error = 0.0f;
+			for (UINT c = 0; c < 4; ++c)
+			{
+				float target = values[c] * 255.0f;
+				int   q      = (int)floorf((target - p) * 0.5f + 0.5f);
+				candidate[c] = (uint32_t)MathHelper::Clamp(q, 0, 127);
+				float diff   = float((candidate[c] << 1) | p) - target;
+				error += diff * diff;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				pbit      = p;
+				for (UINT c = 0; c < 4; ++c)
+					quantized[c] = candidate[c];
+			}
+		}
+	}
+
+	// Mode 6: RGBA endpoints with 7 bits + p-bit and 4-bit indices. Returns the squared error.
+	float EncodeBC7Mode6(const XMVECTOR colors[16], const BlockSoA& soa, uint8_t block[16])
+	{
+		XMVECTOR lo, hi;
+		FitEndpoints(colors, lo, hi);
+
+		float    bestError = FLT_MAX;
+		uint32_t bestEndpoints[2][4];
+		uint32_t bestPbits[2];
+		uint8_t  bestIndices[16];
+
+		for (UINT iteration = 0; iteration < 2; ++iteration)
+		{
+			uint32_t endpoints[2][4];
+			uint32_t pbits[2];
+			QuantizeBC7Endpoint(lo, endpoints[0], pbits[0]);
+			QuantizeBC7Endpoint(hi, endpoints[1], pbits[1]);
+
+			XMFLOAT4 palette[16];
+			for (UINT k = 0; k < 16; ++k)
+			{
+				uint32_t w = kBC7Weights4[k];
+				float*   p = &palette[k].x;
+				for (UINT c = 0; c < 4; ++c)
+				{
+					uint32_t a = (endpoints[0][c] << 1) | pbits[0];
+					uint32_t b = (endpoints[1][c] << 1) | pbits[1];
+					p[c]       = (((64 - w) * a + w * b + 32) >> 6) / 255.0f;
+				}
+			}
+
+			uint8_t indices[16];
+			float   error = SelectIndices(soa, palette, 16, 4, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+				memcpy(bestPbits, pbits, sizeof(pbits));
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+
+			float weights[16];
+			for (UINT i = 0; i < 16; ++i)
+				weights[i] = kBC7Weights4[indices[i]] / 64.0f;
+
+			if (!LeastSquaresEndpoints(colors, weights, lo, hi))
+				break;
+		}
+
+		// The anchor (texel 0) index is stored without its top bit, so it must be < 8.
+		if (bestIndices[0] & 8)
+		{
+			for (UINT c = 0; c < 4; ++c)
+				std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+			std::swap(bestPbits[0], bestPbits[1]);
+			for (UINT i = 0; i < 16; ++i)
+				bestIndices[i] = uint8_t(15 - bestIndices[i]);
+		}
+
+		memset(block, 0, 16);
+		BitWriter writer;
+		writer.Data = block;
+		writer.Write(1 << 6, 7); // mode 6
+		for (UINT c = 0; c < 4; ++c)
+		{
+			writer.Write(bestEndpoints[0][c], 7);
+			writer.Write(bestEndpoints[1][c], 7);
+		}
+		writer.Write(bestPbits[0], 1);
+		writer.Write(bestPbits[1], 1);
+		for (UINT i = 0; i < 16; ++i)
+			writer.Write(bestIndices[i], i == 0 ? 3 : 4);
+
+		return bestError;
+	}
+
+	// Mode 5 without channel rotation: RGB with 7-bit endpoints and 2-bit indices, alpha with its own
+	// 8-bit endpoints and 2-bit indices. Returns the squared error.
+	float EncodeBC7Mode5(const XMVECTOR colors[16], const BlockSoA& soa, uint8_t block[16])
+	{
+		XMVECTOR rgb[16];
+		for (UINT i = 0; i < 16; ++i)
+			rgb[i] = XMVectorSetW(colors[i], 0.0f);
+
+		XMVECTOR lo, hi;
+		FitEndpoints(rgb, lo, hi);
+
+		float    colorError = FLT_MAX;
+		uint32_t colorEndpoints[2][3];
+		uint8_t  colorIndices[16];
+
+		for (UINT iteration = 0; iteration < 2; ++iteration)
+		{
+			uint32_t endpoints[2][3];
+			XMFLOAT4 ends[2];
+			XMStoreFloat4(&ends[0], XMVectorSaturate(lo));
+			XMStoreFloat4(&ends[1], XMVectorSaturate(hi));
+			for (UINT e = 0; e < 2; ++e)
+			{
+				const float* v = &ends[e].x;
+				for (UINT c = 0; c < 3; ++c)
+					endpoints[e][c] = (uint32_t)(v[c] * 127.0f + 0.5f);
+			}
+
+			XMFLOAT4 palette[4];
+			for (UINT k = 0; k < 4; ++k)
+			{
+				uint32_t w = kBC7Weights2[k];
+				float*   p = &palette[k].x;
+				for (UINT c = 0; c < 3; ++c)
+				{
+					uint32_t a = (endpoints[0][c] << 1) | (endpoints[0][c] >> 6);
+					uint32_t b = (endpoints[1][c] << 1) | (endpoints[1][c] >> 6);
+					p[c]       = (((64 - w) * a + w * b + 32) >> 6) / 255.0f;
+				}
+				palette[k].w = 0.0f;
+			}
+
+			uint8_t indices[16];
+			float   error = SelectIndices(soa, palette, 4, 3, indices);
+			if (error < colorError)
+			{
+				colorError = error;
+				memcpy(colorEndpoints, endpoints, sizeof(endpoints));
+				memcpy(colorIndices, indices, sizeof(indices));
+			}
+
+			float weights[16];
+			for (UINT i = 0; i < 16; ++i)
+				weights[i] = kBC7Weights2[indices[i]] / 64.0f;
+
+			if (!LeastSquaresEndpoints(rgb, weights, lo, hi))
+				break;
+		}
+
+		// Alpha: min/max endpoints, indices picked on the alpha channel alone.
+		float minAlpha = soa.Channel[3][0], maxAlpha = soa.Channel[3][0];
+		for (UINT i = 1; i < 16; ++i)
+		{
+			minAlpha = std::min(minAlpha, soa.Channel[3][i]);
+			maxAlpha = std::max(maxAlpha, soa.Channel[3][i]);
+		}
+
+		uint32_t alphaEndpoints[2] = {ToUnorm8(minAlpha), ToUnorm8(maxAlpha)};
+		XMFLOAT4 alphaPalette[4]   = {};
+		for (UINT k = 0; k < 4; ++k)
+		{
+			uint32_t w        = kBC7Weights2[k];
+			alphaPalette[k].x = (((64 - w) * alphaEndpoints[0] + w * alphaEndpoints[1] + 32) >> 6) / 255.0f;
+		}
+
+		BlockSoA alphaSoa;
+		memcpy(alphaSoa.Channel[0], soa.Channel[3], sizeof(alphaSoa.Channel[0]));
+
+		uint8_t alphaIndices[16];
+		float   alphaError = SelectIndices(alphaSoa, alphaPalette, 4, 1, alphaIndices);
+
+		// Anchor indices drop their top bit.
+		if (colorIndices[0] & 2)
+		{
+			for (UINT c = 0; c < 3; ++c)
+				std::swap(colorEndpoints[0][c], colorEndpoints[1][c]);
+			for (UINT i = 0; i < 16; ++i)
+				colorIndices[i] = uint8_t(3 - colorIndices[i]);
+		}
+		if (alphaIndices[0] & 2)
+		{
+			std::swap(alphaEndpoints[0], alphaEndpoints[1]);
+			for (UINT i = 0; i < 16; ++i)
+				alphaIndices[i] = uint8_t(3 - alphaIndices[i]);
+		}
+
+		memset(block, 0, 16);
+		BitWriter writer;
+		writer.Data = block;
+		writer.Write(1 << 5, 6); // mode 5
+		writer.Write(0, 2);      // no rotation
+		for (UINT c = 0; c < 3; ++c)
+		{
+			writer.Write(colorEndpoints[0][c], 7);
+			writer.Write(colorEndpoints[1][c], 7);
+		}
+		writer.Write(alphaEndpoints[0], 8);
+		writer.Write(alphaEndpoints[1], 8);
+		for (UINT i = 0; i < 16; ++i)
+			writer.Write(colorIndices[i], i == 0 ? 1 : 2);
+		for (UINT i = 0; i < 16; ++i)
+			writer.Write(alphaIndices[i], i == 0 ? 1 : 2);
+
+		return colorError + alphaError;
+	}
+
+	TextureCooker::Image ConcatenateImages(const std::vector<const TextureCooker::Image*>& images)
+	{
+		TextureCooker::Image result;
+		for (const auto* image : images)
+		{
+			result.Width = image->Width;
+			result.Height += image->Height;
+			result.Texels.insert(result.Texels.end(), image->Texels.begin(), image->Texels.end());
+		}
+		return result;
+	}
+}
+
+void TextureCooker::EncodeBC1(const XMFLOAT4 texels[16], uint8_t block[8])
+{
+	EncodeColorBlock(texels, block);
+}
+
+void TextureCooker::EncodeBC3(const XMFLOAT4 texels[16], uint8_t block[16])
+{
+	float alpha[16];
+	for (UINT i = 0; i < 16; ++i)
+		alpha[i] = texels[i].w;
+
+	EncodeBC4(alpha, block);
+	EncodeColorBlock(texels, block + 8);
+}
+
+void TextureCooker::EncodeBC4(const float values[16], uint8_t block[8])
+{
+	float minValue = values[0], maxValue = values[0];
+	for (UINT i = 1; i < 16; ++i)
+	{
+		minValue = std::min(minValue, values[i]);
+		maxValue = std::max(maxValue, values[i]);
+	}
+
+	uint32_t e0 = ToUnorm8(maxValue);
+	uint32_t e1 = ToUnorm8(minValue);
+	block[0]    = uint8_t(e0);
+	block[1]    = uint8_t(e1);
+
+	uint8_t indices[16] = {};
+	if (e0 != e1)
+	{
+		// e0 > e1 selects the 8-value interpolation mode.
+		XMFLOAT4 palette[8] = {};
+		palette[0].x        = e0 / 255.0f;
+		palette[1].x        = e1 / 255.0f;
+		for (UINT i = 2; i < 8; ++i)
+			palette[i].x = (((8 - i) * e0 + (i - 1) * e1) / 7) / 255.0f;
+
+		BlockSoA soa;
+		for (UINT i = 0; i < 16; ++i)
+			soa.Channel[0][i] = values[i];
+
+		SelectIndices(soa, palette, 8, 1, indices);
+	}
+
+	uint64_t bits = 0;
+	for (UINT i = 0; i < 16; ++i)
+		bits |= uint64_t(indices[i]) << (3 * i);
+
+	for (UINT i = 0; i < 6; ++i)
+		block[2 + i] = uint8_t((bits >> (8 * i)) & 0xFF);
+}
+
+void TextureCooker::EncodeBC5(const XMFLOAT4 texels[16], uint8_t block[16])
+{
+	float red[16], green[16];
+	for (UINT i = 0; i < 16; ++i)
+	{
+		red[i]   = texels[i].x;
+		green[i] = texels[i].y;
+	}
+
+	EncodeBC4(red, block);
+	EncodeBC4(green, block + 8);
+}
+
+void TextureCooker::EncodeBC7(const XMFLOAT4 texels[16], uint8_t block[16])
+{
+	XMVECTOR colors[16];
+	bool     opaque = true;
+	for (UINT i = 0; i < 16; ++i)
+	{
+		colors[i] = XMLoadFloat4(&texels[i]);
+		opaque &= texels[i].w >= 254.5f / 255.0f;
+	}
+
+	BlockSoA soa;
+	ToSoA(colors, soa);
+
+	// Mode 6 ties alpha to the colour line; mode 5 gives alpha its own endpoints and indices.
+	float error = EncodeBC7Mode6(colors, soa, block);
+	if (!opaque)
+	{
+		uint8_t mode5[16];
+		if (EncodeBC7Mode5(colors, soa, mode5) < error)
+			memcpy(block, mode5, sizeof(mode5));
+	}
+}
+
+bool TextureCooker::Decode(DXGI_FORMAT format, const uint8_t* data, size_t rowPitch, UINT width, UINT height, Image& image)
+{
+	image.Width  = width;
+	image.Height = height;
+	image.Texels.assign(size_t(width) * height, XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f));
+
+	auto texel = [&image](UINT x, UINT y) -> XMFLOAT4& { return image.Texels[size_t(y) * image.Width + x]; };
+
+	switch (format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+	{
+		bool bgr    = format != DXGI_FORMAT_R8G8B8A8_UNORM && format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		bool opaque = format == DXGI_FORMAT_B8G8R8X8_UNORM || format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+		for (UINT y = 0; y < height; ++y)
+		{
+			const uint8_t* row = data + y * rowPitch;
+			for (UINT x = 0; x < width; ++x)
+			{
+				const uint8_t* p = row + 4 * x;
+				texel(x, y)      = XMFLOAT4((bgr ? p[2] : p[0]) / 255.0f,
+				                            p[1] / 255.0f,
+				                            (bgr ? p[0] : p[2]) / 255.0f,
+				                            opaque ? 1.0f : p[3] / 255.0f);
+			}
+		}
+		return true;
+	}
+	case DXGI_FORMAT_R8G8_UNORM:
+	case DXGI_FORMAT_R8_UNORM:
+	{
+		UINT channels = format == DXGI_FORMAT_R8G8_UNORM ? 2 : 1;
+		for (UINT y = 0; y < height; ++y)
+		{
+			const uint8_t* row = data + y * rowPitch;
+			for (UINT x = 0; x < width; ++x)
+			{
+				const uint8_t* p = row + channels * x;
+				texel(x, y)      = XMFLOAT4(p[0] / 255.0f, channels == 2 ? p[1] / 255.0f : 0.0f, 0.0f, 1.0f);
+			}
+		}
+		return true;
+	}
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+		for (UINT y = 0; y < height; ++y)
+		{
+			const HALF* row = reinterpret_cast<const HALF*>(data + y * rowPitch);
+			for (UINT x = 0; x < width; ++x)
+			{
+				XMStoreFloat4(&texel(x, y), XMLoadHalf4(reinterpret_cast<const XMHALF4*>(row + 4 * x)));
+			}
+		}
+		return true;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		for (UINT y = 0; y < height; ++y)
+			memcpy(&texel(0, y), data + y * rowPitch, sizeof(XMFLOAT4) * width);
+		return true;
+	default:
+		break;
+	}
+
+	// Block compressed formats.
+	UINT blockBytes;
+	switch (format)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_UNORM:
+		blockBytes = 8;
+		break;
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		blockBytes = 16;
+		break;
+	default:
+		return false;
+	}
+
+	const UINT blocksX = std::max(1u, (width + 3) / 4);
+	const UINT blocksY = std::max(1u, (height + 3) / 4);
+	for (UINT by = 0; by < blocksY; ++by)
+	{
+		for (UINT bx = 0; bx < blocksX; ++bx)
+		{
+			const uint8_t* block = data + by * rowPitch + bx * blockBytes;
+			XMFLOAT4       texels[16];
+			float          values[16];
+
+			switch (format)
+			{
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+				DecodeColorBlock(block, false, texels);
+				break;
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+				DecodeColorBlock(block + 8, true, texels);
+				for (UINT i = 0; i < 16; ++i)
+					texels[i].w = ((block[i / 2] >> (4 * (i & 1))) & 0xF) / 15.0f;
+				break;
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+				DecodeColorBlock(block + 8, true, texels);
+				DecodeBC4Block(block, values);
+				for (UINT i = 0; i < 16; ++i)
+					texels[i].w = values[i];
+				break;
+			case DXGI_FORMAT_BC4_UNORM:
+				DecodeBC4Block(block, values);
+				for (UINT i = 0; i < 16; ++i)
+					texels[i] = XMFLOAT4(values[i], 0.0f, 0.0f, 1.0f);
+				break;
+			case DXGI_FORMAT_BC5_UNORM:
+				DecodeBC4Block(block, values);
+				for (UINT i = 0; i < 16; ++i)
+					texels[i] = XMFLOAT4(values[i], 0.0f, 0.0f, 1.0f);
+				DecodeBC4Block(block + 8, values);
+				for (UINT i = 0; i < 16; ++i)
+					texels[i].y = values[i];
+				break;
+			default:
+				if (!DecodeBC7Block(block, texels))
+					return false;
+				break;
+			}
+
+			for (UINT i = 0; i < 16; ++i)
+			{
+				UINT x = bx * 4 + (i & 3);
+				UINT y = by * 4 + (i >> 2);
+				if (x < width && y < height)
+					texel(x, y) = texels[i];
+			}
+		}
+	}
+
+	return true;
+}
+
+std::vector<uint8_t> TextureCooker::Encode(BlockFormat format, const Image& image, UINT threadCount)
+{
+	assert(format != BlockFormat::Auto);
+
+	const UINT blocksX    = std::max(1u, (image.Width + 3) / 4);
+	const UINT blocksY    = std::max(1u, (image.Height + 3) / 4);
+	const UINT blockBytes = BlockBytes(format);
+
+	std::vector<uint8_t> blocks(size_t(blocksX) * blocksY * blockBytes);
+
+	ParallelFor(blocksY, threadCount, [&](UINT by)
+	{
+		for (UINT bx = 0; bx < blocksX; ++bx)
+		{
+			// Edge blocks of odd sized mips repeat their last row/column.
+			XMFLOAT4 texels[16];
+			for (UINT i = 0; i < 16; ++i)
+			{
+				UINT x    = std::min(bx * 4 + (i & 3), image.Width - 1);
+				UINT y    = std::min(by * 4 + (i >> 2), image.Height - 1);
+				texels[i] = image.Texels[size_t(y) * image.Width + x];
+			}
+
+			uint8_t* block = &blocks[(size_t(by) * blocksX + bx) * blockBytes];
+			switch (format)
+			{
+			case BlockFormat::BC1: EncodeBC1(texels, block);
+				break;
+			case BlockFormat::BC3: EncodeBC3(texels, block);
+				break;
+			case BlockFormat::BC5: EncodeBC5(texels, block);
+				break;
+			default: EncodeBC7(texels, block);
+				break;
+			}
+		}
+	});
+
+	return blocks;
+}
+
+TextureCooker::Image TextureCooker::Downsample(const Image& image, bool srgb, MipGenerator::Filter filter)
+{
+	Image linear = image;
+	if (srgb)
+	{
+		for (auto& t : linear.Texels)
+		{
+			t.x = SrgbToLinear(t.x);
+			t.y = SrgbToLinear(t.y);
+			t.z = SrgbToLinear(t.z);
+		}
+	}
+
+	Image result;
+	result.Width  = std::max(image.Width / 2, 1u);
+	result.Height = std::max(image.Height / 2, 1u);
+	result.Texels.resize(size_t(result.Width) * result.Height);
+
+	// Slices are already spread across threads by CookFile.
+	MipGenerator::Resample(&linear.Texels[0].x,
+	                       linear.Width,
+	                       linear.Height,
+	                       &result.Texels[0].x,
+	                       result.Width,
+	                       result.Height,
+	                       4,
+	                       filter,
+	                       1);
+
+	for (auto& t : result.Texels)
+	{
+		// Saturate: the Kaiser filter can overshoot.
+		t.x = std::min(std::max(t.x, 0.0f), 1.0f);
+		t.y = std::min(std::max(t.y, 0.0f), 1.0f);
+		t.z = std::min(std::max(t.z, 0.0f), 1.0f);
+		t.w = std::min(std::max(t.w, 0.0f), 1.0f);
+		if (srgb)
+		{
+			t.x = LinearToSrgb(t.x);
+			t.y = LinearToSrgb(t.y);
+			t.z = LinearToSrgb(t.z);
+		}
+	}
+
+	return result;
+}
+
+double TextureCooker::ComputePsnr(const Image& a, const Image& b, UINT channelCount)
+{
+	assert(a.Texels.size() == b.Texels.size());
+
+	double sumSquares = 0.0;
+	for (size_t i = 0; i < a.Texels.size(); ++i)
+	{
+		const float* ta = &a.Texels[i].x;
+		const float* tb = &b.Texels[i].x;
+		for (UINT c = 0; c < channelCount; ++c)
+		{
+			double diff = double(ToUnorm8(ta[c])) - double(ToUnorm8(tb[c]));
+			sumSquares += diff * diff;
+		}
+	}
+
+	double mse = sumSquares / (double(a.Texels.size()) * channelCount);
+	return mse > 0.0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+}
+
+TextureCooker::Report TextureCooker::CookFile(const std::wstring& source, const std::wstring& destination, const Options& options)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+
+	//
+	// Read and parse the source.
+	//
+	std::ifstream fin(source, std::ios::binary | std::ios::ate);
+	if (!fin)
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+
+	std::vector<uint8_t> file((size_t)fin.tellg());
+	fin.seekg(0, std::ios::beg);
+	fin.read(reinterpret_cast<char*>(file.data()), (std::streamsize)file.size());
+	fin.close();
+
+	DDS_TEXTURE_INFO                    info;
+	std::vector<DDS_SUBRESOURCE_LAYOUT> layouts;
+	ThrowIfFailed(GetDDSTextureInfoFromMemory(file.data(), file.size(), info, &layouts));
+
+	if (info.dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED));
+	if (file.size() < info.headerSize + info.dataSize)
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_HANDLE_EOF));
+
+	std::wstring lowerName = source;
+	std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), [](wchar_t c) { return (wchar_t)std::towlower(c); });
+	const bool isNormalMap = lowerName.find(L"_nmap") != std::wstring::npos;
+
+	const UINT threadCount = ResolveThreadCount(options.ThreadCount, ~0u);
+	const UINT arraySize   = info.arraySize;
+	const UINT decodeMips  = options.GenerateMips ? 1 : info.mipLevels;
+
+	// slices[j][i] = mip i of array slice j
+	std::vector<std::vector<Image>> slices(arraySize);
+	for (UINT j = 0; j < arraySize; ++j)
+	{
+		slices[j].resize(decodeMips);
+		for (UINT i = 0; i < decodeMips; ++i)
+		{
+			const auto& layout = layouts[j * info.mipLevels + i];
+			if (!Decode(info.format, file.data() + layout.offset, layout.rowPitch, layout.width, layout.height, slices[j][i]))
+				ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED));
+		}
+	}
+
+	//
+	// Pick the target format.
+	//
+	BlockFormat format = options.Format;
+	if (format == BlockFormat::Auto)
+	{
+		bool hasAlpha = false;
+		for (const auto& slice : slices)
+		{
+			for (const auto& t : slice[0].Texels)
+				hasAlpha |= t.w < 254.5f / 255.0f;
+		}
+		format = isNormalMap ? BlockFormat::BC5 : hasAlpha ? BlockFormat::BC3 : BlockFormat::BC1;
+	}
+
+	const bool srgb = format != BlockFormat::BC5 && (IsSrgb(info.format) || (options.ForceSrgb && !isNormalMap));
+
+	//
+	// Mip chain.
+	//
+	UINT mipLevels = decodeMips;
+	if (options.GenerateMips)
+	{
+		mipLevels = 1;
+		for (UINT size = std::max(info.width, info.height); size > 1; size /= 2)
+			++mipLevels;
+
+		ParallelFor(arraySize, threadCount, [&](UINT j)
+		{
+			slices[j].reserve(mipLevels);
+			for (UINT i = 1; i < mipLevels; ++i)
+				slices[j].push_back(Downsample(slices[j][i - 1], srgb, options.MipFilter));
+		});
+	}
+
+	//
+	// Encode every surface; Encode() spreads the block rows of each surface across threads.
+	//
+	std::vector<std::vector<uint8_t>> surfaces;
+	surfaces.reserve(size_t(arraySize) * mipLevels);
+	for (UINT j = 0; j < arraySize; ++j)
+	{
+		for (UINT i = 0; i < mipLevels; ++i)
+			surfaces.push_back(Encode(format, slices[j][i], threadCount));
+	}
+
+	//
+	// Quality: decode mip 0 of every slice again and compare with the source.
+	//
+	const DXGI_FORMAT  cookedFormat = ToDxgiFormat(format, srgb);
+	std::vector<Image> decoded(arraySize);
+	for (UINT j = 0; j < arraySize; ++j)
+	{
+		const UINT blocksX = std::max(1u, (info.width + 3) / 4);
+		Decode(cookedFormat, surfaces[j * mipLevels].data(), blocksX * BlockBytes(format), info.width, info.height, decoded[j]);
+	}
+
+	std::vector<const Image*> sourceMips, cookedMips;
+	for (UINT j = 0; j < arraySize; ++j)
+	{
+		sourceMips.push_back(&slices[j][0]);
+		cookedMips.push_back(&decoded[j]);
+	}
+	const UINT psnrChannels = format == BlockFormat::BC1 ? 3 : format == BlockFormat::BC5 ? 2 : 4;
+
+	Report report;
+	report.SourceFormat = info.format;
+	report.CookedFormat = cookedFormat;
+	report.Width        = info.width;
+	report.Height       = info.height;
+	report.ArraySize    = arraySize;
+	report.MipLevels    = mipLevels;
+	report.SourceBytes  = file.size();
+	report.Psnr         = ComputePsnr(ConcatenateImages(sourceMips), ConcatenateImages(cookedMips), psnrChannels);
+
+	//
+	// Write the DDS file with a DX10 header.
+	//
+	DdsHeader header          = {};
+	header.Size               = sizeof(DdsHeader);
+	header.Flags              = kHeaderFlags;
+	header.Height             = info.height;
+	header.Width              = info.width;
+	header.PitchOrLinearSize  = (UINT)surfaces[0].size();
+	header.MipMapCount        = mipLevels;
+	header.PixelFormat.Size   = sizeof(DdsPixelFormat);
+	header.PixelFormat.Flags  = kPixelFormatFourCC;
+	header.PixelFormat.FourCC = kFourCCDX10;
+	header.Caps               = kCapsTexture | (mipLevels > 1 ? kCapsMipMap | kCapsComplex : 0) | (arraySize > 1 ? kCapsComplex : 0);
+	header.Caps2              = info.isCubeMap ? kCaps2CubeMap : 0;
+
+	DdsHeaderDxt10 dxt10    = {};
+	dxt10.DxgiFormat        = cookedFormat;
+	dxt10.ResourceDimension = kDimensionTexture2D;
+	dxt10.MiscFlag          = info.isCubeMap ? kMiscTextureCube : 0;
+	dxt10.ArraySize         = info.isCubeMap ? arraySize / 6 : arraySize;
+	dxt10.MiscFlags2        = format == BlockFormat::BC1 || format == BlockFormat::BC5 ? DDS_ALPHA_MODE_OPAQUE : DDS_ALPHA_MODE_STRAIGHT;
+
+	std::ofstream fout(destination, std::ios::binary | std::ios::trunc);
+	if (!fout)
+		ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_ACCESS_DENIED));
+
+	fout.write(reinterpret_cast<const char*>(&kDdsMagic), sizeof(kDdsMagic));
+	fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	fout.write(reinterpret_cast<const char*>(&dxt10), sizeof(dxt10));
+	for (const auto& surface : surfaces)
+		fout.write(reinterpret_cast<const char*>(surface.data()), (std::streamsize)surface.size());
+
+	report.CookedBytes = (UINT64)fout.tellp();
+	fout.close();
+
+	auto end            = std::chrono::high_resolution_clock::now();
+	report.Milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+	return report;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "MipGenerator.h"
+
+/**
+ * \brief Offline DDS cooker: decodes a DDS file, rebuilds its mip chain and block-compresses it.
+ * Colour textures go to BC1 (opaque) or BC3 (with alpha), normal maps (*_nmap) to BC5, and BC7 can be
+ * forced for higher quality colour. The output is always written with a DX10 header.
+ *
+ * Block encoders fit endpoints along the principal axis of each block, refine them with one least squares
+ * pass and pick indices four texels at a time with DirectXMath vectors. Blocks are spread across threads.
+ *
+ * Note: BC5 stores only the x and y of a normal map; shaders sampling a cooked normal map must rebuild
+ * z = sqrt(1 - x*x - y*y).
+ */
+class TextureCooker
+{
+public:
+	enum class BlockFormat
+	{
+		Auto, // BC5 for *_nmap files, BC3 if any texel has alpha, BC1 otherwise
+		BC1,
+		BC3,
+		BC5,
+		BC7
+	};
+
+	struct Options
+	{
+		BlockFormat          Format       = BlockFormat::Auto;
+		bool                 GenerateMips = true;  // rebuild the full chain from mip 0 (otherwise keep the source mips)
+		MipGenerator::Filter MipFilter    = MipGenerator::Filter::Box;
+		bool                 ForceSrgb    = false; // treat colour input as sRGB even if its format is not *_SRGB
+		UINT                 ThreadCount  = 0;     // 0 = one per hardware thread
+	};
+
+	struct Report
+	{
+		DXGI_FORMAT SourceFormat = DXGI_FORMAT_UNKNOWN;
+		DXGI_FORMAT CookedFormat = DXGI_FORMAT_UNKNOWN;
+		UINT        Width        = 0;
+		UINT        Height       = 0;
+		UINT        ArraySize    = 0;
+		UINT        MipLevels    = 0;
+		UINT64      SourceBytes  = 0; // file sizes
+		UINT64      CookedBytes  = 0;
+		double      Psnr         = 0.0; // dB over the encoded channels of mip 0, INFINITY if lossless
+		double      Milliseconds = 0.0;
+	};
+
+	// An uncompressed surface; texels are RGBA in [0,1], stored in the colour space of the file.
+	struct Image
+	{
+		UINT                           Width  = 0;
+		UINT                           Height = 0;
+		std::vector<DirectX::XMFLOAT4> Texels;
+	};
+
+	/**
+	 * \brief Cooks one file. Throws DxException if the file cannot be read or its format is not supported.
+	 * \param source DDS file to read
+	 * \param destination DDS file to write (may equal source)
+	 */
+	static Report CookFile(const std::wstring& source, const std::wstring& destination, const Options& options);
+
+	// Block level entry points. texels[] is one 4x4 block in row-major order.
+	static void EncodeBC1(const DirectX::XMFLOAT4 texels[16], uint8_t block[8]);
+	static void EncodeBC3(const DirectX::XMFLOAT4 texels[16], uint8_t block[16]);
+	static void EncodeBC4(const float values[16], uint8_t block[8]);
+	static void EncodeBC5(const DirectX::XMFLOAT4 texels[16], uint8_t block[16]);
+	static void EncodeBC7(const DirectX::XMFLOAT4 texels[16], uint8_t block[16]); // modes 5 and 6
+
+	// Decodes a whole surface of a supported format (uncompressed 8/16/32-bit, BC1-BC5, BC7 modes 5 and 6).
+	static bool Decode(DXGI_FORMAT format, const uint8_t* data, size_t rowPitch, UINT width, UINT height, Image& image);
+
+	// Encodes a whole surface to BC1/BC3/BC5/BC7, spreading block rows across threads.
+	static std::vector<uint8_t> Encode(BlockFormat format, const Image& image, UINT threadCount);
+
+	// Half size image filtered by MipGenerator; filters in linear space when srgb is set.
+	static Image Downsample(const Image& image, bool srgb, MipGenerator::Filter filter = MipGenerator::Filter::Box);
+
+	// Peak signal to noise ratio in dB on 8-bit values over the first channelCount channels.
+	static double ComputePsnr(const Image& a, const Image& b, UINT channelCount);
+};
@@ -0,0 +1,614 @@
+#include "TextureStreamer.h"
+
+using Microsoft::WRL::ComPtr;
+using namespace DirectX;
+
+namespace
+{
+	bool IsBlockCompressed(DXGI_FORMAT format)
+	{
+		return (format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+		       (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB);
+	}
+
+	// Most detailed mip m such that mips 0..m all have a width and height that are multiples of 4, i.e. can be
+	// the top level of a block compressed resource. 0 if not even mip 0 qualifies.
+	UINT LastBlockAlignedMip(UINT width, UINT height)
+	{
+		UINT mip = 0;
+		while ((width >> (mip + 1)) >= 4 && (width >> (mip + 1)) % 4 == 0 &&
+		       (height >> (mip + 1)) >= 4 && (height >> (mip + 1)) % 4 == 0)
+		{
+			++mip;
+		}
+		return mip;
+	}
+}
+
+TextureStreamer::TextureStreamer(ID3D12Device*         device,
+                                 ID3D12DescriptorHeap* srvHeap,
+                                 UINT                  firstSrvHeapIndex,
+                                 UINT                  srvDescriptorSize,
+                                 UINT                  maxTextures,
+                                 UINT64                memoryBudget,
+                                 UINT                  tailDimension) :
+	md3dDevice(device),
+	mSrvHeap(srvHeap),
+	mFirstSrvIndex(firstSrvHeapIndex),
+	mSrvDescriptorSize(srvDescriptorSize),
+	mMaxTextures(maxTextures),
+	mTailDimension(std::max(tailDimension, 1u)),
+	mMemoryBudget(memoryBudget)
+{
+	// The worker holds raw pointers to StreamedTexture, so never let the vector reallocate.
+	mTextures.reserve(maxTextures);
+
+	mWorker = std::thread(&TextureStreamer::WorkerMain, this);
+}
+
+TextureStreamer::~TextureStreamer()
+{
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		mQuit = true;
+	}
+	mQueueCV.notify_all();
+
+	if (mWorker.joinable())
+		mWorker.join();
+}
+
+UINT TextureStreamer::RegisterTexture(ID3D12GraphicsCommandList* cmdList, const std::wstring& filename)
+{
+	DDSCatalog catalog;
+	UINT       index = catalog.AddFile(filename);
+	if (index == DDSCatalog::kNotFound)
+		ThrowIfFailed(E_FAIL);
+
+	return RegisterTexture(cmdList, catalog.Entries()[index]);
+}
+
+UINT TextureStreamer::RegisterTexture(ID3D12GraphicsCommandList* cmdList, const DDSCatalog::Entry& entry)
+{
+	// Each texture owns two slots of the caller's heap; one texture too many would overwrite whatever follows them.
+	if (mTextures.size() >= mMaxTextures)
+		ThrowIfFailed(E_OUTOFMEMORY);
+
+	// The catalog entry already knows where every mip lives in the file.
+	auto tex      = std::make_unique<StreamedTexture>();
+	tex->Filename = entry.Filename;
+	tex->Info     = entry.Info;
+	tex->Layouts  = entry.Layouts;
+
+	// Volume and 1D textures are always fully resident.
+	tex->TailMip = 0;
+	if (tex->Info.dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		while (tex->TailMip + 1 < tex->Info.mipLevels &&
+			((tex->Info.width >> tex->TailMip) > mTailDimension || (tex->Info.height >> tex->TailMip) > mTailDimension))
+		{
+			++tex->TailMip;
+		}
+	}
+
+	// Every resident top mip lies in [0, TailMip], and a block compressed top level must be a multiple of 4 texels
+	// on both axes. A texture whose mip 0 isn't stays fully resident.
+	if (IsBlockCompressed(tex->Info.format))
+		tex->TailMip = std::min(tex->TailMip, LastBlockAlignedMip(tex->Info.width, tex->Info.height));
+
+	tex->ResidentMip    = tex->TailMip;
+	tex->DesiredMip     = tex->TailMip;
+	tex->FullChainBytes = CalcBytes(*tex, 0);
+
+	LoadResult tail;
+	ThrowIfFailed(ReadMips(*tex, tex->TailMip, tex->Info.mipLevels, tail) ? S_OK : E_FAIL);
+
+	// Create the texture with only the tail and upload it.
+	D3D12_RESOURCE_DESC desc = MakeDesc(*tex, tex->TailMip);
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		              &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		              D3D12_HEAP_FLAG_NONE,
+		              &desc,
+		              D3D12_RESOURCE_STATE_COPY_DEST,
+		              nullptr,
+		              IID_PPV_ARGS(&tex->Resource)));
+
+	const UINT             numSubresources = (UINT)tail.Subresources.size();
+	ComPtr<ID3D12Resource> uploadBuffer;
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		              &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		              D3D12_HEAP_FLAG_NONE,
+		              &CD3DX12_RESOURCE_DESC::Buffer(GetRequiredIntermediateSize(tex->Resource.Get(), 0, numSubresources)),
+		              D3D12_RESOURCE_STATE_GENERIC_READ,
+		              nullptr,
+		              IID_PPV_ARGS(&uploadBuffer)));
+
+	UpdateSubresources(cmdList, tex->Resource.Get(), uploadBuffer.Get(), 0, 0, numSubresources, tail.Subresources.data());
+
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(tex->Resource.Get(),
+	                                                                  D3D12_RESOURCE_STATE_COPY_DEST,
+	                                                                  D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+	// Upload buffer must live until the command list has executed.
+	mInitUploaders.push_back(uploadBuffer);
+
+	tex->ResidentBytes = CalcBytes(*tex, tex->TailMip);
+	mStats.ResidentBytes += tex->ResidentBytes;
+	mStats.FullChainBytes += tex->FullChainBytes;
+
+	UINT id = (UINT)mTextures.size();
+	BuildSrv(*tex, id, 0);
+	mTextures.push_back(std::move(tex));
+
+	return id;
+}
+
+void TextureStreamer::SetDesiredMip(UINT id, UINT mip)
+{
+	StreamedTexture* tex  = mTextures[id].get();
+	tex->DesiredMip       = std::min(mip, tex->TailMip);
+	tex->LastRequestFrame = mCurrentFrame;
+}
+
+void TextureStreamer::SetDesiredScreenSize(UINT id, float screenPixels)
+{
+	const StreamedTexture* tex = mTextures[id].get();
+
+	// One texel per pixel is enough; anything sharper is wasted bandwidth.
+	float texels = (float)std::max(tex->Info.width, tex->Info.height);
+	float ratio  = texels / std::max(screenPixels, 1.0f);
+	UINT  mip    = ratio <= 1.0f ? 0 : (UINT)floorf(log2f(ratio));
+
+	SetDesiredMip(id, mip);
+}
+
+bool TextureStreamer::Update(ID3D12GraphicsCommandList* cmdList, UINT64 frameFence, UINT64 completedFence)
+{
+	// Anything the GPU has finished with can go.
+	mPendingReleases.erase(std::remove_if(mPendingReleases.begin(),
+	                                      mPendingReleases.end(),
+	                                      [completedFence](const PendingRelease& r) { return r.Fence <= completedFence; }),
+	                       mPendingReleases.end());
+
+	// The init uploads were recorded before this frame's fence, so they are safe to release with it.
+	for (auto& uploader : mInitUploaders)
+		mPendingReleases.push_back({uploader, frameFence});
+	mInitUploaders.clear();
+
+	bool srvChanged = false;
+
+	//
+	// Make completed background loads resident.
+	//
+	std::deque<LoadResult> results;
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		results.swap(mResults);
+	}
+
+	for (auto& result : results)
+	{
+		StreamedTexture* tex = mTextures[result.ID].get();
+		tex->LoadPending     = false;
+
+		if (!result.Succeeded)
+			continue;
+
+		mStats.BytesStreamed += result.Data.size();
+
+		// The app may have lost interest or the texture may have changed while the load was in flight.
+		UINT newTop = std::max(result.FirstMip, tex->DesiredMip);
+		if (newTop >= tex->ResidentMip || result.LastMip != tex->ResidentMip)
+			continue;
+
+		// The inactive SRV slot may still be referenced by a frame in flight.
+		if (tex->InactiveSlotFence > completedFence)
+			continue;
+
+		UINT64 newBytes = CalcBytes(*tex, newTop);
+		UINT64 growth   = newBytes - tex->ResidentBytes;
+		bool   evicted  = false;
+		bool   fits     = mStats.ResidentBytes + growth <= mMemoryBudget ||
+		                  EvictFor(cmdList, mStats.ResidentBytes + growth - mMemoryBudget, result.ID, frameFence, completedFence, evicted);
+
+		// Victims swap their SRV slot even when they do not free enough, and their old resources go away.
+		srvChanged |= evicted;
+		if (!fits)
+		{
+			// Do not hammer the disk for something that will not fit; try again in a while.
+			++mStats.BudgetRejections;
+			tex->RetryFrame = mCurrentFrame + 30;
+			continue;
+		}
+
+		mStats.MipsStreamedIn += tex->ResidentMip - newTop;
+		Retarget(cmdList, result.ID, newTop, &result, frameFence);
+		srvChanged = true;
+	}
+
+	//
+	// Issue new loads, most starved textures first.
+	//
+	std::vector<UINT> wants;
+	for (UINT i = 0; i < (UINT)mTextures.size(); ++i)
+	{
+		const StreamedTexture* tex = mTextures[i].get();
+		// Skip textures whose spare SRV slot is still in use; the load would only be thrown away.
+		if (!tex->LoadPending && tex->DesiredMip < tex->ResidentMip &&
+			tex->InactiveSlotFence <= completedFence && tex->RetryFrame <= mCurrentFrame)
+			wants.push_back(i);
+	}
+
+	std::sort(wants.begin(),
+	          wants.end(),
+	          [this](UINT a, UINT b)
+	          {
+		          const StreamedTexture* ta = mTextures[a].get();
+		          const StreamedTexture* tb = mTextures[b].get();
+		          return (ta->ResidentMip - ta->DesiredMip) > (tb->ResidentMip - tb->DesiredMip);
+	          });
+
+	if (!wants.empty())
+	{
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		for (UINT id : wants)
+		{
+			StreamedTexture* tex = mTextures[id].get();
+			tex->LoadPending     = true;
+			mRequests.push_back({id, tex, tex->DesiredMip, tex->ResidentMip});
+		}
+	}
+	if (!wants.empty())
+		mQueueCV.notify_one();
+
+	//
+	// Someone lowered the budget: shrink until we fit again.
+	//
+	if (mStats.ResidentBytes > mMemoryBudget)
+	{
+		bool evicted = false;
+		EvictFor(cmdList, mStats.ResidentBytes - mMemoryBudget, UINT(-1), frameFence, completedFence, evicted);
+		srvChanged |= evicted;
+	}
+
+	mStats.PendingLoads = 0;
+	for (const auto& tex : mTextures)
+		mStats.PendingLoads += tex->LoadPending ? 1 : 0;
+
+	// Requests made after this point belong to the next frame.
+	++mCurrentFrame;
+
+	return srvChanged;
+}
+
+void TextureStreamer::DisposeUploaders()
+{
+	mInitUploaders.clear();
+}
+
+void TextureStreamer::SetMemoryBudget(UINT64 bytes)
+{
+	mMemoryBudget = bytes;
+}
+
+UINT64 TextureStreamer::GetMemoryBudget() const
+{
+	return mMemoryBudget;
+}
+
+UINT TextureStreamer::GetSrvHeapIndex(UINT id) const
+{
+	return mFirstSrvIndex + 2 * id + mTextures[id]->ActiveSlot;
+}
+
+UINT TextureStreamer::GetResidentMip(UINT id) const
+{
+	return mTextures[id]->ResidentMip;
+}
+
+UINT TextureStreamer::GetMipLevels(UINT id) const
+{
+	return mTextures[id]->Info.mipLevels;
+}
+
+ID3D12Resource* TextureStreamer::Resource(UINT id) const
+{
+	return mTextures[id]->Resource.Get();
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats() const
+{
+	return mStats;
+}
+
+void TextureStreamer::WorkerMain()
+{
+	for (;;)
+	{
+		LoadRequest request;
+		{
+			std::unique_lock<std::mutex> lock(mQueueMutex);
+			mQueueCV.wait(lock, [this] { return mQuit || !mRequests.empty(); });
+			if (mQuit)
+				return;
+
+			request = mRequests.front();
+			mRequests.pop_front();
+		}
+
+		// File I/O happens outside the lock so the render thread never waits on the disk.
+		LoadResult result;
+		ReadMips(*request.Texture, request.FirstMip, request.LastMip, result);
+		result.ID = request.ID;
+
+		std::lock_guard<std::mutex> lock(mQueueMutex);
+		mResults.push_back(std::move(result));
+	}
+}
+
+bool TextureStreamer::ReadMips(const StreamedTexture& tex, UINT firstMip, UINT lastMip, LoadResult& result)
+{
+	result.FirstMip  = firstMip;
+	result.LastMip   = lastMip;
+	result.Succeeded = false;
+
+	const UINT mipLevels = tex.Info.mipLevels;
+	const UINT mipCount  = lastMip - firstMip;
+
+	// Within one array slice the requested mips are contiguous in the file, so it is one read per slice.
+	size_t totalBytes = 0;
+	for (UINT j = 0; j < tex.Info.arraySize; ++j)
+	{
+		const auto& first = tex.Layouts[j * mipLevels + firstMip];
+		const auto& last  = tex.Layouts[j * mipLevels + lastMip - 1];
+		totalBytes += last.offset + last.byteSize - first.offset;
+	}
+
+	result.Data.resize(totalBytes);
+	result.Subresources.clear();
+	result.Subresources.reserve(size_t(tex.Info.arraySize) * mipCount);
+
+	std::ifstream fin(tex.Filename, std::ios::binary);
+	if (!fin)
+		return false;
+
+	uint8_t* dst = result.Data.data();
+	for (UINT j = 0; j < tex.Info.arraySize; ++j)
+	{
+		const auto& first = tex.Layouts[j * mipLevels + firstMip];
+		const auto& last  = tex.Layouts[j * mipLevels + lastMip - 1];
+		size_t      bytes = last.offset + last.byteSize - first.offset;
+
+		fin.seekg((std::streamoff)first.offset, std::ios::beg);
+		fin.read(reinterpret_cast<char*>(dst), (std::streamsize)bytes);
+		if (!fin)
+			return false;
+
+		for (UINT i = firstMip; i < lastMip; ++i)
+		{
+			const auto& layout = tex.Layouts[j * mipLevels + i];
+
+			D3D12_SUBRESOURCE_DATA data;
+			data.pData      = dst + (layout.offset - first.offset);
+			data.RowPitch   = (LONG_PTR)layout.rowPitch;
+			data.SlicePitch = (LONG_PTR)layout.slicePitch;
+			result.Subresources.push_back(data);
+		}
+
+		dst += bytes;
+	}
+
+	result.Succeeded = true;
+	return true;
+}
+
+D3D12_RESOURCE_DESC TextureStreamer::MakeDesc(const StreamedTexture& tex, UINT topMip) const
+{
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension           = tex.Info.dimension;
+	desc.Width               = std::max(tex.Info.width >> topMip, 1u);
+	desc.Height              = std::max(tex.Info.height >> topMip, 1u);
+	desc.DepthOrArraySize    = (UINT16)(tex.Info.dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? tex.Info.depth : tex.Info.arraySize);
+	desc.MipLevels           = (UINT16)(tex.Info.mipLevels - topMip);
+	desc.Format              = tex.Info.format;
+	desc.SampleDesc.Count    = 1;
+	desc.SampleDesc.Quality  = 0;
+	desc.Flags               = D3D12_RESOURCE_FLAG_NONE;
+
+	// RegisterTexture() limits TailMip so that this holds for every top mip the streamer picks.
+	assert(topMip == 0 || !IsBlockCompressed(desc.Format) || (desc.Width % 4 == 0 && desc.Height % 4 == 0));
+	return desc;
+}
+
+UINT64 TextureStreamer::CalcBytes(const StreamedTexture& tex, UINT topMip) const
+{
+	D3D12_RESOURCE_DESC desc = MakeDesc(tex, topMip);
+	return md3dDevice->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+}
+
+void TextureStreamer::BuildSrv(const StreamedTexture& tex, UINT id, UINT slot)
+{
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Shader4ComponentMapping         = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format                          = tex.Info.format;
+
+	UINT residentMips = tex.Info.mipLevels - tex.ResidentMip;
+	if (tex.Info.dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+	{
+		srvDesc.ViewDimension             = D3D12_SRV_DIMENSION_TEXTURE3D;
+		srvDesc.Texture3D.MipLevels       = residentMips;
+		srvDesc.Texture3D.MostDetailedMip = 0;
+	}
+	else if (tex.Info.isCubeMap && tex.Info.arraySize == 6)
+	{
+		srvDesc.ViewDimension                   = D3D12_SRV_DIMENSION_TEXTURECUBE;
+		srvDesc.TextureCube.MipLevels           = residentMips;
+		srvDesc.TextureCube.MostDetailedMip     = 0;
+		srvDesc.TextureCube.ResourceMinLODClamp = 0.0f;
+	}
+	else if (tex.Info.arraySize > 1)
+	{
+		srvDesc.ViewDimension                      = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+		srvDesc.Texture2DArray.MipLevels           = residentMips;
+		srvDesc.Texture2DArray.MostDetailedMip     = 0;
+		srvDesc.Texture2DArray.FirstArraySlice     = 0;
+		srvDesc.Texture2DArray.ArraySize           = tex.Info.arraySize;
+		srvDesc.Texture2DArray.ResourceMinLODClamp = 0.0f;
+	}
+	else
+	{
+		srvDesc.ViewDimension                 = D3D12_SRV_DIMENSION_TEXTURE2D;
+		srvDesc.Texture2D.MipLevels           = residentMips;
+		srvDesc.Texture2D.MostDetailedMip     = 0;
+		srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+	}
+
+	CD3DX12_CPU_DESCRIPTOR_HANDLE hDescriptor(mSrvHeap->GetCPUDescriptorHandleForHeapStart());
+	hDescriptor.Offset(mFirstSrvIndex + 2 * id + slot, mSrvDescriptorSize);
+	md3dDevice->CreateShaderResourceView(tex.Resource.Get(), &srvDesc, hDescriptor);
+}
+
+bool TextureStreamer::EvictFor(ID3D12GraphicsCommandList* cmdList,
+                               UINT64                     bytesNeeded,
+                               UINT                       excludeId,
+                               UINT64                     frameFence,
+                               UINT64                     completedFence,
+                               bool&                      retargeted)
+{
+	// Least recently requested first.
+	std::vector<UINT> victims;
+	for (UINT i = 0; i < (UINT)mTextures.size(); ++i)
+	{
+		const StreamedTexture* tex = mTextures[i].get();
+		if (i != excludeId && tex->ResidentMip < tex->TailMip && tex->InactiveSlotFence <= completedFence)
+			victims.push_back(i);
+	}
+
+	std::sort(victims.begin(),
+	          victims.end(),
+	          [this](UINT a, UINT b) { return mTextures[a]->LastRequestFrame < mTextures[b]->LastRequestFrame; });
+
+	UINT64 freed = 0;
+	for (UINT id : victims)
+	{
+		if (freed >= bytesNeeded)
+			break;
+
+		StreamedTexture* tex = mTextures[id].get();
+
+		// Textures used this frame only give back what they do not currently want; the rest drop to the tail.
+		UINT newTop = tex->LastRequestFrame == mCurrentFrame ? tex->DesiredMip : tex->TailMip;
+		if (newTop <= tex->ResidentMip)
+			continue;
+
+		UINT64 before = tex->ResidentBytes;
+		mStats.MipsEvicted += newTop - tex->ResidentMip;
+		Retarget(cmdList, id, newTop, nullptr, frameFence);
+		freed     += before - tex->ResidentBytes;
+		retargeted = true;
+	}
+
+	return freed >= bytesNeeded;
+}
+
+void TextureStreamer::Retarget(ID3D12GraphicsCommandList* cmdList,
+                               UINT                       id,
+                               UINT                       newTopMip,
+                               const LoadResult*          newMips,
+                               UINT64                     frameFence)
+{
+	StreamedTexture* tex = mTextures[id].get();
+
+	const UINT oldTop      = tex->ResidentMip;
+	const UINT mipLevels   = tex->Info.mipLevels;
+	const UINT arraySize   = tex->Info.dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : tex->Info.arraySize;
+	const UINT oldMipCount = mipLevels - oldTop;
+	const UINT newMipCount = mipLevels - newTopMip;
+
+	ComPtr<ID3D12Resource> newResource;
+	D3D12_RESOURCE_DESC    desc = MakeDesc(*tex, newTopMip);
+	ThrowIfFailed(md3dDevice->CreateCommittedResource(
+		              &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+		              D3D12_HEAP_FLAG_NONE,
+		              &desc,
+		              D3D12_RESOURCE_STATE_COPY_DEST,
+		              nullptr,
+		              IID_PPV_ARGS(&newResource)));
+
+	cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(tex->Resource.Get(),
+	                                                                  D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+	                                                                  D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+	// Mips both resources have in common are copied GPU side.
+	const UINT sharedTop = std::max(oldTop, newTopMip);
+	for (UINT j = 0; j < arraySize; ++j)
+	{
+		for (UINT m = sharedTop; m < mipLevels; ++m)
+		{
+			CD3DX12_TEXTURE_COPY_LOCATION dst(newResource.Get(), D3D12CalcSubresource(m - newTopMip, j, 0, newMipCount, arraySize));
+			CD3DX12_TEXTURE_COPY_LOCATION src(tex->Resource.Get(), D3D12CalcSubresource(m - oldTop, j, 0, oldMipCount, arraySize));
+			cmdList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+		}
+	}
+
+	// Newly streamed mips come from the background thread's buffer.
+	if (newMips != nullptr && newTopMip < oldTop)
+	{
+		const UINT loadedPerSlice = newMips->LastMip - newMips->FirstMip;
+		const UINT skip           = newTopMip - newMips->FirstMip;
+		const UINT count          = oldTop - newTopMip;
+
+		UINT64 sliceBytes = GetRequiredIntermediateSize(newResource.Get(), 0, count);
+		sliceBytes        = (sliceBytes + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) & ~UINT64(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+
+		ComPtr<ID3D12Resource> uploadBuffer;
+		ThrowIfFailed(md3dDevice->CreateCommittedResource(
+			              &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			              D3D12_HEAP_FLAG_NONE,
+			              &CD3DX12_RESOURCE_DESC::Buffer(sliceBytes * arraySize),
+			              D3D12_RESOURCE_STATE_GENERIC_READ,
+			              nullptr,
+			              IID_PPV_ARGS(&uploadBuffer)));
+
+		for (UINT j = 0; j < arraySize; ++j)
+		{
+			UpdateSubresources(cmdList,
+			                   newResource.Get(),
+			                   uploadBuffer.Get(),
+			                   sliceBytes * j,
+			                   D3D12CalcSubresource(0, j, 0, newMipCount, arraySize),
+			                   count,
+			                   &newMips->Subresources[j * loadedPerSlice + skip]);
+		}
+
+		mPendingReleases.push_back({uploadBuffer, frameFence});
+	}
+
+	// The old texture goes back to being readable: draws recorded later in this frame may still use the old slot.
+	CD3DX12_RESOURCE_BARRIER barriers[2] =
+	{
+		CD3DX12_RESOURCE_BARRIER::Transition(newResource.Get(),
+		                                     D3D12_RESOURCE_STATE_COPY_DEST,
+		                                     D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE),
+		CD3DX12_RESOURCE_BARRIER::Transition(tex->Resource.Get(),
+		                                     D3D12_RESOURCE_STATE_COPY_SOURCE,
+		                                     D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE)
+	};
+	cmdList->ResourceBarrier(2, barriers);
+
+	// Frames in flight still sample the old texture through the old slot.
+	mPendingReleases.push_back({tex->Resource, frameFence});
+
+	UINT64 newBytes = CalcBytes(*tex, newTopMip);
+	mStats.ResidentBytes = mStats.ResidentBytes - tex->ResidentBytes + newBytes;
+
+	tex->Resource      = newResource;
+	tex->ResidentBytes = newBytes;
+	tex->ResidentMip   = newTopMip;
+
+	// Write the view into the slot nobody is using and flip.
+	UINT newSlot = tex->ActiveSlot ^ 1;
+	BuildSrv(*tex, id, newSlot);
+	tex->ActiveSlot        = newSlot;
+	tex->InactiveSlotFence = frameFence;
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "DDSCatalog.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+/**
+ * \brief Streams DDS mip levels in and out of GPU memory on demand.
+ * At registration only the small tail mips (largest dimension <= tailDimension) are read from the file
+ * and uploaded; a block compressed tail may be larger, as it must start at a mip whose size is a multiple
+ * of 4 texels. Higher mips are read by a background thread when the app asks for them through
+ * SetDesiredMip()/SetDesiredScreenSize(), and are made resident in Update() as long as the total
+ * resident texture memory stays within the budget. When the budget is exceeded, the least recently
+ * requested textures are shrunk back towards their tail.
+ *
+ * Changing the resident mip range re-creates the texture with a different top mip, so each texture owns
+ * two consecutive SRV slots in the caller's heap and the live one flips on every change. Use
+ * GetSrvHeapIndex() when filling material data and re-upload the materials whenever Update() returns true.
+ */
+class TextureStreamer
+{
+public:
+	struct Stats
+	{
+		UINT64 ResidentBytes    = 0; // current GPU memory of all streamed textures
+		UINT64 FullChainBytes   = 0; // what all textures would take with every mip resident
+		UINT64 BytesStreamed    = 0; // total bytes read from disk by the background thread
+		UINT   PendingLoads     = 0; // requests queued or in flight on the background thread
+		UINT   MipsStreamedIn   = 0;
+		UINT   MipsEvicted      = 0;
+		UINT   BudgetRejections = 0; // loads that could not be made resident even after eviction
+	};
+
+	/**
+	 * \param device D3D device used to create textures and views
+	 * \param srvHeap Heap holding the SRV slots of the streamed textures
+	 * \param firstSrvHeapIndex Index of the first slot this streamer may use (2 slots per texture)
+	 * \param srvDescriptorSize CBV/SRV/UAV descriptor increment size
+	 * \param maxTextures Maximum number of textures that will be registered
+	 * \param memoryBudget Maximum bytes of texture memory the streamer may keep resident
+	 * \param tailDimension Mips whose width and height are both <= this value are always resident
+	 */
+	TextureStreamer(ID3D12Device*         device,
+	                ID3D12DescriptorHeap* srvHeap,
+	                UINT                  firstSrvHeapIndex,
+	                UINT                  srvDescriptorSize,
+	                UINT                  maxTextures,
+	                UINT64                memoryBudget,
+	                UINT                  tailDimension = 64);
+
+	TextureStreamer(const TextureStreamer& rhs)            = delete;
+	TextureStreamer& operator=(const TextureStreamer& rhs) = delete;
+	~TextureStreamer();
+
+	// Reads the DDS header and tail mips and records their upload on cmdList. Returns the texture id.
+	// Throws once maxTextures textures are registered.
+	UINT RegisterTexture(ID3D12GraphicsCommandList* cmdList, const std::wstring& filename);
+	// Same, but takes the header information from a catalog so only the tail mips are read.
+	UINT RegisterTexture(ID3D12GraphicsCommandList* cmdList, const DDSCatalog::Entry& entry);
+
+	// Feedback API: call every frame for each texture that is in use. Lower mip = more detail.
+	void SetDesiredMip(UINT id, UINT mip);
+	// Convenience feedback: the texture covers roughly screenPixels pixels along its widest axis.
+	void SetDesiredScreenSize(UINT id, float screenPixels);
+
+	/**
+	 * \brief Retires finished work, issues new background loads, evicts to stay in budget and records the
+	 * GPU copies for completed loads on cmdList.
+	 * \param cmdList Command list of the current frame (must be open)
+	 * \param frameFence Fence value the current frame will signal when its command list has executed
+	 * \param completedFence Value returned by ID3D12Fence::GetCompletedValue()
+	 * \return true if any SRV heap index changed this frame
+	 */
+	bool Update(ID3D12GraphicsCommandList* cmdList, UINT64 frameFence, UINT64 completedFence);
+
+	// Upload heaps of RegisterTexture() can be freed once the initialization command list has executed.
+	void DisposeUploaders();
+
+	void   SetMemoryBudget(UINT64 bytes);
+	UINT64 GetMemoryBudget() const;
+
+	UINT            GetSrvHeapIndex(UINT id) const;
+	UINT            GetResidentMip(UINT id) const;
+	UINT            GetMipLevels(UINT id) const;
+	ID3D12Resource* Resource(UINT id) const;
+	Stats           GetStats() const;
+
+private:
+	struct StreamedTexture
+	{
+		std::wstring                                 Filename;
+		DirectX::DDS_TEXTURE_INFO                    Info;
+		std::vector<DirectX::DDS_SUBRESOURCE_LAYOUT> Layouts; // file layout of every subresource
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource       = nullptr;
+		UINT64                                 ResidentBytes  = 0;
+		UINT64                                 FullChainBytes = 0;
+
+		UINT TailMip     = 0; // first mip that is always resident
+		UINT ResidentMip = 0; // most detailed mip currently in Resource
+		UINT DesiredMip  = 0; // most detailed mip requested by the app
+
+		UINT   ActiveSlot        = 0;     // which of the two SRV slots is live
+		UINT64 InactiveSlotFence = 0;     // frame fence that last referenced the inactive slot
+		UINT64 LastRequestFrame  = 0;     // LRU key
+		UINT64 RetryFrame        = 0;     // back-off after a load was rejected by the budget
+		bool   LoadPending       = false; // a background request is queued or in flight
+	};
+
+	// Work item for the background thread: mips [FirstMip, LastMip) of every array slice.
+	struct LoadRequest
+	{
+		UINT                   ID       = 0;
+		const StreamedTexture* Texture  = nullptr; // file name and layouts never change after registration
+		UINT                   FirstMip = 0;
+		UINT                   LastMip  = 0;
+	};
+
+	struct LoadResult
+	{
+		UINT                                ID        = 0;
+		UINT                                FirstMip  = 0;
+		UINT                                LastMip   = 0;
+		bool                                Succeeded = false;
+		std::vector<uint8_t>                Data;
+		std::vector<D3D12_SUBRESOURCE_DATA> Subresources; // slice major, pointing into Data
+	};
+
+	struct PendingRelease
+	{
+		Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+		UINT64                                 Fence = 0;
+	};
+
+	void WorkerMain();
+	static bool ReadMips(const StreamedTexture& tex, UINT firstMip, UINT lastMip, LoadResult& result);
+
+	D3D12_RESOURCE_DESC MakeDesc(const StreamedTexture& tex, UINT topMip) const;
+	UINT64              CalcBytes(const StreamedTexture& tex, UINT topMip) const;
+	void                BuildSrv(const StreamedTexture& tex, UINT id, UINT slot);
+	bool                EvictFor(ID3D12GraphicsCommandList* cmdList,
+	                             UINT64                     bytesNeeded,
+	                             UINT                       excludeId,
+	                             UINT64                     frameFence,
+	                             UINT64                     completedFence,
+	                             bool&                      retargeted);
+	void                Retarget(ID3D12GraphicsCommandList* cmdList,
+	                             UINT                       id,
+	                             UINT                       newTopMip,
+	                             const LoadResult*          newMips,
+	                             UINT64                     frameFence);
+
+private:
+	ID3D12Device*         md3dDevice         = nullptr;
+	ID3D12DescriptorHeap* mSrvHeap           = nullptr;
+	UINT                  mFirstSrvIndex     = 0;
+	UINT                  mSrvDescriptorSize = 0;
+	UINT                  mMaxTextures       = 0;
+	UINT                  mTailDimension     = 64;
+	UINT64                mMemoryBudget      = 0;
+	UINT64                mCurrentFrame      = 0;
+
+	std::vector<std::unique_ptr<StreamedTexture>>       mTextures;
+	std::vector<PendingRelease>                         mPendingReleases;
+	std::vector<Microsoft::WRL::ComPtr<ID3D12Resource>> mInitUploaders;
+
+	Stats mStats;
+
+	// Background loader state (guarded by mQueueMutex).
+	std::thread             mWorker;
+	mutable std::mutex      mQueueMutex;
+	std::condition_variable mQueueCV;
+	std::deque<LoadRequest> mRequests;
+	std::deque<LoadResult>  mResults;
+	bool                    mQuit = false;
+};
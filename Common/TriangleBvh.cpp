@@ -0,0 +1,472 @@
+#include "TriangleBvh.h"
+#include "BvhUtil.h"
+#include <cfloat>
+
+using namespace DirectX;
+
+static_assert(sizeof(TriangleBvh::Node) == 32, "two nodes per cache line");
+
+constexpr UINT TriangleBvh::kNoHit;
+
+namespace
+{
+	// The ray for the box tests, plus every component splatted for the packet tests.
+	struct Ray : BvhUtil::Ray
+	{
+		XMVECTOR Ox;
+		XMVECTOR Oy;
+		XMVECTOR Oz;
+		XMVECTOR Dx;
+		XMVECTOR Dy;
+		XMVECTOR Dz;
+	};
+
+	/**
+	 * \brief Moller-Trumbore against the four triangles of a packet, two-sided.
+	 * \return a bit per lane hit with 0 < t < tMax; t, u and v hold the results of every lane
+	 */
+	inline UINT IntersectPacket(const Ray& ray, const TriangleBvh::TrianglePacket& packet, FXMVECTOR tMax, XMVECTOR& t, XMVECTOR& u, XMVECTOR& v)
+	{
+		const XMVECTOR e1x = XMLoadFloat4(&packet.E1[0]);
+		const XMVECTOR e1y = XMLoadFloat4(&packet.E1[1]);
+		const XMVECTOR e1z = XMLoadFloat4(&packet.E1[2]);
+		const XMVECTOR e2x = XMLoadFloat4(&packet.E2[0]);
+		const XMVECTOR e2y = XMLoadFloat4(&packet.E2[1]);
+		const XMVECTOR e2z = XMLoadFloat4(&packet.E2[2]);
+
+		// p = d x e2, det = e1 . p
+		const XMVECTOR px     = XMVectorSubtract(XMVectorMultiply(ray.Dy, e2z), XMVectorMultiply(ray.Dz, e2y));
+		const XMVECTOR py     = XMVectorSubtract(XMVectorMultiply(ray.Dz, e2x), XMVectorMultiply(ray.Dx, e2z));
+		const XMVECTOR pz     = XMVectorSubtract(XMVectorMultiply(ray.Dx, e2y), XMVectorMultiply(ray.Dy, e2x));
+		const XMVECTOR det    = XMVectorMultiplyAdd(e1x, px, XMVectorMultiplyAdd(e1y, py, XMVectorMultiply(e1z, pz)));
+		const XMVECTOR invDet = XMVectorReciprocal(det);
+
+		// s = o - v0, u = (s . p) / det
+		const XMVECTOR sx = XMVectorSubtract(ray.Ox, XMLoadFloat4(&packet.V0[0]));
+		const XMVECTOR sy = XMVectorSubtract(ray.Oy, XMLoadFloat4(&packet.V0[1]));
+		const XMVECTOR sz = XMVectorSubtract(ray.Oz, XMLoadFloat4(&packet.V0[2]));
+		u                 = XMVectorMultiply(XMVectorMultiplyAdd(sx, px, XMVectorMultiplyAdd(sy, py, XMVectorMultiply(sz, pz))), invDet);
+
+		// q = s x e1, v = (d . q) / det, t = (e2 . q) / det
+		const XMVECTOR qx = XMVectorSubtract(XMVectorMultiply(sy, e1z), XMVectorMultiply(sz, e1y));
+		const XMVECTOR qy = XMVectorSubtract(XMVectorMultiply(sz, e1x), XMVectorMultiply(sx, e1z));
+		const XMVECTOR qz = XMVectorSubtract(XMVectorMultiply(sx, e1y), XMVectorMultiply(sy, e1x));
+		v                 = XMVectorMultiply(XMVectorMultiplyAdd(ray.Dx, qx, XMVectorMultiplyAdd(ray.Dy, qy, XMVectorMultiply(ray.Dz, qz))), invDet);
+		t                 = XMVectorMultiply(XMVectorMultiplyAdd(e2x, qx, XMVectorMultiplyAdd(e2y, qy, XMVectorMultiply(e2z, qz))), invDet);
+
+		// Comparisons with NaN are false, so lanes with det = 0 (padding, or a ray in the triangle's plane) drop out.
+		const XMVECTOR zero = XMVectorZero();
+		XMVECTOR       mask = XMVectorGreater(XMVectorAbs(det), XMVectorReplicate(1e-12f));
+		mask                = XMVectorAndInt(mask, XMVectorGreaterOrEqual(u, zero));
+		mask                = XMVectorAndInt(mask, XMVectorGreaterOrEqual(v, zero));
+		mask                = XMVectorAndInt(mask, XMVectorLessOrEqual(XMVectorAdd(u, v), XMVectorSplatOne()));
+		mask                = XMVectorAndInt(mask, XMVectorGreater(t, zero));
+		mask                = XMVectorAndInt(mask, XMVectorLess(t, tMax));
+		return BvhUtil::LaneMask(mask);
+	}
+
+	inline void WriteLane(TriangleBvh::TrianglePacket& packet, UINT lane, const XMFLOAT3& v0, const XMFLOAT3& v1, const XMFLOAT3& v2)
+	{
+		(&packet.V0[0].x)[lane] = v0.x;
+		(&packet.V0[1].x)[lane] = v0.y;
+		(&packet.V0[2].x)[lane] = v0.z;
+		(&packet.E1[0].x)[lane] = v1.x - v0.x;
+		(&packet.E1[1].x)[lane] = v1.y - v0.y;
+		(&packet.E1[2].x)[lane] = v1.z - v0.z;
+		(&packet.E2[0].x)[lane] = v2.x - v0.x;
+		(&packet.E2[1].x)[lane] = v2.y - v0.y;
+		(&packet.E2[2].x)[lane] = v2.z - v0.z;
+	}
+}
+
+struct TriangleBvh::BuildState
+{
+	std::vector<XMFLOAT3>     Vertices; // three per mesh triangle
+	std::vector<BvhUtil::Box> Bounds;   // of every mesh triangle
+	std::vector<XMFLOAT3>     Centroid;
+	std::vector<UINT>         Depth;    // depth of every node, to keep the traversal stack bounded
+};
+
+void TriangleBvh::Build(const XMFLOAT3* positions,
+                        UINT            positionStride,
+                        UINT            vertexCount,
+                        const uint32_t* indices,
+                        UINT            indexCount)
+{
+	const UINT triangleCount = indexCount / 3;
+
+	mNodes.clear();
+	mPackets.clear();
+	mTriangleIds.resize(triangleCount);
+	mTriangleCount = triangleCount;
+
+	if (triangleCount == 0)
+		return;
+
+	auto position = [&](uint32_t index) -> const XMFLOAT3&
+	{
+		assert(index < vertexCount);
+		return *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const BYTE*>(positions) + size_t(index) * positionStride);
+	};
+
+	BuildState state;
+	state.Vertices.resize(3 * size_t(triangleCount));
+	state.Bounds.resize(triangleCount);
+	state.Centroid.resize(triangleCount);
+	for (UINT i = 0; i < triangleCount; ++i)
+	{
+		const XMFLOAT3& v0 = state.Vertices[3 * i + 0] = position(indices[3 * i + 0]);
+		const XMFLOAT3& v1 = state.Vertices[3 * i + 1] = position(indices[3 * i + 1]);
+		const XMFLOAT3& v2 = state.Vertices[3 * i + 2] = position(indices[3 * i + 2]);
+
+		BvhUtil::Box& box = state.Bounds[i];
+		box.Min           = v0;
+		box.Max           = v0;
+		BvhUtil::Grow(box.Min, box.Max, v1, v1);
+		BvhUtil::Grow(box.Min, box.Max, v2, v2);
+		state.Centroid[i] = XMFLOAT3(0.5f * (box.Min.x + box.Max.x), 0.5f * (box.Min.y + box.Max.y), 0.5f * (box.Min.z + box.Max.z));
+		mTriangleIds[i] = i;
+	}
+
+	// A binary tree with leaves of at least one triangle has at most 2n - 1 nodes.
+	mNodes.reserve(2 * size_t(triangleCount));
+	state.Depth.reserve(2 * size_t(triangleCount));
+
+	// While building, LeftOrFirst and Count hold the triangle range of every node.
+	Node root;
+	root.LeftOrFirst = 0;
+	root.Count       = triangleCount;
+	mNodes.push_back(root);
+	state.Depth.push_back(0);
+
+	// Nodes are fitted and split in creation order, so children always come after their parent.
+	for (UINT node = 0; node < (UINT)mNodes.size(); ++node)
+	{
+		FitNode(node, state);
+		Subdivide(node, state);
+	}
+
+	// Copy the vertices into packets in leaf order. Every leaf starts a packet, so its slots become
+	// packet * 4 + lane and the padding lanes at the end of a leaf keep zero edges.
+	UINT packetCount = 0;
+	for (const Node& n : mNodes)
+		packetCount += (n.Count + 3) / 4;
+
+	TrianglePacket empty;
+	memset(&empty, 0, sizeof(empty));
+	mPackets.assign(packetCount, empty);
+
+	std::vector<UINT> leafOrder;
+	leafOrder.swap(mTriangleIds);
+	mTriangleIds.assign(4 * size_t(packetCount), kNoHit);
+
+	UINT packet = 0;
+	for (Node& n : mNodes)
+	{
+		if (n.Count == 0)
+			continue;
+
+		const UINT first = n.LeftOrFirst;
+		n.LeftOrFirst    = 4 * packet;
+		for (UINT i = 0; i < n.Count; ++i)
+		{
+			const UINT triangle = leafOrder[first + i];
+			WriteLane(mPackets[packet + i / 4], i % 4,
+			          state.Vertices[3 * triangle + 0], state.Vertices[3 * triangle + 1], state.Vertices[3 * triangle + 2]);
+			mTriangleIds[n.LeftOrFirst + i] = triangle;
+		}
+		packet += (n.Count + 3) / 4;
+	}
+}
+
+void TriangleBvh::Build(const MeshGeometry& geo, const SubmeshGeometry& submesh)
+{
+	const BYTE* vertexData  = static_cast<const BYTE*>(geo.VertexBufferCPU->GetBufferPointer());
+	const UINT  vertexCount = geo.VertexBufferByteSize / geo.VertexByteStride;
+
+	std::vector<uint32_t> indices(submesh.IndexCount);
+	if (geo.IndexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		const uint16_t* source = static_cast<const uint16_t*>(geo.IndexBufferCPU->GetBufferPointer()) + submesh.StartIndexLocation;
+		for (UINT i = 0; i < submesh.IndexCount; ++i)
+			indices[i] = source[i] + submesh.BaseVertexLocation;
+	}
+	else
+	{
+		const uint32_t* source = static_cast<const uint32_t*>(geo.IndexBufferCPU->GetBufferPointer()) + submesh.StartIndexLocation;
+		for (UINT i = 0; i < submesh.IndexCount; ++i)
+			indices[i] = source[i] + submesh.BaseVertexLocation;
+	}
+
+	Build(reinterpret_cast<const XMFLOAT3*>(vertexData), geo.VertexByteStride, vertexCount, indices.data(), submesh.IndexCount);
+}
+
+void TriangleBvh::Subdivide(UINT node, BuildState& state)
+{
+	const UINT first = mNodes[node].LeftOrFirst;
+	const UINT count = mNodes[node].Count;
+	if (count <= kMaxLeafSize || state.Depth[node] + 1 >= kStackSize)
+		return;
+
+	const UINT leftCount = BvhUtil::PartitionSah(mTriangleIds.data() + first,
+	                                             count,
+	                                             mNodes[node].Min,
+	                                             mNodes[node].Max,
+	                                             state.Centroid.data(),
+	                                             state.Bounds.data(),
+	                                             kMaxLeafSize);
+	if (leftCount == 0)
+		return;
+
+	const UINT left  = (UINT)mNodes.size();
+	const UINT depth = state.Depth[node] + 1;
+
+	Node child;
+	child.LeftOrFirst = first;
+	child.Count       = leftCount;
+	mNodes.push_back(child);
+	child.LeftOrFirst = first + leftCount;
+	child.Count       = count - leftCount;
+	mNodes.push_back(child);
+	state.Depth.push_back(depth);
+	state.Depth.push_back(depth);
+
+	mNodes[node].LeftOrFirst = left;
+	mNodes[node].Count       = 0;
+}
+
+void TriangleBvh::FitNode(UINT node, const BuildState& state)
+{
+	Node& n = mNodes[node];
+	n.Min   = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+	n.Max   = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	for (UINT i = n.LeftOrFirst; i < n.LeftOrFirst + n.Count; ++i)
+		BvhUtil::Grow(n.Min, n.Max, state.Bounds[mTriangleIds[i]].Min, state.Bounds[mTriangleIds[i]].Max);
+}
+
+bool TriangleBvh::Intersect(FXMVECTOR origin, FXMVECTOR direction, float tMax, Hit& hit, TraceStats* stats) const
+{
+	return Trace<false>(origin, direction, tMax, &hit, stats);
+}
+
+bool TriangleBvh::Occluded(FXMVECTOR origin, FXMVECTOR direction, float tMax, TraceStats* stats) const
+{
+	return Trace<true>(origin, direction, tMax, nullptr, stats);
+}
+
+template <bool AnyHit>
+bool TriangleBvh::Trace(FXMVECTOR origin, FXMVECTOR direction, float tMax, Hit* hit, TraceStats* stats) const
+{
+	if (mNodes.empty())
+		return false;
+
+	Ray      ray;
+	XMFLOAT3 dir;
+	XMStoreFloat3(&ray.Origin, origin);
+	XMStoreFloat3(&dir, direction);
+	ray.InvDirection = XMFLOAT3(BvhUtil::SafeInverse(dir.x), BvhUtil::SafeInverse(dir.y), BvhUtil::SafeInverse(dir.z));
+	ray.Ox           = XMVectorSplatX(origin);
+	ray.Oy           = XMVectorSplatY(origin);
+	ray.Oz           = XMVectorSplatZ(origin);
+	ray.Dx           = XMVectorSplatX(direction);
+	ray.Dy           = XMVectorSplatY(direction);
+	ray.Dz           = XMVectorSplatZ(direction);
+
+	TraceStats counters;
+	float      closest = tMax;
+	bool       found   = false;
+	Hit        best;
+
+	// Far children waiting to be visited, with the distance at which the ray enters them.
+	struct Entry
+	{
+		UINT  Node;
+		float T;
+	};
+
+	Entry stack[kStackSize];
+	UINT  stackSize = 0;
+
+	float entry = 0.0f;
+	UINT  node  = 0;
+	bool  visit = BvhUtil::IntersectBox(ray, mNodes[0], closest, entry);
+	++counters.NodesVisited;
+
+	while (visit)
+	{
+		const Node& n = mNodes[node];
+		if (n.Count > 0)
+		{
+			counters.TrianglesTested += n.Count;
+
+			const UINT firstPacket = n.LeftOrFirst / 4;
+			const UINT endPacket   = firstPacket + (n.Count + 3) / 4;
+			for (UINT p = firstPacket; p < endPacket; ++p)
+			{
+				XMVECTOR   t, u, v;
+				const UINT mask = IntersectPacket(ray, mPackets[p], XMVectorReplicate(closest), t, u, v);
+				if (mask == 0)
+					continue;
+
+				found = true;
+				if (AnyHit)
+					break;
+
+				// Every lane in the mask is closer than the hit so far; keep the nearest of them.
+				XMFLOAT4 ts, us, vs;
+				XMStoreFloat4(&ts, t);
+				XMStoreFloat4(&us, u);
+				XMStoreFloat4(&vs, v);
+				for (UINT lane = 0; lane < 4; ++lane)
+				{
+					if ((mask & (1u << lane)) != 0 && (&ts.x)[lane] < closest)
+					{
+						closest       = (&ts.x)[lane];
+						best.T        = closest;
+						best.U        = (&us.x)[lane];
+						best.V        = (&vs.x)[lane];
+						best.Triangle = mTriangleIds[4 * p + lane];
+					}
+				}
+			}
+
+			if (AnyHit && found)
+				break;
+		}
+		else
+		{
+			// Visit the nearer child first and stack the other one.
+			float      leftEntry, rightEntry;
+			const UINT left     = n.LeftOrFirst;
+			const bool hitLeft  = BvhUtil::IntersectBox(ray, mNodes[left], closest, leftEntry);
+			const bool hitRight = BvhUtil::IntersectBox(ray, mNodes[left + 1], closest, rightEntry);
+			counters.NodesVisited += 2;
+
+			if (hitLeft && hitRight)
+			{
+				const bool leftFirst = leftEntry <= rightEntry;
+				stack[stackSize++]   = leftFirst ? Entry{left + 1, rightEntry} : Entry{left, leftEntry};
+				node                 = leftFirst ? left : left + 1;
+				continue;
+			}
+			if (hitLeft || hitRight)
+			{
+				node = hitLeft ? left : left + 1;
+				continue;
+			}
+		}
+
+		// Pop the next subtree the ray still reaches before the closest hit so far.
+		visit = false;
+		while (stackSize > 0)
+		{
+			const Entry& e = stack[--stackSize];
+			if (e.T < closest)
+			{
+				node  = e.Node;
+				visit = true;
+				break;
+			}
+		}
+	}
+
+	if (stats != nullptr)
+	{
+		stats->NodesVisited    += counters.NodesVisited;
+		stats->TrianglesTested += counters.TrianglesTested;
+	}
+
+	if (found && !AnyHit)
+		*hit = best;
+	return found;
+}
+
+void TriangleBvh::IntersectBatch(const RayBatch& rays, HitBatch& hits, UINT threadCount) const
+{
+	const UINT rayCount   = rays.Size();
+	const UINT chunkCount = (rayCount + kBatchChunkSize - 1) / kBatchChunkSize;
+
+	hits.Triangle.resize(rayCount);
+	hits.T.resize(rayCount);
+	hits.U.resize(rayCount);
+	hits.V.resize(rayCount);
+
+	// Every chunk writes its own range of the outputs, so the jobs share nothing.
+	ParallelFor(chunkCount, threadCount, [&](UINT chunk)
+	{
+		const UINT end = std::min(rayCount, (chunk + 1) * kBatchChunkSize);
+		for (UINT i = chunk * kBatchChunkSize; i < end; ++i)
+		{
+			const XMVECTOR origin    = XMVectorSet(rays.OriginX[i], rays.OriginY[i], rays.OriginZ[i], 1.0f);
+			const XMVECTOR direction = XMVectorSet(rays.DirectionX[i], rays.DirectionY[i], rays.DirectionZ[i], 0.0f);
+
+			Hit hit;
+			if (!Trace<false>(origin, direction, rays.TMax[i], &hit, nullptr))
+			{
+				hit.T        = rays.TMax[i];
+				hit.Triangle = kNoHit;
+			}
+
+			hits.Triangle[i] = hit.Triangle;
+			hits.T[i]        = hit.T;
+			hits.U[i]        = hit.U;
+			hits.V[i]        = hit.V;
+		}
+	});
+}
+
+UINT TriangleBvh::OccludedBatch(const RayBatch& rays, uint8_t* occluded, UINT threadCount) const
+{
+	const UINT rayCount   = rays.Size();
+	const UINT chunkCount = (rayCount + kBatchChunkSize - 1) / kBatchChunkSize;
+
+	ParallelFor(chunkCount, threadCount, [&](UINT chunk)
+	{
+		const UINT end = std::min(rayCount, (chunk + 1) * kBatchChunkSize);
+		for (UINT i = chunk * kBatchChunkSize; i < end; ++i)
+		{
+			const XMVECTOR origin    = XMVectorSet(rays.OriginX[i], rays.OriginY[i], rays.OriginZ[i], 1.0f);
+			const XMVECTOR direction = XMVectorSet(rays.DirectionX[i], rays.DirectionY[i], rays.DirectionZ[i], 0.0f);
+			occluded[i]              = Trace<true>(origin, direction, rays.TMax[i], nullptr, nullptr) ? 1 : 0;
+		}
+	});
+
+	UINT count = 0;
+	for (UINT i = 0; i < rayCount; ++i)
+		count += occluded[i];
+	return count;
+}
+
+void TriangleBvh::RayBatch::Clear()
+{
+	OriginX.clear();
+	OriginY.clear();
+	OriginZ.clear();
+	DirectionX.clear();
+	DirectionY.clear();
+	DirectionZ.clear();
+	TMax.clear();
+}
+
+void TriangleBvh::RayBatch::Reserve(UINT count)
+{
+	OriginX.reserve(count);
+	OriginY.reserve(count);
+	OriginZ.reserve(count);
+	DirectionX.reserve(count);
+	DirectionY.reserve(count);
+	DirectionZ.reserve(count);
+	TMax.reserve(count);
+}
+
+void TriangleBvh::RayBatch::Add(FXMVECTOR origin, FXMVECTOR direction, float tMax)
+{
+	OriginX.push_back(XMVectorGetX(origin));
+	OriginY.push_back(XMVectorGetY(origin));
+	OriginZ.push_back(XMVectorGetZ(origin));
+	DirectionX.push_back(XMVectorGetX(direction));
+	DirectionY.push_back(XMVectorGetY(direction));
+	DirectionZ.push_back(XMVectorGetZ(direction));
+	TMax.push_back(tMax);
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "ParallelFor.h"
+
+/**
+ * \brief Bounding volume hierarchy over the triangles of one mesh, for ray queries on the CPU
+ * (picking, line of sight, ambient occlusion baking).
+ *
+ * Built once, top-down with a binned surface area heuristic. Nodes are 32 bytes, two to a cache line,
+ * and the children of a node are adjacent. The triangles of every leaf are copied into packets of four
+ * in structure-of-arrays form, so a leaf reads one contiguous run of memory instead of gathering through
+ * the index buffer, and one ray is tested against four triangles per SIMD step.
+ *
+ * Queries are in the local space of the mesh. The ray direction does not need to be unit length;
+ * hit distances are in units of it.
+ */
+class TriangleBvh
+{
+public:
+	struct Node
+	{
+		DirectX::XMFLOAT3 Min;
+		UINT              LeftOrFirst; // interior: first child, the second is LeftOrFirst + 1; leaf: first triangle slot
+		DirectX::XMFLOAT3 Max;
+		UINT              Count;       // triangles of a leaf, 0 for an interior node
+	};
+
+	// Four triangles, one per lane: the first vertex and the two edges leaving it, x/y/z in separate vectors.
+	// Leaves start on a packet boundary; unused lanes have zero edges, which no ray can hit.
+	struct TrianglePacket
+	{
+		DirectX::XMFLOAT4 V0[3];
+		DirectX::XMFLOAT4 E1[3]; // V1 - V0
+		DirectX::XMFLOAT4 E2[3]; // V2 - V0
+	};
+
+	struct Hit
+	{
+		float T        = 0.0f;
+		float U        = 0.0f; // barycentric weight of V1
+		float V        = 0.0f; // barycentric weight of V2
+		UINT  Triangle = 0;    // index of the triangle in the mesh, i.e. its indices start at 3 * Triangle
+	};
+
+	struct TraceStats
+	{
+		UINT NodesVisited    = 0;
+		UINT TrianglesTested = 0;
+	};
+
+	// Rays in structure-of-arrays form, for the batch queries.
+	struct RayBatch
+	{
+		std::vector<float> OriginX;
+		std::vector<float> OriginY;
+		std::vector<float> OriginZ;
+		std::vector<float> DirectionX;
+		std::vector<float> DirectionY;
+		std::vector<float> DirectionZ;
+		std::vector<float> TMax;
+
+		void Clear();
+		void Reserve(UINT count);
+		void Add(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax);
+
+		UINT Size() const { return (UINT)TMax.size(); }
+	};
+
+	// Closest hit of every ray of a batch; Triangle is kNoHit where the ray missed.
+	struct HitBatch
+	{
+		std::vector<UINT>  Triangle;
+		std::vector<float> T;
+		std::vector<float> U;
+		std::vector<float> V;
+	};
+
+	static constexpr UINT kNoHit          = ~0u;
+	static constexpr UINT kBatchChunkSize = 256; // rays per job of the batch queries
+	static constexpr UINT kStackSize      = 64;  // traversal stack entries; the build stops splitting deeper
+
+	/**
+	 * \brief Builds the tree of a triangle list.
+	 * \param positions First position; consecutive positions are positionStride bytes apart
+	 */
+	void Build(const DirectX::XMFLOAT3* positions,
+	           UINT                     positionStride,
+	           UINT                     vertexCount,
+	           const uint32_t*          indices,
+	           UINT                     indexCount);
+
+	// Builds the tree of a submesh from the CPU copies of the buffers; the position must be the first vertex element.
+	void Build(const MeshGeometry& geo, const SubmeshGeometry& submesh);
+
+	UINT TriangleCount() const { return mTriangleCount; }
+	UINT NodeCount() const { return (UINT)mNodes.size(); }
+
+	const Node& GetNode(UINT node) const { return mNodes[node]; }
+
+	// Mesh triangle in a leaf slot, LeftOrFirst .. LeftOrFirst + Count - 1 of a leaf node.
+	UINT TriangleAt(UINT slot) const { return mTriangleIds[slot]; }
+
+	// Closest hit with 0 < t < tMax. Returns false and leaves hit untouched when the ray misses.
+	bool Intersect(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, Hit& hit, TraceStats* stats = nullptr) const;
+
+	// True if any triangle lies on the ray with 0 < t < tMax; stops at the first one found.
+	bool Occluded(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, TraceStats* stats = nullptr) const;
+
+	// Closest hits of a batch of rays, in chunks of kBatchChunkSize on up to threadCount threads (0 = one per hardware thread).
+	void IntersectBatch(const RayBatch& rays, HitBatch& hits, UINT threadCount) const;
+
+	// Any-hit queries of a batch of rays; occluded[i] is set to 1 or 0. Returns the number of occluded rays.
+	UINT OccludedBatch(const RayBatch& rays, uint8_t* occluded, UINT threadCount) const;
+
+private:
+	static constexpr UINT kMaxLeafSize = 4;
+
+	struct BuildState;
+
+	void Subdivide(UINT node, BuildState& state);
+	void FitNode(UINT node, const BuildState& state);
+
+	template <bool AnyHit>
+	bool Trace(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, Hit* hit, TraceStats* stats) const;
+
+private:
+	std::vector<Node>           mNodes;
+	std::vector<TrianglePacket> mPackets;     // leaf triangles, four per packet
+	std::vector<UINT>           mTriangleIds; // mesh triangle of every slot, kNoHit for padding
+	UINT                        mTriangleCount = 0;
+};
@@ -0,0 +1,183 @@
+#include "TwoLevelBvh.h"
+#include "BvhUtil.h"
+
+using namespace DirectX;
+
+namespace
+{
+	BoundingBox WorldBounds(const TriangleBvh& mesh, FXMMATRIX world)
+	{
+		// The root of the mesh tree bounds every triangle; an empty mesh gets an empty box at the origin.
+		BoundingBox local(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+		if (mesh.NodeCount() > 0)
+		{
+			const TriangleBvh::Node& root = mesh.GetNode(0);
+			BoundingBox::CreateFromPoints(local, XMLoadFloat3(&root.Min), XMLoadFloat3(&root.Max));
+		}
+
+		BoundingBox bounds;
+		local.Transform(bounds, world);
+		return bounds;
+	}
+}
+
+UINT TwoLevelBvh::AddInstance(const TriangleBvh* mesh, FXMMATRIX world)
+{
+	assert(mesh != nullptr);
+
+	Instance instance;
+	instance.Mesh = mesh;
+	XMStoreFloat4x4(&instance.InvWorld, XMMatrixInverse(nullptr, world));
+
+	mInstances.push_back(instance);
+	mWorldBounds.push_back(WorldBounds(*mesh, world));
+	return (UINT)mInstances.size() - 1;
+}
+
+void TwoLevelBvh::Clear()
+{
+	mInstances.clear();
+	mWorldBounds.clear();
+	mTopLevel.Build(nullptr, 0);
+}
+
+void TwoLevelBvh::Build()
+{
+	mTopLevel.Build(mWorldBounds.data(), (UINT)mWorldBounds.size());
+}
+
+void TwoLevelBvh::SetTransform(UINT instance, FXMMATRIX world)
+{
+	Instance& inst = mInstances[instance];
+	XMStoreFloat4x4(&inst.InvWorld, XMMatrixInverse(nullptr, world));
+
+	mWorldBounds[instance] = WorldBounds(*inst.Mesh, world);
+	mTopLevel.SetBounds(instance, mWorldBounds[instance]);
+}
+
+void TwoLevelBvh::Refit()
+{
+	mTopLevel.Refit();
+}
+
+bool TwoLevelBvh::Intersect(FXMVECTOR origin, FXMVECTOR direction, float tMax, Hit& hit, TraceStats* stats) const
+{
+	return Trace<false>(origin, direction, tMax, &hit, stats);
+}
+
+bool TwoLevelBvh::Occluded(FXMVECTOR origin, FXMVECTOR direction, float tMax, TraceStats* stats) const
+{
+	return Trace<true>(origin, direction, tMax, nullptr, stats);
+}
+
+template <bool AnyHit>
+bool TwoLevelBvh::Trace(FXMVECTOR origin, FXMVECTOR direction, float tMax, Hit* hit, TraceStats* stats) const
+{
+	if (mTopLevel.NodeCount() == 0)
+		return false;
+
+	BvhUtil::Ray ray;
+	XMFLOAT3     dir;
+	XMStoreFloat3(&ray.Origin, origin);
+	XMStoreFloat3(&dir, direction);
+	ray.InvDirection = XMFLOAT3(BvhUtil::SafeInverse(dir.x), BvhUtil::SafeInverse(dir.y), BvhUtil::SafeInverse(dir.z));
+
+	TraceStats counters;
+	float      closest = tMax;
+	bool       found   = false;
+	Hit        best;
+
+	struct Entry
+	{
+		UINT  Node;
+		float T;
+	};
+
+	// Depth first, nearer child first; the stack holds at most one sibling per level, and the build caps the depth.
+	Entry stack[SceneBvh::kStackSize];
+	UINT  stackSize = 0;
+
+	float entry = 0.0f;
+	if (BvhUtil::IntersectBox(ray, mTopLevel.GetNode(0), closest, entry))
+		stack[stackSize++] = {0, entry};
+	++counters.NodesVisited;
+
+	while (stackSize > 0)
+	{
+		const Entry e = stack[--stackSize];
+		if (e.T >= closest)
+			continue;
+
+		const SceneBvh::Node& node = mTopLevel.GetNode(e.Node);
+		if (node.Left == 0)
+		{
+			for (UINT slot = node.First; slot < node.First + node.Count; ++slot)
+			{
+				// An affine transform keeps the ray parameter, so t is the same in both spaces.
+				const UINT      index    = mTopLevel.ObjectAt(slot);
+				const Instance& instance = mInstances[index];
+				const XMMATRIX  invWorld = XMLoadFloat4x4(&instance.InvWorld);
+				const XMVECTOR  o        = XMVector3TransformCoord(origin, invWorld);
+				const XMVECTOR  d        = XMVector3TransformNormal(direction, invWorld);
+				++counters.InstancesTested;
+
+				if (AnyHit)
+				{
+					if (instance.Mesh->Occluded(o, d, closest, &counters.Mesh))
+					{
+						found = true;
+						break;
+					}
+				}
+				else
+				{
+					TriangleBvh::Hit meshHit;
+					if (instance.Mesh->Intersect(o, d, closest, meshHit, &counters.Mesh))
+					{
+						found         = true;
+						closest       = meshHit.T;
+						best.Instance = index;
+						best.Mesh     = meshHit;
+					}
+				}
+			}
+
+			if (AnyHit && found)
+				break;
+			continue;
+		}
+
+		float      leftEntry, rightEntry;
+		const bool hitLeft  = BvhUtil::IntersectBox(ray, mTopLevel.GetNode(node.Left), closest, leftEntry);
+		const bool hitRight = BvhUtil::IntersectBox(ray, mTopLevel.GetNode(node.Left + 1), closest, rightEntry);
+		counters.NodesVisited += 2;
+
+		// Push the farther child first so the nearer one is visited next.
+		if (hitLeft && hitRight)
+		{
+			const bool leftFirst = leftEntry <= rightEntry;
+			stack[stackSize++]   = leftFirst ? Entry{node.Left + 1, rightEntry} : Entry{node.Left, leftEntry};
+			stack[stackSize++]   = leftFirst ? Entry{node.Left, leftEntry} : Entry{node.Left + 1, rightEntry};
+		}
+		else if (hitLeft)
+		{
+			stack[stackSize++] = {node.Left, leftEntry};
+		}
+		else if (hitRight)
+		{
+			stack[stackSize++] = {node.Left + 1, rightEntry};
+		}
+	}
+
+	if (stats != nullptr)
+	{
+		stats->NodesVisited         += counters.NodesVisited;
+		stats->InstancesTested      += counters.InstancesTested;
+		stats->Mesh.NodesVisited    += counters.Mesh.NodesVisited;
+		stats->Mesh.TrianglesTested += counters.Mesh.TrianglesTested;
+	}
+
+	if (found && !AnyHit)
+		*hit = best;
+	return found;
+}
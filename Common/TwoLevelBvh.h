@@ -0,0 +1,71 @@
+#pragma once
+
+#include "SceneBvh.h"
+#include "TriangleBvh.h"
+
+/**
+ * \brief Ray queries over instanced meshes. The bottom level is one TriangleBvh per mesh, shared by every
+ * instance of it; the top level is a SceneBvh over the world space bounds of the instances.
+ *
+ * The top level finds the instances whose bounds the ray crosses, nearest first. Only for those the ray is
+ * moved into the local space of the instance with its inverse world matrix and traced through the mesh
+ * tree, so no mesh data is copied per instance. Moving instances only refits the top level.
+ *
+ * The mesh trees are not owned and must outlive this object.
+ */
+class TwoLevelBvh
+{
+public:
+	struct Hit
+	{
+		UINT             Instance = 0; // index returned by AddInstance
+		TriangleBvh::Hit Mesh;         // T is in units of the world space ray direction
+	};
+
+	struct TraceStats
+	{
+		UINT                    NodesVisited    = 0; // top level nodes
+		UINT                    InstancesTested = 0; // rays moved into instance space and traced
+		TriangleBvh::TraceStats Mesh;                // summed over the bottom levels
+	};
+
+	// Adds an instance of mesh and returns its index. Call Build() once every instance is added.
+	UINT AddInstance(const TriangleBvh* mesh, DirectX::FXMMATRIX world);
+
+	void Clear();
+
+	// Builds the top level from scratch.
+	void Build();
+
+	// Moves one instance; the top level is refitted by the next Refit().
+	void SetTransform(UINT instance, DirectX::FXMMATRIX world);
+
+	// Refits the top level to the current transforms. Much cheaper than Build(), but the tree gets looser
+	// as instances drift from where they were built.
+	void Refit();
+
+	UINT InstanceCount() const { return (UINT)mInstances.size(); }
+
+	const SceneBvh& TopLevel() const { return mTopLevel; }
+
+	// Closest hit with 0 < t < tMax over every instance. Returns false and leaves hit untouched when the ray misses.
+	bool Intersect(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, Hit& hit, TraceStats* stats = nullptr) const;
+
+	// True if any instance has a triangle on the ray with 0 < t < tMax.
+	bool Occluded(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, TraceStats* stats = nullptr) const;
+
+private:
+	struct Instance
+	{
+		const TriangleBvh*  Mesh;
+		DirectX::XMFLOAT4X4 InvWorld;
+	};
+
+	template <bool AnyHit>
+	bool Trace(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float tMax, Hit* hit, TraceStats* stats) const;
+
+private:
+	std::vector<Instance>             mInstances;
+	std::vector<DirectX::BoundingBox> mWorldBounds; // kept for Build(); SceneBvh holds its own copy
+	SceneBvh                          mTopLevel;
+};
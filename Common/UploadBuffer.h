@@ -2,6 +2,35 @@
 
 #include "d3dUtil.h"
 
+/**
+ * \brief memcpy through non-temporal stores when dst is 16 byte aligned and byteSize is a multiple of 16;
+ * falls back to memcpy otherwise. Follow a batch of calls with StreamFence().
+ */
+inline void StreamCopy(void* dst, const void* src, size_t byteSize)
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	if ((reinterpret_cast<uintptr_t>(dst) & 15) == 0 && (byteSize & 15) == 0)
+	{
+		auto*       d = static_cast<__m128i*>(dst);
+		const auto* s = static_cast<const __m128i*>(src);
+		for (size_t i = 0; i < byteSize / 16; ++i)
+			_mm_stream_si128(d + i, _mm_loadu_si128(s + i));
+		return;
+	}
+#endif
+	memcpy(dst, src, byteSize);
+}
+
+/**
+ * \brief Orders the non-temporal stores of StreamCopy before any later store of the calling thread.
+ */
+inline void StreamFence()
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	_mm_sfence();
+#endif
+}
+
 /**
  * \brief A light wrapper around upload buffer (e.g. constant buffer)
  * \tparam T Data type in the upload buffer
@@ -74,6 +103,18 @@ class UploadBuffer
 			memcpy(&mMappedData[elementIndex * mElementByteSize], &data, sizeof(T));
 		}
 
+		/**
+		 * \brief Same as CopyData, but writes with non-temporal stores where possible.
+		 * The mapped memory is write-combined and the CPU never reads it back, so bypassing the cache keeps
+		 * large per-frame uploads from evicting the data being read to produce them. Safe to call from
+		 * several threads for different elements. Each writing thread must fence its stores before the buffer is
+		 * handed to the GPU: StreamFence(), or any locked instruction such as the atomic counter of ParallelFor.
+		 */
+		void StreamData(int elementIndex, const T& data)
+		{
+			StreamCopy(&mMappedData[elementIndex * mElementByteSize], &data, sizeof(T));
+		}
+
 	private:
 		Microsoft::WRL::ComPtr<ID3D12Resource> mUploadBuffer;
 		BYTE*                                  mMappedData = nullptr;
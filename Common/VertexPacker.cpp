@@ -0,0 +1,230 @@
+#include "VertexPacker.h"
+#include <cfloat>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+static_assert(sizeof(VertexPacker::PackedVertex) == 20, "PackedVertex must match InputLayout()");
+static_assert(sizeof(VertexPacker::PackedSkinnedVertex) == 28, "PackedSkinnedVertex must match SkinnedInputLayout()");
+
+namespace
+{
+	// D3D decodes an snorm16 as value / 32767, with -32768 clamped to -1.
+	inline float DecodeSnorm16(int16_t value)
+	{
+		return std::max(value / 32767.0f, -1.0f);
+	}
+
+	// acos loses small angles to float rounding near 1; atan2 of sine and cosine keeps them.
+	inline float AngleInDegrees(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMConvertToDegrees(atan2f(XMVectorGetX(XMVector3Length(XMVector3Cross(a, b))), XMVectorGetX(XMVector3Dot(a, b))));
+	}
+}
+
+VertexPacker::Quantization VertexPacker::QuantizationOf(const BoundingBox& bounds)
+{
+	Quantization quantization;
+	quantization.Offset = XMFLOAT3(bounds.Center.x - bounds.Extents.x, bounds.Center.y - bounds.Extents.y, bounds.Center.z - bounds.Extents.z);
+	quantization.Scale  = XMFLOAT3(2.0f * bounds.Extents.x, 2.0f * bounds.Extents.y, 2.0f * bounds.Extents.z);
+	return quantization;
+}
+
+VertexPacker::Report VertexPacker::Pack(PackedVertex* dst, const VertexStreams& vertices, const Quantization& quantization)
+{
+	return PackVertices(dst, vertices, quantization);
+}
+
+VertexPacker::Report VertexPacker::Pack(PackedSkinnedVertex* dst, const VertexStreams& vertices, const Quantization& quantization)
+{
+	Report report = PackVertices(dst, vertices, quantization);
+
+	for (UINT v = 0; v < vertices.VertexCount; ++v)
+	{
+		PackedSkinnedVertex& out = dst[v];
+		if (vertices.BoneIndices != nullptr)
+		{
+			const BYTE* bones = &vertices.At(vertices.BoneIndices, v);
+			for (UINT k = 0; k < 4; ++k)
+				out.BoneIndices[k] = bones[k];
+		}
+		else
+		{
+			out.BoneIndices[0] = out.BoneIndices[1] = out.BoneIndices[2] = out.BoneIndices[3] = 0;
+		}
+
+		if (vertices.BoneWeights == nullptr)
+		{
+			// Bound rigidly to the first bone.
+			out.BoneWeights[0] = 255;
+			out.BoneWeights[1] = out.BoneWeights[2] = out.BoneWeights[3] = 0;
+			continue;
+		}
+
+		const XMFLOAT3& weights = vertices.At(vertices.BoneWeights, v);
+		EncodeBoneWeights(weights, out.BoneWeights);
+
+		const float source[4] = {weights.x, weights.y, weights.z, std::max(1.0f - weights.x - weights.y - weights.z, 0.0f)};
+		for (UINT k = 0; k < 4; ++k)
+			report.MaxBoneWeightError = std::max(report.MaxBoneWeightError, fabsf(out.BoneWeights[k] / 255.0f - source[k]));
+	}
+	return report;
+}
+
+template <typename Packed>
+VertexPacker::Report VertexPacker::PackVertices(Packed* dst, const VertexStreams& vertices, const Quantization& quantization)
+{
+	Report report;
+	report.VertexCount = vertices.VertexCount;
+	report.SourceBytes = vertices.VertexCount * vertices.Stride;
+	report.PackedBytes = vertices.VertexCount * sizeof(Packed);
+
+	// Flat axes, such as the height of a grid, keep their offset and store zero.
+	const XMVECTOR offset  = XMLoadFloat3(&quantization.Offset);
+	const XMVECTOR scale   = XMLoadFloat3(&quantization.Scale);
+	const XMVECTOR flat    = XMVectorLessOrEqual(scale, XMVectorZero());
+	const XMVECTOR inverse = XMVectorSelect(XMVectorReciprocal(scale), XMVectorZero(), flat);
+
+	for (UINT v = 0; v < vertices.VertexCount; ++v)
+	{
+		Packed& out = dst[v];
+
+		const XMVECTOR position = XMLoadFloat3(&vertices.At(vertices.Positions, v));
+		XMFLOAT3       unorm;
+		XMStoreFloat3(&unorm, XMVectorSaturate((position - offset) * inverse) * 65535.0f + XMVectorReplicate(0.5f));
+		out.Position[0] = (uint16_t)unorm.x;
+		out.Position[1] = (uint16_t)unorm.y;
+		out.Position[2] = (uint16_t)unorm.z;
+		out.Position[3] = 0;
+
+		const XMVECTOR decoded = offset + XMVectorSet(out.Position[0], out.Position[1], out.Position[2], 0.0f) * (1.0f / 65535.0f) * scale;
+		report.MaxPositionError = std::max(report.MaxPositionError, XMVectorGetX(XMVector3Length(decoded - position)));
+
+		// Zero vectors, such as the tangents of a model without texture coordinates, store zero.
+		out.Normal[0] = out.Normal[1] = out.TangentU[0] = out.TangentU[1] = 0;
+		if (vertices.Normals != nullptr)
+			PackDirection(vertices.At(vertices.Normals, v), out.Normal, report.MaxNormalError);
+		if (vertices.TangentUs != nullptr)
+			PackDirection(vertices.At(vertices.TangentUs, v), out.TangentU, report.MaxTangentError);
+
+		out.TexC[0] = out.TexC[1] = 0;
+		if (vertices.TexCoords != nullptr)
+		{
+			const XMFLOAT2& texC = vertices.At(vertices.TexCoords, v);
+			out.TexC[0]          = XMConvertFloatToHalf(texC.x);
+			out.TexC[1]          = XMConvertFloatToHalf(texC.y);
+
+			const float error       = std::max(fabsf(XMConvertHalfToFloat(out.TexC[0]) - texC.x), fabsf(XMConvertHalfToFloat(out.TexC[1]) - texC.y));
+			report.MaxTexCoordError = std::max(report.MaxTexCoordError, error);
+		}
+	}
+	return report;
+}
+
+void VertexPacker::PackDirection(const XMFLOAT3& direction, int16_t encoded[2], float& maxError)
+{
+	const XMVECTOR vector = XMLoadFloat3(&direction);
+	if (XMVectorGetX(XMVector3LengthSq(vector)) == 0.0f)
+		return;
+
+	const XMVECTOR unit = XMVector3Normalize(vector);
+	EncodeOctahedral(unit, encoded);
+	maxError = std::max(maxError, AngleInDegrees(unit, DecodeOctahedral(encoded)));
+}
+
+std::vector<D3D12_INPUT_ELEMENT_DESC> VertexPacker::InputLayout()
+{
+	return
+	{
+		{"POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"TANGENT", 0, DXGI_FORMAT_R16G16_SNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+		{"TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
+	};
+}
+
+std::vector<D3D12_INPUT_ELEMENT_DESC> VertexPacker::SkinnedInputLayout()
+{
+	std::vector<D3D12_INPUT_ELEMENT_DESC> layout = InputLayout();
+	layout.push_back({"WEIGHTS", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 20, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0});
+	layout.push_back({"BONEINDICES", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0});
+	return layout;
+}
+
+void VertexPacker::EncodeOctahedral(FXMVECTOR n, int16_t encoded[2])
+{
+	XMFLOAT3 unit;
+	XMStoreFloat3(&unit, n);
+
+	// Project onto the octahedron |x| + |y| + |z| = 1 and fold the lower half over the diagonals.
+	const float length = fabsf(unit.x) + fabsf(unit.y) + fabsf(unit.z);
+	float       u      = length > 0.0f ? unit.x / length : 0.0f;
+	float       v      = length > 0.0f ? unit.y / length : 0.0f;
+	if (unit.z < 0.0f)
+	{
+		const float foldedU = (1.0f - fabsf(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		const float foldedV = (1.0f - fabsf(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+		u                   = foldedU;
+		v                   = foldedV;
+	}
+
+	// Of the four grid points around (u, v), keep the one that decodes closest to n.
+	const float baseU   = floorf(u * 32767.0f);
+	const float baseV   = floorf(v * 32767.0f);
+	float       bestDot = -FLT_MAX;
+	for (UINT corner = 0; corner < 4; ++corner)
+	{
+		const int16_t candidate[2] =
+		{
+			(int16_t)std::min(std::max(baseU + (corner & 1), -32767.0f), 32767.0f),
+			(int16_t)std::min(std::max(baseV + (corner >> 1), -32767.0f), 32767.0f)
+		};
+		const float dot = XMVectorGetX(XMVector3Dot(DecodeOctahedral(candidate), n));
+		if (dot > bestDot)
+		{
+			bestDot    = dot;
+			encoded[0] = candidate[0];
+			encoded[1] = candidate[1];
+		}
+	}
+}
+
+XMVECTOR VertexPacker::DecodeOctahedral(const int16_t encoded[2])
+{
+	float       x = DecodeSnorm16(encoded[0]);
+	float       y = DecodeSnorm16(encoded[1]);
+	const float z = 1.0f - fabsf(x) - fabsf(y);
+
+	// Unfold the lower half, as OctDecode in VertexPacking.hlsl does.
+	const float t = std::max(-z, 0.0f);
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+	return XMVector3Normalize(XMVectorSet(x, y, z, 0.0f));
+}
+
+void VertexPacker::EncodeBoneWeights(const XMFLOAT3& weights, uint8_t encoded[4])
+{
+	float source[4] = {std::max(weights.x, 0.0f), std::max(weights.y, 0.0f), std::max(weights.z, 0.0f), 0.0f};
+	source[3]       = std::max(1.0f - source[0] - source[1] - source[2], 0.0f);
+
+	const float sum   = source[0] + source[1] + source[2] + source[3];
+	UINT        total = 0;
+	float       remainders[4];
+	for (UINT k = 0; k < 4; ++k)
+	{
+		const float scaled = source[k] / sum * 255.0f;
+		encoded[k]         = (uint8_t)scaled;
+		remainders[k]      = scaled - encoded[k];
+		total             += encoded[k];
+	}
+
+	// Hand the bytes lost to truncation to the weights that lost the most.
+	for (; total < 255; ++total)
+	{
+		UINT largest = 0;
+		for (UINT k = 1; k < 4; ++k)
+			largest = remainders[k] > remainders[largest] ? k : largest;
+		++encoded[largest];
+		remainders[largest] = -1.0f;
+	}
+}
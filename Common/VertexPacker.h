@@ -0,0 +1,91 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+#include "VertexStreams.h"
+
+/**
+ * \brief Packs float vertices into compact formats the input assembler expands for free.
+ *
+ * Positions become 16-bit unsigned normalized coordinates inside the bounds of their mesh; the vertex
+ * shader rebuilds them as Offset + value * Scale from a Quantization in its object constants. Normals and
+ * tangents are folded onto an octahedron and stored as two 16-bit signed normalized values (Cigolle et
+ * al., "A Survey of Efficient Representations for Independent Unit Vectors", 2014); the encoder rounds
+ * towards whichever of the four nearest grid points decodes closest to the input. Texture coordinates
+ * become half floats. Bone weights become four bytes that sum to exactly 255, so a skinned vertex never
+ * gains or loses scale.
+ *
+ * A PackedVertex is 20 bytes against the 44 of GeometryGenerator::Vertex, and a PackedSkinnedVertex 28
+ * against the 60 of M3DLoader::SkinnedVertex. Common/VertexPacking.hlsl has the matching decoders.
+ */
+class VertexPacker
+{
+public:
+	struct PackedVertex
+	{
+		uint16_t Position[4]; // R16G16B16A16_UNORM, w unused
+		int16_t  Normal[2];   // R16G16_SNORM, octahedral
+		int16_t  TangentU[2]; // R16G16_SNORM, octahedral
+		uint16_t TexC[2];     // R16G16_FLOAT
+	};
+
+	struct PackedSkinnedVertex
+	{
+		uint16_t Position[4];
+		int16_t  Normal[2];
+		int16_t  TangentU[2];
+		uint16_t TexC[2];
+		uint8_t  BoneWeights[4]; // R8G8B8A8_UNORM, summing to 255
+		uint8_t  BoneIndices[4]; // R8G8B8A8_UINT
+	};
+
+	// Position = Offset + unorm * Scale, per axis.
+	struct Quantization
+	{
+		DirectX::XMFLOAT3 Offset = {0.0f, 0.0f, 0.0f};
+		DirectX::XMFLOAT3 Scale  = {1.0f, 1.0f, 1.0f};
+	};
+
+	// Largest round trip errors of one Pack call.
+	struct Report
+	{
+		UINT  VertexCount        = 0;
+		UINT  SourceBytes        = 0;
+		UINT  PackedBytes        = 0;
+		float MaxPositionError   = 0.0f; // mesh units
+		float MaxNormalError     = 0.0f; // degrees
+		float MaxTangentError    = 0.0f; // degrees
+		float MaxTexCoordError   = 0.0f; // texture coordinate units
+		float MaxBoneWeightError = 0.0f; // of a single weight
+	};
+
+	// The quantization that spans the box; use the submesh bounds so the render item can find it again.
+	static Quantization QuantizationOf(const DirectX::BoundingBox& bounds);
+
+	/**
+	 * \brief Packs vertices.VertexCount vertices into dst and measures what the round trip lost.
+	 * \param vertices Only Positions is required; missing streams pack as zero.
+	 * \param quantization Must contain every position; QuantizationOf the mesh bounds.
+	 */
+	static Report Pack(PackedVertex* dst, const VertexStreams& vertices, const Quantization& quantization);
+	static Report Pack(PackedSkinnedVertex* dst, const VertexStreams& vertices, const Quantization& quantization);
+
+	// Input layouts of both formats, with the semantics of the float layouts they replace.
+	static std::vector<D3D12_INPUT_ELEMENT_DESC> InputLayout();
+	static std::vector<D3D12_INPUT_ELEMENT_DESC> SkinnedInputLayout();
+
+	// Unit vector to and from the octahedral encoding.
+	static void              EncodeOctahedral(DirectX::FXMVECTOR n, int16_t encoded[2]);
+	static DirectX::XMVECTOR DecodeOctahedral(const int16_t encoded[2]);
+
+	// Four weights, the last implied, as bytes that sum to 255 with the largest remainders rounded up.
+	static void EncodeBoneWeights(const DirectX::XMFLOAT3& weights, uint8_t encoded[4]);
+
+private:
+	// The members both formats share.
+	template <typename Packed>
+	static Report PackVertices(Packed* dst, const VertexStreams& vertices, const Quantization& quantization);
+
+	// Encodes a direction of any length and records the angle the round trip lost.
+	static void PackDirection(const DirectX::XMFLOAT3& direction, int16_t encoded[2], float& maxError);
+};
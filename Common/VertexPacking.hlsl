@@ -0,0 +1,31 @@
+//***************************************************************************************
+// VertexPacking.hlsl: decoders for the vertex formats of VertexPacker.h.
+//
+// The input assembler already turns the UNORM, SNORM and FLOAT formats into floats:
+//   POSITION     R16G16B16A16_UNORM  float3 in [0, 1] inside the mesh bounds
+//   NORMAL       R16G16_SNORM        float2 octahedral
+//   TANGENT      R16G16_SNORM        float2 octahedral
+//   TEXCOORD     R16G16_FLOAT        float2, used as is
+//   WEIGHTS      R8G8B8A8_UNORM      float4 summing to 1, used as is
+//   BONEINDICES  R8G8B8A8_UINT       uint4, used as is
+//***************************************************************************************
+
+#ifndef VERTEX_PACKING_HLSL
+#define VERTEX_PACKING_HLSL
+
+// Rebuilds a position from the VertexPacker::Quantization of its mesh.
+float3 DecodePosition(float3 unorm, float3 offset, float3 scale)
+{
+	return offset + unorm * scale;
+}
+
+// Unfolds the lower half of the octahedron; matches VertexPacker::DecodeOctahedral.
+float3 OctDecode(float2 e)
+{
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float  t = saturate(-n.z);
+	n.xy += n.xy >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+#endif // VERTEX_PACKING_HLSL
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "d3dUtil.h"
+#include "GeometryGenerator.h"
+#include <type_traits>
+
+/**
+ * \brief Attribute streams of an interleaved vertex buffer, as read by MeshSimplifier, VertexPacker and
+ * TangentGenerator. Every pointer is to the member of the first vertex, and consecutive vertices are Stride
+ * bytes apart. Each tool states which streams it needs and ignores the others.
+ */
+struct VertexStreams
+{
+	UINT                     VertexCount = 0;
+	UINT                     Stride      = 0;
+	const DirectX::XMFLOAT3* Positions   = nullptr;
+	const DirectX::XMFLOAT3* Normals     = nullptr;
+	const DirectX::XMFLOAT3* TangentUs   = nullptr;
+	const DirectX::XMFLOAT2* TexCoords   = nullptr;
+	const DirectX::XMFLOAT3* BoneWeights = nullptr; // the fourth weight is 1 minus the others, as in M3DLoader::SkinnedVertex
+	const BYTE*              BoneIndices = nullptr; // four per vertex
+
+	// Member of vertex v in the stream whose first member is first.
+	template <typename T>
+	static T& At(T* first, UINT stride, UINT v)
+	{
+		using Byte = typename std::conditional<std::is_const<T>::value, const uint8_t, uint8_t>::type;
+		return *reinterpret_cast<T*>(reinterpret_cast<Byte*>(first) + (size_t)v * stride);
+	}
+
+	template <typename T>
+	const T& At(const T* stream, UINT v) const
+	{
+		return At(stream, Stride, v);
+	}
+
+	// Streams of a generated mesh.
+	static VertexStreams Describe(const GeometryGenerator::MeshData& mesh)
+	{
+		VertexStreams streams;
+		streams.VertexCount = (UINT)mesh.Vertices.size();
+		streams.Stride      = sizeof(GeometryGenerator::Vertex);
+		if (!mesh.Vertices.empty())
+		{
+			streams.Positions = &mesh.Vertices[0].Position;
+			streams.Normals   = &mesh.Vertices[0].Normal;
+			streams.TangentUs = &mesh.Vertices[0].TangentU;
+			streams.TexCoords = &mesh.Vertices[0].TexC;
+		}
+		return streams;
+	}
+};
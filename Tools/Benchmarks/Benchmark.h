@@ -0,0 +1,53 @@
+#pragma once
+
+#include "../../Common/d3dUtil.h"
+#include "../../Common/GeometryGenerator.h"
+#include <cfloat>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * \brief Best wall clock time of repeatCount runs of fn, in milliseconds.
+ * The best run rather than the mean is reported so that one descheduled run does not skew the table.
+ */
+template <typename Fn>
+double MeasureMilliseconds(int repeatCount, const Fn& fn)
+{
+	double best = DBL_MAX;
+	for (int i = 0; i < repeatCount; ++i)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		fn();
+		auto end = std::chrono::high_resolution_clock::now();
+		best     = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	return best;
+}
+
+// Models shipped with the demos, relative to Tools/Benchmarks where the benchmarks run.
+extern const char* const kSkullPath;
+extern const char* const kCarPath;
+extern const char* const kSoldierPath;
+
+// Loads a model in the text format of skull.txt and car.txt (positions and normals). False if it is missing.
+bool LoadTextModel(const char* path, GeometryGenerator::MeshData& mesh);
+
+// Benchmark entry points, registered in BenchmarkMain.cpp.
+void RunMipGeneratorBenchmark();
+void RunFrustumCullingBenchmark();
+void RunCullUploadBenchmark();
+void RunSceneBvhBenchmark();
+void RunOcclusionCullingBenchmark();
+void RunTriangleBvhBenchmark();
+void RunRayBatchBenchmark();
+void RunTwoLevelBvhBenchmark();
+void RunMeshOptimizerBenchmark();
+void RunOverdrawBenchmark();
+void RunMeshletBenchmark();
+void RunSimplifierBenchmark();
+void RunVertexPackerBenchmark();
+void RunIndexSplitterBenchmark();
+void RunWeldBenchmark();
+void RunTangentBenchmark();
+void RunShapeWriterBenchmark();
@@ -0,0 +1,77 @@
+//***************************************************************************************
+// BenchmarkMain.cpp
+//
+// Micro benchmarks for the CPU side of the demos.
+//
+// Usage: Benchmarks [name]...   (no name runs everything, -list prints the names)
+//***************************************************************************************
+
+#include "Benchmark.h"
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+	struct BenchmarkEntry
+	{
+		const char* Name;
+		const char* Description;
+		void (*Run)();
+	};
+
+	const BenchmarkEntry kBenchmarks[] =
+	{
+		{"mips", "CPU mip chain generation (MipGenerator)", RunMipGeneratorBenchmark},
+		{"cull", "Frustum culling: per-instance frustum transform vs SoA planes (FrustumCuller)", RunFrustumCullingBenchmark},
+		{"cullupload", "100k instance cull + instance buffer upload: serial memcpy vs parallel streaming stores", RunCullUploadBenchmark},
+		{"bvh", "1M object scene: flat frustum culling vs SceneBvh traversal, plus refit cost", RunSceneBvhBenchmark},
+		{"occlusion", "Software occlusion culling of 20k props behind the LandAndWaves hills (OcclusionCuller)", RunOcclusionCullingBenchmark},
+		{"pick", "Ray picking on a 2M triangle mesh: brute force vs TriangleBvh closest and any hit", RunTriangleBvhBenchmark},
+		{"rays", "Batched ambient occlusion rays on the skull: packet kernel, 1 thread vs all threads (TriangleBvh)", RunRayBatchBenchmark},
+		{"tlas", "Picking across 250k instances of shared meshes: every instance vs TwoLevelBvh, refit vs rebuild", RunTwoLevelBvhBenchmark},
+		{"meshopt", "Vertex cache and fetch reordering (MeshOptimizer): ACMR/ATVR before and after", RunMeshOptimizerBenchmark},
+		{"overdraw", "Overdraw ordering of opaque meshes (MeshOptimizer): ACMR and CPU rasterized overdraw per threshold", RunOverdrawBenchmark},
+		{"meshlets", "Meshlets of 64 vertices / 124 triangles: frustum and normal cone culling vs triangles rejected (MeshletMesh)", RunMeshletBenchmark},
+		{"simplify", "Quadric edge collapse LOD chains (MeshSimplifier): time, reported vs measured error per level", RunSimplifierBenchmark},
+		{"vertexpack", "Quantized vertex formats (VertexPacker): bytes before and after, largest round trip errors", RunVertexPackerBenchmark},
+		{"split", "16-bit index splitting of meshes past 65536 vertices (IndexSplitter): parts, copied vertices, index bytes", RunIndexSplitterBenchmark},
+		{"weld", "Vertex welding of generated and imported meshes (MeshWelder): exact, ignoring attributes, within an epsilon", RunWeldBenchmark},
+		{"tangents", "Tangent generation from texture coordinates (TangentGenerator): 1 thread vs all, error to analytic tangents, determinism", RunTangentBenchmark},
+		{"shapes", "Procedural shapes: MeshData + app vertex copies vs written in place through a VertexLayout (GeometryGenerator)", RunShapeWriterBenchmark},
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "-list") == 0)
+	{
+		for (const auto& benchmark : kBenchmarks)
+			cout << setw(12) << left << benchmark.Name << benchmark.Description << endl;
+		return 0;
+	}
+
+	int ran = 0;
+	for (const auto& benchmark : kBenchmarks)
+	{
+		bool selected = argc == 1;
+		for (int i = 1; i < argc; ++i)
+			selected |= strcmp(argv[i], benchmark.Name) == 0;
+
+		if (!selected)
+			continue;
+
+		cout << "== " << benchmark.Name << ": " << benchmark.Description << endl;
+		benchmark.Run();
+		cout << endl;
+		++ran;
+	}
+
+	if (ran == 0)
+	{
+		cout << "no benchmark matches; use -list to see the names" << endl;
+		return 1;
+	}
+
+	return 0;
+}
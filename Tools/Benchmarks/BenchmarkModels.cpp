@@ -0,0 +1,41 @@
+#include "Benchmark.h"
+#include <fstream>
+
+using namespace std;
+using namespace DirectX;
+
+const char* const kSkullPath   = "../../Chapter 21 Ambient Occlusion/Ssao/Models/skull.txt";
+const char* const kCarPath     = "../../Chapter 17 Picking/Picking/Models/car.txt";
+const char* const kSoldierPath = "../../Chapter 23 Character Animation/SkinnedMesh/Models/soldier.m3d";
+
+bool LoadTextModel(const char* path, GeometryGenerator::MeshData& mesh)
+{
+	ifstream fin(path);
+	if (!fin)
+		return false;
+
+	UINT   vcount = 0;
+	UINT   tcount = 0;
+	string ignore;
+
+	fin >> ignore >> vcount;
+	fin >> ignore >> tcount;
+	fin >> ignore >> ignore >> ignore >> ignore;
+
+	// Only positions and normals are stored; the rest of every vertex is left zero.
+	mesh.Vertices.assign(vcount, GeometryGenerator::Vertex(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f),
+	                                                       XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT2(0.0f, 0.0f)));
+	for (UINT i = 0; i < vcount; ++i)
+	{
+		fin >> mesh.Vertices[i].Position.x >> mesh.Vertices[i].Position.y >> mesh.Vertices[i].Position.z;
+		fin >> mesh.Vertices[i].Normal.x >> mesh.Vertices[i].Normal.y >> mesh.Vertices[i].Normal.z;
+	}
+
+	fin >> ignore >> ignore >> ignore;
+
+	mesh.Indices32.resize(3 * tcount);
+	for (UINT i = 0; i < tcount; ++i)
+		fin >> mesh.Indices32[i * 3 + 0] >> mesh.Indices32[i * 3 + 1] >> mesh.Indices32[i * 3 + 2];
+
+	return !fin.fail();
+}
@@ -0,0 +1,212 @@
+#include "Benchmark.h"
+#include "../../Common/FrustumCuller.h"
+#include "../../Common/UploadBuffer.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	struct Instance
+	{
+		XMFLOAT4X4 World;
+	};
+
+	// Same layout as InstancingAndCulling's InstanceData (144 bytes).
+	struct GpuInstance
+	{
+		XMFLOAT4X4 World;
+		XMFLOAT4X4 TexTransform;
+		UINT       MaterialIndex;
+		UINT       Pad[3];
+	};
+
+	inline void BuildGpuInstance(const Instance& instance, UINT materialIndex, GpuInstance& data)
+	{
+		XMStoreFloat4x4(&data.World, XMMatrixTranspose(XMLoadFloat4x4(&instance.World)));
+		XMStoreFloat4x4(&data.TexTransform, XMMatrixIdentity());
+		data.MaterialIndex = materialIndex;
+	}
+
+	// The per-instance test InstancingAndCullingApp::UpdateInstanceData used to run: invert the world
+	// matrix, move the view space frustum into local space and test the local bounds.
+	UINT CullWithFrustumTransform(const vector<Instance>& instances,
+	                              const BoundingBox&      localBounds,
+	                              const BoundingFrustum&  viewFrustum,
+	                              FXMMATRIX               view,
+	                              UINT*                   visible)
+	{
+		XMMATRIX invView = XMMatrixInverse(&XMMatrixDeterminant(view), view);
+
+		UINT visibleCount = 0;
+		for (UINT i = 0; i < (UINT)instances.size(); ++i)
+		{
+			XMMATRIX world    = XMLoadFloat4x4(&instances[i].World);
+			XMMATRIX invWorld = XMMatrixInverse(&XMMatrixDeterminant(world), world);
+
+			BoundingFrustum localSpaceFrustum;
+			viewFrustum.Transform(localSpaceFrustum, XMMatrixMultiply(invView, invWorld));
+
+			if (localSpaceFrustum.Contains(localBounds) != DISJOINT)
+				visible[visibleCount++] = i;
+		}
+		return visibleCount;
+	}
+}
+
+void RunFrustumCullingBenchmark()
+{
+	// Roughly the skull's local bounds.
+	const BoundingBox localBounds(XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(4.0f, 4.0f, 4.0f));
+
+	// The demo's camera: 45 degree vertical field of view, 1..1000, looking down +z from the origin.
+	const XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+	                                       XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+	                                       XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const XMMATRIX proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+
+	BoundingFrustum viewFrustum;
+	BoundingFrustum::CreateFromMatrix(viewFrustum, proj);
+
+	cout << setw(10) << right << "instances" << setw(14) << "method" << setw(12) << "ms"
+		<< setw(14) << "ns/instance" << setw(10) << "visible" << setw(10) << "speedup" << endl;
+	cout << fixed << setprecision(3);
+
+	for (UINT instanceCount : {125u, 10000u, 1000000u})
+	{
+		// Instances spread through a cube around the camera with random orientation and scale,
+		// so roughly a tenth of them are in view, as in the demo's grid.
+		const float halfSize = 5.0f * powf((float)instanceCount, 1.0f / 3.0f) + 100.0f;
+
+		mt19937                          rng(instanceCount);
+		uniform_real_distribution<float> position(-halfSize, halfSize);
+		uniform_real_distribution<float> angle(0.0f, XM_2PI);
+		uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+		vector<Instance> instances(instanceCount);
+		FrustumCuller    culler;
+		culler.Reserve(instanceCount);
+		for (auto& instance : instances)
+		{
+			XMMATRIX world = XMMatrixScaling(scale(rng), scale(rng), scale(rng)) *
+			                 XMMatrixRotationRollPitchYaw(angle(rng), angle(rng), angle(rng)) *
+			                 XMMatrixTranslation(position(rng), position(rng), position(rng));
+			XMStoreFloat4x4(&instance.World, world);
+
+			BoundingBox worldBounds;
+			localBounds.Transform(worldBounds, world);
+			culler.Add(worldBounds);
+		}
+
+		vector<UINT> visible(instanceCount);
+		const int    repeatCount = instanceCount >= 1000000 ? 3 : 20;
+
+		UINT   legacyVisible = 0;
+		double legacyMs      = MeasureMilliseconds(repeatCount, [&]()
+		{
+			legacyVisible = CullWithFrustumTransform(instances, localBounds, viewFrustum, view, visible.data());
+		});
+
+		// Plane extraction is part of the per-view cost, so it is timed too.
+		UINT   soaVisible = 0;
+		double soaMs      = MeasureMilliseconds(repeatCount, [&]()
+		{
+			FrustumCuller::Frustum frustum = FrustumCuller::ExtractPlanes(XMMatrixMultiply(view, proj));
+			soaVisible                     = culler.Cull(frustum, visible.data());
+		});
+
+		const double toNs = 1.0e6 / instanceCount;
+		cout << setw(10) << instanceCount << setw(14) << "transform" << setw(12) << legacyMs
+			<< setw(14) << legacyMs * toNs << setw(10) << legacyVisible << endl;
+		cout << setw(10) << instanceCount << setw(14) << "soa planes" << setw(12) << soaMs
+			<< setw(14) << soaMs * toNs << setw(10) << soaVisible << setw(9) << legacyMs / soaMs << "x" << endl;
+	}
+
+	cout << "soa planes tests world space AABBs, so it may keep a few more instances near the frustum corners." << endl;
+}
+
+void RunCullUploadBenchmark()
+{
+	const UINT        instanceCount = 100000;
+	const BoundingBox localBounds(XMFLOAT3(0.0f, 1.0f, 0.0f), XMFLOAT3(4.0f, 4.0f, 4.0f));
+
+	// Wide enough that about half of the instances are visible, so the upload dominates.
+	const XMMATRIX view     = XMMatrixLookAtLH(XMVectorSet(0.0f, 0.0f, -600.0f, 1.0f),
+	                                           XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+	                                           XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const XMMATRIX proj     = XMMatrixPerspectiveFovLH(0.4f * XM_PI, 16.0f / 9.0f, 1.0f, 2000.0f);
+	const XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+	mt19937                          rng(instanceCount);
+	uniform_real_distribution<float> position(-300.0f, 300.0f);
+
+	vector<Instance> instances(instanceCount);
+	FrustumCuller    culler;
+	culler.Reserve(instanceCount);
+	for (auto& instance : instances)
+	{
+		XMMATRIX world = XMMatrixTranslation(position(rng), position(rng), position(rng));
+		XMStoreFloat4x4(&instance.World, world);
+
+		BoundingBox worldBounds;
+		localBounds.Transform(worldBounds, world);
+		culler.Add(worldBounds);
+	}
+
+	// Stands in for the mapped upload heap; D3D12 maps buffers 64KB aligned.
+	GpuInstance*                   mapped = static_cast<GpuInstance*>(_aligned_malloc(sizeof(GpuInstance) * instanceCount, 65536));
+	vector<UINT>                   visible(instanceCount);
+	FrustumCuller::ParallelScratch scratch;
+
+	const UINT   threadCount = ResolveThreadCount(0, ~0u);
+	const int    repeatCount = 20;
+	const double toNs        = 1.0e6 / instanceCount;
+
+	cout << instanceCount << " instances, " << threadCount << " threads" << endl;
+	cout << setw(28) << left << "method" << right << setw(12) << "ms" << setw(14) << "ns/instance"
+		<< setw(10) << "visible" << setw(10) << "speedup" << endl;
+	cout << fixed << setprecision(3);
+
+	// What UpdateInstanceData did before: cull on one thread, then CopyData one element at a time.
+	UINT   serialVisible = 0;
+	double serialMs      = MeasureMilliseconds(repeatCount, [&]()
+	{
+		const FrustumCuller::Frustum frustum = FrustumCuller::ExtractPlanes(viewProj);
+		serialVisible                        = culler.Cull(frustum, visible.data());
+		for (UINT i = 0; i < serialVisible; ++i)
+		{
+			GpuInstance data;
+			BuildGpuInstance(instances[visible[i]], 0, data);
+			memcpy(&mapped[i], &data, sizeof(data));
+		}
+	});
+	cout << setw(28) << left << "serial + memcpy" << right << setw(12) << serialMs
+		<< setw(14) << serialMs * toNs << setw(10) << serialVisible << endl;
+
+	for (bool deterministic : {true, false})
+	{
+		for (UINT threads : {1u, threadCount})
+		{
+			UINT   parallelVisible = 0;
+			double parallelMs      = MeasureMilliseconds(repeatCount, [&]()
+			{
+				const FrustumCuller::Frustum frustum = FrustumCuller::ExtractPlanes(viewProj);
+				parallelVisible = culler.CullParallel(frustum, threads, deterministic, scratch, [&](UINT slot, UINT index)
+				{
+					GpuInstance data;
+					BuildGpuInstance(instances[index], 0, data);
+					StreamCopy(&mapped[slot], &data, sizeof(data));
+				});
+				StreamFence();
+			});
+
+			ostringstream name;
+			name << (deterministic ? "ordered" : "atomic") << " stream, " << threads << "t";
+			cout << setw(28) << left << name.str() << right << setw(12) << parallelMs << setw(14) << parallelMs * toNs
+				<< setw(10) << parallelVisible << setw(9) << serialMs / parallelMs << "x" << endl;
+		}
+	}
+
+	_aligned_free(mapped);
+}
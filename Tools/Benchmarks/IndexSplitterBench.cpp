@@ -0,0 +1,98 @@
+#include "Benchmark.h"
+#include "../../Common/IndexSplitter.h"
+#include "../../Common/MeshOptimizer.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	void SplitMesh(const char* name, const GeometryGenerator::MeshData& source)
+	{
+		GeometryGenerator::MeshData mesh;
+		IndexSplitter::Result       result;
+		double                      ms = MeasureMilliseconds(3, [&]()
+		{
+			mesh   = source;
+			result = IndexSplitter::Split(mesh);
+		});
+
+		// The parts must draw the triangles of the source, winding kept, from copies of the right vertices.
+		const UINT       sourceCount = (UINT)source.Vertices.size();
+		vector<uint64_t> expected;
+		vector<uint64_t> drawn;
+		auto             key         = [](uint32_t a, uint32_t b, uint32_t c)
+		{
+			// Rotate the smallest index first so the same triangle always gets the same key.
+			while (a > b || a > c)
+			{
+				const uint32_t t = a;
+				a = b;
+				b = c;
+				c = t;
+			}
+			return ((uint64_t)a << 42) | ((uint64_t)b << 21) | c;
+		};
+		for (size_t i = 0; i < source.Indices32.size(); i += 3)
+			expected.push_back(key(source.Indices32[i], source.Indices32[i + 1], source.Indices32[i + 2]));
+
+		UINT mismatched = 0;
+		for (const SubmeshGeometry& part : result.Parts)
+		{
+			for (UINT i = 0; i < part.IndexCount; i += 3)
+			{
+				uint32_t original[3];
+				for (UINT k = 0; k < 3; ++k)
+				{
+					const uint32_t v = part.BaseVertexLocation + result.Indices[part.StartIndexLocation + i + k];
+					original[k]      = v < sourceCount ? v : result.ExtraVertices[v - sourceCount];
+					mismatched      += memcmp(&mesh.Vertices[v].Position, &source.Vertices[original[k]].Position, sizeof(XMFLOAT3)) != 0 ? 1 : 0;
+				}
+				drawn.push_back(key(original[0], original[1], original[2]));
+			}
+		}
+		sort(expected.begin(), expected.end());
+		sort(drawn.begin(), drawn.end());
+		mismatched += expected != drawn ? 1 : 0;
+
+		const UINT triangleCount = (UINT)source.Indices32.size() / 3;
+		cout << setw(20) << left << name << right << setw(9) << source.Vertices.size() << " vertices" << setw(9) << triangleCount << " tris  "
+			<< setw(3) << result.Parts.size() << " parts  " << setw(6) << result.ExtraVertices.size() << " vertices copied  indices "
+			<< setprecision(1) << source.Indices32.size() * 4 / 1024.0 << " -> " << result.Indices.size() * 2 / 1024.0 << " KB  "
+			<< setprecision(2) << ms << " ms  " << mismatched << " mismatched" << endl;
+	}
+}
+
+void RunIndexSplitterBenchmark()
+{
+	cout << fixed;
+
+	GeometryGenerator geoGen;
+	GeometryGenerator::MeshData grid = geoGen.CreateGrid(100.0f, 100.0f, 300, 300);
+	SplitMesh("grid 300x300", grid);
+	SplitMesh("sphere 500x500", geoGen.CreateSphere(1.0f, 500, 500));
+	SplitMesh("geosphere 6", geoGen.CreateGeosphere(1.0f, 6));
+
+	// Vertices in random order: most triangles span the whole buffer and need copies, until the vertex
+	// buffer is put in the order the triangles use it.
+	vector<uint32_t> order(grid.Vertices.size());
+	for (uint32_t v = 0; v < (uint32_t)order.size(); ++v)
+		order[v] = v;
+	shuffle(order.begin(), order.end(), mt19937(1));
+
+	GeometryGenerator::MeshData shuffled;
+	shuffled.Vertices.resize(grid.Vertices.size());
+	for (size_t v = 0; v < order.size(); ++v)
+		shuffled.Vertices[order[v]] = grid.Vertices[v];
+	for (uint32_t index : grid.Indices32)
+		shuffled.Indices32.push_back(order[index]);
+	SplitMesh("grid, shuffled", shuffled);
+
+	const UINT used = MeshOptimizer::OptimizeVertexFetch(shuffled.Vertices.data(), sizeof(GeometryGenerator::Vertex), (UINT)shuffled.Vertices.size(),
+	                                                     shuffled.Indices32.data(), (UINT)shuffled.Indices32.size());
+	shuffled.Vertices.resize(used);
+	SplitMesh("grid, refetched", shuffled);
+}
@@ -0,0 +1,87 @@
+#include "Benchmark.h"
+#include "../../Common/MeshOptimizer.h"
+#include "../../Chapter 23 Character Animation/SkinnedMesh/LoadM3d.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	void PrintRow(const char* name, UINT triangles, const MeshOptimizer::Report& report, double ms)
+	{
+		cout << setw(14) << left << name << right << setw(8) << triangles << " tris  "
+			<< setprecision(3) << "ACMR " << report.Before.Acmr << " -> " << report.After.Acmr
+			<< "  ATVR " << report.Before.Atvr << " -> " << report.After.Atvr
+			<< "  vertices " << report.VertexCountBefore << " -> " << report.VertexCountAfter
+			<< setprecision(2) << "  " << ms << " ms" << endl;
+	}
+
+	void OptimizeMesh(const char* name, const GeometryGenerator::MeshData& source)
+	{
+		GeometryGenerator::MeshData mesh;
+		MeshOptimizer::Report       report;
+		double                      ms = MeasureMilliseconds(3, [&]()
+		{
+			mesh   = source;
+			report = MeshOptimizer::Optimize(mesh, MeshOptimizer::Options());
+		});
+		PrintRow(name, (UINT)mesh.Indices32.size() / 3, report, ms);
+	}
+}
+
+void RunMeshOptimizerBenchmark()
+{
+	cout << fixed << "post-transform cache of " << MeshOptimizer::kDefaultCacheSize << " entries" << endl;
+
+	GeometryGenerator geoGen;
+	OptimizeMesh("geosphere 5", geoGen.CreateGeosphere(1.0f, 5));
+	OptimizeMesh("sphere", geoGen.CreateSphere(1.0f, 200, 200));
+	OptimizeMesh("grid", geoGen.CreateGrid(100.0f, 100.0f, 300, 300));
+
+	const char* models[][2] = {{"skull.txt", kSkullPath}, {"car.txt", kCarPath}};
+	for (const auto& model : models)
+	{
+		GeometryGenerator::MeshData mesh;
+		if (LoadTextModel(model[1], mesh))
+			OptimizeMesh(model[0], mesh);
+		else
+			cout << "skipped: " << model[1] << " not found (run from Tools/Benchmarks)" << endl;
+	}
+
+	// The soldier is drawn a subset at a time, so the triangles of each subset are reordered among themselves
+	// and the vertices by first use over the whole index buffer.
+	vector<M3DLoader::SkinnedVertex> vertices;
+	vector<USHORT>                   indices;
+	vector<M3DLoader::Subset>        subsets;
+	vector<M3DLoader::M3dMaterial>   mats;
+	SkinnedData                      skinInfo;
+	M3DLoader                        loader;
+	if (!loader.LoadM3d(kSoldierPath, vertices, indices, subsets, mats, skinInfo))
+	{
+		cout << "skipped: " << kSoldierPath << " not found (run from Tools/Benchmarks)" << endl;
+		return;
+	}
+
+	const UINT            vertexCount = (UINT)vertices.size();
+	MeshOptimizer::Report report;
+	report.VertexCountBefore = vertexCount;
+	report.Before            = MeshOptimizer::AnalyzeVertexCache(indices.data(), (UINT)indices.size(), vertexCount);
+
+	vector<M3DLoader::SkinnedVertex> optimized;
+	vector<USHORT>                   optimizedIndices;
+	double                           ms = MeasureMilliseconds(3, [&]()
+	{
+		optimized        = vertices;
+		optimizedIndices = indices;
+		for (const auto& subset : subsets)
+		{
+			USHORT* first = optimizedIndices.data() + 3 * subset.FaceStart;
+			MeshOptimizer::OptimizeVertexCache(first, first, 3 * subset.FaceCount, vertexCount);
+		}
+		report.VertexCountAfter = MeshOptimizer::OptimizeVertexFetch(optimized.data(), sizeof(M3DLoader::SkinnedVertex), vertexCount,
+		                                                             optimizedIndices.data(), (UINT)optimizedIndices.size());
+	});
+	report.After = MeshOptimizer::AnalyzeVertexCache(optimizedIndices.data(), (UINT)optimizedIndices.size(), report.VertexCountAfter);
+
+	PrintRow("soldier.m3d", (UINT)indices.size() / 3, report, ms);
+}
@@ -0,0 +1,151 @@
+#include "Benchmark.h"
+#include "../../Common/MeshletMesh.h"
+#include "../../Common/MeshOptimizer.h"
+#include "../../Chapter 23 Character Animation/SkinnedMesh/LoadM3d.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	// Cameras all around the model at one to three radii, looking near its centre, so some views see all of
+	// it and close ones only part.
+	void MeasureCulling(const char* name, const MeshletMesh& meshlets, const XMFLOAT3* positions, UINT stride, double buildMs)
+	{
+		const UINT meshletCount  = meshlets.MeshletCount();
+		const UINT triangleCount = meshlets.TriangleCount();
+
+		BoundingSphere sphere;
+		{
+			vector<XMFLOAT3> points(meshlets.Vertices().size());
+			for (size_t i = 0; i < points.size(); ++i)
+				points[i] = *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + (size_t)meshlets.Vertices()[i] * stride);
+			BoundingSphere::CreateFromPoints(sphere, points.size(), points.data(), sizeof(XMFLOAT3));
+		}
+
+		UINT vertexSum = 0;
+		for (UINT i = 0; i < meshletCount; ++i)
+			vertexSum += meshlets.GetMeshlet(i).VertexCount;
+
+		cout << fixed << name << ": " << triangleCount << " triangles in " << meshletCount << " meshlets (" << setprecision(1)
+			<< (float)vertexSum / meshletCount << " vertices, " << (float)triangleCount / meshletCount << " triangles each), built in "
+			<< setprecision(2) << buildMs << " ms" << endl;
+
+		const UINT                       viewCount = 1000;
+		mt19937                          rng(viewCount);
+		uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const XMMATRIX                   proj = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 0.01f * sphere.Radius, 100.0f * sphere.Radius);
+
+		vector<FrustumCuller::Frustum> frustums(viewCount);
+		vector<XMFLOAT3>               eyes(viewCount);
+		for (UINT v = 0; v < viewCount; ++v)
+		{
+			const float    z      = 2.0f * unit(rng) - 1.0f;
+			const float    phi    = XM_2PI * unit(rng);
+			const float    ring   = sqrtf(1.0f - z * z);
+			const XMVECTOR center = XMLoadFloat3(&sphere.Center);
+			const XMVECTOR eye    = center + (1.0f + 2.0f * unit(rng)) * sphere.Radius * XMVectorSet(ring * cosf(phi), z, ring * sinf(phi), 0.0f);
+			const XMVECTOR target = center + 0.5f * sphere.Radius * XMVectorSet(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f, 0.0f);
+			const XMVECTOR up     = fabsf(z) < 0.99f ? XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) : XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+			frustums[v]           = FrustumCuller::ExtractPlanes(XMMatrixLookAtLH(eye, target, up) * proj);
+			XMStoreFloat3(&eyes[v], eye);
+		}
+
+		vector<MeshletMesh::IndexRange> ranges;
+		MeshletMesh::CullStats          stats;
+		UINT                            rangeCount = 0;
+		double                          cullMs     = MeasureMilliseconds(3, [&]()
+		{
+			stats      = MeshletMesh::CullStats();
+			rangeCount = 0;
+			for (UINT v = 0; v < viewCount; ++v)
+			{
+				ranges.clear();
+				meshlets.Cull(frustums[v], XMLoadFloat3(&eyes[v]), ranges, &stats);
+				rangeCount += (UINT)ranges.size();
+			}
+		});
+
+		// What per-triangle culling would reject, and whether any triangle the rasterizer would draw was culled.
+		const vector<uint32_t>& indices    = meshlets.Indices();
+		UINT64                  backfacing = 0;
+		UINT64                  missed     = 0;
+		vector<uint8_t>         drawn(triangleCount);
+		for (UINT v = 0; v < viewCount; v += 10)
+		{
+			ranges.clear();
+			meshlets.Cull(frustums[v], XMLoadFloat3(&eyes[v]), ranges);
+			fill(drawn.begin(), drawn.end(), 0);
+			for (const auto& range : ranges)
+				fill(drawn.begin() + range.StartIndexLocation / 3, drawn.begin() + (range.StartIndexLocation + range.IndexCount) / 3, 1);
+
+			for (UINT t = 0; t < triangleCount; ++t)
+			{
+				XMVECTOR p[3];
+				for (UINT k = 0; k < 3; ++k)
+					p[k] = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const uint8_t*>(positions) + (size_t)indices[t * 3 + k] * stride));
+
+				const bool front = XMVectorGetX(XMVector3Dot(XMVector3Cross(p[1] - p[0], p[2] - p[0]), p[0] - XMLoadFloat3(&eyes[v]))) < 0.0f;
+				backfacing += front ? 0 : 1;
+
+				bool inside = true;
+				for (UINT plane = 0; plane < 6 && inside; ++plane)
+				{
+					const XMVECTOR planeVector = XMLoadFloat4(&frustums[v].Planes[plane]);
+					inside = XMVectorGetX(XMVector4Dot(planeVector, XMVectorSetW(p[0], 1.0f))) >= 0.0f &&
+					         XMVectorGetX(XMVector4Dot(planeVector, XMVectorSetW(p[1], 1.0f))) >= 0.0f &&
+					         XMVectorGetX(XMVector4Dot(planeVector, XMVectorSetW(p[2], 1.0f))) >= 0.0f;
+				}
+				missed += front && inside && !drawn[t] ? 1 : 0;
+			}
+		}
+
+		const double tested     = (double)stats.MeshletsTested;
+		const double drawnShare = stats.TrianglesVisible / ((double)triangleCount * viewCount);
+		cout << setprecision(1)
+			<< "  " << 100.0 * stats.FrustumCulled / tested << "% of meshlets outside the frustum, " << 100.0 * stats.BackfaceCulled / tested
+			<< "% facing away; " << 100.0 * (1.0 - drawnShare) << "% of triangles culled (per triangle back face culling alone: "
+			<< 100.0 * backfacing / ((double)triangleCount * (viewCount / 10)) << "%)" << endl
+			<< setprecision(2) << "  " << cullMs * 1000.0 / viewCount << " us per view (" << cullMs * 1.0e6 / tested
+			<< " ns per meshlet), " << setprecision(1) << (double)rangeCount / viewCount << " index ranges per view, "
+			<< missed << " front facing triangles inside the frustum culled" << endl;
+	}
+}
+
+void RunMeshletBenchmark()
+{
+	GeometryGenerator::MeshData skull;
+	if (LoadTextModel(kSkullPath, skull))
+	{
+		MeshOptimizer::Optimize(skull, MeshOptimizer::Options());
+
+		MeshletMesh meshlets;
+		double      buildMs = MeasureMilliseconds(3, [&]() { meshlets.Build(skull); });
+		MeasureCulling("skull.txt", meshlets, &skull.Vertices[0].Position, sizeof(GeometryGenerator::Vertex), buildMs);
+	}
+	else
+	{
+		cout << "skipped: " << kSkullPath << " not found (run from Tools/Benchmarks)" << endl;
+	}
+
+	vector<M3DLoader::SkinnedVertex> vertices;
+	vector<USHORT>                   indices;
+	vector<M3DLoader::Subset>        subsets;
+	vector<M3DLoader::M3dMaterial>   mats;
+	SkinnedData                      skinInfo;
+	M3DLoader                        loader;
+	if (!loader.LoadM3d(kSoldierPath, vertices, indices, subsets, mats, skinInfo))
+	{
+		cout << "skipped: " << kSoldierPath << " not found (run from Tools/Benchmarks)" << endl;
+		return;
+	}
+
+	// In the bind pose, as one mesh; the demo would keep one set of meshlets per subset.
+	MeshletMesh meshlets;
+	double      buildMs = MeasureMilliseconds(3, [&]()
+	{
+		meshlets.Build(indices.data(), (UINT)indices.size(), &vertices[0].Pos, sizeof(M3DLoader::SkinnedVertex), (UINT)vertices.size());
+	});
+	MeasureCulling("soldier.m3d", meshlets, &vertices[0].Pos, sizeof(M3DLoader::SkinnedVertex), buildMs);
+}
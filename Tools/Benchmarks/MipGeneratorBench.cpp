@@ -0,0 +1,107 @@
+#include "Benchmark.h"
+#include "../../Common/MipGenerator.h"
+#include <random>
+#include <thread>
+
+using namespace std;
+
+namespace
+{
+	struct MipCase
+	{
+		const char* Name;
+		DXGI_FORMAT Format;
+		UINT        Width;
+		UINT        Height;
+		UINT        ArraySize;
+	};
+
+	// Random texels; the filters do not branch on values, so content does not change the timing.
+	vector<uint8_t> MakeSource(const MipCase& mipCase)
+	{
+		vector<uint8_t> data(MipGenerator::ComputeChainBytes(mipCase.Format, mipCase.Width, mipCase.Height, 1) * mipCase.ArraySize);
+
+		mt19937 rng(1234);
+		if (mipCase.Format == DXGI_FORMAT_R32_FLOAT)
+		{
+			uniform_real_distribution<float> value(0.0f, 1.0f);
+			float*                           texels = reinterpret_cast<float*>(data.data());
+			for (size_t i = 0; i < data.size() / sizeof(float); ++i)
+				texels[i] = value(rng);
+		}
+		else if (mipCase.Format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+		{
+			uniform_real_distribution<float> value(0.0f, 4.0f);
+			auto*                            texels = reinterpret_cast<DirectX::PackedVector::HALF*>(data.data());
+			for (size_t i = 0; i < data.size() / sizeof(DirectX::PackedVector::HALF); ++i)
+				texels[i] = DirectX::PackedVector::XMConvertFloatToHalf(value(rng));
+		}
+		else
+		{
+			for (auto& byte : data)
+				byte = (uint8_t)rng();
+		}
+
+		return data;
+	}
+}
+
+void RunMipGeneratorBenchmark()
+{
+	const MipCase cases[] =
+	{
+		{"RGBA8 sRGB 2048^2", DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 2048, 2048, 1},
+		{"RGBA8 1000x600", DXGI_FORMAT_R8G8B8A8_UNORM, 1000, 600, 1},
+		{"RGBA8 208x256x3", DXGI_FORMAT_R8G8B8A8_UNORM, 208, 256, 3}, // treeArrayCorrect.dds
+		{"RGBA16F 2048^2", DXGI_FORMAT_R16G16B16A16_FLOAT, 2048, 2048, 1},
+		{"R32F 2048^2", DXGI_FORMAT_R32_FLOAT, 2048, 2048, 1},
+	};
+
+	const UINT hardwareThreads = std::max(thread::hardware_concurrency(), 1u);
+
+	cout << setw(20) << left << "surface" << setw(8) << "filter" << setw(9) << right << "threads"
+		<< setw(12) << "ms" << setw(12) << "MPixels/s" << endl;
+	cout << fixed << setprecision(2);
+
+	for (const auto& mipCase : cases)
+	{
+		const vector<uint8_t> source   = MakeSource(mipCase);
+		const UINT            mipCount = MipGenerator::CountMips(mipCase.Width, mipCase.Height);
+		vector<uint8_t>       chain(MipGenerator::ComputeChainBytes(mipCase.Format, mipCase.Width, mipCase.Height, mipCount) * mipCase.ArraySize);
+
+		// Throughput counts the mip 0 texels read, the usual figure for mip generators.
+		const double megaPixels = double(mipCase.Width) * mipCase.Height * mipCase.ArraySize / 1.0e6;
+
+		for (auto filter : {MipGenerator::Filter::Box, MipGenerator::Filter::Kaiser})
+		{
+			for (UINT threads : {1u, hardwareThreads})
+			{
+				MipGenerator::Options options;
+				options.MipFilter   = filter;
+				options.ThreadCount = threads;
+
+				double ms = MeasureMilliseconds(5, [&]()
+				{
+					MipGenerator::GenerateChain(mipCase.Format,
+					                            mipCase.Width,
+					                            mipCase.Height,
+					                            mipCase.ArraySize,
+					                            1,
+					                            source.data(),
+					                            mipCount,
+					                            chain.data(),
+					                            options);
+				});
+
+				cout << setw(20) << left << mipCase.Name
+					<< setw(8) << (filter == MipGenerator::Filter::Box ? "box" : "kaiser")
+					<< setw(9) << right << threads
+					<< setw(12) << ms
+					<< setw(12) << megaPixels / (ms / 1000.0) << endl;
+
+				if (hardwareThreads == 1)
+					break;
+			}
+		}
+	}
+}
@@ -0,0 +1,176 @@
+#include "Benchmark.h"
+#include "../../Common/FrustumCuller.h"
+#include "../../Common/GeometryGenerator.h"
+#include "../../Common/OcclusionCuller.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	// The hills of LandAndWavesApp.
+	float GetHillsHeight(float x, float z)
+	{
+		return 0.3f * (z * sinf(0.1f * x) + x * cosf(0.1f * z));
+	}
+
+	struct OcclusionFrame
+	{
+		double RasterMs;
+		double TestMs;
+		UINT   FrustumVisible;
+		UINT   Visible;
+	};
+
+	struct OcclusionScene
+	{
+		GeometryGenerator::MeshData Land;
+		GeometryGenerator::MeshData Wall;
+		vector<XMFLOAT4X4>          WallWorlds;
+		vector<BoundingBox>         Objects;
+		FrustumCuller               ObjectCuller;
+	};
+
+	OcclusionScene BuildScene()
+	{
+		GeometryGenerator geoGen;
+
+		OcclusionScene scene;
+		scene.Land = geoGen.CreateGrid(160.0f, 160.0f, 50, 50);
+		for (auto& vertex : scene.Land.Vertices)
+			vertex.Position.y = GetHillsHeight(vertex.Position.x, vertex.Position.z);
+
+		// A few large walls, like the boxes and columns of ShadowsApp.
+		scene.Wall = geoGen.CreateBox(1.0f, 1.0f, 1.0f, 0);
+		for (int i = 0; i < 6; ++i)
+		{
+			XMFLOAT4X4 world;
+			XMStoreFloat4x4(&world, XMMatrixScaling(20.0f, 12.0f, 1.5f) * XMMatrixRotationY(i * 0.5f) *
+			                        XMMatrixTranslation(-50.0f + i * 20.0f, GetHillsHeight(-50.0f + i * 20.0f, -20.0f) + 5.0f, -20.0f));
+			scene.WallWorlds.push_back(world);
+		}
+
+		// Small props standing on the terrain.
+		mt19937                          rng(34);
+		uniform_real_distribution<float> position(-78.0f, 78.0f);
+		uniform_real_distribution<float> extent(0.3f, 1.5f);
+		for (int i = 0; i < 20000; ++i)
+		{
+			const float x = position(rng);
+			const float z = position(rng);
+			const float h = extent(rng);
+
+			BoundingBox box;
+			box.Center  = XMFLOAT3(x, GetHillsHeight(x, z) + h, z);
+			box.Extents = XMFLOAT3(extent(rng), h, extent(rng));
+			scene.Objects.push_back(box);
+			scene.ObjectCuller.Add(box);
+		}
+
+		return scene;
+	}
+
+	OcclusionFrame RunFrame(const OcclusionScene& scene,
+	                        OcclusionCuller&      culler,
+	                        FXMMATRIX             viewProj,
+	                        UINT                  threadCount,
+	                        vector<UINT>&         frustumVisible,
+	                        vector<BoundingBox>&  candidates,
+	                        vector<uint8_t>&      visible)
+	{
+		OcclusionFrame frame = {};
+
+		frame.RasterMs = MeasureMilliseconds(5, [&]()
+		{
+			culler.BeginFrame(viewProj);
+			culler.AddOccluder(XMMatrixIdentity(),
+			                   &scene.Land.Vertices[0].Position,
+			                   sizeof(GeometryGenerator::Vertex),
+			                   (UINT)scene.Land.Vertices.size(),
+			                   scene.Land.Indices32.data(),
+			                   (UINT)scene.Land.Indices32.size());
+			for (const auto& world : scene.WallWorlds)
+			{
+				culler.AddOccluder(XMLoadFloat4x4(&world),
+				                   &scene.Wall.Vertices[0].Position,
+				                   sizeof(GeometryGenerator::Vertex),
+				                   (UINT)scene.Wall.Vertices.size(),
+				                   scene.Wall.Indices32.data(),
+				                   (UINT)scene.Wall.Indices32.size());
+			}
+			culler.Rasterize(threadCount);
+		});
+
+		// Only what survives the frustum test is tested for occlusion.
+		frame.FrustumVisible = scene.ObjectCuller.Cull(FrustumCuller::ExtractPlanes(viewProj), frustumVisible.data());
+		candidates.resize(frame.FrustumVisible);
+		for (UINT i = 0; i < frame.FrustumVisible; ++i)
+			candidates[i] = scene.Objects[frustumVisible[i]];
+
+		visible.resize(frame.FrustumVisible);
+		frame.TestMs = MeasureMilliseconds(5, [&]()
+		{
+			frame.Visible = culler.TestBoxes(candidates.data(), frame.FrustumVisible, visible.data(), threadCount);
+		});
+
+		return frame;
+	}
+}
+
+void RunOcclusionCullingBenchmark()
+{
+	const OcclusionScene scene = BuildScene();
+
+	const UINT      threadCount = ResolveThreadCount(0, ~0u);
+	OcclusionCuller culler(320, 192);
+
+	cout << scene.Objects.size() << " objects, " << culler.Width() << "x" << culler.Height() << " depth buffer, "
+		<< threadCount << " threads" << endl;
+	cout << setw(6) << "frame" << setw(12) << "raster ms" << setw(10) << "test ms" << setw(10) << "in view"
+		<< setw(10) << "visible" << setw(10) << "culled" << endl;
+
+	vector<UINT>        frustumVisible(scene.Objects.size());
+	vector<BoundingBox> candidates;
+	vector<uint8_t>     visible;
+	vector<uint8_t>     singleThreadVisible;
+	bool                deterministic = true;
+
+	// A camera walking across the valley, a few meters above the ground.
+	const XMMATRIX proj        = XMMatrixPerspectiveFovLH(0.25f * XM_PI, 16.0f / 9.0f, 1.0f, 1000.0f);
+	double         totalMs     = 0.0;
+	UINT           totalInView = 0;
+	UINT           totalCulled = 0;
+	const int      frameCount  = 8;
+	for (int f = 0; f < frameCount; ++f)
+	{
+		const float    x        = -60.0f + f * 15.0f;
+		const float    z        = -70.0f;
+		const XMVECTOR eye      = XMVectorSet(x, GetHillsHeight(x, z) + 4.0f, z, 1.0f);
+		const XMVECTOR target   = XMVectorSet(x * 0.5f, GetHillsHeight(x * 0.5f, 0.0f), 0.0f, 1.0f);
+		const XMMATRIX view     = XMMatrixLookAtLH(eye, target, XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const XMMATRIX viewProj = XMMatrixMultiply(view, proj);
+
+		// Same frame on one thread: the depth buffer and the results must not change.
+		RunFrame(scene, culler, viewProj, 1, frustumVisible, candidates, singleThreadVisible);
+		const vector<float> singleThreadDepth(culler.DepthBuffer(), culler.DepthBuffer() + culler.Width() * culler.Height());
+
+		const OcclusionFrame frame = RunFrame(scene, culler, viewProj, threadCount, frustumVisible, candidates, visible);
+		deterministic &= singleThreadVisible == visible &&
+			memcmp(singleThreadDepth.data(), culler.DepthBuffer(), singleThreadDepth.size() * sizeof(float)) == 0;
+
+		const UINT culled = frame.FrustumVisible - frame.Visible;
+		cout << fixed << setprecision(3) << setw(6) << f << setw(12) << frame.RasterMs << setw(10) << frame.TestMs
+			<< setw(10) << frame.FrustumVisible << setw(10) << frame.Visible << setw(9) << setprecision(1)
+			<< (frame.FrustumVisible > 0 ? 100.0 * culled / frame.FrustumVisible : 0.0) << "%" << endl;
+
+		totalMs     += frame.RasterMs + frame.TestMs;
+		totalInView += frame.FrustumVisible;
+		totalCulled += culled;
+	}
+
+	cout << setprecision(3) << "average " << totalMs / frameCount << " ms/frame, "
+		<< setprecision(1) << (totalInView > 0 ? 100.0 * totalCulled / totalInView : 0.0) << "% of the objects in view occluded, "
+		<< culler.GetStats().RasterizedTriangles << " of " << culler.GetStats().OccluderTriangles << " occluder triangles rasterized" << endl;
+	cout << "1 thread vs " << threadCount << " threads: " << (deterministic ? "identical" : "DIFFERENT") << " depth and results" << endl;
+}
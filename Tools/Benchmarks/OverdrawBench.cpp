@@ -0,0 +1,73 @@
+#include "Benchmark.h"
+#include "../../Common/MeshOptimizer.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	void MeasureOrders(const char* name, GeometryGenerator::MeshData mesh)
+	{
+		const UINT      indexCount  = (UINT)mesh.Indices32.size();
+		const UINT      vertexCount = (UINT)mesh.Vertices.size();
+		const XMFLOAT3* positions   = &mesh.Vertices[0].Position;
+		const UINT      stride      = sizeof(GeometryGenerator::Vertex);
+
+		auto printRow = [&](const char* order, const vector<uint32_t>& indices, double ms)
+		{
+			const auto cache    = MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+			const auto overdraw = MeshOptimizer::AnalyzeOverdraw(indices.data(), indexCount, positions, stride, vertexCount);
+			cout << "  " << setw(24) << left << order << right << setprecision(3) << "ACMR " << cache.Acmr
+				<< "  overdraw " << overdraw.Overdraw << setprecision(2) << "  " << ms << " ms" << endl;
+		};
+
+		cout << name << ": " << indexCount / 3 << " triangles" << endl;
+		printRow("as loaded", mesh.Indices32, 0.0);
+
+		vector<uint32_t> cacheOrder(indexCount);
+		double           cacheMs = MeasureMilliseconds(3, [&]()
+		{
+			MeshOptimizer::OptimizeVertexCache(cacheOrder.data(), mesh.Indices32.data(), indexCount, vertexCount);
+		});
+		printRow("vertex cache", cacheOrder, cacheMs);
+
+		const float thresholds[] = {1.05f, 1.25f, 3.0f};
+		for (const float threshold : thresholds)
+		{
+			vector<uint32_t> overdrawOrder(indexCount);
+			double           overdrawMs = MeasureMilliseconds(3, [&]()
+			{
+				MeshOptimizer::OptimizeOverdraw(overdrawOrder.data(), cacheOrder.data(), indexCount, positions, stride, vertexCount, threshold);
+			});
+
+			ostringstream order;
+			order << "+ overdraw, " << fixed << setprecision(2) << threshold << "x ACMR";
+			printRow(order.str().c_str(), overdrawOrder, overdrawMs);
+		}
+	}
+}
+
+void RunOverdrawBenchmark()
+{
+	cout << fixed << "overdraw: pixels passing the depth test per pixel covered, from 8 views at 256x256" << endl;
+
+	const char* models[][2] = {{"skull.txt", kSkullPath}, {"car.txt", kCarPath}};
+	for (const auto& model : models)
+	{
+		GeometryGenerator::MeshData mesh;
+		if (LoadTextModel(model[1], mesh))
+			MeasureOrders(model[0], mesh);
+		else
+			cout << "skipped: " << model[1] << " not found (run from Tools/Benchmarks)" << endl;
+	}
+
+	// Two spheres, one inside the other, so the outer one should be drawn first.
+	GeometryGenerator           geoGen;
+	GeometryGenerator::MeshData spheres = geoGen.CreateGeosphere(0.5f, 4);
+	GeometryGenerator::MeshData outer   = geoGen.CreateGeosphere(1.0f, 4);
+	const uint32_t              base    = (uint32_t)spheres.Vertices.size();
+	spheres.Vertices.insert(spheres.Vertices.end(), outer.Vertices.begin(), outer.Vertices.end());
+	for (const uint32_t i : outer.Indices32)
+		spheres.Indices32.push_back(base + i);
+	MeasureOrders("nested geospheres", spheres);
+}
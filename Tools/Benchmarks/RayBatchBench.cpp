@@ -0,0 +1,112 @@
+#include "Benchmark.h"
+#include "../../Common/TriangleBvh.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+void RunRayBatchBenchmark()
+{
+	GeometryGenerator::MeshData skull;
+	if (!LoadTextModel(kSkullPath, skull))
+	{
+		cout << "skipped: " << kSkullPath << " not found (run from Tools/Benchmarks)" << endl;
+		return;
+	}
+
+	TriangleBvh bvh;
+	bvh.Build(&skull.Vertices[0].Position, sizeof(GeometryGenerator::Vertex), (UINT)skull.Vertices.size(), skull.Indices32.data(), (UINT)skull.Indices32.size());
+
+	// Ambient occlusion style rays: cosine distributed over the hemisphere of random surface points, lifted
+	// off the surface a little so they do not hit their own triangle.
+	const UINT pointCount   = 32768;
+	const UINT raysPerPoint = 16;
+	const UINT triCount     = bvh.TriangleCount();
+
+	mt19937                          rng(triCount);
+	uniform_int_distribution<UINT>   triangle(0, triCount - 1);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	TriangleBvh::RayBatch rays;
+	rays.Reserve(pointCount * raysPerPoint);
+	for (UINT i = 0; i < pointCount; ++i)
+	{
+		const UINT* tri = &skull.Indices32[3 * triangle(rng)];
+		float       b1  = unit(rng);
+		float       b2  = unit(rng);
+		if (b1 + b2 > 1.0f)
+		{
+			b1 = 1.0f - b1;
+			b2 = 1.0f - b2;
+		}
+
+		const XMVECTOR p0 = XMLoadFloat3(&skull.Vertices[tri[0]].Position);
+		const XMVECTOR p1 = XMLoadFloat3(&skull.Vertices[tri[1]].Position);
+		const XMVECTOR p2 = XMLoadFloat3(&skull.Vertices[tri[2]].Position);
+		const XMVECTOR n  = XMVector3Normalize(XMLoadFloat3(&skull.Vertices[tri[0]].Normal) + XMLoadFloat3(&skull.Vertices[tri[1]].Normal) + XMLoadFloat3(&skull.Vertices[tri[2]].Normal));
+		const XMVECTOR p  = p0 + b1 * (p1 - p0) + b2 * (p2 - p0) + 0.01f * n;
+
+		// Tangent frame around the normal.
+		const XMVECTOR up = fabsf(XMVectorGetY(n)) < 0.999f ? XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) : XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+		const XMVECTOR t  = XMVector3Normalize(XMVector3Cross(up, n));
+		const XMVECTOR b  = XMVector3Cross(n, t);
+
+		for (UINT r = 0; r < raysPerPoint; ++r)
+		{
+			const float radius = sqrtf(unit(rng));
+			const float phi    = XM_2PI * unit(rng);
+			const float h      = sqrtf(std::max(0.0f, 1.0f - radius * radius));
+			rays.Add(p, radius * cosf(phi) * t + radius * sinf(phi) * b + h * n, 2.0f);
+		}
+	}
+
+	const UINT   rayCount = rays.Size();
+	const UINT   threads  = ResolveThreadCount(0, rayCount);
+	const double mrays    = rayCount / 1000.0; // rays per ms -> Mrays/s
+
+	cout << triCount << " triangles, " << bvh.NodeCount() << " nodes; " << rayCount << " occlusion rays of length 2 from "
+		<< pointCount << " surface points" << endl;
+
+	// One ray at a time through the single ray entry points, as a caller without the batch API would.
+	TriangleBvh::HitBatch single;
+	single.Triangle.resize(rayCount);
+	double singleMs = MeasureMilliseconds(3, [&]()
+	{
+		for (UINT i = 0; i < rayCount; ++i)
+		{
+			TriangleBvh::Hit hit;
+			const bool       found = bvh.Intersect(XMVectorSet(rays.OriginX[i], rays.OriginY[i], rays.OriginZ[i], 1.0f),
+			                                       XMVectorSet(rays.DirectionX[i], rays.DirectionY[i], rays.DirectionZ[i], 0.0f),
+			                                       rays.TMax[i], hit);
+			single.Triangle[i] = found ? hit.Triangle : TriangleBvh::kNoHit;
+		}
+	});
+
+	TriangleBvh::HitBatch hits;
+	double                closestSerialMs   = MeasureMilliseconds(3, [&]() { bvh.IntersectBatch(rays, hits, 1); });
+	double                closestParallelMs = MeasureMilliseconds(3, [&]() { bvh.IntersectBatch(rays, hits, 0); });
+
+	vector<uint8_t> occluded(rayCount);
+	UINT            occludedCount = 0;
+	double          anySerialMs   = MeasureMilliseconds(3, [&]() { occludedCount = bvh.OccludedBatch(rays, occluded.data(), 1); });
+	double          anyParallelMs = MeasureMilliseconds(3, [&]() { occludedCount = bvh.OccludedBatch(rays, occluded.data(), 0); });
+
+	UINT mismatches = 0;
+	UINT hitCount   = 0;
+	for (UINT i = 0; i < rayCount; ++i)
+	{
+		const bool found = hits.Triangle[i] != TriangleBvh::kNoHit;
+		hitCount += found ? 1 : 0;
+		if (hits.Triangle[i] != single.Triangle[i] || occluded[i] != (found ? 1 : 0))
+			++mismatches;
+	}
+
+	cout << fixed << setprecision(2)
+		<< "closest hit, one ray per call:     " << mrays / singleMs << " Mrays/s" << endl
+		<< "closest hit, batch, 1 thread:      " << mrays / closestSerialMs << " Mrays/s" << endl
+		<< "closest hit, batch, all threads:   " << mrays / closestParallelMs << " Mrays/s (" << threads << " threads)" << endl
+		<< "any hit, batch, 1 thread:          " << mrays / anySerialMs << " Mrays/s" << endl
+		<< "any hit, batch, all threads:       " << mrays / anyParallelMs << " Mrays/s (" << threads << " threads)" << endl
+		<< hitCount << " rays occluded (" << setprecision(1) << 100.0 * hitCount / rayCount << "%), any hit reports "
+		<< occludedCount << "; " << mismatches << " rays differ between the single ray and batch queries" << endl;
+}
@@ -0,0 +1,106 @@
+#include "Benchmark.h"
+#include "../../Common/SceneBvh.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	struct CullView
+	{
+		const char* Name;
+		XMFLOAT3    Eye;
+		XMFLOAT3    Target;
+		float       FovY;
+		float       FarZ;
+	};
+}
+
+void RunSceneBvhBenchmark()
+{
+	// Objects of one to six units scattered through a 4km cube, like a large open level.
+	const UINT objectCount = 1000000;
+
+	mt19937                          rng(objectCount);
+	uniform_real_distribution<float> position(-2000.0f, 2000.0f);
+	uniform_real_distribution<float> extent(0.5f, 3.0f);
+
+	vector<BoundingBox> bounds(objectCount);
+	FrustumCuller       flat;
+	flat.Reserve(objectCount);
+	for (auto& box : bounds)
+	{
+		box.Center  = XMFLOAT3(position(rng), position(rng), position(rng));
+		box.Extents = XMFLOAT3(extent(rng), extent(rng), extent(rng));
+		flat.Add(box);
+	}
+
+	SceneBvh bvh;
+	double   buildMs = MeasureMilliseconds(1, [&]() { bvh.Build(bounds.data(), objectCount); });
+
+	cout << objectCount << " objects, binned SAH build " << fixed << setprecision(1) << buildMs << " ms, "
+		<< bvh.NodeCount() << " nodes" << endl << endl;
+
+	const CullView views[] =
+	{
+		{"narrow", XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), 0.15f * XM_PI, 1000.0f},
+		{"demo", XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 1.0f), 0.25f * XM_PI, 1000.0f},
+		{"wide far", XMFLOAT3(0.0f, 0.0f, -2500.0f), XMFLOAT3(0.0f, 0.0f, 0.0f), 0.4f * XM_PI, 5000.0f},
+	};
+
+	cout << setw(10) << left << "view" << right << setw(8) << "method" << setw(10) << "ms" << setw(10) << "visible"
+		<< setw(10) << "nodes" << setw(10) << "accepted" << setw(10) << "objects" << setw(10) << "speedup" << endl;
+
+	vector<UINT> visible(objectCount);
+	for (const auto& view : views)
+	{
+		const XMMATRIX viewMatrix = XMMatrixLookAtLH(XMLoadFloat3(&view.Eye), XMLoadFloat3(&view.Target), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const XMMATRIX proj       = XMMatrixPerspectiveFovLH(view.FovY, 16.0f / 9.0f, 1.0f, view.FarZ);
+
+		const FrustumCuller::Frustum frustum = FrustumCuller::ExtractPlanes(XMMatrixMultiply(viewMatrix, proj));
+
+		UINT   flatVisible = 0;
+		double flatMs      = MeasureMilliseconds(5, [&]() { flatVisible = flat.Cull(frustum, visible.data()); });
+
+		UINT                bvhVisible = 0;
+		SceneBvh::CullStats stats;
+		double              bvhMs = MeasureMilliseconds(5, [&]() { bvhVisible = bvh.Cull(frustum, visible.data(), &stats); });
+
+		// The flat loop tests every object once.
+		cout << setprecision(3);
+		cout << setw(10) << left << view.Name << right << setw(8) << "flat" << setw(10) << flatMs << setw(10) << flatVisible
+			<< setw(10) << "-" << setw(10) << "-" << setw(10) << objectCount << endl;
+		cout << setw(10) << left << view.Name << right << setw(8) << "bvh" << setw(10) << bvhMs << setw(10) << bvhVisible
+			<< setw(10) << stats.NodesVisited << setw(10) << stats.NodesAccepted << setw(10) << stats.ObjectsTested
+			<< setw(9) << flatMs / bvhMs << "x" << endl;
+	}
+
+	// Move 1% of the objects and refit their paths, then move all of them and refit the whole tree.
+	uniform_real_distribution<float> offset(-5.0f, 5.0f);
+	auto                             moveObject = [&](UINT object)
+	{
+		bounds[object].Center.x += offset(rng);
+		bounds[object].Center.y += offset(rng);
+		bounds[object].Center.z += offset(rng);
+	};
+
+	double pathMs = MeasureMilliseconds(1, [&]()
+	{
+		for (UINT object = 0; object < objectCount; object += 100)
+		{
+			moveObject(object);
+			bvh.UpdateBounds(object, bounds[object]);
+		}
+	});
+
+	for (UINT object = 0; object < objectCount; ++object)
+	{
+		moveObject(object);
+		bvh.SetBounds(object, bounds[object]);
+	}
+	double refitMs = MeasureMilliseconds(1, [&]() { bvh.Refit(); });
+
+	cout << endl << setprecision(2) << "UpdateBounds on 1% of the objects: " << pathMs << " ms, full Refit: " << refitMs
+		<< " ms, rebuild: " << buildMs << " ms" << endl;
+}
@@ -0,0 +1,105 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	// The vertex most demos draw shapes with.
+	struct AppVertex
+	{
+		XMFLOAT3 Pos;
+		XMFLOAT3 Normal;
+		XMFLOAT2 TexC;
+	};
+
+	using CreateMesh   = function<GeometryGenerator::MeshData()>;
+	using CreateInto   = function<GeometryGenerator::MeshSize(const GeometryGenerator::MeshBuffers&)>;
+	using SortedCorner = vector<float>;
+
+	// Vertices of every triangle corner, for comparing meshes that order them differently.
+	vector<SortedCorner> CornersOf(const GeometryGenerator::Vertex* vertices, const uint32_t* indices, size_t indexCount)
+	{
+		vector<SortedCorner> corners;
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const GeometryGenerator::Vertex& v = vertices[indices[i]];
+			corners.push_back({v.Position.x, v.Position.y, v.Position.z, v.Normal.x, v.Normal.y, v.Normal.z, v.TangentU.x, v.TangentU.y,
+			                   v.TangentU.z, v.TexC.x, v.TexC.y});
+		}
+		sort(corners.begin(), corners.end());
+		return corners;
+	}
+
+	void WriteShape(const char* name, GeometryGenerator::MeshSize size, const CreateMesh& createMesh, const CreateInto& createInto)
+	{
+		// The copies BuildShapeGeometry makes: MeshData, then the app vertices and 16-bit indices, then the blob.
+		vector<uint8_t> blob(size.VertexCount * sizeof(AppVertex) + size.IndexCount * sizeof(uint16_t));
+		const double    copiedMs = MeasureMilliseconds(5, [&]()
+		{
+			GeometryGenerator::MeshData mesh = createMesh();
+			vector<AppVertex>           vertices(mesh.Vertices.size());
+			for (size_t i = 0; i < mesh.Vertices.size(); ++i)
+				vertices[i] = {mesh.Vertices[i].Position, mesh.Vertices[i].Normal, mesh.Vertices[i].TexC};
+			vector<uint16_t> indices(mesh.GetIndices16());
+			memcpy(blob.data(), vertices.data(), vertices.size() * sizeof(AppVertex));
+			memcpy(blob.data() + vertices.size() * sizeof(AppVertex), indices.data(), indices.size() * sizeof(uint16_t));
+		});
+
+		// The same bytes written in place; the tangent is never computed.
+		GeometryGenerator::MeshBuffers out;
+		out.Layout.Stride   = sizeof(AppVertex);
+		out.Layout.Position = {offsetof(AppVertex, Pos), GeometryGenerator::VertexLayout::Float3};
+		out.Layout.Normal   = {offsetof(AppVertex, Normal), GeometryGenerator::VertexLayout::Float3};
+		out.Layout.TexC     = {offsetof(AppVertex, TexC), GeometryGenerator::VertexLayout::Float2};
+		out.Vertices        = blob.data();
+		out.Indices         = blob.data() + size.VertexCount * sizeof(AppVertex);
+		out.Indices16       = true;
+		vector<uint8_t> copied       = blob;
+		const double    directMs     = MeasureMilliseconds(5, [&]() { createInto(out); });
+		const bool      sameAppBytes = copied == blob;
+
+		// With every attribute the strided overload must give the MeshData triangles, corner for corner.
+		const GeometryGenerator::MeshData mesh = createMesh();
+		vector<GeometryGenerator::Vertex> vertices(size.VertexCount);
+		vector<uint32_t>                  indices(size.IndexCount);
+		GeometryGenerator::MeshBuffers    full;
+		full.Layout   = GeometryGenerator::DefaultLayout();
+		full.Vertices = vertices.data();
+		full.Indices  = indices.data();
+		createInto(full);
+		const bool sameVertices = mesh.Vertices.size() == vertices.size() &&
+		                          memcmp(mesh.Vertices.data(), vertices.data(), vertices.size() * sizeof(GeometryGenerator::Vertex)) == 0 &&
+		                          mesh.Indices32 == indices;
+		const bool sameCorners = CornersOf(mesh.Vertices.data(), mesh.Indices32.data(), mesh.Indices32.size()) ==
+		                         CornersOf(vertices.data(), indices.data(), indices.size());
+
+		cout << setw(18) << left << name << right << setw(7) << size.VertexCount << " vertices" << setw(8) << size.IndexCount << " indices  "
+			<< setprecision(3) << setw(7) << copiedMs << " ms copied  " << setw(7) << directMs << " ms in place  ("
+			<< setprecision(1) << copiedMs / directMs << "x)  "
+			<< (!sameVertices ? (sameCorners ? "same triangles, vertices reordered" : "TRIANGLES DIFFER") : sameAppBytes ? "same bytes" : "BYTES DIFFER")
+			<< endl;
+	}
+}
+
+void RunShapeWriterBenchmark()
+{
+	cout << fixed;
+
+	GeometryGenerator geoGen;
+	WriteShape("box 3", GeometryGenerator::BoxSize(3), [&]() { return geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3); },
+	           [&](const GeometryGenerator::MeshBuffers& out) { return geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3, out); });
+	WriteShape("grid 60x40", GeometryGenerator::GridSize(60, 40), [&]() { return geoGen.CreateGrid(20.0f, 30.0f, 60, 40); },
+	           [&](const GeometryGenerator::MeshBuffers& out) { return geoGen.CreateGrid(20.0f, 30.0f, 60, 40, out); });
+	WriteShape("sphere 20x20", GeometryGenerator::SphereSize(20, 20), [&]() { return geoGen.CreateSphere(0.5f, 20, 20); },
+	           [&](const GeometryGenerator::MeshBuffers& out) { return geoGen.CreateSphere(0.5f, 20, 20, out); });
+	WriteShape("cylinder 20x20", GeometryGenerator::CylinderSize(20, 20), [&]() { return geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20); },
+	           [&](const GeometryGenerator::MeshBuffers& out) { return geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20, out); });
+	WriteShape("grid 250x250", GeometryGenerator::GridSize(250, 250), [&]() { return geoGen.CreateGrid(100.0f, 100.0f, 250, 250); },
+	           [&](const GeometryGenerator::MeshBuffers& out) { return geoGen.CreateGrid(100.0f, 100.0f, 250, 250, out); });
+	WriteShape("sphere 250x250", GeometryGenerator::SphereSize(250, 250), [&]() { return geoGen.CreateSphere(0.5f, 250, 250); },
+	           [&](const GeometryGenerator::MeshBuffers& out) { return geoGen.CreateSphere(0.5f, 250, 250, out); });
+}
@@ -0,0 +1,189 @@
+#include "Benchmark.h"
+#include "../../Common/MeshSimplifier.h"
+#include "../../Common/TriangleBvh.h"
+#include "../../Chapter 23 Character Animation/SkinnedMesh/LoadM3d.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	const vector<float> kRatios = {0.5f, 0.25f, 0.125f, 0.0625f};
+
+	// Closest point of triangle abc to p (Ericson, "Real-Time Collision Detection", 5.1.5).
+	XMVECTOR ClosestPointOnTriangle(FXMVECTOR p, FXMVECTOR a, FXMVECTOR b, GXMVECTOR c)
+	{
+		const XMVECTOR ab = b - a;
+		const XMVECTOR ac = c - a;
+		const XMVECTOR ap = p - a;
+		const float    d1 = XMVectorGetX(XMVector3Dot(ab, ap));
+		const float    d2 = XMVectorGetX(XMVector3Dot(ac, ap));
+		if (d1 <= 0.0f && d2 <= 0.0f)
+			return a;
+
+		const XMVECTOR bp = p - b;
+		const float    d3 = XMVectorGetX(XMVector3Dot(ab, bp));
+		const float    d4 = XMVectorGetX(XMVector3Dot(ac, bp));
+		if (d3 >= 0.0f && d4 <= d3)
+			return b;
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+			return a + d1 / (d1 - d3) * ab;
+
+		const XMVECTOR cp = p - c;
+		const float    d5 = XMVectorGetX(XMVector3Dot(ab, cp));
+		const float    d6 = XMVectorGetX(XMVector3Dot(ac, cp));
+		if (d6 >= 0.0f && d5 <= d6)
+			return c;
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+			return a + d2 / (d2 - d6) * ac;
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f)
+			return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+
+		const float denominator = 1.0f / (va + vb + vc);
+		return a + ab * (vb * denominator) + ac * (vc * denominator);
+	}
+
+	// Distance from p to the nearest triangle of the tree, visiting nodes nearer than the best so far.
+	float DistanceToMesh(const TriangleBvh& bvh, const uint8_t* positions, UINT stride, const vector<uint32_t>& indices, FXMVECTOR p)
+	{
+		auto position = [&](uint32_t v) { return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(positions + (size_t)v * stride)); };
+
+		XMFLOAT3 point;
+		XMStoreFloat3(&point, p);
+		auto boxDistanceSq = [&](const TriangleBvh::Node& node)
+		{
+			const float dx = std::max(std::max(node.Min.x - point.x, point.x - node.Max.x), 0.0f);
+			const float dy = std::max(std::max(node.Min.y - point.y, point.y - node.Max.y), 0.0f);
+			const float dz = std::max(std::max(node.Min.z - point.z, point.z - node.Max.z), 0.0f);
+			return dx * dx + dy * dy + dz * dz;
+		};
+
+		float bestSq = FLT_MAX;
+		UINT  stack[64];
+		UINT  stackSize    = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0)
+		{
+			const TriangleBvh::Node& node = bvh.GetNode(stack[--stackSize]);
+			if (boxDistanceSq(node) >= bestSq)
+				continue;
+
+			if (node.Count > 0)
+			{
+				for (UINT i = 0; i < node.Count; ++i)
+				{
+					const UINT     t = bvh.TriangleAt(node.LeftOrFirst + i);
+					const XMVECTOR q = ClosestPointOnTriangle(p, position(indices[t * 3 + 0]), position(indices[t * 3 + 1]), position(indices[t * 3 + 2]));
+					bestSq           = std::min(bestSq, XMVectorGetX(XMVector3LengthSq(q - p)));
+				}
+				continue;
+			}
+
+			// Push the farther child first so the nearer one is searched first.
+			const UINT left  = node.LeftOrFirst;
+			const bool swap  = boxDistanceSq(bvh.GetNode(left)) < boxDistanceSq(bvh.GetNode(left + 1));
+			stack[stackSize++] = swap ? left + 1 : left;
+			stack[stackSize++] = swap ? left : left + 1;
+		}
+		return sqrtf(bestSq);
+	}
+
+	// Checks the error the quadrics report: the distance of every original vertex from the level.
+	void MeasureLevel(const VertexStreams& vertices, const vector<uint32_t>& indices, float& meanDistance, float& maxDistance)
+	{
+		TriangleBvh bvh;
+		bvh.Build(vertices.Positions, vertices.Stride, vertices.VertexCount, indices.data(), (UINT)indices.size());
+
+		const uint8_t* positions = reinterpret_cast<const uint8_t*>(vertices.Positions);
+		double         sum       = 0.0;
+		maxDistance              = 0.0f;
+		for (UINT v = 0; v < vertices.VertexCount; ++v)
+		{
+			const float distance = DistanceToMesh(bvh, positions, vertices.Stride, indices,
+			                                      XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(positions + (size_t)v * vertices.Stride)));
+			sum         += distance;
+			maxDistance  = std::max(maxDistance, distance);
+		}
+		meanDistance = vertices.VertexCount > 0 ? (float)(sum / vertices.VertexCount) : 0.0f;
+	}
+
+	void SimplifyMesh(const char* name, const VertexStreams& vertices, const vector<uint32_t>& indices)
+	{
+		BoundingSphere sphere;
+		BoundingSphere::CreateFromPoints(sphere, vertices.VertexCount, vertices.Positions, vertices.Stride);
+
+		vector<MeshSimplifier::Lod> lods;
+		double                      ms = MeasureMilliseconds(3, [&]()
+		{
+			lods = MeshSimplifier::BuildLodChain(indices.data(), (UINT)indices.size(), vertices, kRatios, MeshSimplifier::Options());
+		});
+
+		const UINT triangleCount = (UINT)indices.size() / 3;
+		cout << name << ": " << triangleCount << " triangles, chain of " << lods.size() << " levels in " << setprecision(1) << ms << " ms ("
+			<< setprecision(2) << triangleCount / (ms * 1000.0) << " M triangles/s); errors in % of the radius" << endl;
+
+		for (size_t i = 0; i < lods.size(); ++i)
+		{
+			float meanDistance = 0.0f;
+			float maxDistance  = 0.0f;
+			MeasureLevel(vertices, lods[i].Indices, meanDistance, maxDistance);
+
+			cout << "  " << setw(6) << setprecision(3) << kRatios[i] << setw(8) << lods[i].Indices.size() / 3 << " tris  quadric error "
+				<< setw(6) << 100.0f * lods[i].Error / sphere.Radius << "  vertex distance mean " << setw(6) << 100.0f * meanDistance / sphere.Radius
+				<< " max " << setw(6) << 100.0f * maxDistance / sphere.Radius << endl;
+		}
+	}
+
+	void SimplifyMesh(const char* name, const GeometryGenerator::MeshData& mesh)
+	{
+		SimplifyMesh(name, VertexStreams::Describe(mesh), mesh.Indices32);
+	}
+}
+
+void RunSimplifierBenchmark()
+{
+	cout << fixed;
+
+	GeometryGenerator geoGen;
+	SimplifyMesh("sphere", geoGen.CreateSphere(1.0f, 100, 100));
+	SimplifyMesh("cylinder", geoGen.CreateCylinder(1.0f, 0.5f, 3.0f, 100, 40));
+
+	const char* models[][2] = {{"skull.txt", kSkullPath}, {"car.txt", kCarPath}};
+	for (const auto& model : models)
+	{
+		GeometryGenerator::MeshData mesh;
+		if (LoadTextModel(model[1], mesh))
+			SimplifyMesh(model[0], mesh);
+		else
+			cout << "skipped: " << model[1] << " not found (run from Tools/Benchmarks)" << endl;
+	}
+
+	vector<M3DLoader::SkinnedVertex> vertices;
+	vector<USHORT>                   indices;
+	vector<M3DLoader::Subset>        subsets;
+	vector<M3DLoader::M3dMaterial>   mats;
+	SkinnedData                      skinInfo;
+	M3DLoader                        loader;
+	if (!loader.LoadM3d(kSoldierPath, vertices, indices, subsets, mats, skinInfo))
+	{
+		cout << "skipped: " << kSoldierPath << " not found (run from Tools/Benchmarks)" << endl;
+		return;
+	}
+
+	// The whole soldier in the bind pose, with texture seams and bone weights.
+	VertexStreams soldier;
+	soldier.VertexCount = (UINT)vertices.size();
+	soldier.Stride      = sizeof(M3DLoader::SkinnedVertex);
+	soldier.Positions   = &vertices[0].Pos;
+	soldier.Normals     = &vertices[0].Normal;
+	soldier.TexCoords   = &vertices[0].TexC;
+	soldier.BoneWeights = &vertices[0].BoneWeights;
+	soldier.BoneIndices = vertices[0].BoneIndices;
+	SimplifyMesh("soldier.m3d", soldier, vector<uint32_t>(indices.begin(), indices.end()));
+}
@@ -0,0 +1,86 @@
+#include "Benchmark.h"
+#include "../../Common/TangentGenerator.h"
+#include "../../Common/ParallelFor.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	// Rebuilds the tangents of a mesh on one thread and on all of them, and compares them with the analytic
+	// tangents the generator wrote and with each other.
+	void GenerateTangents(const char* name, const GeometryGenerator::MeshData& source)
+	{
+		GeometryGenerator::MeshData serial   = source;
+		GeometryGenerator::MeshData parallel = source;
+		TangentGenerator::Report    report;
+		const double                serialMs   = MeasureMilliseconds(3, [&]() { report = TangentGenerator::Generate(serial, 1); });
+		const double                parallelMs = MeasureMilliseconds(3, [&]() { TangentGenerator::Generate(parallel, 0); });
+
+		// Any thread count must give the same bits.
+		UINT differing = 0;
+		for (UINT threads : {2u, 3u, 0u})
+		{
+			GeometryGenerator::MeshData other = source;
+			TangentGenerator::Generate(other, threads);
+			for (size_t v = 0; v < source.Vertices.size(); ++v)
+				differing += memcmp(&other.Vertices[v].TangentU, &serial.Vertices[v].TangentU, sizeof(XMFLOAT3)) != 0 ? 1 : 0;
+		}
+
+		// Angle to the analytic tangent, where there is one; the poles and seams of the generator have none
+		// that texture coordinates agree with, so the 99th percentile is shown beside the mean.
+		vector<float> errors;
+		for (size_t v = 0; v < source.Vertices.size(); ++v)
+		{
+			const XMVECTOR expected = XMLoadFloat3(&source.Vertices[v].TangentU);
+			const XMVECTOR actual   = XMLoadFloat3(&serial.Vertices[v].TangentU);
+			if (XMVectorGetX(XMVector3LengthSq(expected)) == 0.0f)
+				continue;
+			const XMVECTOR unit = XMVector3Normalize(expected);
+			errors.push_back(XMConvertToDegrees(atan2f(XMVectorGetX(XMVector3Length(XMVector3Cross(unit, actual))),
+			                                           XMVectorGetX(XMVector3Dot(unit, actual)))));
+		}
+
+		float mean = 0.0f;
+		for (float error : errors)
+			mean += error / errors.size();
+		sort(errors.begin(), errors.end());
+		const float p99 = errors.empty() ? 0.0f : errors[errors.size() * 99 / 100];
+
+		cout << setw(14) << left << name << right << setw(8) << report.VertexCount << " vertices" << setw(8) << report.TriangleCount << " tris  "
+			<< setprecision(2) << setw(7) << serialMs << " ms 1 thread  " << setw(6) << parallelMs << " ms " << ResolveThreadCount(0, ~0u)
+			<< " threads  " << setw(6) << report.FallbackVertices << " from normal  " << setw(5) << report.MirroredVertices << " mirrored  error "
+			<< setprecision(3) << mean << " deg mean " << p99 << " deg p99  " << differing << " differing" << endl;
+	}
+}
+
+void RunTangentBenchmark()
+{
+	cout << fixed;
+
+	GeometryGenerator geoGen;
+	GenerateTangents("box", geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3));
+	GenerateTangents("cylinder", geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20));
+	GenerateTangents("grid 300x300", geoGen.CreateGrid(20.0f, 30.0f, 300, 300));
+	GenerateTangents("sphere 500x500", geoGen.CreateSphere(0.5f, 500, 500));
+	GenerateTangents("geosphere 6", geoGen.CreateGeosphere(0.5f, 6));
+
+	// Texture coordinates mirrored across x = 0, as an artist would lay out a symmetric model.
+	GeometryGenerator::MeshData mirrored = geoGen.CreateGrid(20.0f, 30.0f, 300, 300);
+	for (GeometryGenerator::Vertex& vertex : mirrored.Vertices)
+	{
+		vertex.TexC.x = fabsf(vertex.Position.x) / 10.0f;
+		if (vertex.Position.x < 0.0f)
+			vertex.TangentU = XMFLOAT3(-1.0f, 0.0f, 0.0f);
+	}
+	GenerateTangents("grid mirrored", mirrored);
+
+	// No texture coordinates: every tangent comes from the normal, as the demos need for the skull.
+	GeometryGenerator::MeshData skull;
+	if (LoadTextModel(kSkullPath, skull))
+		GenerateTangents("skull.txt", skull);
+	else
+		cout << "skipped: " << kSkullPath << " not found (run from Tools/Benchmarks)" << endl;
+}
@@ -0,0 +1,131 @@
+#include "Benchmark.h"
+#include "../../Common/GeometryGenerator.h"
+#include "../../Common/TriangleBvh.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	struct PickRay
+	{
+		XMFLOAT3 Origin;
+		XMFLOAT3 Direction; // unit length
+	};
+
+	// The loop PickingApp::Pick used to run: every triangle, nearest hit wins.
+	bool PickBruteForce(const GeometryGenerator::MeshData& mesh, const PickRay& ray, float& tmin, UINT& triangle)
+	{
+		const XMVECTOR origin    = XMLoadFloat3(&ray.Origin);
+		const XMVECTOR direction = XMLoadFloat3(&ray.Direction);
+		const UINT     triCount  = (UINT)mesh.Indices32.size() / 3;
+
+		bool found = false;
+		tmin       = MathHelper::Infinity;
+		for (UINT i = 0; i < triCount; ++i)
+		{
+			XMVECTOR v0 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[i * 3 + 0]].Position);
+			XMVECTOR v1 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[i * 3 + 1]].Position);
+			XMVECTOR v2 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[i * 3 + 2]].Position);
+
+			float t = 0.0f;
+			if (TriangleTests::Intersects(origin, direction, v0, v1, v2, t) && t < tmin)
+			{
+				tmin     = t;
+				triangle = i;
+				found    = true;
+			}
+		}
+		return found;
+	}
+}
+
+void RunTriangleBvhBenchmark()
+{
+	// A bumpy sphere of two million triangles, standing in for a scanned or sculpted mesh.
+	GeometryGenerator           geoGen;
+	GeometryGenerator::MeshData mesh = geoGen.CreateSphere(1.0f, 1000, 1000);
+	for (auto& vertex : mesh.Vertices)
+	{
+		const XMVECTOR p     = XMLoadFloat3(&vertex.Position);
+		const float    bumps = 1.0f + 0.05f * sinf(17.0f * vertex.Position.x) * cosf(13.0f * vertex.Position.y) * sinf(11.0f * vertex.Position.z);
+		XMStoreFloat3(&vertex.Position, XMVectorScale(p, bumps));
+	}
+
+	const UINT triangleCount = (UINT)mesh.Indices32.size() / 3;
+
+	TriangleBvh bvh;
+	double      buildMs = MeasureMilliseconds(1, [&]()
+	{
+		bvh.Build(&mesh.Vertices[0].Position, sizeof(GeometryGenerator::Vertex), (UINT)mesh.Vertices.size(),
+		          mesh.Indices32.data(), (UINT)mesh.Indices32.size());
+	});
+
+	cout << triangleCount << " triangles, SAH build " << fixed << setprecision(1) << buildMs << " ms, "
+		<< bvh.NodeCount() << " nodes (" << bvh.NodeCount() * sizeof(TriangleBvh::Node) / 1024 << " KB)" << endl;
+
+	// Picking rays from a camera orbit towards points around the mesh; a bit over half of them miss.
+	mt19937                          rng(triangleCount);
+	uniform_real_distribution<float> angle(0.0f, XM_2PI);
+	uniform_real_distribution<float> target(-1.5f, 1.5f);
+
+	vector<PickRay> rays(100000);
+	for (auto& ray : rays)
+	{
+		const float    a      = angle(rng);
+		const XMVECTOR origin = XMVectorSet(4.0f * cosf(a), target(rng), 4.0f * sinf(a), 1.0f);
+		const XMVECTOR aim    = XMVectorSet(target(rng), target(rng), target(rng), 1.0f);
+		XMStoreFloat3(&ray.Origin, origin);
+		XMStoreFloat3(&ray.Direction, XMVector3Normalize(aim - origin));
+	}
+
+	// The brute force loop is far too slow for every ray: time a few and check them against the tree.
+	const UINT bruteCount = 16;
+	UINT       mismatches = 0;
+	double     bruteMs    = MeasureMilliseconds(1, [&]()
+	{
+		for (UINT i = 0; i < bruteCount; ++i)
+		{
+			float            t        = 0.0f;
+			UINT             triangle = 0;
+			const bool       found    = PickBruteForce(mesh, rays[i], t, triangle);
+			TriangleBvh::Hit hit;
+			const bool       bvhFound = bvh.Intersect(XMLoadFloat3(&rays[i].Origin), XMLoadFloat3(&rays[i].Direction), MathHelper::Infinity, hit);
+			if (found != bvhFound || (found && fabsf(t - hit.T) > 1e-4f))
+				++mismatches;
+		}
+	});
+
+	UINT                    hits = 0;
+	TriangleBvh::TraceStats stats;
+	double                  closestMs = MeasureMilliseconds(3, [&]()
+	{
+		hits  = 0;
+		stats = TriangleBvh::TraceStats();
+		for (const auto& ray : rays)
+		{
+			TriangleBvh::Hit hit;
+			hits += bvh.Intersect(XMLoadFloat3(&ray.Origin), XMLoadFloat3(&ray.Direction), MathHelper::Infinity, hit, &stats) ? 1 : 0;
+		}
+	});
+
+	UINT   occluded = 0;
+	double anyMs    = MeasureMilliseconds(3, [&]()
+	{
+		occluded = 0;
+		for (const auto& ray : rays)
+			occluded += bvh.Occluded(XMLoadFloat3(&ray.Origin), XMLoadFloat3(&ray.Direction), MathHelper::Infinity) ? 1 : 0;
+	});
+
+	const double rayCount = (double)rays.size();
+	cout << setprecision(3)
+		<< "brute force: " << bruteMs / bruteCount << " ms/ray" << endl
+		<< "closest hit: " << closestMs * 1000.0 / rayCount << " us/ray, " << rayCount / (closestMs * 1000.0) << " Mrays/s, "
+		<< hits << " hits, " << setprecision(1) << stats.NodesVisited / rayCount << " nodes and "
+		<< stats.TrianglesTested / rayCount << " triangles per ray" << endl
+		<< setprecision(3) << "any hit:     " << anyMs * 1000.0 / rayCount << " us/ray, " << rayCount / (anyMs * 1000.0) << " Mrays/s, "
+		<< occluded << " occluded" << endl
+		<< setprecision(0) << "speedup over brute force: " << (bruteMs / bruteCount) / (closestMs / rayCount) << "x, "
+		<< mismatches << " of " << bruteCount << " checked rays differ" << endl;
+}
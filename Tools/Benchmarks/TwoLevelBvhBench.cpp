@@ -0,0 +1,181 @@
+#include "Benchmark.h"
+#include "../../Common/GeometryGenerator.h"
+#include "../../Common/TwoLevelBvh.h"
+#include <random>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	// What picking without a top level costs: every instance, ray moved into its space, traced through its mesh.
+	bool IntersectEveryInstance(const vector<const TriangleBvh*>& meshes, const vector<XMFLOAT4X4>& worlds,
+	                            FXMVECTOR origin, FXMVECTOR direction, TwoLevelBvh::Hit& hit)
+	{
+		float closest = MathHelper::Infinity;
+		bool  found   = false;
+		for (UINT i = 0; i < (UINT)worlds.size(); ++i)
+		{
+			const XMMATRIX invWorld = XMMatrixInverse(nullptr, XMLoadFloat4x4(&worlds[i]));
+
+			TriangleBvh::Hit meshHit;
+			if (meshes[i]->Intersect(XMVector3TransformCoord(origin, invWorld), XMVector3TransformNormal(direction, invWorld), closest, meshHit))
+			{
+				closest      = meshHit.T;
+				hit.Instance = i;
+				hit.Mesh     = meshHit;
+				found        = true;
+			}
+		}
+		return found;
+	}
+}
+
+void RunTwoLevelBvhBenchmark()
+{
+	// Three meshes shared by a quarter of a million instances scattered over a 1 km field.
+	GeometryGenerator           geoGen;
+	GeometryGenerator::MeshData shapes[] =
+	{
+		geoGen.CreateGeosphere(0.5f, 3),
+		geoGen.CreateCylinder(0.5f, 0.3f, 2.0f, 20, 4),
+		geoGen.CreateBox(1.0f, 1.0f, 1.0f, 2),
+	};
+
+	TriangleBvh meshBvhs[_countof(shapes)];
+	UINT        meshTriangles = 0;
+	for (UINT i = 0; i < _countof(shapes); ++i)
+	{
+		meshBvhs[i].Build(&shapes[i].Vertices[0].Position, sizeof(GeometryGenerator::Vertex), (UINT)shapes[i].Vertices.size(),
+		                  shapes[i].Indices32.data(), (UINT)shapes[i].Indices32.size());
+		meshTriangles += meshBvhs[i].TriangleCount();
+	}
+
+	const UINT instanceCount = 250000;
+
+	mt19937                          rng(instanceCount);
+	uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	vector<const TriangleBvh*> meshes(instanceCount);
+	vector<XMFLOAT4X4>         worlds(instanceCount);
+	UINT64                     flatTriangles = 0;
+	for (UINT i = 0; i < instanceCount; ++i)
+	{
+		meshes[i] = &meshBvhs[i % _countof(shapes)];
+		XMStoreFloat4x4(&worlds[i], XMMatrixScaling(0.5f + 1.5f * unit(rng), 0.5f + 1.5f * unit(rng), 0.5f + 1.5f * unit(rng)) *
+		                            XMMatrixRotationRollPitchYaw(XM_2PI * unit(rng), XM_2PI * unit(rng), XM_2PI * unit(rng)) *
+		                            XMMatrixTranslation(1000.0f * unit(rng) - 500.0f, 20.0f * unit(rng), 1000.0f * unit(rng) - 500.0f));
+		flatTriangles += meshes[i]->TriangleCount();
+	}
+
+	TwoLevelBvh scene;
+	double      addMs = MeasureMilliseconds(1, [&]()
+	{
+		scene.Clear();
+		for (UINT i = 0; i < instanceCount; ++i)
+			scene.AddInstance(meshes[i], XMLoadFloat4x4(&worlds[i]));
+	});
+	double buildMs = MeasureMilliseconds(1, [&]() { scene.Build(); });
+
+	cout << instanceCount << " instances of " << _countof(shapes) << " meshes (" << meshTriangles << " triangles shared, "
+		<< flatTriangles / 1000000 << "M if every instance had its own copy)" << endl
+		<< fixed << setprecision(1) << "add instances " << addMs << " ms, top level build " << buildMs << " ms, "
+		<< scene.TopLevel().NodeCount() << " nodes" << endl;
+
+	// Rays from a few metres above the field looking down at it at random angles, like picking from a
+	// camera over the scene.
+	vector<XMFLOAT3> origins(100000);
+	vector<XMFLOAT3> directions(origins.size());
+	auto makeRays = [&]()
+	{
+		for (size_t i = 0; i < origins.size(); ++i)
+		{
+			origins[i]    = XMFLOAT3(1000.0f * unit(rng) - 500.0f, 30.0f + 20.0f * unit(rng), 1000.0f * unit(rng) - 500.0f);
+			const float a = XM_2PI * unit(rng);
+			XMStoreFloat3(&directions[i], XMVector3Normalize(XMVectorSet(cosf(a), -0.05f - 0.5f * unit(rng), sinf(a), 0.0f)));
+		}
+	};
+
+	// Checks a few rays against the loop over every instance.
+	auto countMismatches = [&](UINT rayCount)
+	{
+		UINT mismatches = 0;
+		for (UINT i = 0; i < rayCount; ++i)
+		{
+			const XMVECTOR   origin    = XMLoadFloat3(&origins[i]);
+			const XMVECTOR   direction = XMLoadFloat3(&directions[i]);
+			TwoLevelBvh::Hit expected, actual;
+			const bool       found     = IntersectEveryInstance(meshes, worlds, origin, direction, expected);
+			const bool       sceneHit  = scene.Intersect(origin, direction, MathHelper::Infinity, actual);
+			if (found != sceneHit || (found && (expected.Instance != actual.Instance || fabsf(expected.Mesh.T - actual.Mesh.T) > 1e-3f)))
+				++mismatches;
+		}
+		return mismatches;
+	};
+
+	auto traceAll = [&](TwoLevelBvh::TraceStats& stats, UINT& hits)
+	{
+		return MeasureMilliseconds(3, [&]()
+		{
+			hits  = 0;
+			stats = TwoLevelBvh::TraceStats();
+			for (size_t i = 0; i < origins.size(); ++i)
+			{
+				TwoLevelBvh::Hit hit;
+				hits += scene.Intersect(XMLoadFloat3(&origins[i]), XMLoadFloat3(&directions[i]), MathHelper::Infinity, hit, &stats) ? 1 : 0;
+			}
+		});
+	};
+
+	makeRays();
+
+	const UINT bruteCount = 20;
+	double     bruteMs    = MeasureMilliseconds(1, [&]()
+	{
+		for (UINT i = 0; i < bruteCount; ++i)
+		{
+			TwoLevelBvh::Hit hit;
+			IntersectEveryInstance(meshes, worlds, XMLoadFloat3(&origins[i]), XMLoadFloat3(&directions[i]), hit);
+		}
+	});
+	UINT mismatches = countMismatches(bruteCount);
+
+	TwoLevelBvh::TraceStats stats;
+	UINT                    hits      = 0;
+	double                  closestMs = traceAll(stats, hits);
+
+	const double rayCount = (double)origins.size();
+	cout << setprecision(3)
+		<< "every instance: " << bruteMs / bruteCount << " ms/ray" << endl
+		<< "two level:      " << closestMs * 1000.0 / rayCount << " us/ray, " << rayCount / (closestMs * 1000.0) << " Mrays/s, "
+		<< hits << " hits, " << setprecision(1) << stats.NodesVisited / rayCount << " top level nodes, "
+		<< stats.InstancesTested / rayCount << " instances and " << stats.Mesh.TrianglesTested / rayCount << " triangles per ray, "
+		<< mismatches << " of " << bruteCount << " checked rays differ" << endl;
+
+	// Move every instance a little, as a physics step would, then refit instead of rebuilding.
+	normal_distribution<float> step(0.0f, 0.5f);
+	for (auto& world : worlds)
+	{
+		world._41 += step(rng);
+		world._42 += step(rng);
+		world._43 += step(rng);
+	}
+
+	double refitMs = MeasureMilliseconds(1, [&]()
+	{
+		for (UINT i = 0; i < instanceCount; ++i)
+			scene.SetTransform(i, XMLoadFloat4x4(&worlds[i]));
+		scene.Refit();
+	});
+
+	makeRays();
+	mismatches            = countMismatches(bruteCount);
+	double refitTraceMs   = traceAll(stats, hits);
+	double rebuildMs      = MeasureMilliseconds(1, [&]() { scene.Build(); });
+	double rebuiltTraceMs = traceAll(stats, hits);
+
+	cout << "after moving every instance:" << endl
+		<< "  refit:   " << refitMs << " ms (including the transforms), " << setprecision(3) << rayCount / (refitTraceMs * 1000.0) << " Mrays/s, "
+		<< mismatches << " of " << bruteCount << " checked rays differ" << endl
+		<< setprecision(1) << "  rebuild: " << rebuildMs << " ms, " << setprecision(3) << rayCount / (rebuiltTraceMs * 1000.0) << " Mrays/s" << endl;
+}
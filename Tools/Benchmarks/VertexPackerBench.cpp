@@ -0,0 +1,78 @@
+#include "Benchmark.h"
+#include "../../Common/VertexPacker.h"
+#include "../../Chapter 23 Character Animation/SkinnedMesh/LoadM3d.h"
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	template <typename Packed>
+	void PackMesh(const char* name, const VertexStreams& vertices)
+	{
+		BoundingBox bounds;
+		BoundingBox::CreateFromPoints(bounds, vertices.VertexCount, vertices.Positions, vertices.Stride);
+
+		vector<Packed>       packed(vertices.VertexCount);
+		VertexPacker::Report report;
+		double               ms = MeasureMilliseconds(3, [&]()
+		{
+			report = VertexPacker::Pack(packed.data(), vertices, VertexPacker::QuantizationOf(bounds));
+		});
+
+		const float diagonal = 2.0f * XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents)));
+		cout << setw(12) << left << name << right << setw(8) << report.VertexCount << setw(9) << report.SourceBytes / 1024.0f << " KB ->"
+			<< setw(8) << report.PackedBytes / 1024.0f << " KB (" << setprecision(2) << (float)report.SourceBytes / report.PackedBytes << "x) in "
+			<< ms << " ms" << endl
+			<< "              position " << setprecision(4) << 100.0f * report.MaxPositionError / diagonal << "% of the diagonal, normal "
+			<< setprecision(3) << report.MaxNormalError << " deg, tangent " << report.MaxTangentError << " deg, uv " << setprecision(6)
+			<< report.MaxTexCoordError;
+		if (vertices.BoneWeights != nullptr)
+			cout << ", weight " << setprecision(4) << report.MaxBoneWeightError;
+		cout << setprecision(1) << endl;
+	}
+}
+
+void RunVertexPackerBenchmark()
+{
+	cout << fixed << setprecision(1);
+
+	GeometryGenerator geoGen;
+	PackMesh<VertexPacker::PackedVertex>("box", VertexStreams::Describe(geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3)));
+	PackMesh<VertexPacker::PackedVertex>("grid", VertexStreams::Describe(geoGen.CreateGrid(20.0f, 30.0f, 60, 40)));
+	PackMesh<VertexPacker::PackedVertex>("sphere", VertexStreams::Describe(geoGen.CreateSphere(0.5f, 20, 20)));
+	PackMesh<VertexPacker::PackedVertex>("cylinder", VertexStreams::Describe(geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20)));
+
+	const char* models[][2] = {{"skull.txt", kSkullPath}, {"car.txt", kCarPath}};
+	for (const auto& model : models)
+	{
+		GeometryGenerator::MeshData mesh;
+		if (LoadTextModel(model[1], mesh))
+			PackMesh<VertexPacker::PackedVertex>(model[0], VertexStreams::Describe(mesh));
+		else
+			cout << "skipped: " << model[1] << " not found (run from Tools/Benchmarks)" << endl;
+	}
+
+	vector<M3DLoader::SkinnedVertex> vertices;
+	vector<USHORT>                   indices;
+	vector<M3DLoader::Subset>        subsets;
+	vector<M3DLoader::M3dMaterial>   mats;
+	SkinnedData                      skinInfo;
+	M3DLoader                        loader;
+	if (!loader.LoadM3d(kSoldierPath, vertices, indices, subsets, mats, skinInfo))
+	{
+		cout << "skipped: " << kSoldierPath << " not found (run from Tools/Benchmarks)" << endl;
+		return;
+	}
+
+	VertexStreams soldier;
+	soldier.VertexCount = (UINT)vertices.size();
+	soldier.Stride      = sizeof(M3DLoader::SkinnedVertex);
+	soldier.Positions   = &vertices[0].Pos;
+	soldier.Normals     = &vertices[0].Normal;
+	soldier.TangentUs   = &vertices[0].TangentU;
+	soldier.TexCoords   = &vertices[0].TexC;
+	soldier.BoneWeights = &vertices[0].BoneWeights;
+	soldier.BoneIndices = vertices[0].BoneIndices;
+	PackMesh<VertexPacker::PackedSkinnedVertex>("soldier.m3d", soldier);
+}
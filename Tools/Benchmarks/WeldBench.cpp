@@ -0,0 +1,89 @@
+#include "Benchmark.h"
+#include "../../Common/MeshWelder.h"
+#include <cmath>
+
+using namespace std;
+using namespace DirectX;
+
+namespace
+{
+	void WeldMesh(const char* name, const char* variant, const GeometryGenerator::MeshData& source, const MeshWelder::Options& options)
+	{
+		GeometryGenerator::MeshData mesh;
+		vector<uint32_t>            remap;
+		MeshWelder::Report          report;
+		double                      ms = MeasureMilliseconds(3, [&]()
+		{
+			mesh   = source;
+			report = MeshWelder::Weld(mesh.Vertices.data(), sizeof(GeometryGenerator::Vertex), (UINT)mesh.Vertices.size(), mesh.Indices32.data(),
+			                          (UINT)mesh.Indices32.size(), options, &remap);
+			mesh.Vertices.resize(report.VertexCountAfter);
+			mesh.Indices32.resize(report.TriangleCountAfter * 3);
+		});
+
+		// Every old vertex must have welded into one that matches it within the epsilons.
+		UINT mismatched = 0;
+		for (size_t v = 0; v < source.Vertices.size(); ++v)
+		{
+			const uint8_t* original = reinterpret_cast<const uint8_t*>(&source.Vertices[v]);
+			const uint8_t* welded   = reinterpret_cast<const uint8_t*>(&mesh.Vertices[remap[v]]);
+			for (const MeshWelder::Attribute& attribute : options.Attributes)
+			{
+				for (UINT c = 0; c < attribute.Components; ++c)
+				{
+					const float a = reinterpret_cast<const float*>(original + attribute.Offset)[c];
+					const float b = reinterpret_cast<const float*>(welded + attribute.Offset)[c];
+					mismatched   += fabs(a - b) <= attribute.Epsilon ? 0 : 1;
+				}
+			}
+		}
+
+		cout << setw(10) << left << name << setw(22) << variant << right << setw(8) << report.VertexCountBefore << " -> " << setw(7)
+			<< report.VertexCountAfter << " vertices (" << setw(5) << setprecision(1) << 100.0f * report.VertexCountAfter / report.VertexCountBefore
+			<< "%)  " << setw(7) << report.TriangleCountBefore - report.TriangleCountAfter << " tris dropped  " << setprecision(2) << ms << " ms  "
+			<< mismatched << " mismatched" << endl;
+	}
+
+	void WeldVariants(const char* name, const GeometryGenerator::MeshData& mesh)
+	{
+		BoundingBox bounds;
+		BoundingBox::CreateFromPoints(bounds, mesh.Vertices.size(), &mesh.Vertices[0].Position, sizeof(GeometryGenerator::Vertex));
+		const float diagonal = 2.0f * XMVectorGetX(XMVector3Length(XMLoadFloat3(&bounds.Extents)));
+
+		MeshWelder::Options options;
+		options.Attributes = MeshWelder::VertexAttributes(0.0f, 0.0f, 0.0f);
+		WeldMesh(name, "exact", mesh, options);
+
+		// Positions and normals only, as for a mesh lit without a normal map or texture.
+		options.Attributes.resize(2);
+		WeldMesh(name, "position + normal", mesh, options);
+
+		// Positions alone within 1e-5 of the diagonal, for collision or shadow geometry; seams close up.
+		options.Attributes.resize(1);
+		options.Attributes[0].Epsilon = 1e-5f * diagonal;
+		options.RemoveDegenerates     = true;
+		WeldMesh(name, "position ~1e-5", mesh, options);
+	}
+}
+
+void RunWeldBenchmark()
+{
+	cout << fixed;
+
+	GeometryGenerator geoGen;
+	WeldVariants("box", geoGen.CreateBox(1.0f, 1.0f, 1.0f, 3));
+	WeldVariants("cylinder", geoGen.CreateCylinder(0.5f, 0.3f, 3.0f, 20, 20));
+	WeldVariants("sphere", geoGen.CreateSphere(0.5f, 100, 100));
+	WeldVariants("geosphere", geoGen.CreateGeosphere(0.5f, 5));
+	WeldVariants("grid", geoGen.CreateGrid(20.0f, 30.0f, 300, 300));
+
+	const char* models[][2] = {{"skull.txt", kSkullPath}, {"car.txt", kCarPath}};
+	for (const auto& model : models)
+	{
+		GeometryGenerator::MeshData mesh;
+		if (LoadTextModel(model[1], mesh))
+			WeldVariants(model[0], mesh);
+		else
+			cout << "skipped: " << model[1] << " not found (run from Tools/Benchmarks)" << endl;
+	}
+}
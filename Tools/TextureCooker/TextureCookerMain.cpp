@@ -0,0 +1,178 @@
+//***************************************************************************************
+// TextureCookerMain.cpp
+//
+// Offline block compression for the DDS textures used by the demos.
+//
+// Usage: TextureCooker [-f auto|bc1|bc3|bc5|bc7] [-srgb] [-keepmips] [-kaiser] [-j threads] [-o outdir] <file.dds | dir>...
+//
+// Directories are expanded to the *.dds files they contain. Without -o the files are cooked in place.
+//***************************************************************************************
+
+#include "../../Common/TextureCooker.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace std;
+
+namespace
+{
+	void PrintUsage()
+	{
+		wcout << L"usage: TextureCooker [-f auto|bc1|bc3|bc5|bc7] [-srgb] [-keepmips] [-kaiser] [-j threads] [-o outdir] <file.dds | dir>..." << endl;
+		wcout << L"  -f         block format (default auto: bc5 for *_nmap, bc3 with alpha, bc1 otherwise)" << endl;
+		wcout << L"  -srgb      treat colour input as sRGB" << endl;
+		wcout << L"  -keepmips  encode the source mips instead of rebuilding the chain" << endl;
+		wcout << L"  -kaiser    build mips with a Kaiser filter instead of a box filter" << endl;
+		wcout << L"  -j         worker threads (default: one per hardware thread)" << endl;
+		wcout << L"  -o         output directory (default: overwrite the input)" << endl;
+	}
+
+	bool ParseFormat(const wstring& name, TextureCooker::BlockFormat& format)
+	{
+		if (name == L"auto") format = TextureCooker::BlockFormat::Auto;
+		else if (name == L"bc1") format = TextureCooker::BlockFormat::BC1;
+		else if (name == L"bc3") format = TextureCooker::BlockFormat::BC3;
+		else if (name == L"bc5") format = TextureCooker::BlockFormat::BC5;
+		else if (name == L"bc7") format = TextureCooker::BlockFormat::BC7;
+		else return false;
+		return true;
+	}
+
+	const wchar_t* FormatName(DXGI_FORMAT format)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_BC1_UNORM: return L"BC1";
+		case DXGI_FORMAT_BC1_UNORM_SRGB: return L"BC1_SRGB";
+		case DXGI_FORMAT_BC2_UNORM: return L"BC2";
+		case DXGI_FORMAT_BC3_UNORM: return L"BC3";
+		case DXGI_FORMAT_BC3_UNORM_SRGB: return L"BC3_SRGB";
+		case DXGI_FORMAT_BC4_UNORM: return L"BC4";
+		case DXGI_FORMAT_BC5_UNORM: return L"BC5";
+		case DXGI_FORMAT_BC7_UNORM: return L"BC7";
+		case DXGI_FORMAT_BC7_UNORM_SRGB: return L"BC7_SRGB";
+		case DXGI_FORMAT_R8G8B8A8_UNORM: return L"RGBA8";
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB: return L"RGBA8_SRGB";
+		case DXGI_FORMAT_B8G8R8A8_UNORM: return L"BGRA8";
+		case DXGI_FORMAT_B8G8R8X8_UNORM: return L"BGRX8";
+		case DXGI_FORMAT_R16G16B16A16_FLOAT: return L"RGBA16F";
+		case DXGI_FORMAT_R32G32B32A32_FLOAT: return L"RGBA32F";
+		default: return L"other";
+		}
+	}
+
+	// Appends path, or the *.dds files inside it when it is a directory.
+	void ExpandPath(const wstring& path, vector<wstring>& files)
+	{
+		DWORD attributes = GetFileAttributesW(path.c_str());
+		if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY))
+		{
+			files.push_back(path);
+			return;
+		}
+
+		WIN32_FIND_DATAW findData;
+		HANDLE           find = FindFirstFileW((path + L"\\*.dds").c_str(), &findData);
+		if (find == INVALID_HANDLE_VALUE)
+			return;
+
+		do
+		{
+			if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+				files.push_back(path + L"\\" + findData.cFileName);
+		}
+		while (FindNextFileW(find, &findData));
+
+		FindClose(find);
+	}
+
+	wstring FileNameOf(const wstring& path)
+	{
+		size_t slash = path.find_last_of(L"\\/");
+		return slash == wstring::npos ? path : path.substr(slash + 1);
+	}
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+	TextureCooker::Options options;
+	wstring                outputDir;
+	vector<wstring>        files;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		wstring arg = argv[i];
+		if (arg == L"-f" && i + 1 < argc)
+		{
+			if (!ParseFormat(argv[++i], options.Format))
+			{
+				PrintUsage();
+				return 1;
+			}
+		}
+		else if (arg == L"-srgb")
+			options.ForceSrgb = true;
+		else if (arg == L"-keepmips")
+			options.GenerateMips = false;
+		else if (arg == L"-kaiser")
+			options.MipFilter = MipGenerator::Filter::Kaiser;
+		else if (arg == L"-j" && i + 1 < argc)
+			options.ThreadCount = (UINT)_wtoi(argv[++i]);
+		else if (arg == L"-o" && i + 1 < argc)
+			outputDir = argv[++i];
+		else if (!arg.empty() && arg[0] == L'-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+			ExpandPath(arg, files);
+	}
+
+	if (files.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (!outputDir.empty())
+		CreateDirectoryW(outputDir.c_str(), nullptr);
+
+	int    failures    = 0;
+	UINT64 sourceTotal = 0;
+	UINT64 cookedTotal = 0;
+
+	wcout << fixed << setprecision(2);
+	for (const auto& file : files)
+	{
+		wstring destination = outputDir.empty() ? file : outputDir + L"\\" + FileNameOf(file);
+		try
+		{
+			TextureCooker::Report report = TextureCooker::CookFile(file, destination, options);
+			sourceTotal += report.SourceBytes;
+			cookedTotal += report.CookedBytes;
+
+			wcout << FileNameOf(file) << L": "
+				<< FormatName(report.SourceFormat) << L" -> " << FormatName(report.CookedFormat) << L", "
+				<< report.Width << L"x" << report.Height << L"x" << report.ArraySize << L", "
+				<< report.MipLevels << L" mips, "
+				<< report.Psnr << L" dB, "
+				<< report.SourceBytes / 1024 << L" KB -> " << report.CookedBytes / 1024 << L" KB, "
+				<< report.Milliseconds << L" ms" << endl;
+		}
+		catch (DxException& e)
+		{
+			wcout << FileNameOf(file) << L": failed, " << e.ToString() << endl;
+			++failures;
+		}
+	}
+
+	if (cookedTotal > 0)
+	{
+		wcout << files.size() - failures << L" cooked, " << failures << L" failed, "
+			<< sourceTotal / 1024 << L" KB -> " << cookedTotal / 1024 << L" KB ("
+			<< (double)sourceTotal / (double)cookedTotal << L":1)" << endl;
+	}
+
+	return failures == 0 ? 0 : 1;
+}